@@ -0,0 +1,374 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup Positioning
+* \brief UDP listener for the SensorLogger iPhone app shared by the GNSS and the sensors service
+*
+* \author Marco Residori <marco.residori@xse.de>
+*         agent <agent@local>
+*
+* \copyright Copyright (C) 2013, XS Embedded GmbH
+*            Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <unistd.h>
+#include <memory.h>
+
+#include "iphone-listener.h"
+#include "log.h"
+
+#define BUFLEN 4096
+#define PORT 5555
+
+//Environment variable to override the UDP port
+#define IPHONE_PORT_ENV "IPHONE_PORT"
+
+//The GNSS and the sensors service
+#define IPHONE_MAX_CLIENTS 4
+//Maximum number of fields per line: timestamp + up to 4 sensor records
+#define IPHONE_MAX_FIELDS (1 + 4*(1+IPHONE_NUM_VALUES))
+//Interval for the re-estimation of the offset between phone time and local time [ms]
+#define IPHONE_OFFSET_WINDOW 10000
+
+static DLT_DECLARE_CONTEXT(gIphoneContext)
+
+//Serializes iphoneListenerAdd() and iphoneListenerRemove() including the start and stop of the thread
+static pthread_mutex_t lifecycleMutex = PTHREAD_MUTEX_INITIALIZER;
+//Protects the clients, held by the listener thread while calling them
+static pthread_mutex_t clientsMutex = PTHREAD_MUTEX_INITIALIZER;
+static const TIphoneListenerClient* clients[IPHONE_MAX_CLIENTS];
+static int numClients = 0;
+
+//Listener thread
+static pthread_t listenerThread;
+//Listener thread loop control variable
+static volatile bool isRunning = false;
+//Socket file descriptor used by listener thread
+static int s = -1;
+
+//Offset between phone time and local time [ms]:
+//the smallest observed transmission delay within a window of IPHONE_OFFSET_WINDOW
+static int64_t timeOffset = 0;
+static bool timeOffsetValid = false;
+static int64_t windowOffset = 0;
+static uint64_t windowStart = 0;
+
+static void *listenForMessages(void *ptr);
+
+static uint64_t getLocalTime()
+{
+    struct timespec time_value;
+    clock_gettime(CLOCK_MONOTONIC, &time_value);
+    return (uint64_t)time_value.tv_sec*1000 + time_value.tv_nsec/1000000;
+}
+
+static bool openSocket()
+{
+    struct sockaddr_in si_me;
+    int port = PORT;
+    const char* env;
+
+    DLT_REGISTER_CONTEXT(gIphoneContext,"IPHO", "iPhone listener");
+
+    env = getenv(IPHONE_PORT_ENV);
+    if (env != NULL)
+    {
+        port = atoi(env);
+    }
+
+    if((s=socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP))==-1)
+    {
+        LOG_ERROR_MSG(gIphoneContext,"socket() failed!");
+        return false;
+    }
+
+    memset((char *) &si_me, 0, sizeof(si_me));
+    si_me.sin_family = AF_INET;
+    si_me.sin_port = htons(port);
+    si_me.sin_addr.s_addr = htonl(INADDR_ANY);
+    if(bind(s, (struct sockaddr *)&si_me, sizeof(si_me)) == -1)
+    {
+        LOG_ERROR(gIphoneContext,"bind() to port %d failed!", port);
+        close(s);
+        s = -1;
+        return false;
+    }
+
+    LOG_INFO(gIphoneContext,"Listening on port %d", port);
+    return true;
+}
+
+bool iphoneListenerAdd(const TIphoneListenerClient* client)
+{
+    bool is_ok = true;
+
+    if (client == NULL)
+    {
+        return false;
+    }
+
+    pthread_mutex_lock(&lifecycleMutex);
+
+    if (numClients >= IPHONE_MAX_CLIENTS)
+    {
+        is_ok = false;
+    }
+    else if (numClients == 0)
+    {
+        is_ok = openSocket();
+        if (is_ok)
+        {
+            timeOffsetValid = false;
+            isRunning = true;
+            if (pthread_create(&listenerThread, NULL, listenForMessages, NULL) != 0)
+            {
+                isRunning = false;
+                close(s);
+                s = -1;
+                is_ok = false;
+            }
+        }
+    }
+
+    if (is_ok)
+    {
+        pthread_mutex_lock(&clientsMutex);
+        clients[numClients++] = client;
+        pthread_mutex_unlock(&clientsMutex);
+    }
+
+    pthread_mutex_unlock(&lifecycleMutex);
+
+    return is_ok;
+}
+
+void iphoneListenerRemove(const TIphoneListenerClient* client)
+{
+    bool isLast = false;
+
+    pthread_mutex_lock(&lifecycleMutex);
+
+    pthread_mutex_lock(&clientsMutex);
+    for (int i = 0; i < numClients; i++)
+    {
+        if (clients[i] == client)
+        {
+            clients[i] = clients[--numClients];
+            isLast = (numClients == 0);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&clientsMutex);
+
+    if (isLast)
+    {
+        isRunning = false;
+        //the listener thread wakes up from select() after at most IPHONE_FLUSH_PERIOD
+        pthread_join(listenerThread, NULL);
+        close(s);
+        s = -1;
+    }
+
+    pthread_mutex_unlock(&lifecycleMutex);
+}
+
+/**
+ * Split one line into numeric fields in a single pass.
+ * The line ends at '\n' or '\0', *next is set to the start of the following line.
+ * @return the number of fields, or -1 if the line contains an invalid field
+ */
+static int tokenize(const char* line, const char** next, double fields[], int maxFields)
+{
+    const char* p = line;
+    int n = 0;
+    bool is_ok = true;
+
+    while ((*p == ' ') || (*p == '\t') || (*p == '\r'))
+    {
+        p++;
+    }
+    //empty line
+    if ((*p == '\n') || (*p == '\0'))
+    {
+        *next = (*p == '\n') ? p+1 : p;
+        return 0;
+    }
+
+    while (true)
+    {
+        char* end;
+        double value = strtod(p, &end);
+        if ((end == p) || (n >= maxFields))
+        {
+            is_ok = false;
+        }
+        else
+        {
+            fields[n++] = value;
+            p = end;
+        }
+        while ((*p == ' ') || (*p == '\t') || (*p == '\r'))
+        {
+            p++;
+        }
+        if (is_ok && (*p == ','))
+        {
+            p++;
+            continue;
+        }
+        if (is_ok && (*p != '\n') && (*p != '\0'))
+        {
+            is_ok = false;
+        }
+        break;
+    }
+    //skip the rest of an invalid line
+    while ((*p != '\n') && (*p != '\0'))
+    {
+        p++;
+    }
+    *next = (*p == '\n') ? p+1 : p;
+    return is_ok ? n : -1;
+}
+
+/**
+ * Convert phone time [ms] to local time [ms].
+ * The offset is the smallest difference between reception time and phone time,
+ * re-estimated periodically to follow the drift of the phone clock.
+ */
+static uint64_t convertTime(double phoneTime, uint64_t now)
+{
+    int64_t offset = (int64_t)now - (int64_t)phoneTime;
+    if (!timeOffsetValid || (offset > timeOffset + IPHONE_OFFSET_WINDOW))
+    {
+        //first sample or phone clock reset
+        timeOffset = offset;
+        timeOffsetValid = true;
+        windowOffset = offset;
+        windowStart = now;
+    }
+    if (offset < windowOffset)
+    {
+        windowOffset = offset;
+    }
+    if (offset < timeOffset)
+    {
+        timeOffset = offset;
+    }
+    if (now - windowStart >= IPHONE_OFFSET_WINDOW)
+    {
+        timeOffset = windowOffset;
+        windowOffset = offset;
+        windowStart = now;
+    }
+    return (uint64_t)(phoneTime + timeOffset);
+}
+
+/**
+ * Pass all records of one datagram to the clients, called with clientsMutex held
+ */
+static void processDatagram(const char* buf, uint64_t now)
+{
+    double fields[IPHONE_MAX_FIELDS];
+    const char* line = buf;
+
+    while (*line != '\0')
+    {
+        const char* next;
+        int n = tokenize(line, &next, fields, IPHONE_MAX_FIELDS);
+
+        if (n < 0)
+        {
+            LOG_WARNING_MSG(gIphoneContext,"invalid line ignored");
+        }
+        else if (n > 0)
+        {
+            double phoneTime = fields[0]*1000;
+            uint64_t timestamp = convertTime(phoneTime, now);
+            for (int i = 1; i + IPHONE_NUM_VALUES < n; i += 1 + IPHONE_NUM_VALUES)
+            {
+                for (int c = 0; c < numClients; c++)
+                {
+                    clients[c]->onRecord((int)fields[i], timestamp, phoneTime, &fields[i+1], now);
+                }
+            }
+        }
+        line = next;
+    }
+}
+
+static void *listenForMessages(void *ptr)
+{
+    struct sockaddr_in si_other;
+    socklen_t slen = sizeof(si_other);
+    ssize_t readBytes = 0;
+    char buf[BUFLEN+1]; //add space for terminating \0
+
+    (void)ptr;
+
+    while(isRunning == true)
+    {
+        //use select to introduce a timeout - allows shutdown and flushing of old samples
+        fd_set readfs;
+        struct timeval timeout;
+        int res;
+
+        FD_ZERO(&readfs);
+        FD_SET(s, &readfs);
+        timeout.tv_sec = 0;
+        timeout.tv_usec = IPHONE_FLUSH_PERIOD*1000;
+        res = select(s+1, &readfs, NULL, NULL, &timeout);
+
+        uint64_t now = getLocalTime();
+        readBytes = 0;
+
+        if (res > 0)
+        {
+            slen = sizeof(si_other);
+            readBytes = recvfrom(s, buf, BUFLEN, 0, (struct sockaddr *)&si_other, &slen);
+
+            if(readBytes < 0)
+            {
+                LOG_ERROR_MSG(gIphoneContext,"recvfrom() failed!");
+                readBytes = 0;
+            }
+            else
+            {
+                LOG_DEBUG(gIphoneContext,"Received Packet from %s:%d",
+                          inet_ntoa(si_other.sin_addr), ntohs(si_other.sin_port));
+            }
+        }
+        buf[readBytes] = '\0';
+
+        pthread_mutex_lock(&clientsMutex);
+        processDatagram(buf, now);
+        for (int c = 0; c < numClients; c++)
+        {
+            clients[c]->onFlush(now);
+        }
+        pthread_mutex_unlock(&clientsMutex);
+    }
+
+    return NULL;
+}
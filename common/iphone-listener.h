@@ -0,0 +1,96 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup Positioning
+* \brief UDP listener for the SensorLogger iPhone app shared by the GNSS and the sensors service
+*
+* \details The app sends all the sensors in UDP datagrams to one port.
+*          A unicast datagram is received by only one socket of a host,
+*          so the GNSS and the sensors service do not bind their own sockets
+*          but register as clients of this listener, which is built as
+*          one shared library for both services.
+*          The listener opens the socket for the first client and closes it
+*          when the last client is removed. The port is 5555 and can be
+*          overridden with the environment variable IPHONE_PORT.
+*
+*          The datagrams contain one or more lines of the form
+*            <timestamp>,<sensorId>,<v1>,<v2>,<v3>[,<sensorId>,<v1>,<v2>,<v3>]...
+*          with the timestamp in seconds. Each record is passed to all the clients
+*          with the phone time converted to the local monotonic time.
+*
+* \author Marco Residori <marco.residori@xse.de>
+*         agent <agent@local>
+*
+* \copyright Copyright (C) 2013, XS Embedded GmbH
+*            Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#ifndef INCLUDE_IPHONE_LISTENER
+#define INCLUDE_IPHONE_LISTENER
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//Sensors IDs used by the SensorLogger App
+#define IPHONE_GPS_SENSOR 1
+#define IPHONE_ACC_SENSOR 2
+#define IPHONE_COMPASS    3
+#define IPHONE_GYRO       4
+
+//Number of values per sensor record
+#define IPHONE_NUM_VALUES 3
+
+//The clients are flushed at least with this period [ms]
+#define IPHONE_FLUSH_PERIOD 50
+
+typedef struct
+{
+    /**
+     * Called by the listener thread for each record of a datagram
+     * @param sensorId one of the IPHONE_*_SENSOR IDs or any other ID sent by the app
+     * @param timestamp local time of the record [ms]
+     * @param phoneTime phone time of the record [ms]
+     * @param values the IPHONE_NUM_VALUES values of the record
+     * @param now reception time of the datagram [ms]
+     */
+    void (*onRecord)(int sensorId, uint64_t timestamp, double phoneTime, const double values[], uint64_t now);
+
+    /**
+     * Called by the listener thread after each datagram and at least every IPHONE_FLUSH_PERIOD
+     * @param now local time [ms]
+     */
+    void (*onFlush)(uint64_t now);
+} TIphoneListenerClient;
+
+/**
+ * Register a client, the first client opens the socket and starts the listener thread.
+ * @param client callbacks, must stay valid until iphoneListenerRemove()
+ * @return true on success
+ */
+bool iphoneListenerAdd(const TIphoneListenerClient* client);
+
+/**
+ * Deregister a client, the client is not called anymore after the return.
+ * The last client stops the listener thread and closes the socket.
+ * Must not be called from the callbacks.
+ */
+void iphoneListenerRemove(const TIphoneListenerClient* client);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_IPHONE_LISTENER */
@@ -0,0 +1,280 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup Positioning
+* \brief Logging macros shared by all the positioning components
+*
+* \details The levels less severe than LOG_MIN_LEVEL are compiled out:
+*          neither their arguments are evaluated nor their format strings
+*          are kept in the binary.
+*          With DLT the level of the context is checked at runtime before
+*          the arguments are evaluated and formatted, so a message filtered
+*          by DLT costs a load and a compare.
+*          LOG_<LEVEL>_RATE_LIMITED(context, interval, fmt, ...) logs at most
+*          once per interval [ms] per call site and appends the number of
+*          messages suppressed in between; use it in loops running per sample.
+*          LOG_<LEVEL>_RATE_LIMITED_MSG(context, interval, msg) does the same
+*          for a message without arguments.
+*
+* \copyright  Copyright (C) BMW Car IT GmbH 2011
+*             Copyright (C) 2013, XS Embedded GmbH
+*             Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#ifndef INCLUDE_LOG
+#define INCLUDE_LOG
+
+// turn-on via cmake define:
+// $ cmake -DWITH_DLT=1 -DWITH_DEBUG=1 ..
+// keep only the warnings and the errors of a DLT build:
+// $ cmake -DWITH_DLT=1 -DCMAKE_C_FLAGS=-DLOG_MIN_LEVEL=3 -DCMAKE_CXX_FLAGS=-DLOG_MIN_LEVEL=3 ..
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+// same values as DltLogLevelType
+#define LOG_LEVEL_OFF       0
+#define LOG_LEVEL_FATAL     1
+#define LOG_LEVEL_ERROR     2
+#define LOG_LEVEL_WARNING   3
+#define LOG_LEVEL_INFO      4
+#define LOG_LEVEL_DEBUG     5
+#define LOG_LEVEL_VERBOSE   6
+
+// least severe level compiled in
+#ifndef LOG_MIN_LEVEL
+#if (DLT_ENABLED || DEBUG_ENABLED)
+#define LOG_MIN_LEVEL LOG_LEVEL_VERBOSE
+#else
+#define LOG_MIN_LEVEL LOG_LEVEL_ERROR
+#endif
+#endif
+
+#define LOG_NOTHING do { } while (0)
+
+/**
+ * Rate limit of a call site, the state is kept in static variables of the call site.
+ * @param next earliest time of the next message [ms]
+ * @param suppressed number of messages suppressed since the last one
+ * @param interval minimum time between two messages [ms]
+ * @param count returns the number of messages suppressed before this one
+ * @return 1 if the message is due, 0 if it is suppressed
+ */
+static inline int logRateLimit(uint64_t* next, uint32_t* suppressed, uint32_t interval, uint32_t* count)
+{
+    struct timespec now;
+    uint64_t ms;
+    uint64_t due;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    ms = (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+    due = __atomic_load_n(next, __ATOMIC_RELAXED);
+
+    // only one of several concurrent threads wins
+    if ((ms < due) ||
+        !__atomic_compare_exchange_n(next, &due, ms + interval, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        __atomic_add_fetch(suppressed, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    *count = __atomic_exchange_n(suppressed, 0, __ATOMIC_RELAXED);
+    return 1;
+}
+
+#if (!DLT_ENABLED)
+/*****************************************************************************/
+// use printf
+
+// some type-name used instead of DLT context
+typedef const char* NoDltContext;
+
+#define DLT_DECLARE_CONTEXT(CONTEXT) \
+    NoDltContext CONTEXT;
+
+#define DLT_IMPORT_CONTEXT(CONTEXT) \
+    extern NoDltContext CONTEXT;
+
+#define DLT_REGISTER_CONTEXT(CONTEXT, CONTEXT_ID, DESC) \
+    CONTEXT = CONTEXT_ID;
+
+#define DLT_REGISTER_APP(CONTEXT, DESC) ;
+
+#define DLT_UNREGISTER_CONTEXT(CONTEXT) ;
+#define DLT_UNREGISTER_APP() ;
+#define dlt_free() ;
+
+// the level is only checked at compile time
+#define LOG_IS_ENABLED(context, level) 1
+
+#define LOG_WRITE_MSG(context, level, tag, msg) \
+        fprintf(stderr, "[" tag "][%4s] " msg "\n", context)
+#define LOG_WRITE(context, level, tag, fmt, ...) \
+        fprintf(stderr, "[" tag "][%4s] " fmt "\n", context, __VA_ARGS__)
+
+#else   /* DLT_ENABLED */
+/*****************************************************************************/
+// use DLT
+#include "dlt.h"
+
+typedef const char* Context;
+
+#ifdef DLT_IS_LOG_LEVEL_ENABLED
+#define LOG_IS_ENABLED(context, level) \
+        DLT_IS_LOG_LEVEL_ENABLED(context, (DltLogLevelType)(level))
+#else
+// same check as in dlt_user_log_write_start()
+#define LOG_IS_ENABLED(context, level) \
+        ((context).log_level_ptr && ((level) <= *(context).log_level_ptr))
+#endif
+
+#define LOG_WRITE_MSG(context, level, tag, msg) \
+        DLT_LOG(context, (DltLogLevelType)(level), DLT_STRING(msg))
+#define LOG_WRITE(context, level, tag, fmt, ...) \
+        do \
+        { \
+            if (LOG_IS_ENABLED(context, level)) \
+            { \
+                char logBuffer[256]; \
+                snprintf(logBuffer, sizeof(logBuffer), fmt, __VA_ARGS__); \
+                DLT_LOG(context, (DltLogLevelType)(level), DLT_STRING(logBuffer)); \
+            } \
+        } while (0)
+
+#endif  /* DLT_ENABLED */
+
+// the arguments are only evaluated when the message is due
+#define LOG_WRITE_RATE_LIMITED(context, level, tag, interval, fmt, ...) \
+        do \
+        { \
+            static uint64_t logNext = 0; \
+            static uint32_t logSuppressed = 0; \
+            uint32_t logCount; \
+            if (LOG_IS_ENABLED(context, level) && \
+                logRateLimit(&logNext, &logSuppressed, (interval), &logCount)) \
+            { \
+                LOG_WRITE(context, level, tag, fmt " (%u suppressed)", __VA_ARGS__, (unsigned int)logCount); \
+            } \
+        } while (0)
+#define LOG_WRITE_RATE_LIMITED_MSG(context, level, tag, interval, msg) \
+        do \
+        { \
+            static uint64_t logNext = 0; \
+            static uint32_t logSuppressed = 0; \
+            uint32_t logCount; \
+            if (LOG_IS_ENABLED(context, level) && \
+                logRateLimit(&logNext, &logSuppressed, (interval), &logCount)) \
+            { \
+                LOG_WRITE(context, level, tag, msg " (%u suppressed)", (unsigned int)logCount); \
+            } \
+        } while (0)
+
+/*****************************************************************************/
+// log calls
+#if (LOG_MIN_LEVEL >= LOG_LEVEL_VERBOSE)
+#define LOG_VERBOSE_MSG(context, msg) \
+        LOG_WRITE_MSG(context, LOG_LEVEL_VERBOSE, "VERBO", msg)
+#define LOG_VERBOSE(context, fmt, ...) \
+        LOG_WRITE(context, LOG_LEVEL_VERBOSE, "VERBO", fmt, __VA_ARGS__)
+#define LOG_VERBOSE_RATE_LIMITED(context, interval, fmt, ...) \
+        LOG_WRITE_RATE_LIMITED(context, LOG_LEVEL_VERBOSE, "VERBO", interval, fmt, __VA_ARGS__)
+#define LOG_VERBOSE_RATE_LIMITED_MSG(context, interval, msg) \
+        LOG_WRITE_RATE_LIMITED_MSG(context, LOG_LEVEL_VERBOSE, "VERBO", interval, msg)
+#else
+#define LOG_VERBOSE_MSG(context, msg) LOG_NOTHING
+#define LOG_VERBOSE(context, fmt, ...) LOG_NOTHING
+#define LOG_VERBOSE_RATE_LIMITED(context, interval, fmt, ...) LOG_NOTHING
+#define LOG_VERBOSE_RATE_LIMITED_MSG(context, interval, msg) LOG_NOTHING
+#endif
+
+#if (LOG_MIN_LEVEL >= LOG_LEVEL_DEBUG)
+#define LOG_DEBUG_MSG(context, msg) \
+        LOG_WRITE_MSG(context, LOG_LEVEL_DEBUG, "DEBUG", msg)
+#define LOG_DEBUG(context, fmt, ...) \
+        LOG_WRITE(context, LOG_LEVEL_DEBUG, "DEBUG", fmt, __VA_ARGS__)
+#define LOG_DEBUG_RATE_LIMITED(context, interval, fmt, ...) \
+        LOG_WRITE_RATE_LIMITED(context, LOG_LEVEL_DEBUG, "DEBUG", interval, fmt, __VA_ARGS__)
+#define LOG_DEBUG_RATE_LIMITED_MSG(context, interval, msg) \
+        LOG_WRITE_RATE_LIMITED_MSG(context, LOG_LEVEL_DEBUG, "DEBUG", interval, msg)
+#else
+#define LOG_DEBUG_MSG(context, msg) LOG_NOTHING
+#define LOG_DEBUG(context, fmt, ...) LOG_NOTHING
+#define LOG_DEBUG_RATE_LIMITED(context, interval, fmt, ...) LOG_NOTHING
+#define LOG_DEBUG_RATE_LIMITED_MSG(context, interval, msg) LOG_NOTHING
+#endif
+
+#if (LOG_MIN_LEVEL >= LOG_LEVEL_INFO)
+#define LOG_INFO_MSG(context, msg) \
+        LOG_WRITE_MSG(context, LOG_LEVEL_INFO, "INFO ", msg)
+#define LOG_INFO(context, fmt, ...) \
+        LOG_WRITE(context, LOG_LEVEL_INFO, "INFO ", fmt, __VA_ARGS__)
+#define LOG_INFO_RATE_LIMITED(context, interval, fmt, ...) \
+        LOG_WRITE_RATE_LIMITED(context, LOG_LEVEL_INFO, "INFO ", interval, fmt, __VA_ARGS__)
+#define LOG_INFO_RATE_LIMITED_MSG(context, interval, msg) \
+        LOG_WRITE_RATE_LIMITED_MSG(context, LOG_LEVEL_INFO, "INFO ", interval, msg)
+#else
+#define LOG_INFO_MSG(context, msg) LOG_NOTHING
+#define LOG_INFO(context, fmt, ...) LOG_NOTHING
+#define LOG_INFO_RATE_LIMITED(context, interval, fmt, ...) LOG_NOTHING
+#define LOG_INFO_RATE_LIMITED_MSG(context, interval, msg) LOG_NOTHING
+#endif
+
+#if (LOG_MIN_LEVEL >= LOG_LEVEL_WARNING)
+#define LOG_WARNING_MSG(context, msg) \
+        LOG_WRITE_MSG(context, LOG_LEVEL_WARNING, "WARN ", msg)
+#define LOG_WARNING(context, fmt, ...) \
+        LOG_WRITE(context, LOG_LEVEL_WARNING, "WARN ", fmt, __VA_ARGS__)
+#define LOG_WARNING_RATE_LIMITED(context, interval, fmt, ...) \
+        LOG_WRITE_RATE_LIMITED(context, LOG_LEVEL_WARNING, "WARN ", interval, fmt, __VA_ARGS__)
+#define LOG_WARNING_RATE_LIMITED_MSG(context, interval, msg) \
+        LOG_WRITE_RATE_LIMITED_MSG(context, LOG_LEVEL_WARNING, "WARN ", interval, msg)
+#else
+#define LOG_WARNING_MSG(context, msg) LOG_NOTHING
+#define LOG_WARNING(context, fmt, ...) LOG_NOTHING
+#define LOG_WARNING_RATE_LIMITED(context, interval, fmt, ...) LOG_NOTHING
+#define LOG_WARNING_RATE_LIMITED_MSG(context, interval, msg) LOG_NOTHING
+#endif
+
+#if (LOG_MIN_LEVEL >= LOG_LEVEL_ERROR)
+#define LOG_ERROR_MSG(context, msg) \
+        LOG_WRITE_MSG(context, LOG_LEVEL_ERROR, "ERROR", msg)
+#define LOG_ERROR(context, fmt, ...) \
+        LOG_WRITE(context, LOG_LEVEL_ERROR, "ERROR", fmt, __VA_ARGS__)
+#define LOG_ERROR_RATE_LIMITED(context, interval, fmt, ...) \
+        LOG_WRITE_RATE_LIMITED(context, LOG_LEVEL_ERROR, "ERROR", interval, fmt, __VA_ARGS__)
+#define LOG_ERROR_RATE_LIMITED_MSG(context, interval, msg) \
+        LOG_WRITE_RATE_LIMITED_MSG(context, LOG_LEVEL_ERROR, "ERROR", interval, msg)
+#else
+#define LOG_ERROR_MSG(context, msg) LOG_NOTHING
+#define LOG_ERROR(context, fmt, ...) LOG_NOTHING
+#define LOG_ERROR_RATE_LIMITED(context, interval, fmt, ...) LOG_NOTHING
+#define LOG_ERROR_RATE_LIMITED_MSG(context, interval, msg) LOG_NOTHING
+#endif
+
+#if (LOG_MIN_LEVEL >= LOG_LEVEL_FATAL)
+#define LOG_FATAL_MSG(context, msg) \
+        LOG_WRITE_MSG(context, LOG_LEVEL_FATAL, "FATAL", msg)
+#define LOG_FATAL(context, fmt, ...) \
+        LOG_WRITE(context, LOG_LEVEL_FATAL, "FATAL", fmt, __VA_ARGS__)
+#define LOG_FATAL_RATE_LIMITED(context, interval, fmt, ...) \
+        LOG_WRITE_RATE_LIMITED(context, LOG_LEVEL_FATAL, "FATAL", interval, fmt, __VA_ARGS__)
+#define LOG_FATAL_RATE_LIMITED_MSG(context, interval, msg) \
+        LOG_WRITE_RATE_LIMITED_MSG(context, LOG_LEVEL_FATAL, "FATAL", interval, msg)
+#else
+#define LOG_FATAL_MSG(context, msg) LOG_NOTHING
+#define LOG_FATAL(context, fmt, ...) LOG_NOTHING
+#define LOG_FATAL_RATE_LIMITED(context, interval, fmt, ...) LOG_NOTHING
+#define LOG_FATAL_RATE_LIMITED_MSG(context, interval, msg) LOG_NOTHING
+#endif
+
+#endif /* INCLUDE_LOG */
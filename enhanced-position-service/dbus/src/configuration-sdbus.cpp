@@ -0,0 +1,298 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Configuration interface implemented with sd-bus
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <string.h>
+#include <vector>
+#include "configuration-sdbus.h"
+#include "positioning-constants.h"
+#include "log.h"
+
+DLT_IMPORT_CONTEXT(gCtx);
+
+//same members, signatures and argument names as api/genivi-positioning-configuration.xml
+const sd_bus_vtable ConfigurationSdBus::mVtable[] =
+{
+  SD_BUS_VTABLE_START(0),
+  SD_BUS_METHOD_WITH_NAMES("GetVersion",
+                           NULL,,
+                           "(qqqs)", SD_BUS_PARAM(version),
+                           &ConfigurationSdBus::onGetVersion, SD_BUS_VTABLE_UNPRIVILEGED),
+  SD_BUS_METHOD_WITH_NAMES("GetProperties",
+                           NULL,,
+                           "a{sv}", SD_BUS_PARAM(properties),
+                           &ConfigurationSdBus::onGetProperties, SD_BUS_VTABLE_UNPRIVILEGED),
+  SD_BUS_METHOD_WITH_NAMES("SetProperty",
+                           "sv", SD_BUS_PARAM(name) SD_BUS_PARAM(value),
+                           NULL,,
+                           &ConfigurationSdBus::onSetProperty, SD_BUS_VTABLE_UNPRIVILEGED),
+  SD_BUS_SIGNAL_WITH_NAMES("PropertyChanged",
+                           "sv", SD_BUS_PARAM(name) SD_BUS_PARAM(value), 0),
+  SD_BUS_WRITABLE_PROPERTY("SatelliteSystem", "u",
+                           &ConfigurationSdBus::getProperty, &ConfigurationSdBus::setProperty, 0, SD_BUS_VTABLE_UNPRIVILEGED),
+  SD_BUS_WRITABLE_PROPERTY("UpdateInterval", "i",
+                           &ConfigurationSdBus::getProperty, &ConfigurationSdBus::setProperty, 0, SD_BUS_VTABLE_UNPRIVILEGED),
+  SD_BUS_METHOD_WITH_NAMES("GetSupportedProperties",
+                           NULL,,
+                           "a{sv}", SD_BUS_PARAM(properties),
+                           &ConfigurationSdBus::onGetSupportedProperties, SD_BUS_VTABLE_UNPRIVILEGED),
+  SD_BUS_VTABLE_END
+};
+
+ConfigurationSdBus::ConfigurationSdBus(sd_bus* bus, const char* path, EnhancedPositionSdBus& enhancedPosition)
+: mpBus(bus)
+, mPath(path)
+, mpVtableSlot(0)
+, mEnhancedPosition(enhancedPosition)
+, mUpdateInterval(MIN_UPDATE_INTERVAL)
+, mSatelliteSystem(GENIVI_ENHANCEDPOSITIONSERVICE_GPS)
+{
+}
+
+ConfigurationSdBus::~ConfigurationSdBus()
+{
+  sd_bus_slot_unref(mpVtableSlot);
+}
+
+bool ConfigurationSdBus::init()
+{
+  int r = sd_bus_add_object_vtable(mpBus, &mpVtableSlot, mPath.c_str(), CONFIGURATION_INTERFACE, mVtable, this);
+  if (r < 0)
+  {
+    LOG_ERROR(gCtx,"sd_bus_add_object_vtable failed: %s", strerror(-r));
+    return false;
+  }
+  return true;
+}
+
+int ConfigurationSdBus::onGetVersion(sd_bus_message* m, void* /*userdata*/, sd_bus_error* /*error*/)
+{
+  return sd_bus_reply_method_return(m, "(qqqs)", 4, 0, 0, "28-10-2015alpha");
+}
+
+int ConfigurationSdBus::onGetProperties(sd_bus_message* m, void* userdata, sd_bus_error* /*error*/)
+{
+  ConfigurationSdBus* self = (ConfigurationSdBus*)userdata;
+
+  return sd_bus_reply_method_return(m, "a{sv}", 2,
+                                    "UpdateInterval", "i", self->mUpdateInterval,
+                                    "SatelliteSystem", "u", self->mSatelliteSystem);
+}
+
+int ConfigurationSdBus::onSetProperty(sd_bus_message* m, void* userdata, sd_bus_error* error)
+{
+  ConfigurationSdBus* self = (ConfigurationSdBus*)userdata;
+  const char* name = 0;
+  const char* contents = 0;
+  char type = 0;
+
+  int r = sd_bus_message_read(m, "s", &name);
+  if (r >= 0)
+  {
+    r = sd_bus_message_peek_type(m, &type, &contents);
+  }
+  if (r < 0)
+  {
+    return r;
+  }
+
+  if (strcmp(name, "UpdateInterval") == 0)
+  {
+    int32_t updateInterval = 0;
+    if (strcmp(contents, "i") != 0)
+    {
+      return sd_bus_error_set(error, SD_BUS_ERROR_INVALID_ARGS, "UpdateInterval expects an int32 value");
+    }
+    r = sd_bus_message_read(m, "v", "i", &updateInterval);
+    if (r >= 0)
+    {
+      r = self->setUpdateInterval(updateInterval, error);
+    }
+  }
+  else if (strcmp(name, "SatelliteSystem") == 0)
+  {
+    uint32_t satelliteSystem = 0;
+    if (strcmp(contents, "u") != 0)
+    {
+      return sd_bus_error_set(error, SD_BUS_ERROR_INVALID_ARGS, "SatelliteSystem expects a uint32 value");
+    }
+    r = sd_bus_message_read(m, "v", "u", &satelliteSystem);
+    if (r >= 0)
+    {
+      r = self->setSatelliteSystem(satelliteSystem);
+    }
+  }
+  //unknown properties are ignored like in the dbus-c++ service
+
+  if (r < 0)
+  {
+    return r;
+  }
+  return sd_bus_reply_method_return(m, "");
+}
+
+int ConfigurationSdBus::onGetSupportedProperties(sd_bus_message* m, void* userdata, sd_bus_error* /*error*/)
+{
+  ConfigurationSdBus* self = (ConfigurationSdBus*)userdata;
+  std::vector< int32_t > updateIntervals;
+  std::vector< uint32_t > satelliteSystems;
+  sd_bus_message* reply = 0;
+
+  getSupportedUpdateIntervals(updateIntervals);
+  getSupportedSatelliteSystems(satelliteSystems);
+
+  int r = sd_bus_message_new_method_return(m, &reply);
+  if (r >= 0)
+  {
+    r = sd_bus_message_open_container(reply, 'a', "{sv}");
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_message_open_container(reply, 'e', "sv");
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_message_append(reply, "s", "UpdateInterval");
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_message_open_container(reply, 'v', "ai");
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_message_append_array(reply, 'i', updateIntervals.data(), updateIntervals.size()*sizeof(int32_t));
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_message_close_container(reply);
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_message_close_container(reply);
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_message_open_container(reply, 'e', "sv");
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_message_append(reply, "s", "SatelliteSystem");
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_message_open_container(reply, 'v', "au");
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_message_append_array(reply, 'u', satelliteSystems.data(), satelliteSystems.size()*sizeof(uint32_t));
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_message_close_container(reply);
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_message_close_container(reply);
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_message_close_container(reply);
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_send(self->mpBus, reply, 0);
+  }
+  sd_bus_message_unref(reply);
+  return r;
+}
+
+int ConfigurationSdBus::getProperty(sd_bus* /*bus*/, const char* /*path*/, const char* /*interface*/, const char* property,
+                                    sd_bus_message* reply, void* userdata, sd_bus_error* /*error*/)
+{
+  ConfigurationSdBus* self = (ConfigurationSdBus*)userdata;
+
+  if (strcmp(property, "UpdateInterval") == 0)
+  {
+    return sd_bus_message_append(reply, "i", self->mUpdateInterval);
+  }
+  return sd_bus_message_append(reply, "u", self->mSatelliteSystem);
+}
+
+int ConfigurationSdBus::setProperty(sd_bus* /*bus*/, const char* /*path*/, const char* /*interface*/, const char* property,
+                                    sd_bus_message* value, void* userdata, sd_bus_error* error)
+{
+  ConfigurationSdBus* self = (ConfigurationSdBus*)userdata;
+
+  if (strcmp(property, "UpdateInterval") == 0)
+  {
+    int32_t updateInterval = 0;
+    int r = sd_bus_message_read(value, "i", &updateInterval);
+    return (r < 0) ? r : self->setUpdateInterval(updateInterval, error);
+  }
+
+  uint32_t satelliteSystem = 0;
+  int r = sd_bus_message_read(value, "u", &satelliteSystem);
+  return (r < 0) ? r : self->setSatelliteSystem(satelliteSystem);
+}
+
+int ConfigurationSdBus::setUpdateInterval(int32_t updateInterval, sd_bus_error* error)
+{
+  if ((updateInterval < MIN_UPDATE_INTERVAL) || (updateInterval > MAX_UPDATE_INTERVAL))
+  {
+    return sd_bus_error_set(error, SD_BUS_ERROR_INVALID_ARGS, "UpdateInterval out of range");
+  }
+
+  mUpdateInterval = updateInterval;
+  mEnhancedPosition.setUpdateInterval(mUpdateInterval);
+
+  LOG_INFO(gCtx,"UpdateInterval = %d", mUpdateInterval);
+
+  return emitPropertyChanged("UpdateInterval", "i", (uint32_t)mUpdateInterval);
+}
+
+int ConfigurationSdBus::setSatelliteSystem(uint32_t satelliteSystem)
+{
+  setSatelliteSystems(satelliteSystem);
+
+  //the property is changed immediately, see Configuration::SetProperty
+  mSatelliteSystem = satelliteSystem;
+  LOG_INFO(gCtx,"SatelliteSystem = %d", mSatelliteSystem);
+
+  return emitPropertyChanged("SatelliteSystem", "u", mSatelliteSystem);
+}
+
+int ConfigurationSdBus::emitPropertyChanged(const char* name, const char* signature, uint32_t value)
+{
+  return sd_bus_emit_signal(mpBus, mPath.c_str(), CONFIGURATION_INTERFACE, "PropertyChanged", "sv", name, signature, value);
+}
+
+int32_t ConfigurationSdBus::getUpdateInterval() const
+{
+  return mUpdateInterval;
+}
+
+void ConfigurationSdBus::run()
+{
+  LOG_INFO_MSG(gCtx,"Starting Configuration dispatcher...");
+}
+
+void ConfigurationSdBus::shutdown()
+{
+  LOG_INFO_MSG(gCtx,"Shutting down Configuration dispatcher...");
+}
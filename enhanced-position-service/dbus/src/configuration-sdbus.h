@@ -0,0 +1,78 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Configuration interface implemented with sd-bus
+*
+* \details Same methods, signals and properties as
+* api/genivi-positioning-configuration.xml. Unlike the dbus-c++ adaptor,
+* the properties can also be accessed with org.freedesktop.DBus.Properties.
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+#ifndef ___CONFIGURATION_SDBUS_H
+#define ___CONFIGURATION_SDBUS_H
+
+#include <string>
+#include <systemd/sd-bus.h>
+#include "enhanced-position-sdbus.h"
+
+#define CONFIGURATION_INTERFACE "org.genivi.positioning.Configuration"
+
+class ConfigurationSdBus
+{
+public:
+
+  ConfigurationSdBus(sd_bus* bus, const char* path, EnhancedPositionSdBus& enhancedPosition);
+
+  ~ConfigurationSdBus();
+
+  /**
+   * Register the object on the bus
+   * @return false if the vtable could not be added
+   */
+  bool init();
+
+  int32_t getUpdateInterval() const;
+
+  void run();
+
+  void shutdown();
+
+private:
+
+  static const sd_bus_vtable mVtable[];
+
+  static int onGetVersion(sd_bus_message* m, void* userdata, sd_bus_error* error);
+  static int onGetProperties(sd_bus_message* m, void* userdata, sd_bus_error* error);
+  static int onSetProperty(sd_bus_message* m, void* userdata, sd_bus_error* error);
+  static int onGetSupportedProperties(sd_bus_message* m, void* userdata, sd_bus_error* error);
+  static int getProperty(sd_bus* bus, const char* path, const char* interface, const char* property,
+                         sd_bus_message* reply, void* userdata, sd_bus_error* error);
+  static int setProperty(sd_bus* bus, const char* path, const char* interface, const char* property,
+                         sd_bus_message* value, void* userdata, sd_bus_error* error);
+
+  int setUpdateInterval(int32_t updateInterval, sd_bus_error* error);
+  int setSatelliteSystem(uint32_t satelliteSystem);
+  int emitPropertyChanged(const char* name, const char* signature, uint32_t value);
+
+  sd_bus* mpBus;
+  std::string mPath;
+  sd_bus_slot* mpVtableSlot;
+  EnhancedPositionSdBus& mEnhancedPosition;
+  int32_t mUpdateInterval;
+  uint32_t mSatelliteSystem;
+};
+
+#endif//___CONFIGURATION_SDBUS_H
@@ -71,9 +71,10 @@ static DBus::Variant variant_array_uint32(std::vector< uint32_t > i)
   return variant;
 }
 
-Configuration::Configuration(DBus::Connection &connection, const char * path)
+Configuration::Configuration(DBus::Connection &connection, const char * path, EnhancedPosition& enhancedPosition)
 : DBus::ObjectAdaptor(connection, path)
-, mUpdateInterval(1000)
+, mEnhancedPosition(enhancedPosition)
+, mUpdateInterval(MIN_UPDATE_INTERVAL)
 , mSatelliteSystem(GENIVI_ENHANCEDPOSITIONSERVICE_GPS)
 {
 }
@@ -108,7 +109,15 @@ void Configuration::SetProperty(const std::string& name, const ::DBus::Variant&
 {
   if(name == "UpdateInterval")
   {
-    mUpdateInterval = value;
+    int32_t updateInterval = value;
+
+    if ((updateInterval < MIN_UPDATE_INTERVAL) || (updateInterval > MAX_UPDATE_INTERVAL))
+    {
+      throw DBus::ErrorInvalidArgs("UpdateInterval out of range");
+    }
+
+    mUpdateInterval = updateInterval;
+    mEnhancedPosition.setUpdateInterval(mUpdateInterval);
 
     LOG_INFO(gCtx,"UpdateInterval = %d", mUpdateInterval);
 
@@ -117,25 +126,7 @@ void Configuration::SetProperty(const std::string& name, const ::DBus::Variant&
 
   if(name == "SatelliteSystem")
   {
-    uint32_t requestedSystems = value;  //magic conversion variant -> uint32_t
-    uint32_t activateSystems = 0;
-    if (requestedSystems & GENIVI_ENHANCEDPOSITIONSERVICE_GPS)
-    {
-        activateSystems |= GNSS_SYSTEM_GPS;
-    }
-    if (requestedSystems & GENIVI_ENHANCEDPOSITIONSERVICE_GLONASS)
-    {
-        activateSystems |= GNSS_SYSTEM_GLONASS;
-    }
-    if (requestedSystems & GENIVI_ENHANCEDPOSITIONSERVICE_GALILEO)
-    {
-        activateSystems |= GNSS_SYSTEM_GALILEO;
-    }
-    if (requestedSystems & GENIVI_ENHANCEDPOSITIONSERVICE_GPS)
-    {
-        activateSystems |= GNSS_SYSTEM_BEIDOU;
-    }
-    gnssSetGNSSSystems(activateSystems);
+    setSatelliteSystems(value);  //magic conversion variant -> uint32_t
 
     //For a real implementation the property should only be changed 
     //when the the configuration request has become effective as reported
@@ -155,41 +146,10 @@ std::map< std::string, ::DBus::Variant > Configuration::GetSupportedProperties()
   std::map< std::string, ::DBus::Variant > SupportedProperties;
 
   std::vector< int32_t > updateIntervals;
-  updateIntervals.push_back(1000);
-  updateIntervals.push_back(1500);
-
-  uint32_t supportedSystems;
-  TGNSSConfiguration gnssConfig = {0}; 
-
-  if (gnssGetConfiguration(&gnssConfig) && (gnssConfig.validityBits & GNSS_CONFIG_SATSYS_VALID))
-  { //assume GPS at least
-    supportedSystems = gnssConfig.supportedSystems;
-  }
-  else    
-  { //assume GPS at least
-    supportedSystems = GNSS_SYSTEM_GPS;
-  }
-  
-  //test hack: add GLONASS to have 2 systems
-  supportedSystems = supportedSystems|GNSS_SYSTEM_GLONASS;
+  getSupportedUpdateIntervals(updateIntervals);
 
   std::vector< uint32_t > satelliteSystems;
-  if (supportedSystems & GNSS_SYSTEM_GPS)
-  {
-    satelliteSystems.push_back(GENIVI_ENHANCEDPOSITIONSERVICE_GPS);
-  }
-  if (supportedSystems & GNSS_SYSTEM_GLONASS)
-  {
-    satelliteSystems.push_back(GENIVI_ENHANCEDPOSITIONSERVICE_GLONASS);
-  }
-  if (supportedSystems & GNSS_SYSTEM_GALILEO)
-  {
-    satelliteSystems.push_back(GENIVI_ENHANCEDPOSITIONSERVICE_GALILEO);
-  }
-  if (supportedSystems & GNSS_SYSTEM_BEIDOU)
-  {
-    satelliteSystems.push_back(GENIVI_ENHANCEDPOSITIONSERVICE_COMPASS);
-  }
+  getSupportedSatelliteSystems(satelliteSystems);
 
   SupportedProperties["UpdateInterval"] = variant_array_int32(updateIntervals);
   SupportedProperties["SatelliteSystem"] =  variant_array_uint32(satelliteSystems);
@@ -197,6 +157,11 @@ std::map< std::string, ::DBus::Variant > Configuration::GetSupportedProperties()
   return SupportedProperties;
 }
 
+int32_t Configuration::getUpdateInterval() const
+{
+  return mUpdateInterval;
+}
+
 void Configuration::run()
 {
   LOG_INFO_MSG(gCtx,"Starting Configuration dispatcher...");
@@ -23,6 +23,7 @@
 #endif
 #include <dbus-c++/dbus.h>
 #include "configuration-adaptor.h"
+#include "enhanced-position.h"
 
 class Configuration
   : public org::genivi::positioning::Configuration_adaptor
@@ -31,7 +32,7 @@ class Configuration
 {
 public:
 
-  Configuration(DBus::Connection &connection, const char * path);
+  Configuration(DBus::Connection &connection, const char * path, EnhancedPosition& enhancedPosition);
 
   ~Configuration();
   
@@ -43,12 +44,15 @@ public:
 
   std::map< std::string, ::DBus::Variant > GetSupportedProperties();
 
+  int32_t getUpdateInterval() const;
+
   void run();
 
   void shutdown();
 
 private:
 
+  EnhancedPosition& mEnhancedPosition;
   int32_t mUpdateInterval;
   uint32_t mSatelliteSystem;
 };
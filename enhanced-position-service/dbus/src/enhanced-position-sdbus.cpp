@@ -0,0 +1,780 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief EnhancedPosition interface implemented with sd-bus
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "enhanced-position-sdbus.h"
+#include "positioning-constants.h"
+#include "log.h"
+
+DLT_IMPORT_CONTEXT(gCtx);
+
+EnhancedPositionSdBus* EnhancedPositionSdBus::mpSelf = 0;
+
+const TPositionCallbacks EnhancedPositionSdBus::mCallbacks =
+{
+  &EnhancedPositionSdBus::cbPosition,
+  &EnhancedPositionSdBus::cbSatelliteDetail,
+  &EnhancedPositionSdBus::cbTime,
+  &EnhancedPositionSdBus::cbGyroscope,
+  &EnhancedPositionSdBus::cbAcceleration,
+  &EnhancedPositionSdBus::cbVehicleSpeed,
+  &EnhancedPositionSdBus::cbOdometer
+};
+
+//accuracy of the timers [us]: the sd_event default of 250 ms would merge the publish intervals
+#define TIMER_ACCURACY 1000
+
+//writes the a{tv} dictionary into a message, stops at the first error
+class SdBusDictionaryWriter
+{
+public:
+  SdBusDictionaryWriter(sd_bus_message* m) : mMessage(m), mResult(sd_bus_message_open_container(m, 'a', "{tv}")) {}
+  void addDouble(uint64_t key, double d) { add(key, "d", d); }
+  void addUint8(uint64_t key, uint8_t i) { add(key, "y", i); }
+  void addUint16(uint64_t key, uint16_t i) { add(key, "q", i); }
+  void addInt16(uint64_t key, int16_t i) { add(key, "n", i); }
+  void addInt32(uint64_t key, int32_t i) { add(key, "i", i); }
+  void addUint32(uint64_t key, uint32_t i) { add(key, "u", i); }
+  void addBool(uint64_t key, bool b) { add(key, "b", (int)b); }
+  int close()
+  {
+    if (mResult >= 0)
+    {
+      mResult = sd_bus_message_close_container(mMessage);
+    }
+    return mResult;
+  }
+private:
+  template<typename T>
+  void add(uint64_t key, const char* signature, T value)
+  {
+    if (mResult >= 0)
+    {
+      mResult = sd_bus_message_append(mMessage, "{tv}", key, signature, value);
+    }
+  }
+  sd_bus_message* mMessage;
+  int mResult;
+};
+
+//writes the a(qqqqqb) array of GetSatelliteInfo into a message, stops at the first error
+class SdBusSatelliteWriter
+{
+public:
+  SdBusSatelliteWriter(sd_bus_message* m) : mMessage(m), mResult(sd_bus_message_open_container(m, 'a', "(qqqqqb)")) {}
+  void addSatellite(uint16_t system, uint16_t satelliteId, uint16_t azimuth, uint16_t elevation, uint16_t cNo, bool inUse)
+  {
+    if (mResult >= 0)
+    {
+      mResult = sd_bus_message_append(mMessage, "(qqqqqb)", system, satelliteId, azimuth, elevation, cNo, (int)inUse);
+    }
+  }
+  int close()
+  {
+    if (mResult >= 0)
+    {
+      mResult = sd_bus_message_close_container(mMessage);
+    }
+    return mResult;
+  }
+private:
+  sd_bus_message* mMessage;
+  int mResult;
+};
+
+//writes the arguments (t timestamp, a{tv} data) of GetPositionInfo and the position signals
+static int writePositionInfo(sd_bus_message* m, uint64_t valuesToReturn, const TPositionSnapshot& snapshot)
+{
+  int r = sd_bus_message_append(m, "t", getSnapshotTimestamp(snapshot));
+  if (r < 0)
+  {
+    return r;
+  }
+  SdBusDictionaryWriter writer(m);
+  addPositionInfo(valuesToReturn, snapshot, writer);
+  return writer.close();
+}
+
+//writes the arguments (t timestamp, a{tv} data) of GetPredictedPositionInfo and PredictedPositionUpdate
+static int writeFusedValues(sd_bus_message* m, uint64_t valuesToReturn, const TFusionPosition& fused)
+{
+  int r = sd_bus_message_append(m, "t", fused.timestamp);
+  if (r < 0)
+  {
+    return r;
+  }
+  SdBusDictionaryWriter writer(m);
+  addFusedValues(valuesToReturn, fused, writer);
+  return writer.close();
+}
+
+//writes the arguments (t timestamp, a(qqqqqb) satelliteInfo) of GetSatelliteInfo and SatelliteUpdate
+static int writeSatelliteInfo(sd_bus_message* m)
+{
+  TGNSSSatelliteDetail details[SATELLITE_DETAILS_MAX];
+  uint16_t numDetails = 0;
+
+  uint64_t timestamp = getSatelliteSnapshot(details, numDetails);
+  int r = sd_bus_message_append(m, "t", timestamp);
+  if (r < 0)
+  {
+    return r;
+  }
+  SdBusSatelliteWriter writer(m);
+  addSatelliteInfo(details, numDetails, timestamp, writer);
+  return writer.close();
+}
+
+//writes the arguments (t timestamp, a{tv} time) of GetTime and TimeUpdate
+static int writeTimeInfo(sd_bus_message* m)
+{
+  TGNSSTime utc;
+
+  getTimeSnapshot(utc);
+  int r = sd_bus_message_append(m, "t", utc.timestamp);
+  if (r < 0)
+  {
+    return r;
+  }
+  SdBusDictionaryWriter writer(m);
+  addTimeInfo(utc, writer);
+  return writer.close();
+}
+
+//same members, signatures and argument names as api/genivi-positioning-enhancedposition.xml
+const sd_bus_vtable EnhancedPositionSdBus::mVtable[] =
+{
+  SD_BUS_VTABLE_START(0),
+  SD_BUS_METHOD_WITH_NAMES("GetVersion",
+                           NULL,,
+                           "(qqqs)", SD_BUS_PARAM(version),
+                           &EnhancedPositionSdBus::onGetVersion, SD_BUS_VTABLE_UNPRIVILEGED),
+  SD_BUS_METHOD_WITH_NAMES("GetPositionInfo",
+                           "t", SD_BUS_PARAM(valuesToReturn),
+                           "ta{tv}", SD_BUS_PARAM(timestamp) SD_BUS_PARAM(data),
+                           &EnhancedPositionSdBus::onGetPositionInfo, SD_BUS_VTABLE_UNPRIVILEGED),
+  SD_BUS_METHOD_WITH_NAMES("GetPredictedPositionInfo",
+                           "tt", SD_BUS_PARAM(valuesToReturn) SD_BUS_PARAM(targetTimestamp),
+                           "ta{tv}", SD_BUS_PARAM(timestamp) SD_BUS_PARAM(data),
+                           &EnhancedPositionSdBus::onGetPredictedPositionInfo, SD_BUS_VTABLE_UNPRIVILEGED),
+  SD_BUS_SIGNAL_WITH_NAMES("PositionUpdate",
+                           "t", SD_BUS_PARAM(changedValues), 0),
+  SD_BUS_SIGNAL_WITH_NAMES("PositionUpdateData",
+                           "tta{tv}", SD_BUS_PARAM(changedValues) SD_BUS_PARAM(timestamp) SD_BUS_PARAM(data), 0),
+  SD_BUS_SIGNAL_WITH_NAMES("PredictedPositionUpdate",
+                           "ta{tv}", SD_BUS_PARAM(timestamp) SD_BUS_PARAM(data), 0),
+  SD_BUS_METHOD_WITH_NAMES("GetSatelliteInfo",
+                           NULL,,
+                           "ta(qqqqqb)", SD_BUS_PARAM(timestamp) SD_BUS_PARAM(satelliteInfo),
+                           &EnhancedPositionSdBus::onGetSatelliteInfo, SD_BUS_VTABLE_UNPRIVILEGED),
+  SD_BUS_METHOD_WITH_NAMES("GetTime",
+                           NULL,,
+                           "ta{tv}", SD_BUS_PARAM(timestamp) SD_BUS_PARAM(time),
+                           &EnhancedPositionSdBus::onGetTime, SD_BUS_VTABLE_UNPRIVILEGED),
+  SD_BUS_SIGNAL_WITH_NAMES("SatelliteUpdate",
+                           "ta(qqqqqb)", SD_BUS_PARAM(timestamp) SD_BUS_PARAM(satelliteInfo), 0),
+  SD_BUS_SIGNAL_WITH_NAMES("TimeUpdate",
+                           "ta{tv}", SD_BUS_PARAM(timestamp) SD_BUS_PARAM(time), 0),
+  SD_BUS_METHOD_WITH_NAMES("Subscribe",
+                           "tqdd", SD_BUS_PARAM(valuesToReturn) SD_BUS_PARAM(maxRate) SD_BUS_PARAM(minDistance) SD_BUS_PARAM(minHeadingChange),
+                           "u", SD_BUS_PARAM(subscriptionId),
+                           &EnhancedPositionSdBus::onSubscribe, SD_BUS_VTABLE_UNPRIVILEGED),
+  SD_BUS_METHOD_WITH_NAMES("Unsubscribe",
+                           "u", SD_BUS_PARAM(subscriptionId),
+                           NULL,,
+                           &EnhancedPositionSdBus::onUnsubscribe, SD_BUS_VTABLE_UNPRIVILEGED),
+  SD_BUS_SIGNAL_WITH_NAMES("FilteredPositionUpdate",
+                           "utta{tv}", SD_BUS_PARAM(subscriptionId) SD_BUS_PARAM(changedValues) SD_BUS_PARAM(timestamp) SD_BUS_PARAM(data), 0),
+  SD_BUS_VTABLE_END
+};
+
+EnhancedPositionSdBus::EnhancedPositionSdBus(sd_bus* bus, sd_event* event, const char* path)
+  : mpBus(bus)
+  , mpEvent(event)
+  , mPath(path)
+  , mpVtableSlot(0)
+  , mpNameLostSlot(0)
+  , mpPublishTimer(0)
+  , mpPredictionTimer(0)
+  , mPublishInterval(0)
+  , mPredictionInterval(0)
+  , mStatisticsTime(0)
+  , mPositionInfoRequests(0)
+  , mSendErrors(0)
+{
+  mpSelf = this;
+}
+
+EnhancedPositionSdBus::~EnhancedPositionSdBus()
+{
+  stopPredictionStream();
+  sd_event_source_unref(mpPublishTimer);
+  sd_bus_slot_unref(mpNameLostSlot);
+  sd_bus_slot_unref(mpVtableSlot);
+  mpSelf = 0;
+}
+
+bool EnhancedPositionSdBus::init()
+{
+  int r = sd_bus_add_object_vtable(mpBus, &mpVtableSlot, mPath.c_str(), ENHANCED_POSITION_INTERFACE, mVtable, this);
+  if (r < 0)
+  {
+    LOG_ERROR(gCtx,"sd_bus_add_object_vtable failed: %s", strerror(-r));
+    return false;
+  }
+  return true;
+}
+
+int EnhancedPositionSdBus::onGetVersion(sd_bus_message* m, void* /*userdata*/, sd_bus_error* /*error*/)
+{
+  return sd_bus_reply_method_return(m, "(qqqs)", 4, 5, 0, "18-10-2026");
+}
+
+int EnhancedPositionSdBus::onGetPositionInfo(sd_bus_message* m, void* userdata, sd_bus_error* /*error*/)
+{
+  EnhancedPositionSdBus* self = (EnhancedPositionSdBus*)userdata;
+  uint64_t valuesToReturn = 0;
+
+  int r = sd_bus_message_read(m, "t", &valuesToReturn);
+  if (r < 0)
+  {
+    return r;
+  }
+
+  uint64_t epoch = 0;
+  uint64_t requestTime = 0;
+  TPositionSnapshot snapshot;
+  getSnapshotEpoch(epoch, requestTime);
+  getPositionSnapshot(epoch, requestTime, snapshot);
+  self->mPositionInfoRequests++;
+
+  sd_bus_message* reply = 0;
+  r = sd_bus_message_new_method_return(m, &reply);
+  if (r >= 0)
+  {
+    r = writePositionInfo(reply, valuesToReturn, snapshot);
+  }
+  return self->send(reply, r);
+}
+
+int EnhancedPositionSdBus::onGetPredictedPositionInfo(sd_bus_message* m, void* userdata, sd_bus_error* /*error*/)
+{
+  EnhancedPositionSdBus* self = (EnhancedPositionSdBus*)userdata;
+  uint64_t valuesToReturn = 0;
+  uint64_t targetTimestamp = 0;
+
+  int r = sd_bus_message_read(m, "tt", &valuesToReturn, &targetTimestamp);
+  if (r < 0)
+  {
+    return r;
+  }
+
+  sd_bus_message* reply = 0;
+  r = sd_bus_message_new_method_return(m, &reply);
+  if (r >= 0)
+  {
+    TFusionPosition fused;
+    if (getExtrapolatedPosition(targetTimestamp, fused))
+    {
+      r = writeFusedValues(reply, valuesToReturn, fused);
+    }
+    else
+    {
+      //without sensor fusion there is nothing to extrapolate
+      uint64_t epoch = 0;
+      uint64_t requestTime = 0;
+      TPositionSnapshot snapshot;
+      getSnapshotEpoch(epoch, requestTime);
+      getPositionSnapshot(epoch, requestTime, snapshot);
+      r = writePositionInfo(reply, valuesToReturn, snapshot);
+    }
+  }
+  return self->send(reply, r);
+}
+
+int EnhancedPositionSdBus::onGetSatelliteInfo(sd_bus_message* m, void* userdata, sd_bus_error* /*error*/)
+{
+  EnhancedPositionSdBus* self = (EnhancedPositionSdBus*)userdata;
+  sd_bus_message* reply = 0;
+
+  int r = sd_bus_message_new_method_return(m, &reply);
+  if (r >= 0)
+  {
+    r = writeSatelliteInfo(reply);
+  }
+  return self->send(reply, r);
+}
+
+int EnhancedPositionSdBus::onGetTime(sd_bus_message* m, void* userdata, sd_bus_error* /*error*/)
+{
+  EnhancedPositionSdBus* self = (EnhancedPositionSdBus*)userdata;
+  sd_bus_message* reply = 0;
+
+  int r = sd_bus_message_new_method_return(m, &reply);
+  if (r >= 0)
+  {
+    r = writeTimeInfo(reply);
+  }
+  return self->send(reply, r);
+}
+
+int EnhancedPositionSdBus::onSubscribe(sd_bus_message* m, void* userdata, sd_bus_error* error)
+{
+  EnhancedPositionSdBus* self = (EnhancedPositionSdBus*)userdata;
+  uint64_t valuesToReturn = 0;
+  uint16_t maxRate = 0;
+  double minDistance = 0;
+  double minHeadingChange = 0;
+
+  int r = sd_bus_message_read(m, "tqdd", &valuesToReturn, &maxRate, &minDistance, &minHeadingChange);
+  if (r < 0)
+  {
+    return r;
+  }
+
+  if ((valuesToReturn == 0) || !(minDistance >= 0) || !(minHeadingChange >= 0))
+  {
+    return sd_bus_error_set(error, SD_BUS_ERROR_INVALID_ARGS, "Subscribe: no values or negative threshold");
+  }
+
+  //watch for disconnecting clients once the first client has subscribed
+  if (!self->mpNameLostSlot)
+  {
+    r = sd_bus_add_match(self->mpBus, &self->mpNameLostSlot, NAME_LOST_MATCH_RULE, &EnhancedPositionSdBus::onNameLost, self);
+    if (r < 0)
+    {
+      LOG_WARNING_MSG(gCtx,"Subscribe: cannot watch the bus names - subscriptions of disconnected clients are kept");
+    }
+  }
+
+  uint32_t subscriptionId = self->mSubscriptions.add(sd_bus_message_get_sender(m), valuesToReturn, maxRate, minDistance, minHeadingChange);
+  if (subscriptionId == 0)
+  {
+    return sd_bus_error_set(error, SD_BUS_ERROR_LIMITS_EXCEEDED, "Subscribe: too many subscriptions");
+  }
+
+  return sd_bus_reply_method_return(m, "u", subscriptionId);
+}
+
+int EnhancedPositionSdBus::onUnsubscribe(sd_bus_message* m, void* userdata, sd_bus_error* error)
+{
+  EnhancedPositionSdBus* self = (EnhancedPositionSdBus*)userdata;
+  uint32_t subscriptionId = 0;
+
+  int r = sd_bus_message_read(m, "u", &subscriptionId);
+  if (r < 0)
+  {
+    return r;
+  }
+
+  if (!self->mSubscriptions.remove(subscriptionId, sd_bus_message_get_sender(m)))
+  {
+    return sd_bus_error_set(error, SD_BUS_ERROR_INVALID_ARGS, "Unsubscribe: unknown subscription");
+  }
+
+  return sd_bus_reply_method_return(m, "");
+}
+
+int EnhancedPositionSdBus::onNameLost(sd_bus_message* m, void* userdata, sd_bus_error* /*error*/)
+{
+  EnhancedPositionSdBus* self = (EnhancedPositionSdBus*)userdata;
+  const char* name = 0;
+  const char* oldOwner = 0;
+  const char* newOwner = 0;
+
+  if ((sd_bus_message_read(m, "sss", &name, &oldOwner, &newOwner) < 0) || (newOwner[0] != '\0'))
+  {
+    return 0;
+  }
+
+  self->mSubscriptions.removeSender(name);
+
+  //other match callbacks may be interested as well
+  return 0;
+}
+
+int EnhancedPositionSdBus::newSignal(const char* member, sd_bus_message** m)
+{
+  return sd_bus_message_new_signal(mpBus, m, mPath.c_str(), ENHANCED_POSITION_INTERFACE, member);
+}
+
+//sends and releases the message if the result r of building it is ok
+int EnhancedPositionSdBus::send(sd_bus_message* m, int r)
+{
+  if (r >= 0)
+  {
+    r = sd_bus_send(mpBus, m, 0);
+  }
+  sd_bus_message_unref(m);
+  if (r < 0)
+  {
+    mSendErrors++;
+  }
+  return r;
+}
+
+void EnhancedPositionSdBus::firePositionUpdate(uint64_t changedValues)
+{
+  uint64_t epoch = 0;
+  uint64_t requestTime = 0;
+  TPositionSnapshot snapshot;
+  sd_bus_message* m = 0;
+
+  if (sd_bus_emit_signal(mpBus, mPath.c_str(), ENHANCED_POSITION_INTERFACE, "PositionUpdate", "t", changedValues) < 0)
+  {
+    mSendErrors++;
+  }
+
+  //push the values as well, clients subscribed to PositionUpdateData save the GetPositionInfo round trip
+  getSnapshotEpoch(epoch, requestTime);
+  getPositionSnapshot(epoch, requestTime, snapshot);
+
+  int r = newSignal("PositionUpdateData", &m);
+  if (r >= 0)
+  {
+    r = sd_bus_message_append(m, "t", changedValues);
+  }
+  if (r >= 0)
+  {
+    r = writePositionInfo(m, changedValues, snapshot);
+  }
+  send(m, r);
+
+  mSubscriptions.notify(changedValues, snapshot, *this);
+}
+
+void EnhancedPositionSdBus::fireFilteredPositionUpdate(const TSubscription& subscription, const TPositionSnapshot& snapshot)
+{
+  //unicast: only the subscriber receives the signal
+  sd_bus_message* m = 0;
+  int r = newSignal("FilteredPositionUpdate", &m);
+  if (r >= 0)
+  {
+    r = sd_bus_message_set_destination(m, subscription.sender.c_str());
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_message_append(m, "ut", subscription.id, subscription.changedValues);
+  }
+  if (r >= 0)
+  {
+    r = writePositionInfo(m, subscription.valuesToReturn, snapshot);
+  }
+  send(m, r);
+}
+
+void EnhancedPositionSdBus::fireSatelliteUpdate()
+{
+  sd_bus_message* m = 0;
+  int r = newSignal("SatelliteUpdate", &m);
+  if (r >= 0)
+  {
+    r = writeSatelliteInfo(m);
+  }
+  send(m, r);
+}
+
+void EnhancedPositionSdBus::fireTimeUpdate()
+{
+  sd_bus_message* m = 0;
+  int r = newSignal("TimeUpdate", &m);
+  if (r >= 0)
+  {
+    r = writeTimeInfo(m);
+  }
+  send(m, r);
+}
+
+void EnhancedPositionSdBus::cbPosition(const TGNSSPosition position[], uint16_t numElements)
+{
+  if (position == NULL || numElements < 1)
+  {
+    LOG_ERROR_MSG(gCtx,"cbPosition failed!");
+    return;
+  }
+
+  processGNSSPositions(position, numElements);
+
+  for (int i = 0; i < numElements; i++)
+  {
+    LOG_DEBUG(gCtx,"Position Update[%d/%d]: lat=%f lon=%f alt=%f fixStatus=%d",
+              i+1,
+              numElements,
+              position[i].latitude,
+              position[i].longitude,
+              position[i].altitudeMSL,
+              position[i].fixStatus);
+  }
+
+  LOG_INFO_RATE_LIMITED(gCtx, 1000, "Position Update: lat=%f lon=%f alt=%f fixStatus=%d",
+                        position[numElements-1].latitude,
+                        position[numElements-1].longitude,
+                        position[numElements-1].altitudeMSL,
+                        position[numElements-1].fixStatus);
+
+  if (mpSelf)
+  {
+    //emitted by onPublishTimer in the event loop thread
+    mpSelf->mPublishScheduler.post(getGNSSChangedValues(position, numElements), getMonotonicTime());
+  }
+}
+
+void EnhancedPositionSdBus::cbSatelliteDetail(const TGNSSSatelliteDetail satelliteDetail[], uint16_t numElements)
+{
+  if (satelliteDetail == NULL || numElements < 1)
+  {
+    LOG_ERROR_MSG(gCtx,"cbSatelliteDetail failed!");
+    return;
+  }
+
+  for (int i = 0; i < numElements; i++)
+  {
+    LOG_DEBUG(gCtx,"SatelliteDetail Update[%d/%d]: satelliteId=%d azimuth=%d elevation=%d CNo=%d",
+              i+1,
+              numElements,
+              satelliteDetail[i].satelliteId,
+              satelliteDetail[i].azimuth,
+              satelliteDetail[i].elevation,
+              satelliteDetail[i].CNo);
+  }
+
+  LOG_INFO_RATE_LIMITED(gCtx, 1000, "SatelliteDetail Update: %d satellites", numElements);
+
+  if (mpSelf)
+  {
+    mpSelf->mSatelliteScheduler.post(GENIVI_ENHANCEDPOSITIONSERVICE_VISIBLE_SATELLITES, getMonotonicTime());
+  }
+}
+
+void EnhancedPositionSdBus::cbTime(const TGNSSTime time[], uint16_t numElements)
+{
+  if (time == NULL || numElements < 1)
+  {
+    LOG_ERROR_MSG(gCtx,"cbTime failed!");
+    return;
+  }
+
+  LOG_INFO(gCtx,"Time Update: %04d-%02d-%02d %02d:%02d:%02d.%03d validityBits=0x%08X",
+           time[numElements-1].year,
+           time[numElements-1].month + 1,
+           time[numElements-1].day,
+           time[numElements-1].hour,
+           time[numElements-1].minute,
+           time[numElements-1].second,
+           time[numElements-1].ms,
+           time[numElements-1].validityBits);
+
+  processGNSSTime(time, numElements);
+
+  if (mpSelf)
+  {
+    mpSelf->mTimeScheduler.post(GENIVI_ENHANCEDPOSITIONSERVICE_YEAR, getMonotonicTime());
+  }
+}
+
+void EnhancedPositionSdBus::cbAcceleration(const TAccelerationData accelerationData[], uint16_t numElements)
+{
+  processAcceleration(accelerationData, numElements);
+}
+
+void EnhancedPositionSdBus::cbGyroscope(const TGyroscopeData gyroData[], uint16_t numElements)
+{
+  TFusionPosition fused;
+
+  //the fused position changes with each gyroscope batch
+  if (processGyroscope(gyroData, numElements, fused) && mpSelf)
+  {
+    mpSelf->mPublishScheduler.post(getFusedChangedValues(fused), getMonotonicTime());
+  }
+}
+
+void EnhancedPositionSdBus::cbVehicleSpeed(const TVehicleSpeedData vehicleSpeedData[], uint16_t numElements)
+{
+  processVehicleSpeed(vehicleSpeedData, numElements);
+}
+
+void EnhancedPositionSdBus::cbOdometer(const TOdometerData odometerData[], uint16_t numElements)
+{
+  processOdometer(odometerData, numElements);
+}
+
+//schedules the next expiration of a periodic timer, which sd_event does not provide
+int EnhancedPositionSdBus::armTimer(sd_event_source* source, uint64_t usec, uint64_t interval)
+{
+  uint64_t now = 0;
+  uint64_t next = usec + interval;
+
+  //after a blocked loop, continue from now instead of catching up the missed intervals
+  if ((sd_event_now(mpEvent, CLOCK_MONOTONIC, &now) >= 0) && (next < now))
+  {
+    next = now + interval;
+  }
+
+  int r = sd_event_source_set_time(source, next);
+  if (r >= 0)
+  {
+    r = sd_event_source_set_enabled(source, SD_EVENT_ONESHOT);
+  }
+  return r;
+}
+
+void EnhancedPositionSdBus::startPublishing(int32_t interval)
+{
+  setUpdateInterval(interval);
+}
+
+void EnhancedPositionSdBus::setUpdateInterval(int32_t interval)
+{
+  uint64_t now = 0;
+
+  if ((interval <= 0) || (sd_event_now(mpEvent, CLOCK_MONOTONIC, &now) < 0))
+  {
+    return;
+  }
+
+  LOG_INFO(gCtx,"Publishing position updates every %d ms", interval);
+
+  //the updates pending in the scheduler are published with the new interval
+  mPublishInterval = (uint64_t)interval*1000;
+  if (mpPublishTimer)
+  {
+    armTimer(mpPublishTimer, now, mPublishInterval);
+    return;
+  }
+
+  int r = sd_event_add_time(mpEvent, &mpPublishTimer, CLOCK_MONOTONIC, now + mPublishInterval, TIMER_ACCURACY,
+                            &EnhancedPositionSdBus::onPublishTimer, this);
+  if (r < 0)
+  {
+    LOG_ERROR(gCtx,"sd_event_add_time failed: %s", strerror(-r));
+  }
+}
+
+int EnhancedPositionSdBus::onPublishTimer(sd_event_source* source, uint64_t usec, void* userdata)
+{
+  EnhancedPositionSdBus* self = (EnhancedPositionSdBus*)userdata;
+  uint64_t now = getMonotonicTime();
+  uint64_t changedValues = 0;
+
+  if (self->mPublishScheduler.take(now, changedValues))
+  {
+    self->firePositionUpdate(changedValues);
+  }
+  //the satellites and the time are taken from the GNSS snapshot, the changedValues are not needed
+  if (self->mSatelliteScheduler.take(now, changedValues))
+  {
+    self->fireSatelliteUpdate();
+  }
+  if (self->mTimeScheduler.take(now, changedValues))
+  {
+    self->fireTimeUpdate();
+  }
+
+  self->logStatistics(now);
+
+  return self->armTimer(source, usec, self->mPublishInterval);
+}
+
+void EnhancedPositionSdBus::logStatistics(uint64_t now)
+{
+  if (!isStatisticsDue(mStatisticsTime, now))
+  {
+    return;
+  }
+
+  logPublishStatistics(mPublishScheduler);
+
+  LOG_INFO(gCtx,"GetPositionInfo statistics: requests=%llu sendErrors=%llu",
+           (unsigned long long)mPositionInfoRequests,
+           (unsigned long long)mSendErrors);
+  mPositionInfoRequests = 0;
+  mSendErrors = 0;
+
+  mSubscriptions.logStatistics();
+}
+
+void EnhancedPositionSdBus::startPredictionStream(uint16_t rate)
+{
+  uint64_t now = 0;
+
+  stopPredictionStream();
+
+  if ((rate == 0) || (sd_event_now(mpEvent, CLOCK_MONOTONIC, &now) < 0))
+  {
+    return;
+  }
+
+  LOG_INFO(gCtx,"Starting predicted position stream at %d Hz", rate);
+
+  mPredictionInterval = 1000000/rate;
+  int r = sd_event_add_time(mpEvent, &mpPredictionTimer, CLOCK_MONOTONIC, now + mPredictionInterval, TIMER_ACCURACY,
+                            &EnhancedPositionSdBus::onPredictionTimer, this);
+  if (r < 0)
+  {
+    LOG_ERROR(gCtx,"sd_event_add_time failed: %s", strerror(-r));
+  }
+}
+
+void EnhancedPositionSdBus::stopPredictionStream()
+{
+  if (mpPredictionTimer)
+  {
+    sd_event_source_unref(mpPredictionTimer);
+    mpPredictionTimer = 0;
+  }
+}
+
+int EnhancedPositionSdBus::onPredictionTimer(sd_event_source* source, uint64_t usec, void* userdata)
+{
+  EnhancedPositionSdBus* self = (EnhancedPositionSdBus*)userdata;
+  TFusionPosition fused;
+
+  if (getExtrapolatedPosition(0, fused))
+  {
+    sd_bus_message* m = 0;
+    int r = self->newSignal("PredictedPositionUpdate", &m);
+    if (r >= 0)
+    {
+      r = writeFusedValues(m, getFusedChangedValues(fused), fused);
+    }
+    self->send(m, r);
+  }
+
+  return self->armTimer(source, usec, self->mPredictionInterval);
+}
+
+void EnhancedPositionSdBus::run()
+{
+  LOG_INFO_MSG(gCtx,"Starting EnhancedPosition dispatcher...");
+
+  registerPositionCallbacks(mCallbacks);
+}
+
+void EnhancedPositionSdBus::shutdown()
+{
+  LOG_INFO_MSG(gCtx,"Shutting down EnhancedPosition dispatcher...");
+
+  stopPredictionStream();
+
+  deregisterPositionCallbacks(mCallbacks);
+}
@@ -0,0 +1,142 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief EnhancedPosition interface implemented with sd-bus
+*
+* \details Alternative to the dbus-c++ adaptor with the same object path,
+* methods and signals as api/genivi-positioning-enhancedposition.xml.
+* All bus traffic is handled in the thread of the sd_event loop: the GNSS
+* and sensor callbacks only feed the position core and post their updates
+* to the publish schedulers, which are emptied by the publish timer.
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+#ifndef ___ENHANCED_POSITION_SDBUS_H
+#define ___ENHANCED_POSITION_SDBUS_H
+
+#include <string>
+#include <vector>
+#include <systemd/sd-bus.h>
+#include <systemd/sd-event.h>
+
+#include "gnss-init.h"
+#include "gnss.h"
+#include "acceleration.h"
+#include "gyroscope.h"
+#include "vehicle-speed.h"
+#include "odometer.h"
+#include "publish-scheduler.h"
+#include "position-core.h"
+
+#define ENHANCED_POSITION_INTERFACE "org.genivi.positioning.EnhancedPosition"
+
+class EnhancedPositionSdBus
+{
+public:
+
+  EnhancedPositionSdBus(sd_bus* bus, sd_event* event, const char* path);
+
+  ~EnhancedPositionSdBus();
+
+  /**
+   * Register the object on the bus
+   * @return false if the vtable could not be added
+   */
+  bool init();
+
+  void run();
+
+  void shutdown();
+
+  /**
+   * Emit PositionUpdate/PositionUpdateData, SatelliteUpdate and TimeUpdate
+   * once per update interval with the changes of the whole interval merged.
+   * @param interval [ms]
+   */
+  void startPublishing(int32_t interval);
+
+  /**
+   * Change the update interval, see Configuration::UpdateInterval
+   * @param interval [ms]
+   */
+  void setUpdateInterval(int32_t interval);
+
+  /**
+   * Emit PredictedPositionUpdate at a fixed rate
+   * @param rate [Hz], 0 stops the stream
+   */
+  void startPredictionStream(uint16_t rate);
+
+  void stopPredictionStream();
+
+private:
+
+  static const sd_bus_vtable mVtable[];
+
+  static int onGetVersion(sd_bus_message* m, void* userdata, sd_bus_error* error);
+  static int onGetPositionInfo(sd_bus_message* m, void* userdata, sd_bus_error* error);
+  static int onGetPredictedPositionInfo(sd_bus_message* m, void* userdata, sd_bus_error* error);
+  static int onGetSatelliteInfo(sd_bus_message* m, void* userdata, sd_bus_error* error);
+  static int onGetTime(sd_bus_message* m, void* userdata, sd_bus_error* error);
+  static int onSubscribe(sd_bus_message* m, void* userdata, sd_bus_error* error);
+  static int onUnsubscribe(sd_bus_message* m, void* userdata, sd_bus_error* error);
+  static int onNameLost(sd_bus_message* m, void* userdata, sd_bus_error* error);
+  static int onPublishTimer(sd_event_source* source, uint64_t usec, void* userdata);
+  static int onPredictionTimer(sd_event_source* source, uint64_t usec, void* userdata);
+
+  void firePositionUpdate(uint64_t changedValues);
+  void fireFilteredPositionUpdate(const TSubscription& subscription, const TPositionSnapshot& snapshot);
+  void fireSatelliteUpdate();
+  void fireTimeUpdate();
+  void logStatistics(uint64_t now);
+  int newSignal(const char* member, sd_bus_message** m);
+  int send(sd_bus_message* m, int r);
+  int armTimer(sd_event_source* source, uint64_t usec, uint64_t interval);
+
+  sd_bus* mpBus;
+  sd_event* mpEvent;
+  std::string mPath;
+  sd_bus_slot* mpVtableSlot;
+  sd_bus_slot* mpNameLostSlot;
+  sd_event_source* mpPublishTimer;
+  sd_event_source* mpPredictionTimer;
+  uint64_t mPublishInterval;      //[us]
+  uint64_t mPredictionInterval;   //[us]
+
+  PublishScheduler mPublishScheduler;
+  PublishScheduler mSatelliteScheduler;
+  PublishScheduler mTimeScheduler;
+  uint64_t mStatisticsTime;
+  uint64_t mPositionInfoRequests;
+  uint64_t mSendErrors;
+
+  SubscriptionList mSubscriptions;
+
+  static void cbTime(const TGNSSTime time[], uint16_t numElements);
+  static void cbSatelliteDetail(const TGNSSSatelliteDetail satelliteDetail[], uint16_t numElements);
+  static void cbPosition(const TGNSSPosition position[], uint16_t numElements);
+  static void cbAcceleration(const TAccelerationData accelerationData[], uint16_t numElements);
+  static void cbGyroscope(const TGyroscopeData gyroData[], uint16_t numElements);
+  static void cbVehicleSpeed(const TVehicleSpeedData vehicleSpeedData[], uint16_t numElements);
+  static void cbOdometer(const TOdometerData odometerData[], uint16_t numElements);
+
+  static const TPositionCallbacks mCallbacks;
+  static EnhancedPositionSdBus* mpSelf;
+
+  //calls fireFilteredPositionUpdate
+  friend class SubscriptionList;
+};
+
+#endif//___ENHANCED_POSITION_SDBUS_H
@@ -18,6 +18,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 #include "enhanced-position.h"
 #include "positioning-constants.h"
 #include "log.h"
@@ -26,6 +28,17 @@ DLT_IMPORT_CONTEXT(gCtx);
 
 EnhancedPosition* EnhancedPosition::mpSelf = 0;
 
+const TPositionCallbacks EnhancedPosition::mCallbacks =
+{
+  &EnhancedPosition::cbPosition,
+  &EnhancedPosition::cbSatelliteDetail,
+  &EnhancedPosition::cbTime,
+  &EnhancedPosition::cbGyroscope,
+  &EnhancedPosition::cbAcceleration,
+  &EnhancedPosition::cbVehicleSpeed,
+  &EnhancedPosition::cbOdometer
+};
+
 static DBus::Variant variant_double(double d)
 {
   DBus::Variant variant;
@@ -42,6 +55,22 @@ static DBus::Variant variant_uint16(uint16_t i)
   return variant;
 }
 
+static DBus::Variant variant_uint8(uint8_t i)
+{
+  DBus::Variant variant;
+  DBus::MessageIter iter=variant.writer();
+  iter << i;
+  return variant;
+}
+
+static DBus::Variant variant_int16(int16_t i)
+{
+  DBus::Variant variant;
+  DBus::MessageIter iter=variant.writer();
+  iter << i;
+  return variant;
+}
+
 static DBus::Variant variant_int32(int32_t i)
 {
   DBus::Variant variant;
@@ -58,6 +87,14 @@ static DBus::Variant variant_uint32(uint32_t i)
   return variant;
 }
 
+static DBus::Variant variant_bool(bool b)
+{
+  DBus::Variant variant;
+  DBus::MessageIter iter=variant.writer();
+  iter << b;
+  return variant;
+}
+
 static DBus::Variant variant_string(std::string s)
 {
   DBus::Variant variant;
@@ -66,14 +103,143 @@ static DBus::Variant variant_string(std::string s)
   return variant;
 }
 
+//collects the values into the map of the generated adaptor methods and signals
+class VariantMapWriter
+{
+public:
+  VariantMapWriter(std::map< uint64_t, ::DBus::Variant >& data) : mData(data) {}
+  void addDouble(uint64_t key, double d) { mData[key] = variant_double(d); }
+  void addUint8(uint64_t key, uint8_t i) { mData[key] = variant_uint8(i); }
+  void addUint16(uint64_t key, uint16_t i) { mData[key] = variant_uint16(i); }
+  void addInt16(uint64_t key, int16_t i) { mData[key] = variant_int16(i); }
+  void addInt32(uint64_t key, int32_t i) { mData[key] = variant_int32(i); }
+  void addUint32(uint64_t key, uint32_t i) { mData[key] = variant_uint32(i); }
+  void addBool(uint64_t key, bool b) { mData[key] = variant_bool(b); }
+private:
+  std::map< uint64_t, ::DBus::Variant >& mData;
+};
+
+//writes the a{tv} dictionary directly into a message,
+//without the map nodes and the variant objects with their own message buffers
+class DictionaryWriter
+{
+public:
+  DictionaryWriter(DBus::MessageIter& iter) : mIter(iter), mDict(iter.new_array("{tv}")) {}
+  void addDouble(uint64_t key, double d) { add(key, "d", d); }
+  void addUint8(uint64_t key, uint8_t i) { add(key, "y", i); }
+  void addUint16(uint64_t key, uint16_t i) { add(key, "q", i); }
+  void addInt16(uint64_t key, int16_t i) { add(key, "n", i); }
+  void addInt32(uint64_t key, int32_t i) { add(key, "i", i); }
+  void addUint32(uint64_t key, uint32_t i) { add(key, "u", i); }
+  void addBool(uint64_t key, bool b) { add(key, "b", b); }
+  void close() { mIter.close_container(mDict); }
+private:
+  template<typename T>
+  void add(uint64_t key, const char* signature, const T& value)
+  {
+    DBus::MessageIter entry = mDict.new_dict_entry();
+    entry << key;
+    DBus::MessageIter variant = entry.new_variant(signature);
+    variant << value;
+    entry.close_container(variant);
+    mDict.close_container(entry);
+  }
+  DBus::MessageIter& mIter;
+  DBus::MessageIter mDict;
+};
+
+//writes the out arguments (t timestamp, a{tv} data) of GetPositionInfo
+static void writePositionInfo(uint64_t valuesToReturn, const TPositionSnapshot& snapshot, DBus::MessageIter& iter)
+{
+  iter << getSnapshotTimestamp(snapshot);
+  DictionaryWriter writer(iter);
+  addPositionInfo(valuesToReturn, snapshot, writer);
+  writer.close();
+}
+
+//collects the satellites into the vector of the generated adaptor methods and signals
+class SatelliteInfoWriter
+{
+public:
+  SatelliteInfoWriter(std::vector< TSatelliteInfo >& satelliteInfo) : mSatelliteInfo(satelliteInfo) {}
+  void addSatellite(uint16_t system, uint16_t satelliteId, uint16_t azimuth, uint16_t elevation, uint16_t cNo, bool inUse)
+  {
+    TSatelliteInfo info;
+    info._1 = system;
+    info._2 = satelliteId;
+    info._3 = azimuth;
+    info._4 = elevation;
+    info._5 = cNo;
+    info._6 = inUse;
+    mSatelliteInfo.push_back(info);
+  }
+private:
+  std::vector< TSatelliteInfo >& mSatelliteInfo;
+};
+
+//satellites of the latest GNSS epoch from the GNSS snapshot
+static void getSatelliteInfo(uint64_t& timestamp, std::vector< TSatelliteInfo >& satelliteInfo)
+{
+  TGNSSSatelliteDetail details[SATELLITE_DETAILS_MAX];
+  uint16_t numDetails = 0;
+
+  timestamp = getSatelliteSnapshot(details, numDetails);
+  satelliteInfo.reserve(numDetails);
+  SatelliteInfoWriter writer(satelliteInfo);
+  addSatelliteInfo(details, numDetails, timestamp, writer);
+}
+
+//date/time from the GNSS snapshot
+static void getTimeInfo(uint64_t& timestamp, std::map< uint64_t, ::DBus::Variant >& time)
+{
+  TGNSSTime utc;
+
+  getTimeSnapshot(utc);
+  timestamp = utc.timestamp;
+  VariantMapWriter writer(time);
+  addTimeInfo(utc, writer);
+}
+
 EnhancedPosition::EnhancedPosition(DBus::Connection & connection, const char * path)
   : DBus::ObjectAdaptor(connection, path)
+  , mpPredictionTimeout(0)
+  , mpDispatcher(0)
+  , mpPublishTimeout(0)
+  , mStatisticsTime(0)
+  , mpPositionPipe(0)
+  , mPositionWakeupPending(false)
+  , mPositionDrops(0)
+  , mPositionInfoCacheNext(0)
+  , mPositionInfoRequests(0)
+  , mPositionInfoCacheHits(0)
+  , mIsBusFilterAdded(false)
 {
     mpSelf = this;
+    memset(mPositionInfoCache, 0, sizeof(mPositionInfoCache));
+
+    //the subscriptions are bound to the bus name of the caller, which the generated stubs do not provide
+    org::genivi::positioning::EnhancedPosition_adaptor::_methods["Subscribe"] =
+      new DBus::Callback<EnhancedPosition, DBus::Message, const DBus::CallMessage&>(this, &EnhancedPosition::onSubscribe);
+    org::genivi::positioning::EnhancedPosition_adaptor::_methods["Unsubscribe"] =
+      new DBus::Callback<EnhancedPosition, DBus::Message, const DBus::CallMessage&>(this, &EnhancedPosition::onUnsubscribe);
 }
 
 EnhancedPosition::~EnhancedPosition()
 {
+    stopPredictionStream();
+    delete mpPublishTimeout;
+    if (mpPositionPipe)
+    {
+      mpDispatcher->del_pipe(mpPositionPipe);
+    }
+    for (int i = 0; i < POSITION_INFO_CACHE_SIZE; i++)
+    {
+      delete mPositionInfoCache[i].pReply;
+    }
+    if (mIsBusFilterAdded)
+    {
+      conn().remove_filter(mBusFilter);
+    }
     mpSelf = 0;
 }
 
@@ -82,9 +248,9 @@ EnhancedPosition::~EnhancedPosition()
   ::DBus::Struct< uint16_t, uint16_t, uint16_t, std::string > Version;
 
   Version._1 = 4;
-  Version._2 = 0;
+  Version._2 = 5;
   Version._3 = 0;
-  Version._4 = std::string("25-04-2016");
+  Version._4 = std::string("18-10-2026");
 
   return Version;
 }
@@ -93,112 +259,204 @@ EnhancedPosition::~EnhancedPosition()
 
 void EnhancedPosition::GetPositionInfo(const uint64_t& valuesToReturn, uint64_t& timestamp, std::map< uint64_t, ::DBus::Variant >& data)
 {
-  //std::map< uint64_t, ::DBus::Variant > Data;
+  uint64_t epoch = 0;
+  uint64_t requestTime = 0;
+  TPositionSnapshot snapshot;
 
-  TGNSSPosition position;
+  getSnapshotEpoch(epoch, requestTime);
+  getPositionSnapshot(epoch, requestTime, snapshot);
 
-  bool isPosRequested = false;
-  bool isCourseRequested = false;
+  timestamp = getSnapshotTimestamp(snapshot);
+  VariantMapWriter writer(data);
+  addPositionInfo(valuesToReturn, snapshot, writer);
+}
 
-  if ((valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE) ||
-      (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE) ||
-      (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE))
+DBus::Message EnhancedPosition::onGetPositionInfo(const DBus::CallMessage& call)
+{
+  if (strcmp(call.signature(), "t") != 0)
   {
-    isPosRequested = true;
+    return DBus::ErrorMessage(call, DBUS_ERROR_INVALID_ARGS, "GetPositionInfo expects a uint64 argument");
   }
 
-  if ((valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_HEADING) ||
-      (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_SPEED) ||
-      (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_CLIMB ))
+  uint64_t valuesToReturn = 0;
+  DBus::MessageIter ri = call.reader();
+  ri >> valuesToReturn;
+
+  uint64_t epoch = 0;
+  uint64_t requestTime = 0;
+  getSnapshotEpoch(epoch, requestTime);
+  mPositionInfoRequests++;
+
+  //same input data, same request time and same values: resend the serialized reply
+  for (int i = 0; i < POSITION_INFO_CACHE_SIZE; i++)
   {
-    isCourseRequested = true;
+    TPositionInfoCacheEntry& entry = mPositionInfoCache[i];
+    if (entry.pReply &&
+        (entry.valuesToReturn == valuesToReturn) &&
+        (entry.epoch == epoch) &&
+        (entry.requestTime == requestTime))
+    {
+      mPositionInfoCacheHits++;
+      DBus::Message reply = entry.pReply->copy();
+      reply.reply_serial(call.serial());
+      reply.destination(call.sender());
+      return reply;
+    }
   }
 
-  if(gnssGetPosition(&position))
+  TPositionSnapshot snapshot;
+  getPositionSnapshot(epoch, requestTime, snapshot);
+
+  DBus::ReturnMessage reply(call);
+  DBus::MessageIter wi = reply.writer();
+  writePositionInfo(valuesToReturn, snapshot, wi);
+
+  //the reply is locked when it is sent: keep a copy, replacing the oldest entry
+  TPositionInfoCacheEntry& entry = mPositionInfoCache[mPositionInfoCacheNext];
+  mPositionInfoCacheNext = (mPositionInfoCacheNext + 1) % POSITION_INFO_CACHE_SIZE;
+  delete entry.pReply;
+  entry.pReply = new DBus::Message(reply.copy());
+  entry.valuesToReturn = valuesToReturn;
+  entry.epoch = epoch;
+  entry.requestTime = requestTime;
+
+  return reply;
+}
+
+void EnhancedPosition::enableDirectMarshalling()
+{
+  //replace the stub of the generated adaptor, which marshals a map of variants
+  org::genivi::positioning::EnhancedPosition_adaptor::_methods["GetPositionInfo"] =
+    new DBus::Callback<EnhancedPosition, DBus::Message, const DBus::CallMessage&>(this, &EnhancedPosition::onGetPositionInfo);
+}
+
+void EnhancedPosition::GetPredictedPositionInfo(const uint64_t& valuesToReturn, const uint64_t& targetTimestamp, uint64_t& timestamp, std::map< uint64_t, ::DBus::Variant >& data)
+{
+  TFusionPosition fused;
+
+  if (!getExtrapolatedPosition(targetTimestamp, fused))
+  {
+    //without sensor fusion there is nothing to extrapolate
+    GetPositionInfo(valuesToReturn, timestamp, data);
+    return;
+  }
+
+  timestamp = fused.timestamp;
+  VariantMapWriter writer(data);
+  addFusedValues(valuesToReturn, fused, writer);
+}
+
+void EnhancedPosition::GetSatelliteInfo(uint64_t& timestamp, std::vector< ::DBus::Struct< uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, bool > >& satelliteInfo)
+{
+  getSatelliteInfo(timestamp, satelliteInfo);
+}
+
+void EnhancedPosition::GetTime(uint64_t& timestamp, std::map< uint64_t, ::DBus::Variant >& time)
+{
+  getTimeInfo(timestamp, time);
+}
+
+//replaced by onSubscribe/onUnsubscribe in the constructor
+uint32_t EnhancedPosition::Subscribe(const uint64_t&, const uint16_t&, const double&, const double&)
+{
+  throw DBus::ErrorFailed("Subscribe requires the bus name of the caller");
+}
+
+void EnhancedPosition::Unsubscribe(const uint32_t&)
+{
+  throw DBus::ErrorFailed("Unsubscribe requires the bus name of the caller");
+}
+
+DBus::Message EnhancedPosition::onSubscribe(const DBus::CallMessage& call)
+{
+  if (strcmp(call.signature(), "tqdd") != 0)
   {
+    return DBus::ErrorMessage(call, DBUS_ERROR_INVALID_ARGS, "Subscribe expects the arguments (tqdd)");
+  }
 
-    timestamp = position.timestamp;
+  uint64_t valuesToReturn = 0;
+  uint16_t maxRate = 0;
+  double minDistance = 0;
+  double minHeadingChange = 0;
+  DBus::MessageIter ri = call.reader();
+  ri >> valuesToReturn >> maxRate >> minDistance >> minHeadingChange;
 
-    if(isPosRequested)
+  if ((valuesToReturn == 0) || !(minDistance >= 0) || !(minHeadingChange >= 0))
+  {
+    return DBus::ErrorMessage(call, DBUS_ERROR_INVALID_ARGS, "Subscribe: no values or negative threshold");
+  }
+
+  //watch for disconnecting clients once the first client has subscribed
+  if (!mIsBusFilterAdded)
+  {
+    try
     {
-      if (position.validityBits & GNSS_POSITION_LATITUDE_VALID)
-      {
-        data[GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE] = variant_double(position.latitude);
-      }
-
-      if (position.validityBits & GNSS_POSITION_LONGITUDE_VALID)
-      {
-        data[GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE] = variant_double(position.longitude);
-      }
-
-      if (position.validityBits & GNSS_POSITION_ALTITUDEMSL_VALID)
-      {
-        data[GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE] = variant_double(position.altitudeMSL);
-      }
+      conn().add_match(NAME_LOST_MATCH_RULE);
+      mBusFilter = new DBus::Callback<EnhancedPosition, bool, const DBus::Message&>(this, &EnhancedPosition::onBusMessage);
+      conn().add_filter(mBusFilter);
+      mIsBusFilterAdded = true;
     }
-
-    if(isCourseRequested)
+    catch (DBus::Error& e)
     {
-      if (position.validityBits & GNSS_POSITION_HEADING_VALID)
-      {
-        data[GENIVI_ENHANCEDPOSITIONSERVICE_HEADING] = variant_double(position.heading);
-      }
-
-      if (position.validityBits & GNSS_POSITION_HSPEED_VALID)
-      {
-        data[GENIVI_ENHANCEDPOSITIONSERVICE_SPEED] = variant_double(position.hSpeed);
-      }
-
-      if (position.validityBits & GNSS_POSITION_VSPEED_VALID)
-      {
-        data[GENIVI_ENHANCEDPOSITIONSERVICE_CLIMB] = variant_double(position.vSpeed);
-      }
+      LOG_WARNING_MSG(gCtx,"Subscribe: cannot watch the bus names - subscriptions of disconnected clients are kept");
     }
   }
 
-  //always provide some status information
-  if (position.validityBits & GNSS_POSITION_STAT_VALID)
+  uint32_t subscriptionId = mSubscriptions.add(call.sender(), valuesToReturn, maxRate, minDistance, minHeadingChange);
+  if (subscriptionId == 0)
   {
-    data[GENIVI_ENHANCEDPOSITIONSERVICE_GNSS_FIX_STATUS] = variant_uint16(position.fixStatus);
+    return DBus::ErrorMessage(call, DBUS_ERROR_LIMITS_EXCEEDED, "Subscribe: too many subscriptions");
   }
-  if (position.validityBits & GNSS_POSITION_USYS_VALID)
+
+  DBus::ReturnMessage reply(call);
+  DBus::MessageIter wi = reply.writer();
+  wi << subscriptionId;
+  return reply;
+}
+
+DBus::Message EnhancedPosition::onUnsubscribe(const DBus::CallMessage& call)
+{
+  if (strcmp(call.signature(), "u") != 0)
   {
-    data[GENIVI_ENHANCEDPOSITIONSERVICE_USED_SATELLITESYSTEMS] = variant_uint32(position.usedSystems);
+    return DBus::ErrorMessage(call, DBUS_ERROR_INVALID_ARGS, "Unsubscribe expects a uint32 argument");
   }
 
+  uint32_t subscriptionId = 0;
+  DBus::MessageIter ri = call.reader();
+  ri >> subscriptionId;
 
+  if (!mSubscriptions.remove(subscriptionId, call.sender()))
+  {
+    return DBus::ErrorMessage(call, DBUS_ERROR_INVALID_ARGS, "Unsubscribe: unknown subscription");
+  }
+
+  return DBus::ReturnMessage(call);
 }
 
+bool EnhancedPosition::onBusMessage(const DBus::Message& msg)
+{
+  if (!msg.is_signal("org.freedesktop.DBus", "NameOwnerChanged"))
+  {
+    return false;
+  }
 
+  std::string name;
+  std::string oldOwner;
+  std::string newOwner;
+  DBus::MessageIter ri = msg.reader();
+  ri >> name >> oldOwner >> newOwner;
 
-void EnhancedPosition::GetSatelliteInfo(uint64_t& timestamp, std::vector< ::DBus::Struct< uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, bool > >& satelliteInfo)
-{
-  throw DBus::ErrorNotSupported("Method not supported yet");
-}
+  if (newOwner.empty())
+  {
+    mSubscriptions.removeSender(name.c_str());
+  }
 
-void EnhancedPosition::GetTime(uint64_t& timestamp, std::map< uint64_t, ::DBus::Variant >& time)
-{
-  throw DBus::ErrorNotSupported("Method not supported yet");
+  //other filters may be interested as well
+  return false;
 }
 
 void EnhancedPosition::sigPositionUpdate(const TGNSSPosition position[], uint16_t numElements)
 {
-  bool latChanged = false;
-  bool lonChanged = false;
-  bool altChanged = false;
-  bool speedChanged = false;
-  bool headingChanged = false;
-  bool climbChanged = false;
-  bool pdopChanged = false;
-  bool hdopChanged = false;
-  bool vdopChanged = false;
-  bool usatChanged = false; //used satellites
-  bool fixStatusChanged = false;
-  bool fixTypeBitsChanged = false;
-  bool usedSystemsChanged = false;
-
-  uint64_t changedValues = 0;
-
   if (position == NULL || numElements < 1)
   {
     LOG_ERROR_MSG(gCtx,"sigPositionUpdate failed!");
@@ -207,159 +465,175 @@ void EnhancedPosition::sigPositionUpdate(const TGNSSPosition position[], uint16_
 
   for (int i = 0; i< numElements; i++)
   {
-    LOG_INFO(gCtx,"Position Update[%d/%d]: lat=%f lon=%f alt=%f",
-             i+1,
-             numElements,
-             position[i].latitude, 
-             position[i].longitude,
-             position[i].altitudeMSL);
+    LOG_DEBUG(gCtx,"Position Update[%d/%d]: lat=%f lon=%f alt=%f",
+              i+1,
+              numElements,
+              position[i].latitude,
+              position[i].longitude,
+              position[i].altitudeMSL);
+
+    LOG_DEBUG(gCtx,"Accuracy Update[%d/%d]: pdop=%f hdop=%f vdop=%f sigmaHPosition=%f sigmaAltitude=%f",
+              i+1,
+              numElements,
+              position[i].pdop,
+              position[i].hdop,
+              position[i].vdop,
+              position[i].sigmaHPosition,
+              position[i].sigmaAltitude);
+
+    LOG_DEBUG(gCtx,"Status Update[%d/%d]: fixStatus=%d fixTypeBits=0x%08X",
+              i+1,
+              numElements,
+              position[i].fixStatus,
+              position[i].fixTypeBits);
+  }
 
-      LOG_INFO(gCtx,"Accuracy Update[%d/%d]: pdop=%f hdop=%f vdop=%f \
-               sigmaHPosition=%f sigmaAltitude=%f",
-               i+1,
-               numElements,
-               position[i].pdop, 
-               position[i].hdop,
-               position[i].vdop,
-               position[i].sigmaHPosition,
-               position[i].sigmaAltitude);
+  LOG_INFO_RATE_LIMITED(gCtx, 1000, "Position Update: lat=%f lon=%f alt=%f fixStatus=%d",
+                        position[numElements-1].latitude,
+                        position[numElements-1].longitude,
+                        position[numElements-1].altitudeMSL,
+                        position[numElements-1].fixStatus);
 
-      LOG_INFO(gCtx,"Status Update[%d/%d]: fixStatus=%d fixTypeBits=0x%08X",
-               i+1,
-               numElements,
-               position[i].fixStatus,
-               position[i].fixTypeBits);
+  uint64_t changedValues = getGNSSChangedValues(position, numElements);
 
-    if (latChanged == false)
-    {
-      latChanged = (position[i].validityBits & GNSS_POSITION_LATITUDE_VALID);
-    }
+  if (!mpSelf)
+  {
+    LOG_ERROR_MSG(gCtx,"Null pointer!");    
+    return;
+  }
 
-    if (lonChanged == false)
-    {
-      lonChanged = (position[i].validityBits & GNSS_POSITION_LONGITUDE_VALID);
-    }
+  //notify clients
+  mpSelf->publish(changedValues);
 
-    if (altChanged == false)
-    {
-      altChanged = (position[i].validityBits & GNSS_POSITION_ALTITUDEMSL_VALID);
-    }
+}
 
-    if (speedChanged == false)
-    {
-      speedChanged = (position[i].validityBits & GNSS_POSITION_HSPEED_VALID);
-    }
 
-    if (headingChanged == false)
-    {
-      headingChanged = (position[i].validityBits & GNSS_POSITION_HEADING_VALID);
-    }
+void EnhancedPosition::firePositionUpdate(uint64_t changedValues)
+{
+  uint64_t epoch = 0;
+  uint64_t requestTime = 0;
+  TPositionSnapshot snapshot;
 
-    if (climbChanged == false)
-    {
-      climbChanged = (position[i].validityBits & GNSS_POSITION_VSPEED_VALID);
-    }
+  PositionUpdate(changedValues);
 
-    if (pdopChanged == false)
-    {
-      pdopChanged = (position[i].validityBits & GNSS_POSITION_PDOP_VALID);
-    }
+  //push the values as well, clients subscribed to PositionUpdateData save the GetPositionInfo round trip
+  getSnapshotEpoch(epoch, requestTime);
+  getPositionSnapshot(epoch, requestTime, snapshot);
 
-    if (hdopChanged == false)
-    {
-      hdopChanged = (position[i].validityBits & GNSS_POSITION_HDOP_VALID);
-    }
+  DBus::SignalMessage sig("PositionUpdateData");
+  DBus::MessageIter wi = sig.writer();
+  wi << changedValues;
+  writePositionInfo(changedValues, snapshot, wi);
+  org::genivi::positioning::EnhancedPosition_adaptor::emit_signal(sig);
 
-    if (vdopChanged == false)
-    {
-      vdopChanged = (position[i].validityBits & GNSS_POSITION_VDOP_VALID);
-    }
+  mSubscriptions.notify(changedValues, snapshot, *this);
+}
 
-    if (usatChanged == false)
-    {
-      usatChanged = (position[i].validityBits & GNSS_POSITION_USAT_VALID);
-    }
+void EnhancedPosition::fireFilteredPositionUpdate(const TSubscription& subscription, const TPositionSnapshot& snapshot)
+{
+  //unicast: only the subscriber receives the signal
+  DBus::SignalMessage sig("FilteredPositionUpdate");
+  sig.destination(subscription.sender.c_str());
+  DBus::MessageIter wi = sig.writer();
+  wi << subscription.id << subscription.changedValues;
+  writePositionInfo(subscription.valuesToReturn, snapshot, wi);
+  org::genivi::positioning::EnhancedPosition_adaptor::emit_signal(sig);
+}
 
-    if (fixStatusChanged == false)
-    {
-      fixStatusChanged = (position[i].validityBits & GNSS_POSITION_STAT_VALID);
-    }
+void EnhancedPosition::publish(uint64_t changedValues)
+{
+  //emitted by onPublishTimeout in the dispatcher thread, never from the GNSS or sensors thread
+  mPublishScheduler.post(changedValues, getMonotonicTime());
+}
 
-    if (fixTypeBitsChanged == false)
+void EnhancedPosition::cbPosition(const TGNSSPosition position[], uint16_t numElements)
+{
+    processGNSSPositions(position, numElements);
+
+    if (mpSelf && mpSelf->mpPositionPipe)
     {
-      fixTypeBitsChanged = (position[i].validityBits & GNSS_POSITION_TYPE_VALID);
+      //logging and D-Bus emission are done in the dispatcher thread,
+      //so a busy bus does not delay the GNSS data acquisition
+      mpSelf->enqueuePositions(position, numElements);
     }
-
-    if (usedSystemsChanged == false)
+    else
     {
-        usedSystemsChanged = (position[i].validityBits & GNSS_POSITION_USYS_VALID);
+      sigPositionUpdate(position, numElements);
     }
-  }
-
-
-  //in a real product, the coordinates would be used for dead-reckoning.
-  //in this proof of concept, the client application is simply notified 
-  //about changes of latitude, longitude and/or altitude
+}
 
-  if (latChanged)
+void EnhancedPosition::enqueuePositions(const TGNSSPosition position[], uint16_t numElements)
+{
+  if (position == NULL)
   {
-     changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE;
+    return;
   }
 
-  if (lonChanged)
+  for (int i = 0; i<numElements; i++)
   {
-     changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE;
+    mPositionQueue.push(position[i]);
   }
 
-  if (altChanged)
+  //wake up the dispatcher only if it has not been woken up yet
+  if (!mPositionWakeupPending.exchange(true))
   {
-     changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE;
+    char token = 0;
+    mpPositionPipe->write(&token, sizeof(token));
   }
+}
 
-  if (speedChanged)
-  {
-     changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_SPEED;
-  }
+void EnhancedPosition::onPositionPipe(const void* data, void*, unsigned int)
+{
+  EnhancedPosition* self = (EnhancedPosition*)data;
 
-  if (headingChanged)
+  if (self)
   {
-     changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_HEADING;
+    self->processPositionQueue();
   }
+}
 
-  if (climbChanged)
-  {
-     changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_CLIMB;
-  }
+void EnhancedPosition::processPositionQueue()
+{
+  TGNSSPosition positions[8];
+  uint16_t numElements = 0;
 
-  if (pdopChanged)
-  {
-    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_PDOP;
-  }
+  //reset before draining the queue: a position enqueued meanwhile triggers a new wakeup
+  mPositionWakeupPending.store(false);
 
-  if (hdopChanged)
+  while (mPositionQueue.pop(positions[numElements]))
   {
-    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_HDOP;
+    numElements++;
+    if (numElements == sizeof(positions)/sizeof(positions[0]))
+    {
+      sigPositionUpdate(positions, numElements);
+      numElements = 0;
+    }
   }
-  
-  if (vdopChanged)
+  if (numElements > 0)
   {
-    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_VDOP;
-  }  
-
-  if (usatChanged)
-  {
-    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_USED_SATELLITES;
+    sigPositionUpdate(positions, numElements);
   }
+}
+
 
-  if (fixStatusChanged)
+void EnhancedPosition::cbSatelliteDetail(const TGNSSSatelliteDetail satelliteDetail[], uint16_t numElements)
+{
+  if (satelliteDetail == NULL || numElements < 1)
   {
-    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_GNSS_FIX_STATUS;
+    LOG_ERROR_MSG(gCtx,"cbSatelliteDetail failed!");
+    return;
   }
 
-  if (usedSystemsChanged)
+  for (int i = 0; i<numElements; i++)
   {
-    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_USED_SATELLITESYSTEMS;
-  }
+    LOG_DEBUG(gCtx,"SatelliteDetail Update[%d/%d]: satelliteId=%d azimuth=%d elevation=%d CNo=%d",
+              i+1,
+              numElements,
+              satelliteDetail[i].satelliteId,
+              satelliteDetail[i].azimuth,
+              satelliteDetail[i].elevation,
+              satelliteDetail[i].CNo);
+  }  
 
   if (!mpSelf)
   {
@@ -367,53 +641,64 @@ void EnhancedPosition::sigPositionUpdate(const TGNSSPosition position[], uint16_
     return;
   }
 
-  //notify clients
-  mpSelf->PositionUpdate(changedValues);
-
+  //notify clients: emitted by onPublishTimeout
+  mpSelf->mSatelliteScheduler.post(GENIVI_ENHANCEDPOSITIONSERVICE_VISIBLE_SATELLITES, getMonotonicTime());
 }
 
-
-void EnhancedPosition::cbPosition(const TGNSSPosition position[], uint16_t numElements)
+void EnhancedPosition::cbTime(const TGNSSTime time[], uint16_t numElements)
 {
-    sigPositionUpdate(position, numElements);
-}
-
-
-void EnhancedPosition::cbSatelliteDetail(const TGNSSSatelliteDetail satelliteDetail[], uint16_t numElements)
-{
-  if (satelliteDetail == NULL || numElements < 1)
+  if (time == NULL || numElements < 1)
   {
-    LOG_ERROR_MSG(gCtx,"cbSatelliteDetail failed!");
+    LOG_ERROR_MSG(gCtx,"cbTime failed!");
     return;
   }
 
-  for (int i = 0; i<numElements; i++)
-  {
-    LOG_INFO(gCtx,"SatelliteDetail Update[%d/%d]: satelliteId=%d azimuth=%d elevation=%d CNo=%d",
-             i+1,
-             numElements,
-             satelliteDetail[i].satelliteId, 
-             satelliteDetail[i].azimuth,
-             satelliteDetail[i].elevation,                                   
-             satelliteDetail[i].CNo);
-  }  
+  LOG_INFO(gCtx,"Time Update: %04d-%02d-%02d %02d:%02d:%02d.%03d validityBits=0x%08X",
+           time[numElements-1].year,
+           time[numElements-1].month + 1,
+           time[numElements-1].day,
+           time[numElements-1].hour,
+           time[numElements-1].minute,
+           time[numElements-1].second,
+           time[numElements-1].ms,
+           time[numElements-1].validityBits);
+
+  processGNSSTime(time, numElements);
 
   if (!mpSelf)
   {
-    LOG_ERROR_MSG(gCtx,"Null pointer!");    
+    LOG_ERROR_MSG(gCtx,"Null pointer!");
     return;
   }
-    
-  //todo: notify clients
-  //mpSelf->SatelliteInfoUpdate(changedValues);
+
+  //notify clients: emitted by onPublishTimeout
+  mpSelf->mTimeScheduler.post(GENIVI_ENHANCEDPOSITIONSERVICE_YEAR, getMonotonicTime());
+}
+
+void EnhancedPosition::fireSatelliteUpdate()
+{
+  uint64_t timestamp = 0;
+  std::vector< TSatelliteInfo > satelliteInfo;
+
+  getSatelliteInfo(timestamp, satelliteInfo);
+  SatelliteUpdate(timestamp, satelliteInfo);
+}
+
+void EnhancedPosition::fireTimeUpdate()
+{
+  uint64_t timestamp = 0;
+  std::map< uint64_t, ::DBus::Variant > time;
+
+  getTimeInfo(timestamp, time);
+  TimeUpdate(timestamp, time);
 }
 
 void EnhancedPosition::cbAcceleration(const TAccelerationData accelerationData[], uint16_t numElements)
 {
-    LOG_INFO_MSG(gCtx,"Acceleration...");
+    LOG_DEBUG_MSG(gCtx,"Acceleration...");
     for (int i = 0; i<numElements; i++)
     {
-      LOG_INFO(gCtx,"Acceleration Update[%d/%d]: x=%d y=%d z=%d temperature=%d measurementInterval=%d validityBits=%d",
+      LOG_DEBUG(gCtx,"Acceleration Update[%d/%d]: x=%f y=%f z=%f temperature=%f measurementInterval=%d validityBits=%d",
                i+1,
                numElements,
                accelerationData[i].x,
@@ -423,14 +708,16 @@ void EnhancedPosition::cbAcceleration(const TAccelerationData accelerationData[]
                accelerationData[i].measurementInterval,
                accelerationData[i].validityBits);
     }
+
+    processAcceleration(accelerationData, numElements);
 }
 
 void EnhancedPosition::cbGyroscope(const TGyroscopeData gyroData[], uint16_t numElements)
 {
-    LOG_INFO_MSG(gCtx,"Gyroscope...");
+    LOG_DEBUG_MSG(gCtx,"Gyroscope...");
     for (int i = 0; i<numElements; i++)
     {
-      LOG_INFO(gCtx,"Gyroscope Update[%d/%d]: yawRate=%d pitchRate=%d rollRate=%d temperature=%d measurementInterval=%d validityBits=%d",
+      LOG_DEBUG(gCtx,"Gyroscope Update[%d/%d]: yawRate=%f pitchRate=%f rollRate=%f temperature=%f measurementInterval=%d validityBits=%d",
                i+1,
                numElements,
                gyroData[i].yawRate,
@@ -440,30 +727,155 @@ void EnhancedPosition::cbGyroscope(const TGyroscopeData gyroData[], uint16_t num
                gyroData[i].measurementInterval,
                gyroData[i].validityBits);
     }
+
+    TFusionPosition fused;
+    bool isFused = processGyroscope(gyroData, numElements, fused);
+
+    //the fused position changes with each gyroscope batch
+    if (isFused && mpSelf)
+    {
+      mpSelf->publish(getFusedChangedValues(fused));
+    }
+}
+
+void EnhancedPosition::cbVehicleSpeed(const TVehicleSpeedData vehicleSpeedData[], uint16_t numElements)
+{
+    processVehicleSpeed(vehicleSpeedData, numElements);
+}
+
+void EnhancedPosition::cbOdometer(const TOdometerData odometerData[], uint16_t numElements)
+{
+    processOdometer(odometerData, numElements);
+}
+
+void EnhancedPosition::startPublishing(DBus::BusDispatcher& dispatcher, int32_t interval)
+{
+  if (interval <= 0)
+  {
+    LOG_WARNING(gCtx,"Invalid update interval %d ms, using %d ms", interval, MIN_UPDATE_INTERVAL);
+    interval = MIN_UPDATE_INTERVAL;
+  }
+
+  mpDispatcher = &dispatcher;
+  mpPositionPipe = mpDispatcher->add_pipe(&EnhancedPosition::onPositionPipe, this);
+  setUpdateInterval(interval);
+}
+
+void EnhancedPosition::setUpdateInterval(int32_t interval)
+{
+  if (!mpDispatcher || (interval <= 0))
+  {
+    return;
+  }
+
+  LOG_INFO(gCtx,"Publishing position updates every %d ms", interval);
+
+  //the updates pending in the scheduler are published with the new timer
+  DBus::DefaultTimeout* pTimeout = new DBus::DefaultTimeout(interval, true, mpDispatcher);
+  pTimeout->expired = new DBus::Callback<EnhancedPosition, void, DBus::DefaultTimeout&>(this, &EnhancedPosition::onPublishTimeout);
+  delete mpPublishTimeout;
+  mpPublishTimeout = pTimeout;
+}
+
+void EnhancedPosition::onPublishTimeout(DBus::DefaultTimeout&)
+{
+  uint64_t now = getMonotonicTime();
+  uint64_t changedValues = 0;
+
+  if (mPublishScheduler.take(now, changedValues))
+  {
+    firePositionUpdate(changedValues);
+  }
+  //the satellites and the time are taken from the GNSS snapshot, the changedValues are not needed
+  if (mSatelliteScheduler.take(now, changedValues))
+  {
+    fireSatelliteUpdate();
+  }
+  if (mTimeScheduler.take(now, changedValues))
+  {
+    fireTimeUpdate();
+  }
+
+  if (isStatisticsDue(mStatisticsTime, now))
+  {
+    logPublishStatistics(mPublishScheduler);
+
+    uint64_t drops = mPositionQueue.getDrops();
+    LOG_INFO(gCtx,"Position queue statistics: positions=%llu maxDepth=%u/%u drops=%llu",
+             (unsigned long long)mPositionQueue.getPushes(),
+             mPositionQueue.takeMaxDepth(),
+             mPositionQueue.capacity(),
+             (unsigned long long)drops);
+    if (drops != mPositionDrops)
+    {
+      LOG_WARNING(gCtx,"%llu GNSS positions dropped: dispatcher thread too slow",
+                  (unsigned long long)(drops - mPositionDrops));
+      mPositionDrops = drops;
+    }
+
+    LOG_INFO(gCtx,"GetPositionInfo statistics: requests=%llu cacheHits=%llu",
+             (unsigned long long)mPositionInfoRequests,
+             (unsigned long long)mPositionInfoCacheHits);
+    mPositionInfoRequests = 0;
+    mPositionInfoCacheHits = 0;
+
+    mSubscriptions.logStatistics();
+  }
+}
+
+void EnhancedPosition::startPredictionStream(DBus::BusDispatcher& dispatcher, uint16_t rate)
+{
+  stopPredictionStream();
+
+  if (rate == 0)
+  {
+    return;
+  }
+
+  LOG_INFO(gCtx,"Starting predicted position stream at %d Hz", rate);
+
+  mpPredictionTimeout = new DBus::DefaultTimeout(1000/rate, true, &dispatcher);
+  mpPredictionTimeout->expired = new DBus::Callback<EnhancedPosition, void, DBus::DefaultTimeout&>(this, &EnhancedPosition::onPredictionTimeout);
+}
+
+void EnhancedPosition::stopPredictionStream()
+{
+  if (mpPredictionTimeout)
+  {
+    delete mpPredictionTimeout;
+    mpPredictionTimeout = 0;
+  }
+}
+
+void EnhancedPosition::onPredictionTimeout(DBus::DefaultTimeout&)
+{
+  TFusionPosition fused;
+  std::map< uint64_t, ::DBus::Variant > data;
+
+  if (!getExtrapolatedPosition(0, fused))
+  {
+    return;
+  }
+
+  VariantMapWriter writer(data);
+  addFusedValues(getFusedChangedValues(fused), fused, writer);
+  PredictedPositionUpdate(fused.timestamp, data);
 }
 
 void EnhancedPosition::run()
 {
   LOG_INFO_MSG(gCtx,"Starting EnhancedPosition dispatcher...");
 
-  if (!gnssRegisterPositionCallback(&cbPosition))
-      LOG_ERROR_MSG(gCtx,"Position Callback not registered");
-  if (!gnssRegisterSatelliteDetailCallback(&cbSatelliteDetail))
-      LOG_ERROR_MSG(gCtx,"SatelliteDetail Callback not registered");
-  if (!snsGyroscopeRegisterCallback(&cbGyroscope))
-      LOG_ERROR_MSG(gCtx,"Gyroscope Callback not registered");
-  if (!snsAccelerationRegisterCallback(&cbAcceleration))
-      LOG_ERROR_MSG(gCtx,"Acceleration Callback not registered");
+  registerPositionCallbacks(mCallbacks);
 }
 
 void EnhancedPosition::shutdown()
 {
   LOG_INFO_MSG(gCtx,"Shutting down EnhancedPosition dispatcher...");
 
-  gnssDeregisterPositionCallback(&cbPosition);
-  gnssDeregisterSatelliteDetailCallback(&cbSatelliteDetail);
-  snsGyroscopeDeregisterCallback(&cbGyroscope);
-  snsAccelerationDeregisterCallback(&cbAcceleration);
+  stopPredictionStream();
+
+  deregisterPositionCallbacks(mCallbacks);
 }
 
 
@@ -21,6 +21,8 @@
 #ifndef DBUS_HAS_RECURSIVE_MUTEX
 #define DBUS_HAS_RECURSIVE_MUTEX
 #endif
+#include <string>
+#include <vector>
 #include <dbus-c++/dbus.h>
 
 #include "enhanced-position-adaptor.h"
@@ -28,6 +30,17 @@
 #include "gnss.h"
 #include "acceleration.h"
 #include "gyroscope.h"
+#include "vehicle-speed.h"
+#include "odometer.h"
+#include "publish-scheduler.h"
+#include "spsc-queue.h"
+#include "position-core.h"
+
+//satelliteInfo element of GetSatelliteInfo: system, satelliteId, azimuth, elevation, cNo, inUse
+typedef ::DBus::Struct< uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, bool > TSatelliteInfo;
+
+//number of cached GetPositionInfo replies, i.e. of different valuesToReturn served from the cache
+#define POSITION_INFO_CACHE_SIZE 8
 
 class EnhancedPosition
   : public org::genivi::positioning::EnhancedPosition_adaptor
@@ -43,23 +56,115 @@ public:
   ::DBus::Struct< uint16_t, uint16_t, uint16_t, std::string > GetVersion();
 
   void GetPositionInfo(const uint64_t& valuesToReturn, uint64_t& timestamp, std::map< uint64_t, ::DBus::Variant >& data);
+  void GetPredictedPositionInfo(const uint64_t& valuesToReturn, const uint64_t& targetTimestamp, uint64_t& timestamp, std::map< uint64_t, ::DBus::Variant >& data);
   void GetSatelliteInfo(uint64_t& timestamp, std::vector< ::DBus::Struct< uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, bool > >& satelliteInfo);
   void GetTime(uint64_t& timestamp, std::map< uint64_t, ::DBus::Variant >& time);
+  uint32_t Subscribe(const uint64_t& valuesToReturn, const uint16_t& maxRate, const double& minDistance, const double& minHeadingChange);
+  void Unsubscribe(const uint32_t& subscriptionId);
+
+  /**
+   * Answer GetPositionInfo by writing the reply directly from a snapshot of
+   * the position instead of the map of variants of the generated adaptor.
+   * Replies are cached per epoch of the input data, so many clients polling
+   * the same values share one serialization.
+   */
+  void enableDirectMarshalling();
 
   void run();
 
   void shutdown();
 
+  /**
+   * Emit PositionUpdate/PositionUpdateData once per update interval from the
+   * dispatcher thread, with the changes of the whole interval merged.
+   * SatelliteUpdate and TimeUpdate are limited to the same interval.
+   * Must be called before run(): the updates are only emitted from the
+   * dispatcher thread, without it nothing is published.
+   * @param interval [ms], MIN_UPDATE_INTERVAL if not positive
+   */
+  void startPublishing(DBus::BusDispatcher& dispatcher, int32_t interval);
+
+  /**
+   * Change the update interval, see Configuration::UpdateInterval
+   * @param interval [ms]
+   */
+  void setUpdateInterval(int32_t interval);
+
+  /**
+   * Emit PredictedPositionUpdate at a fixed rate from the dispatcher thread
+   * @param rate [Hz], 0 stops the stream
+   */
+  void startPredictionStream(DBus::BusDispatcher& dispatcher, uint16_t rate);
+
+  void stopPredictionStream();
+
 private:
 
+  typedef struct
+  {
+    uint64_t valuesToReturn;
+    uint64_t epoch;
+    uint64_t requestTime;
+    DBus::Message* pReply;    //0 if unused
+  } TPositionInfoCacheEntry;
+
+  DBus::Message onGetPositionInfo(const DBus::CallMessage& call);
+  DBus::Message onSubscribe(const DBus::CallMessage& call);
+  DBus::Message onUnsubscribe(const DBus::CallMessage& call);
+  bool onBusMessage(const DBus::Message& msg);
+  void onPredictionTimeout(DBus::DefaultTimeout& timeout);
+  void onPublishTimeout(DBus::DefaultTimeout& timeout);
+  void publish(uint64_t changedValues);
+  void enqueuePositions(const TGNSSPosition position[], uint16_t numElements);
+  void processPositionQueue();
+  static void onPositionPipe(const void* data, void* buffer, unsigned int nbyte);
+
+  DBus::DefaultTimeout* mpPredictionTimeout;
+  DBus::BusDispatcher* mpDispatcher;
+  DBus::DefaultTimeout* mpPublishTimeout;
+  PublishScheduler mPublishScheduler;
+  PublishScheduler mSatelliteScheduler;
+  PublishScheduler mTimeScheduler;
+  uint64_t mStatisticsTime;
+
+  //GNSS positions handed over from the GNSS thread to the dispatcher thread
+  SpscQueue<TGNSSPosition, 32> mPositionQueue;
+  DBus::Pipe* mpPositionPipe;
+  std::atomic<bool> mPositionWakeupPending;
+  uint64_t mPositionDrops;
+
+  //GetPositionInfo replies, only accessed in the dispatcher thread
+  TPositionInfoCacheEntry mPositionInfoCache[POSITION_INFO_CACHE_SIZE];
+  int mPositionInfoCacheNext;
+  uint64_t mPositionInfoRequests;
+  uint64_t mPositionInfoCacheHits;
+
+  //only read and written by the dispatcher thread, which also emits all signals
+  SubscriptionList mSubscriptions;
+  //removes the subscriptions of clients which have left the bus
+  DBus::MessageSlot mBusFilter;
+  bool mIsBusFilterAdded;
+
+  static void cbTime(const TGNSSTime time[], uint16_t numElements);
   static void cbSatelliteDetail(const TGNSSSatelliteDetail satelliteDetail[], uint16_t numElements);
   static void cbPosition(const TGNSSPosition position[], uint16_t numElements);
   static void cbAcceleration(const TAccelerationData accelerationData[], uint16_t numElements);
   static void cbGyroscope(const TGyroscopeData gyroData[], uint16_t numElements);
+  static void cbVehicleSpeed(const TVehicleSpeedData vehicleSpeedData[], uint16_t numElements);
+  static void cbOdometer(const TOdometerData odometerData[], uint16_t numElements);
 
   static void sigPositionUpdate(const TGNSSPosition position[], uint16_t numElements);
 
+  void firePositionUpdate(uint64_t changedValues);
+  void fireFilteredPositionUpdate(const TSubscription& subscription, const TPositionSnapshot& snapshot);
+  void fireSatelliteUpdate();
+  void fireTimeUpdate();
+
+  static const TPositionCallbacks mCallbacks;
   static EnhancedPosition* mpSelf;
+
+  //calls fireFilteredPositionUpdate
+  friend class SubscriptionList;
 };
 
 #endif//__ENHANCED_POSITION_H
@@ -0,0 +1,714 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Dead-reckoning fusion of GNSS, gyroscope, acceleration and odometry
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <math.h>
+#include <string.h>
+
+#include "fusion-engine.h"
+
+#define FUSION_PI 3.14159265358979323846
+#define FUSION_DEG2RAD (FUSION_PI/180.0)
+#define FUSION_RAD2DEG (180.0/FUSION_PI)
+
+//WGS84 ellipsoid
+#define FUSION_WGS84_A 6378137.0
+#define FUSION_WGS84_E2 6.69437999014e-3
+
+//maximum step of the time update [s]
+#define FUSION_MAX_STEP 0.5
+//sensor samples older than this are not used for the time update [ms]
+#define FUSION_SENSOR_TIMEOUT 1000
+//the position is flagged as dead reckoned if there was no GNSS position for this time [ms]
+#define FUSION_DR_TIMEOUT 2000
+//maximum age of a GNSS position relative to the filter time that is compensated [ms]
+#define FUSION_MAX_GNSS_DELAY 1000
+//the odometer is used only if there was no vehicle speed for this time [ms]
+#define FUSION_VEHICLESPEED_TIMEOUT 1000
+//maximum interval for the extrapolation of the position [ms]
+#define FUSION_MAX_EXTRAPOLATION 2000
+//the reference point is moved when the position is farther away [m]
+#define FUSION_MAX_REFERENCE_DISTANCE 10000.0
+//GNSS heading is used only above this speed [m/s]
+#define FUSION_MIN_HEADING_SPEED 3.0
+//number of consecutively rejected GNSS positions after which the filter is re-initialized
+#define FUSION_MAX_GNSS_REJECTIONS 5
+
+//innovation test thresholds: chi-square 99.9% quantiles for 1 and 2 degrees of freedom
+#define FUSION_GATE_1D 10.8
+#define FUSION_GATE_2D 13.8
+
+//process noise spectral densities
+#define FUSION_Q_POSITION 0.01                                  //[m^2/s]
+#define FUSION_Q_HEADING  ((0.5*FUSION_DEG2RAD)*(0.5*FUSION_DEG2RAD))   //[rad^2/s]
+#define FUSION_Q_HEADING_NOGYRO ((10.0*FUSION_DEG2RAD)*(10.0*FUSION_DEG2RAD))
+#define FUSION_Q_SPEED_ACC 0.25                                 //[(m/s)^2/s] with acceleration
+#define FUSION_Q_SPEED 4.0                                      //[(m/s)^2/s] without acceleration
+#define FUSION_Q_GYROBIAS ((0.01*FUSION_DEG2RAD)*(0.01*FUSION_DEG2RAD))  //[(rad/s)^2/s]
+#define FUSION_Q_SCALE 1e-6                                     //[1/s]
+#define FUSION_Q_ACCBIAS 1e-4                                   //[(m/s^2)^2/s]
+#define FUSION_Q_ALTITUDE 0.01                                  //[m^2/s]
+#define FUSION_Q_CLIMB 0.25                                     //[(m/s)^2/s]
+
+//initial standard deviations
+#define FUSION_SIGMA0_HEADING FUSION_PI
+#define FUSION_SIGMA0_SPEED 5.0
+#define FUSION_SIGMA0_GYROBIAS (1.0*FUSION_DEG2RAD)
+#define FUSION_SIGMA0_SCALE 0.05
+#define FUSION_SIGMA0_ACCBIAS 0.5
+#define FUSION_SIGMA0_ALTITUDE 100.0
+#define FUSION_SIGMA0_CLIMB 1.0
+
+//default measurement standard deviations
+#define FUSION_SIGMA_HPOSITION 10.0     //[m] if neither sigmaHPosition nor hdop are available
+#define FUSION_HDOP_FACTOR 5.0          //[m] per hdop
+#define FUSION_SIGMA_ALTITUDE 15.0      //[m]
+#define FUSION_VDOP_FACTOR 7.5          //[m] per vdop
+#define FUSION_SIGMA_HSPEED 0.5         //[m/s]
+#define FUSION_SIGMA_VSPEED 0.5         //[m/s]
+#define FUSION_SIGMA_HEADING 2.0        //[degree]
+#define FUSION_SIGMA_VEHICLESPEED 0.1   //[m/s]
+#define FUSION_SIGMA_ODOMETER 0.1       //[m/s] plus the quantization of the odometer counter
+
+static double wrapAngle(double angle)
+{
+    while (angle > FUSION_PI)
+    {
+        angle -= 2*FUSION_PI;
+    }
+    while (angle <= -FUSION_PI)
+    {
+        angle += 2*FUSION_PI;
+    }
+    return angle;
+}
+
+//days from 1970-01-01 to a date of the proleptic Gregorian calendar
+//independent of the time zone and the C library, month 1..12
+static int64_t daysFromCivil(int64_t year, int64_t month, int64_t day)
+{
+    year -= (month <= 2) ? 1 : 0;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yoe = year - era*400;
+    int64_t doy = (153*(month + (month > 2 ? -3 : 9)) + 2)/5 + day - 1;
+    int64_t doe = yoe*365 + yoe/4 - yoe/100 + doy;
+    return era*146097 + doe - 719468;
+}
+
+FusionEngine::FusionEngine()
+  : mUtcOffset(0)
+  , mUtcValid(false)
+{
+  memset(&mStatistics, 0, sizeof(mStatistics));
+  reset();
+}
+
+void FusionEngine::reset()
+{
+  mInitialized = false;
+  mTime = 0;
+  mX.fill(0);
+  mP.fill(0);
+  mRefLatitude = 0;
+  mRefLongitude = 0;
+  mMetersPerDegreeLat = 0;
+  mMetersPerDegreeLon = 0;
+  mYawRate = 0;
+  mYawRateValid = false;
+  mYawRateTime = 0;
+  mAcceleration = 0;
+  mAccelerationValid = false;
+  mAccelerationTime = 0;
+  mVehicleSpeedTime = 0;
+  mVehicleSpeedSeen = false;
+  mOdometerDistance = 0;
+  mOdometerTime = 0;
+  mOdometerValid = false;
+  mAltitudeValid = false;
+  mGNSSTime = 0;
+  mGNSSRejections = 0;
+}
+
+void FusionEngine::setReference(double latitude, double longitude)
+{
+  //radii of curvature of the ellipsoid at the reference point
+  double sinLat = sin(latitude*FUSION_DEG2RAD);
+  double w = sqrt(1.0 - FUSION_WGS84_E2*sinLat*sinLat);
+  double rN = FUSION_WGS84_A / w;
+  double rM = FUSION_WGS84_A * (1.0 - FUSION_WGS84_E2) / (w*w*w);
+
+  mRefLatitude = latitude;
+  mRefLongitude = longitude;
+  mMetersPerDegreeLat = rM * FUSION_DEG2RAD;
+  mMetersPerDegreeLon = rN * cos(latitude*FUSION_DEG2RAD) * FUSION_DEG2RAD;
+}
+
+void FusionEngine::initialize(const TGNSSPosition& position)
+{
+  bool headingValid = (position.validityBits & GNSS_POSITION_HEADING_VALID) &&
+                      (position.validityBits & GNSS_POSITION_HSPEED_VALID) &&
+                      (position.hSpeed >= FUSION_MIN_HEADING_SPEED);
+  double sigmaH = FUSION_SIGMA_HPOSITION;
+
+  if ((position.validityBits & GNSS_POSITION_SHPOS_VALID) && (position.sigmaHPosition > 0))
+  {
+    sigmaH = position.sigmaHPosition;
+  }
+  else if ((position.validityBits & GNSS_POSITION_HDOP_VALID) && (position.hdop > 0))
+  {
+    sigmaH = position.hdop * FUSION_HDOP_FACTOR;
+  }
+
+  setReference(position.latitude, position.longitude);
+  mX.fill(0);
+  mP.fill(0);
+
+  mX[S_SCALE] = 1.0;
+  mP(S_E,S_E) = sigmaH*sigmaH/2;
+  mP(S_N,S_N) = sigmaH*sigmaH/2;
+  mP(S_PSI,S_PSI) = FUSION_SIGMA0_HEADING*FUSION_SIGMA0_HEADING;
+  mP(S_V,S_V) = FUSION_SIGMA0_SPEED*FUSION_SIGMA0_SPEED;
+  mP(S_BG,S_BG) = FUSION_SIGMA0_GYROBIAS*FUSION_SIGMA0_GYROBIAS;
+  mP(S_SCALE,S_SCALE) = FUSION_SIGMA0_SCALE*FUSION_SIGMA0_SCALE;
+  mP(S_BA,S_BA) = FUSION_SIGMA0_ACCBIAS*FUSION_SIGMA0_ACCBIAS;
+  mP(S_H,S_H) = FUSION_SIGMA0_ALTITUDE*FUSION_SIGMA0_ALTITUDE;
+  mP(S_VZ,S_VZ) = FUSION_SIGMA0_CLIMB*FUSION_SIGMA0_CLIMB;
+
+  if (position.validityBits & GNSS_POSITION_HSPEED_VALID)
+  {
+    mX[S_V] = position.hSpeed;
+    mP(S_V,S_V) = FUSION_SIGMA_HSPEED*FUSION_SIGMA_HSPEED;
+  }
+  if (headingValid)
+  {
+    mX[S_PSI] = wrapAngle(position.heading*FUSION_DEG2RAD);
+    mP(S_PSI,S_PSI) = (FUSION_SIGMA_HEADING*FUSION_DEG2RAD)*(FUSION_SIGMA_HEADING*FUSION_DEG2RAD);
+  }
+  mAltitudeValid = false;
+  if (position.validityBits & GNSS_POSITION_ALTITUDEMSL_VALID)
+  {
+    mX[S_H] = position.altitudeMSL;
+    mP(S_H,S_H) = FUSION_SIGMA_ALTITUDE*FUSION_SIGMA_ALTITUDE;
+    mAltitudeValid = true;
+  }
+
+  mTime = position.timestamp;
+  mGNSSTime = position.timestamp;
+  mGNSSRejections = 0;
+  mInitialized = true;
+  mStatistics.resets++;
+}
+
+void FusionEngine::predict(double dt)
+{
+  bool gyro = mYawRateValid && (mTime < mYawRateTime + FUSION_SENSOR_TIMEOUT);
+  bool acc = mAccelerationValid && (mTime < mAccelerationTime + FUSION_SENSOR_TIMEOUT);
+  double psi = mX[S_PSI];
+  double v = mX[S_V];
+  double sinPsi = sin(psi);
+  double cosPsi = cos(psi);
+
+  //nominal state: the heading is counted clockwise, the yaw rate counter-clockwise
+  mX[S_E] += v*sinPsi*dt;
+  mX[S_N] += v*cosPsi*dt;
+  if (gyro)
+  {
+    mX[S_PSI] = wrapAngle(psi - (mYawRate - mX[S_BG])*dt);
+  }
+  if (acc)
+  {
+    mX[S_V] += (mAcceleration - mX[S_BA])*dt;
+  }
+  mX[S_H] += mX[S_VZ]*dt;
+
+  //error state transition F = I + A*dt with the non-zero elements of A
+  Matrix<double,S_NUM,S_NUM> F = Matrix<double,S_NUM,S_NUM>::identity();
+  F(S_E,S_PSI) = v*cosPsi*dt;
+  F(S_E,S_V) = sinPsi*dt;
+  F(S_N,S_PSI) = -v*sinPsi*dt;
+  F(S_N,S_V) = cosPsi*dt;
+  if (gyro)
+  {
+    F(S_PSI,S_BG) = dt;
+  }
+  if (acc)
+  {
+    F(S_V,S_BA) = -dt;
+  }
+  F(S_H,S_VZ) = dt;
+
+  //P = F*P*F' + Q*dt
+  TState Q;
+  Q[S_E] = FUSION_Q_POSITION*dt;
+  Q[S_N] = FUSION_Q_POSITION*dt;
+  Q[S_PSI] = (gyro ? FUSION_Q_HEADING : FUSION_Q_HEADING_NOGYRO)*dt;
+  Q[S_V] = (acc ? FUSION_Q_SPEED_ACC : FUSION_Q_SPEED)*dt;
+  Q[S_BG] = FUSION_Q_GYROBIAS*dt;
+  Q[S_SCALE] = FUSION_Q_SCALE*dt;
+  Q[S_BA] = FUSION_Q_ACCBIAS*dt;
+  Q[S_H] = FUSION_Q_ALTITUDE*dt;
+  Q[S_VZ] = FUSION_Q_CLIMB*dt;
+  predictCovariance(mP, F, Q);
+
+  mStatistics.predictions++;
+}
+
+void FusionEngine::propagate(uint64_t timestamp)
+{
+  //data older than the state are applied at the current state time
+  if (!mInitialized || (timestamp <= mTime))
+  {
+    return;
+  }
+  double dt = (timestamp - mTime)/1000.0;
+  while (dt > 0)
+  {
+    double step = (dt > FUSION_MAX_STEP) ? FUSION_MAX_STEP : dt;
+    predict(step);
+    dt -= step;
+  }
+  mTime = timestamp;
+}
+
+template<int M>
+bool FusionEngine::update(const Matrix<double,M,S_NUM>& H, const Matrix<double,M,1>& innovation,
+                          const SymmetricMatrix<double,M>& R, double gate)
+{
+  TState dx;
+  if (!kalmanUpdate(mP, dx, H, innovation, R, gate))
+  {
+    mStatistics.rejections++;
+    return false;
+  }
+
+  //inject the error state into the nominal state
+  mX += dx;
+  mX[S_PSI] = wrapAngle(mX[S_PSI]);
+
+  mStatistics.updates++;
+  return true;
+}
+
+void FusionEngine::processGyroscope(const TGyroscopeData& gyroscope)
+{
+  if (!(gyroscope.validityBits & GYROSCOPE_YAWRATE_VALID))
+  {
+    return;
+  }
+  //the sample is the mean rate over the interval up to its timestamp
+  mYawRate = gyroscope.yawRate*FUSION_DEG2RAD;
+  mYawRateValid = true;
+  mYawRateTime = gyroscope.timestamp;
+  propagate(gyroscope.timestamp);
+}
+
+void FusionEngine::processAcceleration(const TAccelerationData& acceleration)
+{
+  if (!(acceleration.validityBits & ACCELERATION_X_VALID))
+  {
+    return;
+  }
+  mAcceleration = acceleration.x;
+  mAccelerationValid = true;
+  mAccelerationTime = acceleration.timestamp;
+  propagate(acceleration.timestamp);
+}
+
+void FusionEngine::processSpeed(double speed, double variance, bool magnitude)
+{
+  //measurement model: speed = scale * v
+  Matrix<double,1,S_NUM> H = Matrix<double,1,S_NUM>::zero();
+  double predicted = mX[S_SCALE]*mX[S_V];
+  double sign = 1.0;
+  if (magnitude && (predicted < 0))
+  {
+    sign = -1.0;
+  }
+  H(0,S_V) = sign*mX[S_SCALE];
+  H(0,S_SCALE) = sign*mX[S_V];
+  Matrix<double,1,1> innovation;
+  innovation[0] = speed - sign*predicted;
+  SymmetricMatrix<double,1> R;
+  R(0,0) = variance;
+  update(H, innovation, R, FUSION_GATE_1D);
+}
+
+void FusionEngine::processVehicleSpeed(const TVehicleSpeedData& vehicleSpeed)
+{
+  if (!(vehicleSpeed.validityBits & VEHICLESPEED_VEHICLESPEED_VALID))
+  {
+    return;
+  }
+  mVehicleSpeedTime = vehicleSpeed.timestamp;
+  mVehicleSpeedSeen = true;
+  if (!mInitialized)
+  {
+    return;
+  }
+  propagate(vehicleSpeed.timestamp);
+  processSpeed(vehicleSpeed.vehicleSpeed, FUSION_SIGMA_VEHICLESPEED*FUSION_SIGMA_VEHICLESPEED, false);
+}
+
+void FusionEngine::processOdometer(const TOdometerData& odometer)
+{
+  if (!(odometer.validityBits & ODOMETER_TRAVELLEDDISTANCE_VALID))
+  {
+    mOdometerValid = false;
+    return;
+  }
+  bool use = mOdometerValid && (odometer.timestamp > mOdometerTime) &&
+             !(mVehicleSpeedSeen && (odometer.timestamp < mVehicleSpeedTime + FUSION_VEHICLESPEED_TIMEOUT));
+  double dt = (odometer.timestamp - mOdometerTime)/1000.0;
+  uint16_t delta = (uint16_t)(odometer.travelledDistance - mOdometerDistance);
+
+  mOdometerDistance = odometer.travelledDistance;
+  mOdometerTime = odometer.timestamp;
+  mOdometerValid = true;
+
+  if (use && mInitialized && (dt <= FUSION_SENSOR_TIMEOUT/1000.0))
+  {
+    //the counter has no direction and a resolution of 1cm
+    double sigma = FUSION_SIGMA_ODOMETER + 0.01/dt;
+    propagate(odometer.timestamp);
+    processSpeed(delta/100.0/dt, sigma*sigma, true);
+  }
+}
+
+void FusionEngine::processGNSSPosition(const TGNSSPosition& position)
+{
+  const uint32_t latlon = GNSS_POSITION_LATITUDE_VALID | GNSS_POSITION_LONGITUDE_VALID;
+  if ((position.validityBits & latlon) != latlon)
+  {
+    return;
+  }
+  if ((position.validityBits & GNSS_POSITION_STAT_VALID) &&
+      (position.fixStatus != GNSS_FIX_STATUS_2D) && (position.fixStatus != GNSS_FIX_STATUS_3D))
+  {
+    return;
+  }
+  if (!mInitialized)
+  {
+    initialize(position);
+    return;
+  }
+
+  propagate(position.timestamp);
+
+  //the state may already be ahead of the GNSS position: move the prediction back along the track
+  double delay = 0;
+  if (mTime > position.timestamp)
+  {
+    delay = (mTime - position.timestamp)/1000.0;
+    if (delay > FUSION_MAX_GNSS_DELAY/1000.0)
+    {
+      delay = FUSION_MAX_GNSS_DELAY/1000.0;
+    }
+  }
+  double sinPsi = sin(mX[S_PSI]);
+  double cosPsi = cos(mX[S_PSI]);
+  double v = mX[S_V];
+
+  //horizontal position
+  double sigmaH = FUSION_SIGMA_HPOSITION;
+  if ((position.validityBits & GNSS_POSITION_SHPOS_VALID) && (position.sigmaHPosition > 0))
+  {
+    sigmaH = position.sigmaHPosition;
+  }
+  else if ((position.validityBits & GNSS_POSITION_HDOP_VALID) && (position.hdop > 0))
+  {
+    sigmaH = position.hdop * FUSION_HDOP_FACTOR;
+  }
+  {
+    Matrix<double,2,S_NUM> H = Matrix<double,2,S_NUM>::zero();
+    H(0,S_E) = 1.0;
+    H(1,S_N) = 1.0;
+    Matrix<double,2,1> innovation;
+    innovation[0] = (position.longitude - mRefLongitude)*mMetersPerDegreeLon - (mX[S_E] - v*sinPsi*delay);
+    innovation[1] = (position.latitude - mRefLatitude)*mMetersPerDegreeLat - (mX[S_N] - v*cosPsi*delay);
+    SymmetricMatrix<double,2> R = SymmetricMatrix<double,2>::identity();
+    R(0,0) = sigmaH*sigmaH/2;
+    R(1,1) = sigmaH*sigmaH/2;
+    if (update(H, innovation, R, FUSION_GATE_2D))
+    {
+      mGNSSTime = position.timestamp;
+      mGNSSRejections = 0;
+    }
+    else if (++mGNSSRejections >= FUSION_MAX_GNSS_REJECTIONS)
+    {
+      //the filter has diverged or the vehicle has been moved: start again from the GNSS position
+      initialize(position);
+      return;
+    }
+    else
+    {
+      return;
+    }
+  }
+
+  //altitude and vertical speed
+  if ((position.validityBits & GNSS_POSITION_ALTITUDEMSL_VALID) &&
+      !((position.validityBits & GNSS_POSITION_STAT_VALID) && (position.fixStatus != GNSS_FIX_STATUS_3D)))
+  {
+    double sigma = FUSION_SIGMA_ALTITUDE;
+    if ((position.validityBits & GNSS_POSITION_SALT_VALID) && (position.sigmaAltitude > 0))
+    {
+      sigma = position.sigmaAltitude;
+    }
+    else if ((position.validityBits & GNSS_POSITION_VDOP_VALID) && (position.vdop > 0))
+    {
+      sigma = position.vdop * FUSION_VDOP_FACTOR;
+    }
+    if (!mAltitudeValid)
+    {
+      mX[S_H] = position.altitudeMSL;
+      mP(S_H,S_H) = sigma*sigma;
+      mAltitudeValid = true;
+    }
+    else
+    {
+      Matrix<double,1,S_NUM> H = Matrix<double,1,S_NUM>::zero();
+      H(0,S_H) = 1.0;
+      Matrix<double,1,1> innovation;
+      innovation[0] = position.altitudeMSL - (mX[S_H] - mX[S_VZ]*delay);
+      SymmetricMatrix<double,1> R;
+      R(0,0) = sigma*sigma;
+      update(H, innovation, R, FUSION_GATE_1D);
+    }
+  }
+  if (position.validityBits & GNSS_POSITION_VSPEED_VALID)
+  {
+    double sigma = FUSION_SIGMA_VSPEED;
+    if ((position.validityBits & GNSS_POSITION_SVSPEED_VALID) && (position.sigmaVSpeed > 0))
+    {
+      sigma = position.sigmaVSpeed;
+    }
+    Matrix<double,1,S_NUM> H = Matrix<double,1,S_NUM>::zero();
+    H(0,S_VZ) = 1.0;
+    Matrix<double,1,1> innovation;
+    innovation[0] = position.vSpeed - mX[S_VZ];
+    SymmetricMatrix<double,1> R;
+    R(0,0) = sigma*sigma;
+    update(H, innovation, R, FUSION_GATE_1D);
+  }
+
+  //horizontal speed: GNSS provides the magnitude only
+  if (position.validityBits & GNSS_POSITION_HSPEED_VALID)
+  {
+    double sigma = FUSION_SIGMA_HSPEED;
+    if ((position.validityBits & GNSS_POSITION_SHSPEED_VALID) && (position.sigmaHSpeed > 0))
+    {
+      sigma = position.sigmaHSpeed;
+    }
+    double sign = (mX[S_V] < 0) ? -1.0 : 1.0;
+    Matrix<double,1,S_NUM> H = Matrix<double,1,S_NUM>::zero();
+    H(0,S_V) = sign;
+    Matrix<double,1,1> innovation;
+    innovation[0] = position.hSpeed - sign*mX[S_V];
+    SymmetricMatrix<double,1> R;
+    R(0,0) = sigma*sigma;
+    update(H, innovation, R, FUSION_GATE_1D);
+  }
+
+  //course over ground: only reliable at higher speeds, opposite to the heading when driving backward
+  if ((position.validityBits & GNSS_POSITION_HEADING_VALID) &&
+      (position.validityBits & GNSS_POSITION_HSPEED_VALID) &&
+      (position.hSpeed >= FUSION_MIN_HEADING_SPEED))
+  {
+    double sigma = FUSION_SIGMA_HEADING;
+    if ((position.validityBits & GNSS_POSITION_SHEADING_VALID) && (position.sigmaHeading > 0))
+    {
+      sigma = position.sigmaHeading;
+    }
+    sigma *= FUSION_DEG2RAD;
+    double course = mX[S_PSI] + ((mX[S_V] < 0) ? FUSION_PI : 0);
+    Matrix<double,1,S_NUM> H = Matrix<double,1,S_NUM>::zero();
+    H(0,S_PSI) = 1.0;
+    Matrix<double,1,1> innovation;
+    innovation[0] = wrapAngle(position.heading*FUSION_DEG2RAD - course);
+    SymmetricMatrix<double,1> R;
+    R(0,0) = sigma*sigma;
+    update(H, innovation, R, FUSION_GATE_1D);
+  }
+
+  //keep the local frame small
+  if (mX[S_E]*mX[S_E] + mX[S_N]*mX[S_N] > FUSION_MAX_REFERENCE_DISTANCE*FUSION_MAX_REFERENCE_DISTANCE)
+  {
+    setReference(mRefLatitude + mX[S_N]/mMetersPerDegreeLat, mRefLongitude + mX[S_E]/mMetersPerDegreeLon);
+    mX[S_E] = 0;
+    mX[S_N] = 0;
+  }
+}
+
+void FusionEngine::processGNSSTime(const TGNSSTime& time)
+{
+  const uint32_t datetime = GNSS_TIME_DATE_VALID | GNSS_TIME_TIME_VALID;
+  if (((time.validityBits & datetime) != datetime) || (time.month > 11))
+  {
+    return;
+  }
+
+  int64_t leapSeconds = 0;
+  if ((time.validityBits & GNSS_TIME_SCALE_VALID) && (time.scale == GNSS_TIME_SCALE_GPS))
+  {
+    if (!(time.validityBits & GNSS_TIME_LEAPSEC_VALID))
+    {
+      return;
+    }
+    leapSeconds = time.leapSeconds;
+  }
+
+  //the GNSS service counts the months from 0 like struct tm
+  int64_t days = daysFromCivil(time.year, time.month + 1, time.day);
+  int64_t utc = ((days*24 + time.hour)*60 + time.minute)*60 + time.second - leapSeconds;
+  utc = utc*1000 + time.ms;
+
+  mUtcOffset = utc - (int64_t)time.timestamp;
+  mUtcValid = true;
+}
+
+bool FusionEngine::getPosition(TFusionPosition& position) const
+{
+  memset(&position, 0, sizeof(position));
+  if (!mInitialized)
+  {
+    return false;
+  }
+
+  double heading = mX[S_PSI]*FUSION_RAD2DEG;
+  if (heading < 0)
+  {
+    heading += 360.0;
+  }
+  double sigmaHeading = sqrt(mP(S_PSI,S_PSI))*FUSION_RAD2DEG;
+
+  position.timestamp = mTime;
+  position.latitude = mRefLatitude + mX[S_N]/mMetersPerDegreeLat;
+  position.longitude = mRefLongitude + mX[S_E]/mMetersPerDegreeLon;
+  position.altitude = mX[S_H];
+  position.heading = heading;
+  position.speed = mX[S_V];
+  position.climb = mX[S_VZ];
+  position.sigmaHPosition = sqrt(mP(S_E,S_E) + mP(S_N,S_N));
+  position.sigmaAltitude = sqrt(mP(S_H,S_H));
+  position.sigmaHeading = sigmaHeading;
+  position.sigmaSpeed = sqrt(mP(S_V,S_V));
+  position.drStatus = (mTime > mGNSSTime + FUSION_DR_TIMEOUT);
+  position.validityBits = FUSION_POSITION_LATLON_VALID | FUSION_POSITION_SPEED_VALID;
+  if (mAltitudeValid)
+  {
+    position.validityBits |= FUSION_POSITION_ALTITUDE_VALID | FUSION_POSITION_CLIMB_VALID;
+  }
+  //until the heading has been observed, it is not worth reporting
+  if (sigmaHeading < 45.0)
+  {
+    position.validityBits |= FUSION_POSITION_HEADING_VALID;
+  }
+  if (mYawRateValid && (mTime < mYawRateTime + FUSION_SENSOR_TIMEOUT))
+  {
+    position.yawRate = (mYawRate - mX[S_BG])*FUSION_RAD2DEG;
+    position.validityBits |= FUSION_POSITION_YAWRATE_VALID;
+  }
+  if (mUtcValid)
+  {
+    position.utcTime = (uint64_t)((int64_t)mTime + mUtcOffset);
+    position.validityBits |= FUSION_POSITION_UTC_VALID;
+  }
+
+  return true;
+}
+
+bool FusionEngine::extrapolate(uint64_t timestamp, TFusionPosition& position) const
+{
+  if (!getPosition(position))
+  {
+    return false;
+  }
+
+  int64_t interval = (int64_t)(timestamp - mTime);
+  if (interval > FUSION_MAX_EXTRAPOLATION)
+  {
+    interval = FUSION_MAX_EXTRAPOLATION;
+  }
+  else if (interval < -FUSION_MAX_EXTRAPOLATION)
+  {
+    interval = -FUSION_MAX_EXTRAPOLATION;
+  }
+  if (interval == 0)
+  {
+    return true;
+  }
+
+  //constant speed and turn rate: the position moves along a circular arc
+  double dt = interval/1000.0;
+  double psi = mX[S_PSI];
+  double v = mX[S_V];
+  double turnRate = 0;
+  if (position.validityBits & FUSION_POSITION_YAWRATE_VALID)
+  {
+    turnRate = -(mYawRate - mX[S_BG]);
+  }
+  double dPsi = turnRate*dt;
+  double dE;
+  double dN;
+  if (fabs(dPsi) < 1e-6)
+  {
+    dE = v*sin(psi)*dt;
+    dN = v*cos(psi)*dt;
+  }
+  else
+  {
+    dE = v/turnRate*(cos(psi) - cos(psi + dPsi));
+    dN = v/turnRate*(sin(psi + dPsi) - sin(psi));
+  }
+
+  double heading = wrapAngle(psi + dPsi)*FUSION_RAD2DEG;
+  if (heading < 0)
+  {
+    heading += 360.0;
+  }
+
+  //uncertainty from speed and heading errors plus the process noise over the interval
+  double adt = fabs(dt);
+  double sigmaE2 = mP(S_E,S_E) + mP(S_V,S_V)*adt*adt + v*v*mP(S_PSI,S_PSI)*adt*adt + 2*FUSION_Q_POSITION*adt;
+  double sigmaH2 = mP(S_H,S_H) + mP(S_VZ,S_VZ)*adt*adt + FUSION_Q_ALTITUDE*adt;
+  double sigmaPsi2 = mP(S_PSI,S_PSI) + mP(S_BG,S_BG)*adt*adt + FUSION_Q_HEADING*adt;
+
+  position.timestamp = mTime + interval;
+  if (position.validityBits & FUSION_POSITION_UTC_VALID)
+  {
+    position.utcTime += interval;
+  }
+  position.latitude += dN/mMetersPerDegreeLat;
+  position.longitude += dE/mMetersPerDegreeLon;
+  position.altitude += mX[S_VZ]*dt;
+  position.heading = heading;
+  position.sigmaHPosition = sqrt(sigmaE2 + mP(S_N,S_N));
+  position.sigmaAltitude = sqrt(sigmaH2);
+  position.sigmaHeading = sqrt(sigmaPsi2)*FUSION_RAD2DEG;
+  position.sigmaSpeed = sqrt(mP(S_V,S_V) + FUSION_Q_SPEED_ACC*adt);
+  position.drStatus = (position.timestamp > mGNSSTime + FUSION_DR_TIMEOUT);
+  position.extrapolation = (int32_t)interval;
+
+  return true;
+}
+
+void FusionEngine::getStatistics(TFusionStatistics& statistics) const
+{
+  statistics = mStatistics;
+}
@@ -0,0 +1,185 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Dead-reckoning fusion of GNSS, gyroscope, acceleration and odometry
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+#ifndef ___FUSION_ENGINE_H
+#define ___FUSION_ENGINE_H
+
+#include <stdint.h>
+
+#include "gnss.h"
+#include "gyroscope.h"
+#include "acceleration.h"
+#include "vehicle-speed.h"
+#include "odometer.h"
+#include "matrix.h"
+
+/**
+ * TFusionPosition::validityBits provides information which fields in TFusionPosition contain valid data.
+ */
+typedef enum {
+    FUSION_POSITION_LATLON_VALID    = 0x00000001,   /**< latitude, longitude and sigmaHPosition */
+    FUSION_POSITION_ALTITUDE_VALID  = 0x00000002,   /**< altitude and sigmaAltitude */
+    FUSION_POSITION_HEADING_VALID   = 0x00000004,   /**< heading and sigmaHeading */
+    FUSION_POSITION_SPEED_VALID     = 0x00000008,   /**< speed and sigmaSpeed */
+    FUSION_POSITION_CLIMB_VALID     = 0x00000010,   /**< climb */
+    FUSION_POSITION_YAWRATE_VALID   = 0x00000020,   /**< yawRate */
+    FUSION_POSITION_UTC_VALID       = 0x00000040    /**< utcTime */
+} EFusionPositionValidityBits;
+
+/**
+ * Fused position
+ */
+typedef struct {
+    uint64_t timestamp;         /**< Time of validity [ms], same time base as the sensor/GNSS timestamps */
+    double latitude;            /**< WGS84 latitude [degree] */
+    double longitude;           /**< WGS84 longitude [degree] */
+    float altitude;             /**< Altitude above mean sea level [m] */
+    float heading;              /**< Course over ground [degree], 0 => north, 90 => east */
+    float speed;                /**< Speed [m/s], negative when driving backward */
+    float climb;                /**< Vertical speed [m/s] */
+    float yawRate;              /**< Bias compensated yaw rate [degree/s], positive for a left turn */
+    float sigmaHPosition;       /**< Standard error estimate of the horizontal position [m] */
+    float sigmaAltitude;        /**< Standard error estimate of the altitude [m] */
+    float sigmaHeading;         /**< Standard error estimate of the heading [degree] */
+    float sigmaSpeed;           /**< Standard error estimate of the speed [m/s] */
+    bool drStatus;              /**< True if the position is propagated by dead reckoning only (no recent GNSS fix) */
+    int32_t extrapolation;      /**< Time from the latest input to timestamp [ms], 0 if not extrapolated */
+    uint64_t utcTime;           /**< UTC at timestamp [ms since 1970-01-01], derived from the latest GNSS time */
+    uint32_t validityBits;      /**< [bitwise or'ed @ref EFusionPositionValidityBits values] */
+} TFusionPosition;
+
+/**
+ * Processing statistics
+ */
+typedef struct {
+    uint64_t predictions;       /**< Number of time updates */
+    uint64_t updates;           /**< Number of accepted measurement updates */
+    uint64_t rejections;        /**< Number of measurements rejected by the innovation test */
+    uint64_t resets;            /**< Number of re-initializations from GNSS */
+} TFusionStatistics;
+
+/**
+ * Error-state Kalman filter for 2D dead reckoning with altitude.
+ *
+ * Nominal state: east/north offset from a reference point, heading, speed,
+ * gyroscope yaw rate bias, odometry scale factor, longitudinal acceleration
+ * bias, altitude and vertical speed. The filter propagates the nominal state
+ * with the gyroscope yaw rate and the longitudinal acceleration, estimates
+ * the error state with GNSS position/velocity and speed measurements and
+ * injects it into the nominal state after each update.
+ *
+ * State and covariance have a fixed size, no memory is allocated.
+ * The results only depend on the sequence of input data, not on the
+ * wall clock, so replaying a log gives the same results each time.
+ * The class is not thread-safe: the caller must serialize the calls.
+ */
+class FusionEngine
+{
+public:
+
+  FusionEngine();
+
+  /**
+   * Forget all data and wait for the next GNSS fix
+   */
+  void reset();
+
+  void processGyroscope(const TGyroscopeData& gyroscope);
+  void processAcceleration(const TAccelerationData& acceleration);
+  void processVehicleSpeed(const TVehicleSpeedData& vehicleSpeed);
+  void processOdometer(const TOdometerData& odometer);
+  void processGNSSPosition(const TGNSSPosition& position);
+
+  /**
+   * Relate the timestamps to UTC, see TFusionPosition::utcTime.
+   * GPS time is only used if the leap seconds are known.
+   * The time is kept by reset(), it does not depend on the position.
+   */
+  void processGNSSTime(const TGNSSTime& time);
+
+  /**
+   * Get the fused position at the time of the latest input
+   * @return false as long as the filter has not been initialized by a GNSS fix
+   */
+  bool getPosition(TFusionPosition& position) const;
+
+  /**
+   * Get the fused position extrapolated to a given time, assuming constant
+   * speed, yaw rate and climb since the latest input. The standard errors
+   * grow with the extrapolation interval. The interval is limited,
+   * see TFusionPosition::extrapolation for the interval actually used.
+   * The state of the filter is not changed.
+   * @param timestamp target time [ms], same time base as the input data
+   * @return false as long as the filter has not been initialized by a GNSS fix
+   */
+  bool extrapolate(uint64_t timestamp, TFusionPosition& position) const;
+
+  void getStatistics(TFusionStatistics& statistics) const;
+
+private:
+
+  //indexes of the state vector
+  enum { S_E, S_N, S_PSI, S_V, S_BG, S_SCALE, S_BA, S_H, S_VZ, S_NUM };
+
+  typedef Matrix<double,S_NUM,1> TState;
+  typedef SymmetricMatrix<double,S_NUM> TCovariance;
+
+  void propagate(uint64_t timestamp);
+  void predict(double dt);
+  template<int M>
+  bool update(const Matrix<double,M,S_NUM>& H, const Matrix<double,M,1>& innovation,
+              const SymmetricMatrix<double,M>& R, double gate);
+  void initialize(const TGNSSPosition& position);
+  void setReference(double latitude, double longitude);
+  void processSpeed(double speed, double variance, bool magnitude);
+
+  bool mInitialized;
+  uint64_t mTime;                 //time of the state [ms]
+  TState mX;                      //nominal state
+  TCovariance mP;                 //covariance of the error state
+
+  double mRefLatitude;            //reference point of the local east/north frame [degree]
+  double mRefLongitude;
+  double mMetersPerDegreeLat;
+  double mMetersPerDegreeLon;
+
+  double mYawRate;                //latest raw yaw rate [rad/s]
+  bool mYawRateValid;
+  uint64_t mYawRateTime;
+  double mAcceleration;           //latest longitudinal acceleration [m/s^2]
+  bool mAccelerationValid;
+  uint64_t mAccelerationTime;
+
+  uint64_t mVehicleSpeedTime;     //time of the latest vehicle speed
+  bool mVehicleSpeedSeen;
+  uint16_t mOdometerDistance;     //previous odometer counter [cm]
+  uint64_t mOdometerTime;
+  bool mOdometerValid;
+
+  bool mAltitudeValid;
+  uint64_t mGNSSTime;             //time of the latest accepted GNSS position
+  uint16_t mGNSSRejections;       //consecutively rejected GNSS positions
+
+  int64_t mUtcOffset;             //UTC [ms since 1970-01-01] minus timestamp
+  bool mUtcValid;
+
+  TFusionStatistics mStatistics;
+};
+
+#endif//___FUSION_ENGINE_H
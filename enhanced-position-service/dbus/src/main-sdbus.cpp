@@ -0,0 +1,212 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief EnhancedPositionService with the sd-bus backend
+*
+* \details Same bus name, object paths and interfaces as main.cpp.
+* The bus and all timers are dispatched by one sd_event loop;
+* SIGINT and SIGTERM end the loop.
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <systemd/sd-bus.h>
+#include <systemd/sd-event.h>
+
+#include "enhanced-position-sdbus.h"
+#include "position-feedback-sdbus.h"
+#include "configuration-sdbus.h"
+#include "position-shm.h"
+#include "log.h"
+#include "gnss.h"
+#include "gnss-init.h"
+#include "sns-init.h"
+#include "gyroscope.h"
+#include "acceleration.h"
+#include "vehicle-speed.h"
+#include "odometer.h"
+
+const char* ENHANCED_POSITION_SERVICE_NAME = "org.genivi.positioning.EnhancedPosition";
+const char* ENHANCED_POSITION_OBJECT_PATH = "/org/genivi/positioning/EnhancedPosition";
+const char* POSITION_FEEDBACK_OBJECT_PATH = "/org/genivi/positioning/PositionFeedback";
+const char* CONFIGURATION_OBJECT_PATH = "/org/genivi/positioning/Configuration";
+//rate of the PredictedPositionUpdate signal [Hz], not set or 0: no predicted position stream
+const char* PREDICTION_RATE_ENV = "ENHANCED_POSITION_PREDICTION_RATE";
+#define PREDICTION_RATE_MAX 50
+
+DLT_DECLARE_CONTEXT(gCtx);
+
+bool checkGNSSMajorVersion(int expectedMajor)
+{
+  int major = -1;
+
+  gnssGetVersion(&major, 0, 0);
+
+  if (major != expectedMajor)
+  {
+    LOG_ERROR(gCtx,"Wrong API version: gnssGetVersion returned unexpected value %d != %d",
+              major,
+              expectedMajor);
+
+    return false;
+  }
+
+  return true;
+}
+
+int main()
+{
+  sd_event* event = 0;
+  sd_bus* bus = 0;
+  sigset_t mask;
+  int r;
+
+  DLT_REGISTER_APP("ENHP", "EnhancedPositionService");
+  DLT_REGISTER_CONTEXT(gCtx,"EPSR", "Global Context");  // EPSR = EnhancedPositionService Server Application
+  LOG_INFO_MSG(gCtx,"Starting EnhancedPositionService (sd-bus)...");
+
+  //the signals are delivered to the event loop, so block them before any thread is created
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGTERM);
+  sigaddset(&mask, SIGINT);
+  sigprocmask(SIG_BLOCK, &mask, 0);
+
+  r = sd_event_default(&event);
+  if (r >= 0)
+  {
+    r = sd_bus_open_user(&bus);
+  }
+  if (r >= 0)
+  {
+    r = sd_bus_attach_event(bus, event, SD_EVENT_PRIORITY_NORMAL);
+  }
+  if (r >= 0)
+  {
+    //a NULL handler exits the loop
+    r = sd_event_add_signal(event, 0, SIGTERM, 0, 0);
+  }
+  if (r >= 0)
+  {
+    r = sd_event_add_signal(event, 0, SIGINT, 0, 0);
+  }
+  if (r < 0)
+  {
+    LOG_ERROR(gCtx,"sd-bus setup failed: %s - exiting!", strerror(-r));
+    exit(EXIT_FAILURE);
+  }
+
+  if(!checkGNSSMajorVersion(GENIVI_GNSS_API_MAJOR))
+  {
+    LOG_ERROR_MSG(gCtx,"Wrong GNSS version - exiting!");
+    exit(EXIT_FAILURE);
+  }
+
+  if(!gnssInit())
+  {
+    LOG_ERROR_MSG(gCtx,"gnssInit failure - exiting!");
+    exit(EXIT_FAILURE);
+  }
+
+  //the sensors are optional: without them, the position is plain GNSS
+  bool isSnsInitialized = snsInit();
+  if (isSnsInitialized)
+  {
+    if (!snsGyroscopeInit())
+      LOG_WARNING_MSG(gCtx,"snsGyroscopeInit failure");
+    if (!snsAccelerationInit())
+      LOG_WARNING_MSG(gCtx,"snsAccelerationInit failure");
+    if (!snsVehicleSpeedInit())
+      LOG_WARNING_MSG(gCtx,"snsVehicleSpeedInit failure");
+    if (!snsOdometerInit())
+      LOG_WARNING_MSG(gCtx,"snsOdometerInit failure");
+  }
+  else
+  {
+    LOG_WARNING_MSG(gCtx,"snsInit failure - no dead reckoning");
+  }
+
+  //local clients may read the position from shared memory instead of polling over D-Bus
+  if (!epsShmCreate())
+  {
+    LOG_WARNING_MSG(gCtx,"epsShmCreate failure - no shared memory position");
+  }
+
+  EnhancedPositionSdBus EnhancedPositionServer(bus, event, ENHANCED_POSITION_OBJECT_PATH);
+  PositionFeedbackSdBus PositionFeedbackServer(bus, POSITION_FEEDBACK_OBJECT_PATH);
+  ConfigurationSdBus ConfigurationServer(bus, CONFIGURATION_OBJECT_PATH, EnhancedPositionServer);
+
+  //register the objects before the name is taken, so clients never see a partial service
+  if (!EnhancedPositionServer.init() || !PositionFeedbackServer.init() || !ConfigurationServer.init())
+  {
+    LOG_ERROR_MSG(gCtx,"Object registration failure - exiting!");
+    exit(EXIT_FAILURE);
+  }
+
+  r = sd_bus_request_name(bus, ENHANCED_POSITION_SERVICE_NAME, 0);
+  if (r < 0)
+  {
+    LOG_ERROR(gCtx,"sd_bus_request_name failed: %s - exiting!", strerror(-r));
+    exit(EXIT_FAILURE);
+  }
+
+  EnhancedPositionServer.startPublishing(ConfigurationServer.getUpdateInterval());
+  EnhancedPositionServer.run();
+  PositionFeedbackServer.run();
+  ConfigurationServer.run();
+
+  const char* env = getenv(PREDICTION_RATE_ENV);
+  if (env)
+  {
+    int rate = atoi(env);
+    if (rate > PREDICTION_RATE_MAX)
+    {
+      rate = PREDICTION_RATE_MAX;
+    }
+    if (rate > 0)
+    {
+      EnhancedPositionServer.startPredictionStream(rate);
+    }
+  }
+
+  r = sd_event_loop(event);
+  if (r < 0)
+  {
+    LOG_ERROR(gCtx,"sd_event_loop failed: %s", strerror(-r));
+  }
+  LOG_INFO_MSG(gCtx,"Signal received");
+
+  ConfigurationServer.shutdown();
+  PositionFeedbackServer.shutdown();
+  EnhancedPositionServer.shutdown();
+  epsShmDestroy();
+
+  if (isSnsInitialized)
+  {
+    snsOdometerDestroy();
+    snsVehicleSpeedDestroy();
+    snsAccelerationDestroy();
+    snsGyroscopeDestroy();
+    snsDestroy();
+  }
+
+  gnssDestroy();
+
+  sd_bus_flush(bus);
+
+  return 0;
+}
@@ -17,6 +17,8 @@
 **************************************************************************/
 
 #include <signal.h>
+#include <stdlib.h>
+#include <string.h>
 #ifndef DBUS_HAS_RECURSIVE_MUTEX
 #define DBUS_HAS_RECURSIVE_MUTEX
 #endif
@@ -25,14 +27,25 @@
 #include "enhanced-position.h"
 #include "position-feedback.h"
 #include "configuration.h"
+#include "position-shm.h"
 #include "log.h"
 #include "gnss.h"
 #include "gnss-init.h"
+#include "sns-init.h"
+#include "gyroscope.h"
+#include "acceleration.h"
+#include "vehicle-speed.h"
+#include "odometer.h"
 
 const char* ENHANCED_POSITION_SERVICE_NAME = "org.genivi.positioning.EnhancedPosition";
 const char* ENHANCED_POSITION_OBJECT_PATH = "/org/genivi/positioning/EnhancedPosition";
 const char* POSITION_FEEDBACK_OBJECT_PATH = "/org/genivi/positioning/PositionFeedback";
 const char* CONFIGURATION_OBJECT_PATH = "/org/genivi/positioning/Configuration";
+//rate of the PredictedPositionUpdate signal [Hz], not set or 0: no predicted position stream
+const char* PREDICTION_RATE_ENV = "ENHANCED_POSITION_PREDICTION_RATE";
+#define PREDICTION_RATE_MAX 50
+//"map": answer GetPositionInfo with the generated adaptor instead of the direct marshalling, e.g. for benchmarks
+const char* MARSHALLING_ENV = "ENHANCED_POSITION_MARSHALLING";
 
 DLT_DECLARE_CONTEXT(gCtx);
 
@@ -95,22 +108,76 @@ int main()
     exit(EXIT_FAILURE);
   }
 
+  //the sensors are optional: without them, the position is plain GNSS
+  bool isSnsInitialized = snsInit();
+  if (isSnsInitialized)
+  {
+    if (!snsGyroscopeInit())
+      LOG_WARNING_MSG(gCtx,"snsGyroscopeInit failure");
+    if (!snsAccelerationInit())
+      LOG_WARNING_MSG(gCtx,"snsAccelerationInit failure");
+    if (!snsVehicleSpeedInit())
+      LOG_WARNING_MSG(gCtx,"snsVehicleSpeedInit failure");
+    if (!snsOdometerInit())
+      LOG_WARNING_MSG(gCtx,"snsOdometerInit failure");
+  }
+  else
+  {
+    LOG_WARNING_MSG(gCtx,"snsInit failure - no dead reckoning");
+  }
+
   conn->setup(&dispatcher);
   conn->request_name(ENHANCED_POSITION_SERVICE_NAME);
 
+  //local clients may read the position from shared memory instead of polling over D-Bus
+  if (!epsShmCreate())
+  {
+    LOG_WARNING_MSG(gCtx,"epsShmCreate failure - no shared memory position");
+  }
+
   EnhancedPosition EnhancedPositionServer(*conn, ENHANCED_POSITION_OBJECT_PATH); 
   PositionFeedback PositionFeedbackServer(*conn, POSITION_FEEDBACK_OBJECT_PATH);
-  Configuration ConfigurationServer(*conn, CONFIGURATION_OBJECT_PATH);
+  Configuration ConfigurationServer(*conn, CONFIGURATION_OBJECT_PATH, EnhancedPositionServer);
   
+  const char* marshalling = getenv(MARSHALLING_ENV);
+  if (!marshalling || (strcmp(marshalling, "map") != 0))
+  {
+    EnhancedPositionServer.enableDirectMarshalling();
+  }
+  EnhancedPositionServer.startPublishing(dispatcher, ConfigurationServer.getUpdateInterval());
   EnhancedPositionServer.run();
   PositionFeedbackServer.run();
   ConfigurationServer.run();
 
+  const char* env = getenv(PREDICTION_RATE_ENV);
+  if (env)
+  {
+    int rate = atoi(env);
+    if (rate > PREDICTION_RATE_MAX)
+    {
+      rate = PREDICTION_RATE_MAX;
+    }
+    if (rate > 0)
+    {
+      EnhancedPositionServer.startPredictionStream(dispatcher, rate);
+    }
+  }
+
   dispatcher.enter();
 
   ConfigurationServer.shutdown();
   PositionFeedbackServer.shutdown();
   EnhancedPositionServer.shutdown();
+  epsShmDestroy();
+
+  if (isSnsInitialized)
+  {
+    snsOdometerDestroy();
+    snsVehicleSpeedDestroy();
+    snsAccelerationDestroy();
+    snsGyroscopeDestroy();
+    snsDestroy();
+  }
 
   gnssDestroy();
   
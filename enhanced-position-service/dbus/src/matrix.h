@@ -0,0 +1,587 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Fixed-size matrix algebra for positioning filters
+*
+* \details Header-only templates with the dimensions as template parameters:
+*   - Matrix<T,R,C>: dense row-major matrix,
+*   - SymmetricMatrix<T,N>: packed storage of the lower triangle, e.g. for covariances,
+*   - Cholesky and LDL' decomposition and solvers for symmetric matrices,
+*   - Kalman filter helpers: covariance prediction and the Joseph form update.
+* No memory is allocated, all temporaries live on the stack. The functions are
+* meant for the small sizes of positioning filters (about 3 to 24 states).
+* The rows are stored contiguously and the inner loops run with unit stride
+* over the innermost index, so that the compiler can vectorize them.
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+#ifndef ___MATRIX_H
+#define ___MATRIX_H
+
+#include <math.h>
+
+//alignment of the matrix data: allows aligned vector loads of the first row
+#define MATRIX_ALIGNMENT 16
+
+/**
+ * Dense matrix with R rows and C columns, stored row by row.
+ * Vectors are matrices with one column and can be indexed with [].
+ */
+template<typename T, int R, int C>
+class Matrix
+{
+public:
+
+  static const int ROWS = R;
+  static const int COLS = C;
+
+  /**
+   * The elements are not initialized, use zero() or identity()
+   */
+  Matrix() {}
+
+  static Matrix zero()
+  {
+    Matrix m;
+    m.fill(0);
+    return m;
+  }
+
+  static Matrix identity()
+  {
+    Matrix m;
+    m.fill(0);
+    for (int i = 0; (i < R) && (i < C); i++)
+    {
+      m.mData[i][i] = 1;
+    }
+    return m;
+  }
+
+  void fill(T value)
+  {
+    T* p = data();
+    for (int i = 0; i < R*C; i++)
+    {
+      p[i] = value;
+    }
+  }
+
+  T& operator()(int row, int col) { return mData[row][col]; }
+  const T& operator()(int row, int col) const { return mData[row][col]; }
+
+  //element access in storage order, mainly for vectors
+  T& operator[](int i) { return data()[i]; }
+  const T& operator[](int i) const { return data()[i]; }
+
+  T* data() { return &mData[0][0]; }
+  const T* data() const { return &mData[0][0]; }
+
+  Matrix& operator+=(const Matrix& b)
+  {
+    T* p = data();
+    const T* q = b.data();
+    for (int i = 0; i < R*C; i++)
+    {
+      p[i] += q[i];
+    }
+    return *this;
+  }
+
+  Matrix& operator-=(const Matrix& b)
+  {
+    T* p = data();
+    const T* q = b.data();
+    for (int i = 0; i < R*C; i++)
+    {
+      p[i] -= q[i];
+    }
+    return *this;
+  }
+
+  Matrix& operator*=(T s)
+  {
+    T* p = data();
+    for (int i = 0; i < R*C; i++)
+    {
+      p[i] *= s;
+    }
+    return *this;
+  }
+
+  Matrix operator+(const Matrix& b) const { Matrix m(*this); m += b; return m; }
+  Matrix operator-(const Matrix& b) const { Matrix m(*this); m -= b; return m; }
+  Matrix operator*(T s) const { Matrix m(*this); m *= s; return m; }
+
+  Matrix<T,C,R> transpose() const
+  {
+    Matrix<T,C,R> m;
+    for (int i = 0; i < R; i++)
+    {
+      for (int j = 0; j < C; j++)
+      {
+        m(j,i) = mData[i][j];
+      }
+    }
+    return m;
+  }
+
+private:
+
+  alignas(MATRIX_ALIGNMENT) T mData[R][C];
+};
+
+/**
+ * Matrix product A*B
+ */
+template<typename T, int R, int K, int C>
+inline Matrix<T,R,C> operator*(const Matrix<T,R,K>& a, const Matrix<T,K,C>& b)
+{
+  Matrix<T,R,C> m = Matrix<T,R,C>::zero();
+  for (int i = 0; i < R; i++)
+  {
+    for (int k = 0; k < K; k++)
+    {
+      const T aik = a(i,k);
+      for (int j = 0; j < C; j++)
+      {
+        m(i,j) += aik*b(k,j);
+      }
+    }
+  }
+  return m;
+}
+
+/**
+ * Matrix product A*B' without forming the transpose
+ */
+template<typename T, int R, int K, int C>
+inline Matrix<T,R,C> multiplyTransposed(const Matrix<T,R,K>& a, const Matrix<T,C,K>& b)
+{
+  Matrix<T,R,C> m;
+  for (int i = 0; i < R; i++)
+  {
+    for (int j = 0; j < C; j++)
+    {
+      T sum = 0;
+      for (int k = 0; k < K; k++)
+      {
+        sum += a(i,k)*b(j,k);
+      }
+      m(i,j) = sum;
+    }
+  }
+  return m;
+}
+
+/**
+ * Symmetric NxN matrix: only the lower triangle is stored, row by row.
+ * (i,j) and (j,i) refer to the same element.
+ */
+template<typename T, int N>
+class SymmetricMatrix
+{
+public:
+
+  static const int SIZE = N;
+  static const int ELEMENTS = N*(N+1)/2;
+
+  /**
+   * The elements are not initialized, use zero() or identity()
+   */
+  SymmetricMatrix() {}
+
+  static SymmetricMatrix zero()
+  {
+    SymmetricMatrix m;
+    m.fill(0);
+    return m;
+  }
+
+  static SymmetricMatrix identity()
+  {
+    SymmetricMatrix m;
+    m.fill(0);
+    for (int i = 0; i < N; i++)
+    {
+      m(i,i) = 1;
+    }
+    return m;
+  }
+
+  /**
+   * Symmetric part (A+A')/2 of a dense matrix
+   */
+  static SymmetricMatrix fromMatrix(const Matrix<T,N,N>& a)
+  {
+    SymmetricMatrix m;
+    for (int i = 0; i < N; i++)
+    {
+      for (int j = 0; j <= i; j++)
+      {
+        m(i,j) = (a(i,j) + a(j,i))/2;
+      }
+    }
+    return m;
+  }
+
+  Matrix<T,N,N> toMatrix() const
+  {
+    Matrix<T,N,N> m;
+    for (int i = 0; i < N; i++)
+    {
+      const T* row = &mData[index(i,0)];
+      for (int j = 0; j <= i; j++)
+      {
+        m(i,j) = row[j];
+        m(j,i) = row[j];
+      }
+    }
+    return m;
+  }
+
+  void fill(T value)
+  {
+    for (int i = 0; i < ELEMENTS; i++)
+    {
+      mData[i] = value;
+    }
+  }
+
+  static int index(int i, int j)
+  {
+    return (i >= j) ? i*(i+1)/2 + j : j*(j+1)/2 + i;
+  }
+
+  T& operator()(int i, int j) { return mData[index(i,j)]; }
+  const T& operator()(int i, int j) const { return mData[index(i,j)]; }
+
+  T* data() { return mData; }
+  const T* data() const { return mData; }
+
+  SymmetricMatrix& operator+=(const SymmetricMatrix& b)
+  {
+    for (int i = 0; i < ELEMENTS; i++)
+    {
+      mData[i] += b.mData[i];
+    }
+    return *this;
+  }
+
+  SymmetricMatrix operator+(const SymmetricMatrix& b) const { SymmetricMatrix m(*this); m += b; return m; }
+
+  /**
+   * Add a diagonal matrix, e.g. a process noise with independent components
+   */
+  void addDiagonal(const Matrix<T,N,1>& d)
+  {
+    for (int i = 0; i < N; i++)
+    {
+      mData[index(i,i)] += d[i];
+    }
+  }
+
+private:
+
+  alignas(MATRIX_ALIGNMENT) T mData[ELEMENTS];
+};
+
+/**
+ * Congruence transformation A*P*A', the result is symmetric by construction
+ */
+template<typename T, int M, int N>
+inline SymmetricMatrix<T,M> congruence(const Matrix<T,M,N>& a, const SymmetricMatrix<T,N>& p)
+{
+  const Matrix<T,M,N> ap = a*p.toMatrix();
+  SymmetricMatrix<T,M> m;
+  for (int i = 0; i < M; i++)
+  {
+    for (int j = 0; j <= i; j++)
+    {
+      T sum = 0;
+      for (int k = 0; k < N; k++)
+      {
+        sum += ap(i,k)*a(j,k);
+      }
+      m(i,j) = sum;
+    }
+  }
+  return m;
+}
+
+/**
+ * In-place Cholesky decomposition A = L*L'
+ * @return false if A is not positive definite; A is undefined then
+ */
+template<typename T, int N>
+inline bool choleskyDecompose(SymmetricMatrix<T,N>& a)
+{
+  T* p = a.data();
+  for (int j = 0; j < N; j++)
+  {
+    T* rowj = p + SymmetricMatrix<T,N>::index(j,0);
+    T d = rowj[j];
+    for (int k = 0; k < j; k++)
+    {
+      d -= rowj[k]*rowj[k];
+    }
+    if (!(d > 0))
+    {
+      return false;
+    }
+    d = sqrt(d);
+    rowj[j] = d;
+    for (int i = j+1; i < N; i++)
+    {
+      T* rowi = p + SymmetricMatrix<T,N>::index(i,0);
+      T sum = rowi[j];
+      for (int k = 0; k < j; k++)
+      {
+        sum -= rowi[k]*rowj[k];
+      }
+      rowi[j] = sum/d;
+    }
+  }
+  return true;
+}
+
+/**
+ * Solve A*X = B in place with the factor L of choleskyDecompose()
+ */
+template<typename T, int N, int K>
+inline void choleskySolve(const SymmetricMatrix<T,N>& l, Matrix<T,N,K>& b)
+{
+  //L*Y = B
+  for (int i = 0; i < N; i++)
+  {
+    for (int k = 0; k < i; k++)
+    {
+      const T lik = l(i,k);
+      for (int j = 0; j < K; j++)
+      {
+        b(i,j) -= lik*b(k,j);
+      }
+    }
+    const T d = 1/l(i,i);
+    for (int j = 0; j < K; j++)
+    {
+      b(i,j) *= d;
+    }
+  }
+  //L'*X = Y
+  for (int i = N-1; i >= 0; i--)
+  {
+    for (int k = i+1; k < N; k++)
+    {
+      const T lki = l(k,i);
+      for (int j = 0; j < K; j++)
+      {
+        b(i,j) -= lki*b(k,j);
+      }
+    }
+    const T d = 1/l(i,i);
+    for (int j = 0; j < K; j++)
+    {
+      b(i,j) *= d;
+    }
+  }
+}
+
+/**
+ * In-place LDL' decomposition with unit lower triangular L and diagonal D.
+ * D is stored on the diagonal, L below it. Unlike the Cholesky
+ * decomposition, no square roots are needed.
+ * @return false if a pivot is zero; A is undefined then
+ */
+template<typename T, int N>
+inline bool ldltDecompose(SymmetricMatrix<T,N>& a)
+{
+  T* p = a.data();
+  T v[N] = {0};
+  for (int j = 0; j < N; j++)
+  {
+    T* rowj = p + SymmetricMatrix<T,N>::index(j,0);
+    T d = rowj[j];
+    //v = D*(row j of L)
+    for (int k = 0; k < j; k++)
+    {
+      v[k] = rowj[k]*p[SymmetricMatrix<T,N>::index(k,k)];
+      d -= rowj[k]*v[k];
+    }
+    if (d == 0)
+    {
+      return false;
+    }
+    rowj[j] = d;
+    for (int i = j+1; i < N; i++)
+    {
+      T* rowi = p + SymmetricMatrix<T,N>::index(i,0);
+      T sum = rowi[j];
+      for (int k = 0; k < j; k++)
+      {
+        sum -= rowi[k]*v[k];
+      }
+      rowi[j] = sum/d;
+    }
+  }
+  return true;
+}
+
+/**
+ * True if the LDL' factor belongs to a positive definite matrix
+ */
+template<typename T, int N>
+inline bool ldltIsPositive(const SymmetricMatrix<T,N>& ld)
+{
+  for (int i = 0; i < N; i++)
+  {
+    if (!(ld(i,i) > 0))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Solve A*X = B in place with the factor of ldltDecompose()
+ */
+template<typename T, int N, int K>
+inline void ldltSolve(const SymmetricMatrix<T,N>& ld, Matrix<T,N,K>& b)
+{
+  //L*Z = B
+  for (int i = 0; i < N; i++)
+  {
+    for (int k = 0; k < i; k++)
+    {
+      const T lik = ld(i,k);
+      for (int j = 0; j < K; j++)
+      {
+        b(i,j) -= lik*b(k,j);
+      }
+    }
+  }
+  //D*Y = Z
+  for (int i = 0; i < N; i++)
+  {
+    const T d = 1/ld(i,i);
+    for (int j = 0; j < K; j++)
+    {
+      b(i,j) *= d;
+    }
+  }
+  //L'*X = Y
+  for (int i = N-1; i >= 0; i--)
+  {
+    for (int k = i+1; k < N; k++)
+    {
+      const T lki = ld(k,i);
+      for (int j = 0; j < K; j++)
+      {
+        b(i,j) -= lki*b(k,j);
+      }
+    }
+  }
+}
+
+/**
+ * Kalman filter time update of the covariance: P = F*P*F' + Q
+ */
+template<typename T, int N>
+inline void predictCovariance(SymmetricMatrix<T,N>& p, const Matrix<T,N,N>& f, const SymmetricMatrix<T,N>& q)
+{
+  p = congruence(f, p);
+  p += q;
+}
+
+/**
+ * Kalman filter time update of the covariance with a diagonal process noise
+ */
+template<typename T, int N>
+inline void predictCovariance(SymmetricMatrix<T,N>& p, const Matrix<T,N,N>& f, const Matrix<T,N,1>& q)
+{
+  p = congruence(f, p);
+  p.addDiagonal(q);
+}
+
+/**
+ * Joseph form of the covariance update: P = (I-K*H)*P*(I-K*H)' + K*R*K'.
+ * Keeps P symmetric and positive semi-definite also for a suboptimal gain
+ * and in the presence of rounding errors.
+ */
+template<typename T, int N, int M>
+inline void josephUpdate(SymmetricMatrix<T,N>& p, const Matrix<T,N,M>& k, const Matrix<T,M,N>& h, const SymmetricMatrix<T,M>& r)
+{
+  Matrix<T,N,N> a = Matrix<T,N,N>::identity();
+  a -= k*h;
+  p = congruence(a, p);
+  p += congruence(k, r);
+}
+
+/**
+ * Kalman filter measurement update with innovation test and Joseph form.
+ * @param p covariance of the state, updated if the measurement is accepted
+ * @param dx correction of the state (error state), only set if the measurement is accepted
+ * @param h measurement matrix
+ * @param innovation measurement minus predicted measurement
+ * @param r covariance of the measurement
+ * @param gate threshold for the squared Mahalanobis distance of the innovation
+ * @param distance if not null, receives the squared Mahalanobis distance
+ * @return false if the measurement was rejected or the innovation covariance is not positive definite
+ */
+template<typename T, int N, int M>
+inline bool kalmanUpdate(SymmetricMatrix<T,N>& p, Matrix<T,N,1>& dx,
+                         const Matrix<T,M,N>& h, const Matrix<T,M,1>& innovation,
+                         const SymmetricMatrix<T,M>& r, T gate, T* distance = 0)
+{
+  //innovation covariance S = H*P*H' + R
+  SymmetricMatrix<T,M> s = congruence(h, p);
+  s += r;
+  if (!ldltDecompose(s) || !ldltIsPositive(s))
+  {
+    return false;
+  }
+
+  //squared Mahalanobis distance y'*inv(S)*y
+  Matrix<T,M,1> w = innovation;
+  ldltSolve(s, w);
+  T d2 = 0;
+  for (int i = 0; i < M; i++)
+  {
+    d2 += innovation[i]*w[i];
+  }
+  if (distance)
+  {
+    *distance = d2;
+  }
+  if (d2 > gate)
+  {
+    return false;
+  }
+
+  //gain K = P*H'*inv(S), computed as K' = inv(S)*H*P
+  const Matrix<T,N,M> pht = multiplyTransposed(p.toMatrix(), h);
+  Matrix<T,M,N> kt = pht.transpose();
+  ldltSolve(s, kt);
+  const Matrix<T,N,M> k = kt.transpose();
+
+  //error state dx = K*y = P*H'*inv(S)*y
+  dx = pht*w;
+
+  josephUpdate(p, k, h, r);
+  return true;
+}
+
+#endif//___MATRIX_H
@@ -0,0 +1,889 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Fusion state and position snapshots independent of the D-Bus binding
+*
+* \author Marco Residori <marco.residori@xse.de>
+*         agent <agent@local>
+*
+* \copyright Copyright (C) 2014, XS Embedded GmbH
+*            Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <time.h>
+#include "position-core.h"
+#include "position-shm.h"
+#include "log.h"
+
+DLT_IMPORT_CONTEXT(gCtx);
+
+//the callbacks of the GNSS and sensors service are invoked from different threads
+static pthread_mutex_t mutexFusion = PTHREAD_MUTEX_INITIALIZER;
+static FusionEngine gFusion;
+
+#define EARTH_RADIUS 6371000.0
+
+//offset between CLOCK_MONOTONIC and the time base of the GNSS/sensor timestamps,
+//estimated as the minimum of (arrival time - timestamp) within a time window
+#define CLOCK_OFFSET_WINDOW 10000
+//offsets up to this value are considered as transport delay within the same time base
+#define CLOCK_OFFSET_SAME_TIMEBASE 1000
+static int64_t gClockOffset = 0;
+static uint64_t gClockOffsetTime = 0;
+static bool gClockOffsetValid = false;
+
+//incremented with each batch of input data, i.e. whenever the position may have changed
+static uint64_t gInputEpoch = 0;
+
+uint64_t getMonotonicTime()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000 + ts.tv_nsec/1000000;
+}
+
+//must be called with mutexFusion locked
+static void updateClockOffset(uint64_t timestamp)
+{
+  uint64_t now = getMonotonicTime();
+  int64_t offset = (int64_t)(now - timestamp);
+
+  if (!gClockOffsetValid || (offset < gClockOffset) || (now - gClockOffsetTime > CLOCK_OFFSET_WINDOW))
+  {
+    gClockOffset = offset;
+    gClockOffsetTime = now;
+    gClockOffsetValid = true;
+  }
+}
+
+//current time in the time base of the GNSS/sensor timestamps
+//must be called with mutexFusion locked
+static uint64_t getRequestTime()
+{
+  uint64_t now = getMonotonicTime();
+
+  if (gClockOffsetValid && ((gClockOffset < 0) || (gClockOffset > CLOCK_OFFSET_SAME_TIMEBASE)))
+  {
+    //e.g. log replay: the newest data is considered as current
+    return now - gClockOffset;
+  }
+  return now;
+}
+
+bool getFusedPosition(TFusionPosition& fused)
+{
+  pthread_mutex_lock(&mutexFusion);
+  bool retval = gFusion.getPosition(fused);
+  pthread_mutex_unlock(&mutexFusion);
+  return retval;
+}
+
+//targetTimestamp 0 means the time of the request
+bool getExtrapolatedPosition(uint64_t targetTimestamp, TFusionPosition& fused)
+{
+  pthread_mutex_lock(&mutexFusion);
+  if (targetTimestamp == 0)
+  {
+    targetTimestamp = getRequestTime();
+  }
+  bool retval = gFusion.extrapolate(targetTimestamp, fused);
+  pthread_mutex_unlock(&mutexFusion);
+  return retval;
+}
+
+uint64_t getFusedChangedValues(const TFusionPosition& fused)
+{
+  uint64_t changedValues = GENIVI_ENHANCEDPOSITIONSERVICE_DR_STATUS;
+
+  if (fused.validityBits & FUSION_POSITION_LATLON_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE |
+                     GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE |
+                     GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_HPOSITION;
+  }
+  if (fused.validityBits & FUSION_POSITION_ALTITUDE_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE |
+                     GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_ALTITUDE;
+  }
+  if (fused.validityBits & FUSION_POSITION_HEADING_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_HEADING |
+                     GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_HEADING;
+  }
+  if (fused.validityBits & FUSION_POSITION_SPEED_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_SPEED |
+                     GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_SPEED;
+  }
+  if (fused.validityBits & FUSION_POSITION_CLIMB_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_CLIMB;
+  }
+  if (fused.validityBits & FUSION_POSITION_YAWRATE_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_YAW_RATE;
+  }
+
+  return changedValues;
+}
+
+void getSnapshotEpoch(uint64_t& epoch, uint64_t& requestTime)
+{
+  pthread_mutex_lock(&mutexFusion);
+  epoch = gInputEpoch;
+  requestTime = getRequestTime();
+  pthread_mutex_unlock(&mutexFusion);
+  requestTime -= requestTime % SNAPSHOT_TIME_RESOLUTION;
+}
+
+void getPositionSnapshot(uint64_t epoch, uint64_t requestTime, TPositionSnapshot& snapshot)
+{
+  snapshot.epoch = epoch;
+  snapshot.requestTime = requestTime;
+  pthread_mutex_lock(&mutexFusion);
+  snapshot.isFused = gFusion.extrapolate(requestTime, snapshot.fused);
+  pthread_mutex_unlock(&mutexFusion);
+
+  //read after the epoch: the data is at least as new as the epoch
+  memset(&snapshot.position, 0, sizeof(snapshot.position));
+  snapshot.isGNSSValid = gnssGetPosition(&snapshot.position);
+}
+
+uint64_t getSnapshotTimestamp(const TPositionSnapshot& snapshot)
+{
+  if (snapshot.isFused)
+  {
+    return snapshot.fused.timestamp;
+  }
+  if (snapshot.isGNSSValid)
+  {
+    return snapshot.position.timestamp;
+  }
+  return 0;
+}
+
+//writes the latest position, status and time into the shared memory segment
+//must be called with mutexFusion locked, this makes it the only writer
+static void publishSharedMemory()
+{
+  TEnhancedPositionRecord record;
+  TFusionPosition fused;
+  TGNSSPosition position;
+  TGNSSTime utc;
+
+  memset(&record, 0, sizeof(record));
+  memset(&position, 0, sizeof(position));
+  bool isGNSSValid = gnssGetPosition(&position);
+
+  if (gFusion.getPosition(fused))
+  {
+    record.timestamp = fused.timestamp;
+    record.latitude = fused.latitude;
+    record.longitude = fused.longitude;
+    record.altitude = fused.altitude;
+    record.heading = fused.heading;
+    record.speed = fused.speed;
+    record.climb = fused.climb;
+    record.yawRate = fused.yawRate;
+    record.sigmaHPosition = fused.sigmaHPosition;
+    record.sigmaAltitude = fused.sigmaAltitude;
+    record.sigmaHeading = fused.sigmaHeading;
+    record.sigmaSpeed = fused.sigmaSpeed;
+    record.drStatus = fused.drStatus ? 1 : 0;
+    record.validityBits = EPS_RECORD_DR_STATUS_VALID;
+    if (fused.validityBits & FUSION_POSITION_LATLON_VALID)
+    {
+      record.validityBits |= EPS_RECORD_LATLON_VALID;
+    }
+    if (fused.validityBits & FUSION_POSITION_ALTITUDE_VALID)
+    {
+      record.validityBits |= EPS_RECORD_ALTITUDE_VALID;
+    }
+    if (fused.validityBits & FUSION_POSITION_HEADING_VALID)
+    {
+      record.validityBits |= EPS_RECORD_HEADING_VALID;
+    }
+    if (fused.validityBits & FUSION_POSITION_SPEED_VALID)
+    {
+      record.validityBits |= EPS_RECORD_SPEED_VALID;
+    }
+    if (fused.validityBits & FUSION_POSITION_CLIMB_VALID)
+    {
+      record.validityBits |= EPS_RECORD_CLIMB_VALID;
+    }
+    if (fused.validityBits & FUSION_POSITION_YAWRATE_VALID)
+    {
+      record.validityBits |= EPS_RECORD_YAWRATE_VALID;
+    }
+  }
+  else if (isGNSSValid)
+  {
+    //no sensor fusion yet: plain GNSS
+    record.timestamp = position.timestamp;
+    if ((position.validityBits & GNSS_POSITION_LATITUDE_VALID) &&
+        (position.validityBits & GNSS_POSITION_LONGITUDE_VALID))
+    {
+      record.latitude = position.latitude;
+      record.longitude = position.longitude;
+      record.sigmaHPosition = position.sigmaHPosition;
+      record.validityBits |= EPS_RECORD_LATLON_VALID;
+    }
+    if (position.validityBits & GNSS_POSITION_ALTITUDEMSL_VALID)
+    {
+      record.altitude = position.altitudeMSL;
+      record.sigmaAltitude = position.sigmaAltitude;
+      record.validityBits |= EPS_RECORD_ALTITUDE_VALID;
+    }
+    if (position.validityBits & GNSS_POSITION_HEADING_VALID)
+    {
+      record.heading = position.heading;
+      record.sigmaHeading = position.sigmaHeading;
+      record.validityBits |= EPS_RECORD_HEADING_VALID;
+    }
+    if (position.validityBits & GNSS_POSITION_HSPEED_VALID)
+    {
+      record.speed = position.hSpeed;
+      record.sigmaSpeed = position.sigmaHSpeed;
+      record.validityBits |= EPS_RECORD_SPEED_VALID;
+    }
+    if (position.validityBits & GNSS_POSITION_VSPEED_VALID)
+    {
+      record.climb = position.vSpeed;
+      record.validityBits |= EPS_RECORD_CLIMB_VALID;
+    }
+  }
+  else
+  {
+    return;
+  }
+
+  if (isGNSSValid && (position.validityBits & GNSS_POSITION_STAT_VALID))
+  {
+    record.fixStatus = position.fixStatus;
+    record.validityBits |= EPS_RECORD_FIX_STATUS_VALID;
+  }
+  if (isGNSSValid && (position.validityBits & GNSS_POSITION_USYS_VALID))
+  {
+    record.usedSystems = position.usedSystems;
+    record.validityBits |= EPS_RECORD_USED_SYSTEMS_VALID;
+  }
+
+  memset(&utc, 0, sizeof(utc));
+  if (gFusion.getPosition(fused) && (fused.validityBits & FUSION_POSITION_UTC_VALID))
+  {
+    //date/time of the fused position
+    time_t seconds = (time_t)(fused.utcTime/1000);
+    struct tm tm;
+    if (gmtime_r(&seconds, &tm))
+    {
+      record.timeTimestamp = fused.timestamp;
+      record.year = tm.tm_year + 1900;
+      record.month = tm.tm_mon + 1;
+      record.day = tm.tm_mday;
+      record.hour = tm.tm_hour;
+      record.minute = tm.tm_min;
+      record.second = tm.tm_sec;
+      record.ms = fused.utcTime % 1000;
+      record.validityBits |= EPS_RECORD_DATE_VALID | EPS_RECORD_TIME_VALID;
+    }
+  }
+  else if (gnssGetTime(&utc))
+  {
+    record.timeTimestamp = utc.timestamp;
+    if (utc.validityBits & GNSS_TIME_DATE_VALID)
+    {
+      record.year = utc.year;
+      //the GNSS service counts the months from 0 like struct tm
+      record.month = utc.month + 1;
+      record.day = utc.day;
+      record.validityBits |= EPS_RECORD_DATE_VALID;
+    }
+    if (utc.validityBits & GNSS_TIME_TIME_VALID)
+    {
+      record.hour = utc.hour;
+      record.minute = utc.minute;
+      record.second = utc.second;
+      record.ms = utc.ms;
+      record.validityBits |= EPS_RECORD_TIME_VALID;
+    }
+  }
+
+  epsShmPublish(&record);
+}
+
+uint64_t getGNSSChangedValues(const TGNSSPosition position[], uint16_t numElements)
+{
+  uint32_t validityBits = 0;
+  uint64_t changedValues = 0;
+
+  for (int i = 0; i < numElements; i++)
+  {
+    validityBits |= position[i].validityBits;
+  }
+
+  //the positions have already been passed to the fusion engine,
+  //so the fused values and their accuracy have changed as well
+  TFusionPosition fused;
+  if (getFusedPosition(fused))
+  {
+    changedValues |= getFusedChangedValues(fused);
+  }
+
+  if (validityBits & GNSS_POSITION_LATITUDE_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE;
+  }
+  if (validityBits & GNSS_POSITION_LONGITUDE_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE;
+  }
+  if (validityBits & GNSS_POSITION_ALTITUDEMSL_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE;
+  }
+  if (validityBits & GNSS_POSITION_HSPEED_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_SPEED;
+  }
+  if (validityBits & GNSS_POSITION_HEADING_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_HEADING;
+  }
+  if (validityBits & GNSS_POSITION_VSPEED_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_CLIMB;
+  }
+  if (validityBits & GNSS_POSITION_PDOP_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_PDOP;
+  }
+  if (validityBits & GNSS_POSITION_HDOP_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_HDOP;
+  }
+  if (validityBits & GNSS_POSITION_VDOP_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_VDOP;
+  }
+  if (validityBits & GNSS_POSITION_USAT_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_USED_SATELLITES;
+  }
+  if (validityBits & GNSS_POSITION_STAT_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_GNSS_FIX_STATUS;
+  }
+  if (validityBits & GNSS_POSITION_USYS_VALID)
+  {
+    changedValues |= GENIVI_ENHANCEDPOSITIONSERVICE_USED_SATELLITESYSTEMS;
+  }
+
+  return changedValues;
+}
+
+void processGNSSPositions(const TGNSSPosition position[], uint16_t numElements)
+{
+  if (position == NULL)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&mutexFusion);
+  for (int i = 0; i<numElements; i++)
+  {
+    gFusion.processGNSSPosition(position[i]);
+  }
+  if (numElements > 0)
+  {
+    updateClockOffset(position[numElements-1].timestamp);
+  }
+  gInputEpoch++;
+  publishSharedMemory();
+  pthread_mutex_unlock(&mutexFusion);
+}
+
+void processAcceleration(const TAccelerationData accelerationData[], uint16_t numElements)
+{
+  pthread_mutex_lock(&mutexFusion);
+  for (int i = 0; i<numElements; i++)
+  {
+    gFusion.processAcceleration(accelerationData[i]);
+  }
+  if (numElements > 0)
+  {
+    updateClockOffset(accelerationData[numElements-1].timestamp);
+  }
+  gInputEpoch++;
+  pthread_mutex_unlock(&mutexFusion);
+}
+
+bool processGyroscope(const TGyroscopeData gyroData[], uint16_t numElements, TFusionPosition& fused)
+{
+  pthread_mutex_lock(&mutexFusion);
+  for (int i = 0; i<numElements; i++)
+  {
+    gFusion.processGyroscope(gyroData[i]);
+  }
+  if (numElements > 0)
+  {
+    updateClockOffset(gyroData[numElements-1].timestamp);
+  }
+  gInputEpoch++;
+  bool isFused = gFusion.getPosition(fused);
+  publishSharedMemory();
+  pthread_mutex_unlock(&mutexFusion);
+
+  return isFused;
+}
+
+void processVehicleSpeed(const TVehicleSpeedData vehicleSpeedData[], uint16_t numElements)
+{
+  pthread_mutex_lock(&mutexFusion);
+  for (int i = 0; i<numElements; i++)
+  {
+    gFusion.processVehicleSpeed(vehicleSpeedData[i]);
+  }
+  if (numElements > 0)
+  {
+    updateClockOffset(vehicleSpeedData[numElements-1].timestamp);
+  }
+  gInputEpoch++;
+  pthread_mutex_unlock(&mutexFusion);
+}
+
+void processOdometer(const TOdometerData odometerData[], uint16_t numElements)
+{
+  pthread_mutex_lock(&mutexFusion);
+  for (int i = 0; i<numElements; i++)
+  {
+    gFusion.processOdometer(odometerData[i]);
+  }
+  if (numElements > 0)
+  {
+    updateClockOffset(odometerData[numElements-1].timestamp);
+  }
+  gInputEpoch++;
+  pthread_mutex_unlock(&mutexFusion);
+}
+
+void processGNSSTime(const TGNSSTime time[], uint16_t numElements)
+{
+  if (time == NULL)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&mutexFusion);
+  for (int i = 0; i<numElements; i++)
+  {
+    gFusion.processGNSSTime(time[i]);
+  }
+  if (numElements > 0)
+  {
+    updateClockOffset(time[numElements-1].timestamp);
+  }
+  gInputEpoch++;
+  pthread_mutex_unlock(&mutexFusion);
+}
+
+void resetPositionCore()
+{
+  pthread_mutex_lock(&mutexFusion);
+  gFusion.reset();
+  gClockOffsetValid = false;
+  gInputEpoch++;
+  pthread_mutex_unlock(&mutexFusion);
+}
+
+void registerPositionCallbacks(const TPositionCallbacks& callbacks)
+{
+  if (!gnssRegisterPositionCallback(callbacks.position))
+      LOG_ERROR_MSG(gCtx,"Position Callback not registered");
+  if (!gnssRegisterSatelliteDetailCallback(callbacks.satelliteDetail))
+      LOG_ERROR_MSG(gCtx,"SatelliteDetail Callback not registered");
+  if (!gnssRegisterTimeCallback(callbacks.time))
+      LOG_ERROR_MSG(gCtx,"Time Callback not registered");
+  if (!snsGyroscopeRegisterCallback(callbacks.gyroscope))
+      LOG_ERROR_MSG(gCtx,"Gyroscope Callback not registered");
+  if (!snsAccelerationRegisterCallback(callbacks.acceleration))
+      LOG_ERROR_MSG(gCtx,"Acceleration Callback not registered");
+  if (!snsVehicleSpeedRegisterCallback(callbacks.vehicleSpeed))
+      LOG_ERROR_MSG(gCtx,"VehicleSpeed Callback not registered");
+  if (!snsOdometerRegisterCallback(callbacks.odometer))
+      LOG_ERROR_MSG(gCtx,"Odometer Callback not registered");
+}
+
+void deregisterPositionCallbacks(const TPositionCallbacks& callbacks)
+{
+  gnssDeregisterPositionCallback(callbacks.position);
+  gnssDeregisterSatelliteDetailCallback(callbacks.satelliteDetail);
+  gnssDeregisterTimeCallback(callbacks.time);
+  snsGyroscopeDeregisterCallback(callbacks.gyroscope);
+  snsAccelerationDeregisterCallback(callbacks.acceleration);
+  snsVehicleSpeedDeregisterCallback(callbacks.vehicleSpeed);
+  snsOdometerDeregisterCallback(callbacks.odometer);
+
+  resetPositionCore();
+}
+
+void getSnapshotCourse(const TPositionSnapshot& snapshot, TSnapshotCourse& course)
+{
+  memset(&course, 0, sizeof(course));
+  if (snapshot.isFused)
+  {
+    course.isPositionValid = (snapshot.fused.validityBits & FUSION_POSITION_LATLON_VALID) != 0;
+    course.latitude = snapshot.fused.latitude;
+    course.longitude = snapshot.fused.longitude;
+    course.isHeadingValid = (snapshot.fused.validityBits & FUSION_POSITION_HEADING_VALID) != 0;
+    course.heading = snapshot.fused.heading;
+  }
+  else if (snapshot.isGNSSValid)
+  {
+    course.isPositionValid = (snapshot.position.validityBits & GNSS_POSITION_LATITUDE_VALID) &&
+                             (snapshot.position.validityBits & GNSS_POSITION_LONGITUDE_VALID);
+    course.latitude = snapshot.position.latitude;
+    course.longitude = snapshot.position.longitude;
+    course.isHeadingValid = (snapshot.position.validityBits & GNSS_POSITION_HEADING_VALID) != 0;
+    course.heading = snapshot.position.heading;
+  }
+}
+
+//equirectangular approximation, accurate enough for the distances of a change threshold [m]
+static double getDistance(double latitude1, double longitude1, double latitude2, double longitude2)
+{
+  double dLongitude = longitude2 - longitude1;
+  if (dLongitude > 180.0)
+  {
+    dLongitude -= 360.0;
+  }
+  else if (dLongitude < -180.0)
+  {
+    dLongitude += 360.0;
+  }
+  double x = dLongitude*M_PI/180.0*cos((latitude1 + latitude2)*M_PI/360.0);
+  double y = (latitude2 - latitude1)*M_PI/180.0;
+  return EARTH_RADIUS*sqrt(x*x + y*y);
+}
+
+//absolute heading difference, 0..180 [degree]
+static double getHeadingChange(double heading1, double heading2)
+{
+  double change = fabs(fmod(heading2 - heading1, 360.0));
+  return change > 180.0 ? 360.0 - change : change;
+}
+
+void initSubscription(TSubscription& subscription, const char* sender, uint64_t valuesToReturn,
+                      uint16_t maxRate, double minDistance, double minHeadingChange)
+{
+  subscription.id = 0;
+  subscription.sender = sender ? sender : "";
+  subscription.valuesToReturn = valuesToReturn;
+  subscription.minInterval = (maxRate > 0) ? 1000/maxRate : 0;
+  subscription.minDistance = minDistance;
+  subscription.minHeadingChange = minHeadingChange;
+  subscription.changedValues = 0;
+  subscription.lastEmission = 0;
+  subscription.isLastPositionValid = false;
+  subscription.lastLatitude = 0;
+  subscription.lastLongitude = 0;
+  subscription.isLastHeadingValid = false;
+  subscription.lastHeading = 0;
+}
+
+ESubscriptionCheck checkSubscription(TSubscription& subscription, uint64_t changedValues,
+                                     const TSnapshotCourse& course, uint64_t now)
+{
+  //collect the changes of the suppressed updates for the next emission
+  subscription.changedValues |= changedValues & subscription.valuesToReturn;
+  if (subscription.changedValues == 0)
+  {
+    return SUBSCRIPTION_UNCHANGED;
+  }
+
+  if ((subscription.lastEmission != 0) && (now - subscription.lastEmission < subscription.minInterval))
+  {
+    return SUBSCRIPTION_SUPPRESSED;
+  }
+
+  //with thresholds, one of them must be exceeded
+  if ((subscription.minDistance > 0) || (subscription.minHeadingChange > 0))
+  {
+    bool isExceeded = false;
+    if ((subscription.minDistance > 0) && course.isPositionValid)
+    {
+      isExceeded = !subscription.isLastPositionValid ||
+                   (getDistance(subscription.lastLatitude, subscription.lastLongitude,
+                                course.latitude, course.longitude) >= subscription.minDistance);
+    }
+    if ((subscription.minHeadingChange > 0) && course.isHeadingValid && !isExceeded)
+    {
+      isExceeded = !subscription.isLastHeadingValid ||
+                   (getHeadingChange(subscription.lastHeading, course.heading) >= subscription.minHeadingChange);
+    }
+    if (!isExceeded)
+    {
+      return SUBSCRIPTION_SUPPRESSED;
+    }
+  }
+
+  return SUBSCRIPTION_NOTIFY;
+}
+
+void resetSubscription(TSubscription& subscription, const TSnapshotCourse& course, uint64_t now)
+{
+  subscription.changedValues = 0;
+  subscription.lastEmission = now;
+  if (course.isPositionValid)
+  {
+    subscription.isLastPositionValid = true;
+    subscription.lastLatitude = course.latitude;
+    subscription.lastLongitude = course.longitude;
+  }
+  if (course.isHeadingValid)
+  {
+    subscription.isLastHeadingValid = true;
+    subscription.lastHeading = course.heading;
+  }
+}
+
+SubscriptionList::SubscriptionList()
+  : mNextId(1)
+  , mEmissions(0)
+  , mSuppressions(0)
+{
+  pthread_mutex_init(&mMutex, NULL);
+}
+
+SubscriptionList::~SubscriptionList()
+{
+  pthread_mutex_destroy(&mMutex);
+}
+
+uint32_t SubscriptionList::add(const char* sender, uint64_t valuesToReturn, uint16_t maxRate, double minDistance, double minHeadingChange)
+{
+  TSubscription subscription;
+  initSubscription(subscription, sender, valuesToReturn, maxRate, minDistance, minHeadingChange);
+
+  pthread_mutex_lock(&mMutex);
+  if (mSubscriptions.size() >= SUBSCRIPTIONS_MAX)
+  {
+    pthread_mutex_unlock(&mMutex);
+    return 0;
+  }
+  subscription.id = mNextId++;
+  mSubscriptions.push_back(subscription);
+  pthread_mutex_unlock(&mMutex);
+
+  LOG_INFO(gCtx,"Subscribe: id=%u sender=%s valuesToReturn=0x%llx maxRate=%u minDistance=%.1f minHeadingChange=%.1f",
+           subscription.id,
+           subscription.sender.c_str(),
+           (unsigned long long)valuesToReturn,
+           maxRate,
+           minDistance,
+           minHeadingChange);
+
+  return subscription.id;
+}
+
+bool SubscriptionList::remove(uint32_t id, const char* sender)
+{
+  bool isRemoved = false;
+
+  if (!sender)
+  {
+    return false;
+  }
+
+  pthread_mutex_lock(&mMutex);
+  for (std::vector< TSubscription >::iterator it = mSubscriptions.begin(); it != mSubscriptions.end(); ++it)
+  {
+    if ((it->id == id) && (it->sender == sender))
+    {
+      mSubscriptions.erase(it);
+      isRemoved = true;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&mMutex);
+
+  if (isRemoved)
+  {
+    LOG_INFO(gCtx,"Unsubscribe: id=%u", id);
+  }
+  return isRemoved;
+}
+
+void SubscriptionList::removeSender(const char* sender)
+{
+  if (!sender)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&mMutex);
+  std::vector< TSubscription >::iterator it = mSubscriptions.begin();
+  while (it != mSubscriptions.end())
+  {
+    if (it->sender == sender)
+    {
+      LOG_INFO(gCtx,"Subscription %u removed: %s has left the bus", it->id, sender);
+      it = mSubscriptions.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  pthread_mutex_unlock(&mMutex);
+}
+
+void SubscriptionList::logStatistics()
+{
+  pthread_mutex_lock(&mMutex);
+  LOG_INFO(gCtx,"Subscription statistics: subscriptions=%u filteredEmissions=%llu suppressed=%llu",
+           (unsigned int)mSubscriptions.size(),
+           (unsigned long long)mEmissions,
+           (unsigned long long)mSuppressions);
+  mEmissions = 0;
+  mSuppressions = 0;
+  pthread_mutex_unlock(&mMutex);
+}
+
+bool isStatisticsDue(uint64_t& statisticsTime, uint64_t now)
+{
+  if (statisticsTime == 0)
+  {
+    statisticsTime = now;
+    return false;
+  }
+  if (now - statisticsTime < PUBLISH_STATISTICS_PERIOD)
+  {
+    return false;
+  }
+  statisticsTime = now;
+  return true;
+}
+
+void logPublishStatistics(PublishScheduler& scheduler)
+{
+  TPublishStatistics statistics;
+
+  scheduler.getStatistics(statistics, true);
+  LOG_INFO(gCtx,"Publish statistics: intervals=%llu emissions=%llu updates=%llu maxMerged=%u meanLatency=%llu ms maxLatency=%llu ms",
+           (unsigned long long)statistics.intervals,
+           (unsigned long long)statistics.emissions,
+           (unsigned long long)statistics.updates,
+           statistics.maxUpdatesPerEmission,
+           (unsigned long long)(statistics.emissions ? statistics.sumLatency/statistics.emissions : 0),
+           (unsigned long long)statistics.maxLatency);
+}
+
+void setSatelliteSystems(uint32_t satelliteSystems)
+{
+  uint32_t activateSystems = 0;
+  if (satelliteSystems & GENIVI_ENHANCEDPOSITIONSERVICE_GPS)
+  {
+      activateSystems |= GNSS_SYSTEM_GPS;
+  }
+  if (satelliteSystems & GENIVI_ENHANCEDPOSITIONSERVICE_GLONASS)
+  {
+      activateSystems |= GNSS_SYSTEM_GLONASS;
+  }
+  if (satelliteSystems & GENIVI_ENHANCEDPOSITIONSERVICE_GALILEO)
+  {
+      activateSystems |= GNSS_SYSTEM_GALILEO;
+  }
+  if (satelliteSystems & GENIVI_ENHANCEDPOSITIONSERVICE_GPS)
+  {
+      activateSystems |= GNSS_SYSTEM_BEIDOU;
+  }
+  gnssSetGNSSSystems(activateSystems);
+}
+
+void getSupportedSatelliteSystems(std::vector< uint32_t >& satelliteSystems)
+{
+  uint32_t supportedSystems;
+  TGNSSConfiguration gnssConfig = {0}; 
+
+  if (gnssGetConfiguration(&gnssConfig) && (gnssConfig.validityBits & GNSS_CONFIG_SATSYS_VALID))
+  { //assume GPS at least
+    supportedSystems = gnssConfig.supportedSystems;
+  }
+  else    
+  { //assume GPS at least
+    supportedSystems = GNSS_SYSTEM_GPS;
+  }
+  
+  //test hack: add GLONASS to have 2 systems
+  supportedSystems = supportedSystems|GNSS_SYSTEM_GLONASS;
+
+  if (supportedSystems & GNSS_SYSTEM_GPS)
+  {
+    satelliteSystems.push_back(GENIVI_ENHANCEDPOSITIONSERVICE_GPS);
+  }
+  if (supportedSystems & GNSS_SYSTEM_GLONASS)
+  {
+    satelliteSystems.push_back(GENIVI_ENHANCEDPOSITIONSERVICE_GLONASS);
+  }
+  if (supportedSystems & GNSS_SYSTEM_GALILEO)
+  {
+    satelliteSystems.push_back(GENIVI_ENHANCEDPOSITIONSERVICE_GALILEO);
+  }
+  if (supportedSystems & GNSS_SYSTEM_BEIDOU)
+  {
+    satelliteSystems.push_back(GENIVI_ENHANCEDPOSITIONSERVICE_COMPASS);
+  }
+}
+
+void getSupportedUpdateIntervals(std::vector< int32_t >& updateIntervals)
+{
+  updateIntervals.push_back(100);
+  updateIntervals.push_back(200);
+  updateIntervals.push_back(500);
+  updateIntervals.push_back(1000);
+  updateIntervals.push_back(1500);
+}
+
+void getTimeSnapshot(TGNSSTime& utc)
+{
+  if (!gnssGetTime(&utc))
+  {
+    memset(&utc, 0, sizeof(utc));
+  }
+}
+
+uint64_t getSatelliteSnapshot(TGNSSSatelliteDetail details[], uint16_t& numDetails)
+{
+  uint64_t timestamp = 0;
+
+  numDetails = 0;
+  if (!gnssGetSatelliteDetails(details, SATELLITE_DETAILS_MAX, &numDetails))
+  {
+    numDetails = 0;
+    return 0;
+  }
+
+  for (uint16_t i = 0; i < numDetails; i++)
+  {
+    if (details[i].timestamp > timestamp)
+    {
+      timestamp = details[i].timestamp;
+    }
+  }
+
+  return timestamp;
+}
@@ -0,0 +1,545 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Fusion state and position snapshots independent of the D-Bus binding
+*
+* \details The GNSS and sensor callbacks pass their data to the functions of
+* this module, which feed the fusion engine and the shared memory segment.
+* The D-Bus backends (dbus-c++ and sd-bus) take snapshots of the position
+* and serialize them with their own writer class. A writer provides
+* addDouble, addUint8, addUint16, addInt16, addInt32, addUint32 and addBool,
+* each taking the key of the a{tv} dictionary and the value.
+* The registration of the callbacks, the subscriptions of FilteredPositionUpdate
+* and the publish statistics are shared by the backends as well, so a backend
+* only implements the bus vtable and the marshalling.
+*
+* \author Marco Residori <marco.residori@xse.de>
+*         agent <agent@local>
+*
+* \copyright Copyright (C) 2014, XS Embedded GmbH
+*            Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+#ifndef ___POSITION_CORE_H
+#define ___POSITION_CORE_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+#include "gnss.h"
+#include "acceleration.h"
+#include "gyroscope.h"
+#include "vehicle-speed.h"
+#include "odometer.h"
+#include "fusion-engine.h"
+#include "publish-scheduler.h"
+#include "positioning-constants.h"
+
+//maximum number of satellites of one GNSS epoch
+#define SATELLITE_DETAILS_MAX 64
+
+//GetPositionInfo extrapolates to the request time rounded down to this resolution [ms],
+//so the requests within this time and the same epoch can share their reply
+#define SNAPSHOT_TIME_RESOLUTION 10
+
+//shortest update interval [ms]: the maximum notification rate of the EnhancedPosition interface is 10Hz
+#define MIN_UPDATE_INTERVAL 100
+#define MAX_UPDATE_INTERVAL 60000
+
+//maximum number of position subscriptions of all clients
+#define SUBSCRIPTIONS_MAX 32
+
+//period of the publish statistics in the log [ms]
+#define PUBLISH_STATISTICS_PERIOD 10000
+
+//match rule for the bus names which have lost their owner, i.e. disconnected clients
+#define NAME_LOST_MATCH_RULE "type='signal',sender='org.freedesktop.DBus',interface='org.freedesktop.DBus',member='NameOwnerChanged',arg2=''"
+
+//state of the input data (epoch) and everything needed to answer GetPositionInfo for it
+typedef struct TPositionSnapshot
+{
+  uint64_t epoch;           //number of input batches passed to the fusion engine
+  uint64_t requestTime;     //time of the request, multiple of SNAPSHOT_TIME_RESOLUTION
+  bool isFused;
+  TFusionPosition fused;    //extrapolated to requestTime
+  bool isGNSSValid;
+  TGNSSPosition position;
+} TPositionSnapshot;
+
+//horizontal position and heading of a snapshot, for the change thresholds of the subscriptions
+typedef struct
+{
+  bool isPositionValid;
+  double latitude;
+  double longitude;
+  bool isHeadingValid;
+  double heading;
+} TSnapshotCourse;
+
+//filter of a client for FilteredPositionUpdate, see Subscribe
+typedef struct
+{
+  uint32_t id;
+  std::string sender;         //unique bus name of the subscriber
+  uint64_t valuesToReturn;
+  uint64_t minInterval;       //[ms], from maxRate
+  double minDistance;         //[m]
+  double minHeadingChange;    //[degree]
+  uint64_t changedValues;     //changed since the previous emission
+  uint64_t lastEmission;      //[ms], monotonic time
+  bool isLastPositionValid;
+  double lastLatitude;
+  double lastLongitude;
+  bool isLastHeadingValid;
+  double lastHeading;
+} TSubscription;
+
+//result of checkSubscription
+typedef enum
+{
+  SUBSCRIPTION_UNCHANGED,     //none of the values of the subscription has changed
+  SUBSCRIPTION_SUPPRESSED,    //changed, but within the rate limit or the thresholds
+  SUBSCRIPTION_NOTIFY         //send FilteredPositionUpdate with subscription.changedValues
+} ESubscriptionCheck;
+
+//callbacks of a backend for the GNSS and the sensors service
+typedef struct
+{
+  GNSSPositionCallback position;
+  GNSSSatelliteDetailCallback satelliteDetail;
+  GNSSTimeCallback time;
+  GyroscopeCallback gyroscope;
+  AccelerationCallback acceleration;
+  VehicleSpeedCallback vehicleSpeed;
+  OdometerCallback odometer;
+} TPositionCallbacks;
+
+/**
+ * CLOCK_MONOTONIC [ms]
+ */
+uint64_t getMonotonicTime();
+
+/**
+ * Input data from the GNSS and sensor callbacks.
+ * May be called from different threads.
+ */
+void processGNSSPositions(const TGNSSPosition position[], uint16_t numElements);
+void processAcceleration(const TAccelerationData accelerationData[], uint16_t numElements);
+void processVehicleSpeed(const TVehicleSpeedData vehicleSpeedData[], uint16_t numElements);
+void processOdometer(const TOdometerData odometerData[], uint16_t numElements);
+void processGNSSTime(const TGNSSTime time[], uint16_t numElements);
+
+/**
+ * Gyroscope input data, which propagates the fused position
+ * @param fused the fused position after the update
+ * @return true if fused is valid
+ */
+bool processGyroscope(const TGyroscopeData gyroData[], uint16_t numElements, TFusionPosition& fused);
+
+/**
+ * Forget the fusion state, e.g. after the callbacks have been deregistered
+ */
+void resetPositionCore();
+
+/**
+ * Register the callbacks of a backend at the GNSS and the sensors service,
+ * a callback which cannot be registered is logged
+ */
+void registerPositionCallbacks(const TPositionCallbacks& callbacks);
+
+/**
+ * Deregister the callbacks of a backend and forget the fusion state
+ */
+void deregisterPositionCallbacks(const TPositionCallbacks& callbacks);
+
+/**
+ * Current fused position, without extrapolation
+ */
+bool getFusedPosition(TFusionPosition& fused);
+
+/**
+ * Fused position extrapolated to the given time
+ * @param targetTimestamp time base of the GNSS/sensor timestamps, 0 means the time of the request
+ */
+bool getExtrapolatedPosition(uint64_t targetTimestamp, TFusionPosition& fused);
+
+/**
+ * changedValues of the PositionUpdate signal for the valid fused values
+ */
+uint64_t getFusedChangedValues(const TFusionPosition& fused);
+
+/**
+ * changedValues of the PositionUpdate signal for a batch of GNSS positions,
+ * which have already been passed to processGNSSPositions()
+ */
+uint64_t getGNSSChangedValues(const TGNSSPosition position[], uint16_t numElements);
+
+/**
+ * Current input epoch and request time for a snapshot.
+ * Snapshots with the same epoch and request time contain the same data.
+ */
+void getSnapshotEpoch(uint64_t& epoch, uint64_t& requestTime);
+
+void getPositionSnapshot(uint64_t epoch, uint64_t requestTime, TPositionSnapshot& snapshot);
+
+uint64_t getSnapshotTimestamp(const TPositionSnapshot& snapshot);
+
+void getSnapshotCourse(const TPositionSnapshot& snapshot, TSnapshotCourse& course);
+
+void initSubscription(TSubscription& subscription, const char* sender, uint64_t valuesToReturn,
+                      uint16_t maxRate, double minDistance, double minHeadingChange);
+
+/**
+ * Apply the rate limit and the change thresholds of a subscription to an update.
+ * The changed values are accumulated until the subscriber is notified.
+ * @param now monotonic time [ms]
+ */
+ESubscriptionCheck checkSubscription(TSubscription& subscription, uint64_t changedValues,
+                                     const TSnapshotCourse& course, uint64_t now);
+
+/**
+ * Start a new interval of a subscription after FilteredPositionUpdate has been sent
+ */
+void resetSubscription(TSubscription& subscription, const TSnapshotCourse& course, uint64_t now);
+
+/**
+ * Subscriptions of all clients for FilteredPositionUpdate.
+ * The bus handlers add and remove the subscriptions, notify() is called
+ * after each PositionUpdate, possibly from another thread.
+ */
+class SubscriptionList
+{
+public:
+
+  SubscriptionList();
+
+  ~SubscriptionList();
+
+  /**
+   * @param sender unique bus name of the subscriber
+   * @return id of the new subscription, 0 if SUBSCRIPTIONS_MAX is reached
+   */
+  uint32_t add(const char* sender, uint64_t valuesToReturn, uint16_t maxRate, double minDistance, double minHeadingChange);
+
+  /**
+   * A client can only remove its own subscriptions
+   * @return false if the sender has no subscription with this id
+   */
+  bool remove(uint32_t id, const char* sender);
+
+  /**
+   * Remove the subscriptions of a client which has left the bus
+   */
+  void removeSender(const char* sender);
+
+  /**
+   * Calls emitter.fireFilteredPositionUpdate(subscription, snapshot) for each
+   * subscription whose rate limit and thresholds let the update pass.
+   * subscription.changedValues contains the changes since its previous emission.
+   */
+  template<class Emitter>
+  void notify(uint64_t changedValues, const TPositionSnapshot& snapshot, Emitter& emitter)
+  {
+    TSnapshotCourse course;
+    uint64_t now = getMonotonicTime();
+
+    getSnapshotCourse(snapshot, course);
+
+    pthread_mutex_lock(&mMutex);
+    for (size_t i = 0; i < mSubscriptions.size(); i++)
+    {
+      TSubscription& subscription = mSubscriptions[i];
+
+      ESubscriptionCheck check = checkSubscription(subscription, changedValues, course, now);
+      if (check == SUBSCRIPTION_SUPPRESSED)
+      {
+        mSuppressions++;
+      }
+      if (check != SUBSCRIPTION_NOTIFY)
+      {
+        continue;
+      }
+
+      emitter.fireFilteredPositionUpdate(subscription, snapshot);
+      mEmissions++;
+
+      resetSubscription(subscription, course, now);
+    }
+    pthread_mutex_unlock(&mMutex);
+  }
+
+  /**
+   * Log the number of subscriptions and of the filtered emissions since the previous call
+   */
+  void logStatistics();
+
+private:
+
+  pthread_mutex_t mMutex;
+  std::vector< TSubscription > mSubscriptions;
+  uint32_t mNextId;
+  uint64_t mEmissions;
+  uint64_t mSuppressions;
+};
+
+/**
+ * Check for the end of a statistics period of PUBLISH_STATISTICS_PERIOD
+ * @param statisticsTime start of the current period, 0 before the first call
+ * @param now monotonic time [ms]
+ * @return true if the statistics are due, a new period has been started
+ */
+bool isStatisticsDue(uint64_t& statisticsTime, uint64_t now);
+
+/**
+ * Log the statistics of a publish scheduler and start a new statistics period of the scheduler
+ */
+void logPublishStatistics(PublishScheduler& scheduler);
+
+/**
+ * Configuration::SatelliteSystem: activate the requested GNSS systems
+ * @param satelliteSystems [bitwise or'ed GENIVI_ENHANCEDPOSITIONSERVICE_* satellite systems]
+ */
+void setSatelliteSystems(uint32_t satelliteSystems);
+
+/**
+ * Supported values of Configuration::SatelliteSystem
+ */
+void getSupportedSatelliteSystems(std::vector< uint32_t >& satelliteSystems);
+
+/**
+ * Supported values of Configuration::UpdateInterval [ms]
+ */
+void getSupportedUpdateIntervals(std::vector< int32_t >& updateIntervals);
+
+template<class Writer>
+void addFusedValues(uint64_t valuesToReturn, const TFusionPosition& fused, Writer& writer)
+{
+  if (fused.validityBits & FUSION_POSITION_LATLON_VALID)
+  {
+    if (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE)
+    {
+      writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE, fused.latitude);
+    }
+    if (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE)
+    {
+      writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE, fused.longitude);
+    }
+    if (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_HPOSITION)
+    {
+      writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_HPOSITION, fused.sigmaHPosition);
+    }
+  }
+
+  if (fused.validityBits & FUSION_POSITION_ALTITUDE_VALID)
+  {
+    if (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE)
+    {
+      writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE, fused.altitude);
+    }
+    if (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_ALTITUDE)
+    {
+      writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_ALTITUDE, fused.sigmaAltitude);
+    }
+  }
+
+  if (fused.validityBits & FUSION_POSITION_HEADING_VALID)
+  {
+    if (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_HEADING)
+    {
+      writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_HEADING, fused.heading);
+    }
+    if (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_HEADING)
+    {
+      writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_HEADING, fused.sigmaHeading);
+    }
+  }
+
+  if (fused.validityBits & FUSION_POSITION_SPEED_VALID)
+  {
+    if (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_SPEED)
+    {
+      writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_SPEED, fused.speed);
+    }
+    if (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_SPEED)
+    {
+      writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_SPEED, fused.sigmaSpeed);
+    }
+  }
+
+  if ((fused.validityBits & FUSION_POSITION_CLIMB_VALID) &&
+      (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_CLIMB))
+  {
+    writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_CLIMB, fused.climb);
+  }
+
+  if ((fused.validityBits & FUSION_POSITION_YAWRATE_VALID) &&
+      (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_YAW_RATE))
+  {
+    writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_YAW_RATE, fused.yawRate);
+  }
+
+  //always provide the dead-reckoning status and the extrapolation age
+  writer.addBool(GENIVI_ENHANCEDPOSITIONSERVICE_DR_STATUS, fused.drStatus);
+  writer.addInt32(GENIVI_ENHANCEDPOSITIONSERVICE_EXTRAPOLATION_AGE, fused.extrapolation);
+}
+
+template<class Writer>
+void addPositionInfo(uint64_t valuesToReturn, const TPositionSnapshot& snapshot, Writer& writer)
+{
+  const TGNSSPosition& position = snapshot.position;
+
+  bool isPosRequested = false;
+  bool isCourseRequested = false;
+
+  if ((valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE) ||
+      (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE) ||
+      (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE))
+  {
+    isPosRequested = true;
+  }
+
+  if ((valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_HEADING) ||
+      (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_SPEED) ||
+      (valuesToReturn & GENIVI_ENHANCEDPOSITIONSERVICE_CLIMB ))
+  {
+    isCourseRequested = true;
+  }
+
+  if (snapshot.isFused)
+  {
+    //position and course from the fusion engine extrapolated to the time of the request,
+    //status information from GNSS
+    addFusedValues(valuesToReturn, snapshot.fused, writer);
+  }
+  else if (snapshot.isGNSSValid)
+  {
+    //no sensor fusion yet: plain GNSS
+    if(isPosRequested)
+    {
+      if (position.validityBits & GNSS_POSITION_LATITUDE_VALID)
+      {
+        writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE, position.latitude);
+      }
+
+      if (position.validityBits & GNSS_POSITION_LONGITUDE_VALID)
+      {
+        writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE, position.longitude);
+      }
+
+      if (position.validityBits & GNSS_POSITION_ALTITUDEMSL_VALID)
+      {
+        writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE, position.altitudeMSL);
+      }
+    }
+
+    if(isCourseRequested)
+    {
+      if (position.validityBits & GNSS_POSITION_HEADING_VALID)
+      {
+        writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_HEADING, position.heading);
+      }
+
+      if (position.validityBits & GNSS_POSITION_HSPEED_VALID)
+      {
+        writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_SPEED, position.hSpeed);
+      }
+
+      if (position.validityBits & GNSS_POSITION_VSPEED_VALID)
+      {
+        writer.addDouble(GENIVI_ENHANCEDPOSITIONSERVICE_CLIMB, position.vSpeed);
+      }
+    }
+  }
+
+  //always provide some status information
+  if (position.validityBits & GNSS_POSITION_STAT_VALID)
+  {
+    writer.addUint16(GENIVI_ENHANCEDPOSITIONSERVICE_GNSS_FIX_STATUS, position.fixStatus);
+  }
+  if (position.validityBits & GNSS_POSITION_USYS_VALID)
+  {
+    writer.addUint32(GENIVI_ENHANCEDPOSITIONSERVICE_USED_SATELLITESYSTEMS, position.usedSystems);
+  }
+}
+
+/**
+ * Date/time from the GNSS snapshot, see GetTime
+ * @param utc set to 0 if no date/time is available
+ */
+void getTimeSnapshot(TGNSSTime& utc);
+
+/**
+ * Satellites from the GNSS snapshot, see GetSatelliteInfo
+ * @param details array with SATELLITE_DETAILS_MAX elements
+ * @return timestamp of the latest GNSS epoch, 0 if not available
+ */
+uint64_t getSatelliteSnapshot(TGNSSSatelliteDetail details[], uint16_t& numDetails);
+
+template<class Writer>
+void addTimeInfo(const TGNSSTime& utc, Writer& writer)
+{
+  if (utc.validityBits & GNSS_TIME_DATE_VALID)
+  {
+    writer.addUint16(GENIVI_ENHANCEDPOSITIONSERVICE_YEAR, utc.year);
+    //the GNSS service counts the months from 0 like struct tm
+    writer.addUint8(GENIVI_ENHANCEDPOSITIONSERVICE_MONTH, utc.month + 1);
+    writer.addUint8(GENIVI_ENHANCEDPOSITIONSERVICE_DAY, utc.day);
+  }
+  if (utc.validityBits & GNSS_TIME_TIME_VALID)
+  {
+    writer.addUint8(GENIVI_ENHANCEDPOSITIONSERVICE_HOUR, utc.hour);
+    writer.addUint8(GENIVI_ENHANCEDPOSITIONSERVICE_MINUTE, utc.minute);
+    writer.addUint8(GENIVI_ENHANCEDPOSITIONSERVICE_SECOND, utc.second);
+    writer.addUint16(GENIVI_ENHANCEDPOSITIONSERVICE_MS, utc.ms);
+  }
+  if (utc.validityBits & GNSS_TIME_SCALE_VALID)
+  {
+    writer.addUint16(GENIVI_ENHANCEDPOSITIONSERVICE_TIME_SCALE, utc.scale == GNSS_TIME_SCALE_GPS ?
+                                                                GENIVI_ENHANCEDPOSITIONSERVICE_TIME_SCALE_GPS :
+                                                                GENIVI_ENHANCEDPOSITIONSERVICE_TIME_SCALE_UTC);
+  }
+  if (utc.validityBits & GNSS_TIME_LEAPSEC_VALID)
+  {
+    writer.addInt16(GENIVI_ENHANCEDPOSITIONSERVICE_LEAP_SECONDS, utc.leapSeconds);
+  }
+}
+
+/**
+ * Calls writer.addSatellite(system, satelliteId, azimuth, elevation, cNo, inUse)
+ * for each satellite of the GNSS epoch with the given timestamp
+ */
+template<class Writer>
+void addSatelliteInfo(const TGNSSSatelliteDetail details[], uint16_t numDetails, uint64_t timestamp, Writer& writer)
+{
+  for (uint16_t i = 0; i < numDetails; i++)
+  {
+    const TGNSSSatelliteDetail& detail = details[i];
+
+    if ((detail.timestamp != timestamp) || !(detail.validityBits & GNSS_SATELLITE_ID_VALID))
+    {
+      continue;
+    }
+
+    //the SBAS systems do not fit into the 16 bit of the D-Bus API
+    writer.addSatellite(((detail.validityBits & GNSS_SATELLITE_SYSTEM_VALID) && (detail.system <= 0xFFFF)) ?
+                        (uint16_t)detail.system : (uint16_t)GENIVI_ENHANCEDPOSITIONSERVICE_INVALID,
+                        detail.satelliteId,
+                        (detail.validityBits & GNSS_SATELLITE_AZIMUTH_VALID) ? detail.azimuth : 0,
+                        (detail.validityBits & GNSS_SATELLITE_ELEVATION_VALID) ? detail.elevation : 0,
+                        (detail.validityBits & GNSS_SATELLITE_CNO_VALID) ? detail.CNo : 0,
+                        (detail.validityBits & GNSS_SATELLITE_USED_VALID) && (detail.statusBits & GNSS_SATELLITE_USED));
+  }
+}
+
+#endif//___POSITION_CORE_H
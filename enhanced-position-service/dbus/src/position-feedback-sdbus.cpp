@@ -0,0 +1,83 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief PositionFeedback interface implemented with sd-bus
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <string.h>
+#include "position-feedback-sdbus.h"
+#include "log.h"
+
+DLT_IMPORT_CONTEXT(gCtx);
+
+//same members, signatures and argument names as api/genivi-positioning-positionfeedback.xml
+const sd_bus_vtable PositionFeedbackSdBus::mVtable[] =
+{
+  SD_BUS_VTABLE_START(0),
+  SD_BUS_METHOD_WITH_NAMES("GetVersion",
+                           NULL,,
+                           "(qqqs)", SD_BUS_PARAM(version),
+                           &PositionFeedbackSdBus::onGetVersion, SD_BUS_VTABLE_UNPRIVILEGED),
+  SD_BUS_METHOD_WITH_NAMES("SetPositionFeedback",
+                           "aa{tv}tq", SD_BUS_PARAM(feedback) SD_BUS_PARAM(timestamp) SD_BUS_PARAM(feedbackType),
+                           NULL,,
+                           &PositionFeedbackSdBus::onSetPositionFeedback, SD_BUS_VTABLE_UNPRIVILEGED),
+  SD_BUS_VTABLE_END
+};
+
+PositionFeedbackSdBus::PositionFeedbackSdBus(sd_bus* bus, const char* path)
+  : mpBus(bus)
+  , mPath(path)
+  , mpVtableSlot(0)
+{
+}
+
+PositionFeedbackSdBus::~PositionFeedbackSdBus()
+{
+  sd_bus_slot_unref(mpVtableSlot);
+}
+
+bool PositionFeedbackSdBus::init()
+{
+  int r = sd_bus_add_object_vtable(mpBus, &mpVtableSlot, mPath.c_str(), POSITION_FEEDBACK_INTERFACE, mVtable, this);
+  if (r < 0)
+  {
+    LOG_ERROR(gCtx,"sd_bus_add_object_vtable failed: %s", strerror(-r));
+    return false;
+  }
+  return true;
+}
+
+int PositionFeedbackSdBus::onGetVersion(sd_bus_message* m, void* /*userdata*/, sd_bus_error* /*error*/)
+{
+  return sd_bus_reply_method_return(m, "(qqqs)", 3, 0, 0, "05-08-2014");
+}
+
+int PositionFeedbackSdBus::onSetPositionFeedback(sd_bus_message* /*m*/, void* /*userdata*/, sd_bus_error* error)
+{
+  return sd_bus_error_set(error, SD_BUS_ERROR_NOT_SUPPORTED, "Method not supported yet");
+}
+
+void PositionFeedbackSdBus::run()
+{
+  LOG_INFO_MSG(gCtx,"Starting PositionFeedback dispatcher...");
+}
+
+void PositionFeedbackSdBus::shutdown()
+{
+  LOG_INFO_MSG(gCtx,"Shutting down PositionFeedback dispatcher...");
+}
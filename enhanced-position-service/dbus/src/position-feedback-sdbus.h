@@ -0,0 +1,60 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief PositionFeedback interface implemented with sd-bus
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#ifndef ___POSITION_FEEDBACK_SDBUS_H
+#define ___POSITION_FEEDBACK_SDBUS_H
+
+#include <string>
+#include <systemd/sd-bus.h>
+
+#define POSITION_FEEDBACK_INTERFACE "org.genivi.positioning.PositionFeedback"
+
+class PositionFeedbackSdBus
+{
+
+public:
+
+  PositionFeedbackSdBus(sd_bus* bus, const char* path);
+
+  ~PositionFeedbackSdBus();
+
+  /**
+   * Register the object on the bus
+   * @return false if the vtable could not be added
+   */
+  bool init();
+
+  void run();
+
+  void shutdown();
+
+private:
+
+  static const sd_bus_vtable mVtable[];
+
+  static int onGetVersion(sd_bus_message* m, void* userdata, sd_bus_error* error);
+  static int onSetPositionFeedback(sd_bus_message* m, void* userdata, sd_bus_error* error);
+
+  sd_bus* mpBus;
+  std::string mPath;
+  sd_bus_slot* mpVtableSlot;
+};
+
+#endif//___POSITION_FEEDBACK_SDBUS_H
@@ -0,0 +1,260 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Latest enhanced position in POSIX shared memory
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "position-shm.h"
+
+#define EPS_SHM_MAGIC 0x31535045    /* "EPS1" */
+//the reader gives up if the writer seems to be stuck in an update, e.g. it has crashed
+#define EPS_SHM_READ_RETRIES 1000
+
+static TEnhancedPositionShm* gWriter = 0;
+static const TEnhancedPositionShm* gReader = 0;
+
+bool epsShmCreate()
+{
+    TEnhancedPositionShm* shm;
+    int fd;
+
+    if (gWriter)
+    {
+        return true;
+    }
+
+    //clients may only read
+    fd = shm_open(EPS_SHM_NAME, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd < 0)
+    {
+        return false;
+    }
+    if (ftruncate(fd, sizeof(TEnhancedPositionShm)) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    shm = (TEnhancedPositionShm*)mmap(0, sizeof(TEnhancedPositionShm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED)
+    {
+        return false;
+    }
+
+    //clients still attached to the segment of a previous run see a new sequence
+    __atomic_store_n(&shm->sequence, __atomic_load_n(&shm->sequence, __ATOMIC_RELAXED) | 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    shm->magic = EPS_SHM_MAGIC;
+    shm->version = EPS_SHM_VERSION;
+    shm->recordSize = sizeof(TEnhancedPositionRecord);
+    shm->historySize = EPS_SHM_HISTORY_SIZE;
+    shm->count = 0;
+    shm->active = 1;
+    memset(shm->history, 0, sizeof(shm->history));
+    __atomic_store_n(&shm->sequence, shm->sequence + 1, __ATOMIC_RELEASE);
+
+    gWriter = shm;
+    return true;
+}
+
+void epsShmPublish(const TEnhancedPositionRecord* record)
+{
+    uint32_t sequence;
+
+    if (!gWriter || !record)
+    {
+        return;
+    }
+
+    sequence = gWriter->sequence;
+    __atomic_store_n(&gWriter->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    gWriter->history[gWriter->count % EPS_SHM_HISTORY_SIZE] = *record;
+    gWriter->count++;
+
+    __atomic_store_n(&gWriter->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+void epsShmDestroy()
+{
+    uint32_t sequence;
+
+    if (!gWriter)
+    {
+        return;
+    }
+
+    sequence = gWriter->sequence;
+    __atomic_store_n(&gWriter->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    gWriter->active = 0;
+    __atomic_store_n(&gWriter->sequence, sequence + 2, __ATOMIC_RELEASE);
+
+    munmap(gWriter, sizeof(TEnhancedPositionShm));
+    shm_unlink(EPS_SHM_NAME);
+    gWriter = 0;
+}
+
+bool epsShmOpen()
+{
+    const TEnhancedPositionShm* shm;
+    struct stat st;
+    int fd;
+
+    if (gReader)
+    {
+        return true;
+    }
+
+    fd = shm_open(EPS_SHM_NAME, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+    if ((fstat(fd, &st) != 0) || (st.st_size < (off_t)sizeof(TEnhancedPositionShm)))
+    {
+        close(fd);
+        return false;
+    }
+    shm = (const TEnhancedPositionShm*)mmap(0, sizeof(TEnhancedPositionShm), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED)
+    {
+        return false;
+    }
+
+    if ((shm->magic != EPS_SHM_MAGIC) ||
+        (shm->version != EPS_SHM_VERSION) ||
+        (shm->recordSize != sizeof(TEnhancedPositionRecord)) ||
+        (shm->historySize != EPS_SHM_HISTORY_SIZE))
+    {
+        munmap((void*)shm, sizeof(TEnhancedPositionShm));
+        return false;
+    }
+
+    gReader = shm;
+    return true;
+}
+
+//begin of a read section, returns false if the writer is active
+static bool readBegin(uint32_t* sequence)
+{
+    *sequence = __atomic_load_n(&gReader->sequence, __ATOMIC_ACQUIRE);
+    return (*sequence & 1) == 0;
+}
+
+//end of a read section, returns false if the data has been changed meanwhile
+static bool readEnd(uint32_t sequence)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&gReader->sequence, __ATOMIC_RELAXED) == sequence;
+}
+
+bool epsShmGetLatest(TEnhancedPositionRecord* record)
+{
+    int retry;
+
+    if (!gReader || !record)
+    {
+        return false;
+    }
+
+    for (retry = 0; retry < EPS_SHM_READ_RETRIES; retry++)
+    {
+        uint32_t sequence;
+        uint64_t count;
+        bool active;
+
+        if (readBegin(&sequence))
+        {
+            //the copy may be torn, it is only used if the sequence has not changed
+            count = gReader->count;
+            active = gReader->active;
+            if (count > 0)
+            {
+                *record = gReader->history[(count - 1) % EPS_SHM_HISTORY_SIZE];
+            }
+            if (readEnd(sequence))
+            {
+                return active && (count > 0);
+            }
+        }
+        sched_yield();
+    }
+
+    return false;
+}
+
+bool epsShmGetHistory(TEnhancedPositionRecord* records, uint16_t count, uint16_t* numRecords)
+{
+    int retry;
+
+    if (!gReader || !records || !numRecords)
+    {
+        return false;
+    }
+
+    for (retry = 0; retry < EPS_SHM_READ_RETRIES; retry++)
+    {
+        uint32_t sequence;
+        uint64_t published;
+        uint64_t first;
+        uint16_t i;
+        bool active;
+
+        if (readBegin(&sequence))
+        {
+            published = gReader->count;
+            active = gReader->active;
+            *numRecords = (published < count) ? (uint16_t)published : count;
+            if (*numRecords > EPS_SHM_HISTORY_SIZE)
+            {
+                *numRecords = EPS_SHM_HISTORY_SIZE;
+            }
+            first = published - *numRecords;
+            for (i = 0; i < *numRecords; i++)
+            {
+                records[i] = gReader->history[(first + i) % EPS_SHM_HISTORY_SIZE];
+            }
+            if (readEnd(sequence))
+            {
+                return active;
+            }
+        }
+        sched_yield();
+    }
+
+    *numRecords = 0;
+    return false;
+}
+
+void epsShmClose()
+{
+    if (gReader)
+    {
+        munmap((void*)gReader, sizeof(TEnhancedPositionShm));
+        gReader = 0;
+    }
+}
@@ -0,0 +1,171 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Latest enhanced position in POSIX shared memory
+*
+* \details The EnhancedPositionService writes each update of the fused
+* position into a shared memory segment, together with the GNSS status,
+* the UTC time and a short history. Local clients map the segment
+* read-only and read it without any IPC, so they can poll at a high rate.
+* The writer protects the segment with a sequence lock: a reader copies
+* the data and retries if the writer has been active meanwhile, the writer
+* never waits for the readers.
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+#ifndef ___POSITION_SHM_H
+#define ___POSITION_SHM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Name of the shared memory object, see shm_open()
+ */
+#define EPS_SHM_NAME "/genivi-enhanced-position"
+
+/**
+ * Layout version of the shared memory segment.
+ * Readers refuse to attach to a segment with a different version.
+ */
+#define EPS_SHM_VERSION 1
+
+/**
+ * Number of records in the history ring
+ */
+#define EPS_SHM_HISTORY_SIZE 32
+
+/**
+ * TEnhancedPositionRecord::validityBits provides information which fields contain valid data.
+ * It is a or'ed bitmask of the EEnhancedPositionRecordValidityBits values.
+ */
+typedef enum {
+    EPS_RECORD_LATLON_VALID         = 0x00000001,   /**< latitude, longitude and sigmaHPosition */
+    EPS_RECORD_ALTITUDE_VALID       = 0x00000002,   /**< altitude and sigmaAltitude */
+    EPS_RECORD_HEADING_VALID        = 0x00000004,   /**< heading and sigmaHeading */
+    EPS_RECORD_SPEED_VALID          = 0x00000008,   /**< speed and sigmaSpeed */
+    EPS_RECORD_CLIMB_VALID          = 0x00000010,   /**< climb */
+    EPS_RECORD_YAWRATE_VALID        = 0x00000020,   /**< yawRate */
+    EPS_RECORD_DR_STATUS_VALID      = 0x00000040,   /**< drStatus */
+    EPS_RECORD_FIX_STATUS_VALID     = 0x00000080,   /**< fixStatus */
+    EPS_RECORD_USED_SYSTEMS_VALID   = 0x00000100,   /**< usedSystems */
+    EPS_RECORD_DATE_VALID           = 0x00000200,   /**< year, month, day */
+    EPS_RECORD_TIME_VALID           = 0x00000400    /**< hour, minute, second, ms */
+} EEnhancedPositionRecordValidityBits;
+
+/**
+ * One update of the enhanced position.
+ * The position is the fused position if available, otherwise the GNSS position.
+ */
+typedef struct {
+    uint64_t timestamp;         /**< Time of validity of the position [ms], same time base as the GNSS/sensor timestamps */
+    double latitude;            /**< WGS84 latitude [degree] */
+    double longitude;           /**< WGS84 longitude [degree] */
+    double altitude;            /**< Altitude above mean sea level [m] */
+    double heading;             /**< Course over ground [degree], 0 => north, 90 => east */
+    double speed;               /**< Speed [m/s] */
+    double climb;               /**< Vertical speed [m/s] */
+    double yawRate;             /**< Yaw rate [degree/s], positive for a left turn */
+    double sigmaHPosition;      /**< Standard error estimate of the horizontal position [m] */
+    double sigmaAltitude;       /**< Standard error estimate of the altitude [m] */
+    double sigmaHeading;        /**< Standard error estimate of the heading [degree] */
+    double sigmaSpeed;          /**< Standard error estimate of the speed [m/s] */
+    uint32_t usedSystems;       /**< GNSS systems used for the fix [bitwise or'ed EGNSSSystem values] */
+    uint16_t fixStatus;         /**< GNSS fix status [EGNSSFixStatus] */
+    uint8_t drStatus;           /**< 1 if the position is propagated by dead reckoning only */
+    uint8_t reserved;
+    uint64_t timeTimestamp;     /**< Timestamp of the acquisition of the UTC date/time [ms] */
+    uint16_t year;              /**< UTC year, 4 digits */
+    uint8_t month;              /**< UTC month, 1..12 */
+    uint8_t day;                /**< UTC day of month, 1..31 */
+    uint8_t hour;               /**< UTC hour, 0..23 */
+    uint8_t minute;             /**< UTC minute, 0..59 */
+    uint8_t second;             /**< UTC second, 0..60 */
+    uint8_t reserved2;
+    uint16_t ms;                /**< UTC millisecond, 0..999 */
+    uint32_t validityBits;      /**< [bitwise or'ed @ref EEnhancedPositionRecordValidityBits values] */
+} TEnhancedPositionRecord;
+
+/**
+ * Layout of the shared memory segment
+ */
+typedef struct {
+    uint32_t magic;             /**< EPS_SHM_MAGIC once the segment is initialized */
+    uint32_t version;           /**< EPS_SHM_VERSION */
+    uint32_t recordSize;        /**< sizeof(TEnhancedPositionRecord) */
+    uint32_t historySize;       /**< EPS_SHM_HISTORY_SIZE */
+    uint32_t sequence;          /**< Sequence lock: odd while the writer updates the segment */
+    uint32_t active;            /**< 1 while the service is running */
+    uint64_t count;             /**< Number of records published, the latest one is history[(count-1) % historySize] */
+    TEnhancedPositionRecord history[EPS_SHM_HISTORY_SIZE];
+} TEnhancedPositionShm;
+
+/**
+ * Server side: create and initialize the shared memory segment.
+ * @return True if the segment is available for publishing
+ */
+bool epsShmCreate();
+
+/**
+ * Server side: publish a new record.
+ * Must not be called concurrently from different threads.
+ * Does nothing if the segment has not been created.
+ * @param record the new latest record, it is also appended to the history
+ */
+void epsShmPublish(const TEnhancedPositionRecord* record);
+
+/**
+ * Server side: mark the segment as inactive and remove it.
+ * Clients which still have it mapped see that the service has stopped.
+ */
+void epsShmDestroy();
+
+/**
+ * Client side: map the shared memory segment read-only.
+ * @return False if the service is not running or the layout version does not match
+ */
+bool epsShmOpen();
+
+/**
+ * Client side: get the latest record without any IPC.
+ * @param record After calling the method the latest record is written into this parameter.
+ * @return False if the segment is not mapped, no record has been published yet or the service has stopped.
+ *         After the service has stopped, call epsShmClose() and epsShmOpen() again.
+ */
+bool epsShmGetLatest(TEnhancedPositionRecord* record);
+
+/**
+ * Client side: get the history of records.
+ * @param records After calling the method the records are written into this array with size count, the oldest first.
+ * @param count Number of elements of the array *records. Up to EPS_SHM_HISTORY_SIZE records are available.
+ * @param numRecords Number of elements written to the array *records.
+ * @return False if the segment is not mapped or the service has stopped.
+ */
+bool epsShmGetHistory(TEnhancedPositionRecord* records, uint16_t count, uint16_t* numRecords);
+
+/**
+ * Client side: unmap the shared memory segment.
+ */
+void epsShmClose();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//___POSITION_SHM_H
@@ -0,0 +1,101 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Coalescing of position updates to a fixed publish interval
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <string.h>
+#include "publish-scheduler.h"
+
+PublishScheduler::PublishScheduler()
+{
+  pthread_mutex_init(&mMutex, NULL);
+  mChangedValues = 0;
+  mUpdates = 0;
+  mFirstUpdateTime = 0;
+  memset(&mStatistics, 0, sizeof(mStatistics));
+}
+
+PublishScheduler::~PublishScheduler()
+{
+  pthread_mutex_destroy(&mMutex);
+}
+
+void PublishScheduler::reset()
+{
+  pthread_mutex_lock(&mMutex);
+  mChangedValues = 0;
+  mUpdates = 0;
+  mFirstUpdateTime = 0;
+  memset(&mStatistics, 0, sizeof(mStatistics));
+  pthread_mutex_unlock(&mMutex);
+}
+
+void PublishScheduler::post(uint64_t changedValues, uint64_t timestamp)
+{
+  pthread_mutex_lock(&mMutex);
+  if (mUpdates == 0)
+  {
+    mFirstUpdateTime = timestamp;
+  }
+  mChangedValues |= changedValues;
+  mUpdates++;
+  mStatistics.updates++;
+  pthread_mutex_unlock(&mMutex);
+}
+
+bool PublishScheduler::take(uint64_t timestamp, uint64_t& changedValues)
+{
+  bool retval = false;
+
+  pthread_mutex_lock(&mMutex);
+  mStatistics.intervals++;
+  if (mUpdates > 0)
+  {
+    uint64_t latency = (timestamp > mFirstUpdateTime) ? (timestamp - mFirstUpdateTime) : 0;
+
+    mStatistics.emissions++;
+    mStatistics.sumLatency += latency;
+    if (latency > mStatistics.maxLatency)
+    {
+      mStatistics.maxLatency = latency;
+    }
+    if (mUpdates > mStatistics.maxUpdatesPerEmission)
+    {
+      mStatistics.maxUpdatesPerEmission = mUpdates;
+    }
+
+    changedValues = mChangedValues;
+    mChangedValues = 0;
+    mUpdates = 0;
+    retval = true;
+  }
+  pthread_mutex_unlock(&mMutex);
+
+  return retval;
+}
+
+void PublishScheduler::getStatistics(TPublishStatistics& statistics, bool reset)
+{
+  pthread_mutex_lock(&mMutex);
+  statistics = mStatistics;
+  if (reset)
+  {
+    memset(&mStatistics, 0, sizeof(mStatistics));
+  }
+  pthread_mutex_unlock(&mMutex);
+}
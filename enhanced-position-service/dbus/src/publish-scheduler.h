@@ -0,0 +1,92 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Coalescing of position updates to a fixed publish interval
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+#ifndef ___PUBLISH_SCHEDULER_H
+#define ___PUBLISH_SCHEDULER_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+/**
+ * Publish statistics since the last reset
+ */
+typedef struct {
+    uint64_t intervals;             /**< Number of publish intervals (timer expirations) */
+    uint64_t emissions;             /**< Number of intervals with at least one update */
+    uint64_t updates;               /**< Number of posted updates */
+    uint32_t maxUpdatesPerEmission; /**< Maximum number of updates merged into one emission */
+    uint64_t sumLatency;            /**< Sum of the delays from the first update of an interval to its emission [ms] */
+    uint64_t maxLatency;            /**< Maximum delay from the first update of an interval to its emission [ms] */
+} TPublishStatistics;
+
+/**
+ * Collects the updates from the GNSS and sensor callbacks and hands them
+ * out once per publish interval, so the update rate on the bus does not
+ * depend on the rate of the input data.
+ *
+ * The changedValues bitmasks of all updates within an interval are merged.
+ * The caller drives the interval with a timer and calls take() on each
+ * expiration. The time is passed in by the caller, which keeps the class
+ * independent of the IPC mechanism and the clock.
+ * post() and take() may be called from different threads.
+ */
+class PublishScheduler
+{
+public:
+
+  PublishScheduler();
+
+  ~PublishScheduler();
+
+  /**
+   * Forget the pending updates and reset the statistics
+   */
+  void reset();
+
+  /**
+   * Register an update
+   * @param changedValues bitmask of the changed values
+   * @param timestamp current time [ms]
+   */
+  void post(uint64_t changedValues, uint64_t timestamp);
+
+  /**
+   * Get the merged updates at the end of a publish interval
+   * @param timestamp current time [ms]
+   * @param changedValues merged bitmask of the values changed in this interval
+   * @return false if nothing has changed in this interval, i.e. nothing to publish
+   */
+  bool take(uint64_t timestamp, uint64_t& changedValues);
+
+  /**
+   * Get the statistics
+   * @param reset start a new statistics period
+   */
+  void getStatistics(TPublishStatistics& statistics, bool reset);
+
+private:
+
+  pthread_mutex_t mMutex;
+  uint64_t mChangedValues;        //merged changedValues of the current interval
+  uint32_t mUpdates;              //number of updates in the current interval
+  uint64_t mFirstUpdateTime;      //time of the first update in the current interval
+  TPublishStatistics mStatistics;
+};
+
+#endif//___PUBLISH_SCHEDULER_H
@@ -0,0 +1,145 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Lock-free single producer single consumer queue
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+#ifndef ___SPSC_QUEUE_H
+#define ___SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * Bounded FIFO queue to hand over data from exactly one producer thread
+ * to exactly one consumer thread without locks.
+ *
+ * The items are copied into a fixed-size ring buffer, no memory is
+ * allocated. When the queue is full, push() drops the new item and
+ * counts the drop, so the producer never blocks.
+ * @param T item type, must be copyable
+ * @param N capacity, must be a power of 2
+ */
+template<typename T, uint32_t N>
+class SpscQueue
+{
+public:
+
+  SpscQueue()
+    : mHead(0)
+    , mTail(0)
+    , mPushes(0)
+    , mDrops(0)
+    , mMaxDepth(0)
+  {
+    static_assert((N > 0) && ((N & (N - 1)) == 0), "SpscQueue capacity must be a power of 2");
+  }
+
+  /**
+   * Append an item, only to be called by the producer
+   * @return false if the queue is full and the item has been dropped
+   */
+  bool push(const T& item)
+  {
+    uint32_t tail = mTail.load(std::memory_order_relaxed);
+    uint32_t head = mHead.load(std::memory_order_acquire);
+
+    if (tail - head >= N)
+    {
+      mDrops.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    mItems[tail & (N - 1)] = item;
+    mTail.store(tail + 1, std::memory_order_release);
+
+    mPushes.fetch_add(1, std::memory_order_relaxed);
+    uint32_t depth = tail + 1 - head;
+    if (depth > mMaxDepth.load(std::memory_order_relaxed))
+    {
+      mMaxDepth.store(depth, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  /**
+   * Remove the oldest item, only to be called by the consumer
+   * @return false if the queue is empty
+   */
+  bool pop(T& item)
+  {
+    uint32_t head = mHead.load(std::memory_order_relaxed);
+    uint32_t tail = mTail.load(std::memory_order_acquire);
+
+    if (head == tail)
+    {
+      return false;
+    }
+
+    item = mItems[head & (N - 1)];
+    mHead.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Current number of items, exact only when called by the consumer or the producer
+   */
+  uint32_t size() const
+  {
+    return mTail.load(std::memory_order_acquire) - mHead.load(std::memory_order_acquire);
+  }
+
+  uint32_t capacity() const
+  {
+    return N;
+  }
+
+  /**
+   * Number of successfully appended items
+   */
+  uint64_t getPushes() const
+  {
+    return mPushes.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Number of items dropped because the queue was full
+   */
+  uint64_t getDrops() const
+  {
+    return mDrops.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Maximum number of items in the queue since the last call
+   */
+  uint32_t takeMaxDepth()
+  {
+    return mMaxDepth.exchange(0, std::memory_order_relaxed);
+  }
+
+private:
+
+  //head and tail are written by different threads: keep them in different cache lines
+  alignas(64) std::atomic<uint32_t> mHead;      //next item to pop, written by the consumer
+  alignas(64) std::atomic<uint32_t> mTail;      //next free slot, written by the producer
+  std::atomic<uint64_t> mPushes;
+  std::atomic<uint64_t> mDrops;
+  std::atomic<uint32_t> mMaxDepth;
+  T mItems[N];
+};
+
+#endif//___SPSC_QUEUE_H
@@ -18,6 +18,7 @@
 
 #include <signal.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "enhanced-position-client.h"
 #include "positioning-constants.h"
@@ -29,13 +30,22 @@ DBus::DefaultTimeout *timeout;
 
 DLT_DECLARE_CONTEXT(gCtx);
 
-EnhancedPositionClient::EnhancedPositionClient(DBus::Connection &connection, const char *path, const char *name)
+EnhancedPositionClient::EnhancedPositionClient(DBus::Connection &connection, const char *path, const char *name, bool pushMode)
   : DBus::ObjectProxy(connection, path, name)
+  , mPushMode(pushMode)
+  , mIsSubscribed(false)
+  , mSubscriptionId(0)
 {
 }
 
 void EnhancedPositionClient::PositionUpdate(const uint64_t& changedValues)
 {
+  if (mPushMode || mIsSubscribed)
+  {
+    //the values are delivered by PositionUpdateData
+    return;
+  }
+
   LOG_INFO_MSG(gCtx,"Position Update");
   
   // retrieve the data 
@@ -44,6 +54,53 @@ void EnhancedPositionClient::PositionUpdate(const uint64_t& changedValues)
     
   GetPositionInfo(changedValues, timestamp, posData);
 
+  logPositionInfo(changedValues, posData);
+}
+
+void EnhancedPositionClient::PositionUpdateData(const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data)
+{
+  if (!mPushMode || mIsSubscribed)
+  {
+    return;
+  }
+
+  LOG_INFO_MSG(gCtx,"Position Update Data");
+
+  std::map< uint64_t, ::DBus::Variant > posData = data;
+
+  logPositionInfo(changedValues, posData);
+}
+
+void EnhancedPositionClient::FilteredPositionUpdate(const uint32_t& subscriptionId, const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data)
+{
+  LOG_INFO(gCtx,"Filtered Position Update: subscription=%u", subscriptionId);
+
+  std::map< uint64_t, ::DBus::Variant > posData = data;
+
+  logPositionInfo(changedValues, posData);
+}
+
+bool EnhancedPositionClient::subscribe(uint64_t valuesToReturn, uint16_t maxRate, double minDistance, double minHeadingChange)
+{
+  try
+  {
+    mSubscriptionId = Subscribe(valuesToReturn, maxRate, minDistance, minHeadingChange);
+    LOG_INFO(gCtx,"Subscribed: subscription=%u", mSubscriptionId);
+  }
+  catch (DBus::Error& e)
+  {
+    LOG_ERROR_MSG(gCtx,"Subscribe failed");
+    return false;
+  }
+
+  //the proxy matches all signals of the interface, the filtered updates are sent to this client directly
+  conn().remove_match("type='signal',interface='org.genivi.positioning.EnhancedPosition',path='/org/genivi/positioning/EnhancedPosition'", false);
+  mIsSubscribed = true;
+  return true;
+}
+
+void EnhancedPositionClient::logPositionInfo(uint64_t changedValues, std::map< uint64_t, ::DBus::Variant >& posData)
+{
   if (changedValues & GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE)
   {
     LOG_INFO(gCtx,"LAT=%lf", posData[GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE].reader().get_double());
@@ -87,14 +144,50 @@ void EnhancedPositionClient::PositionUpdate(const uint64_t& changedValues)
 
 }
 
+void EnhancedPositionClient::PredictedPositionUpdate(const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data)
+{
+  LOG_INFO(gCtx,"Predicted Position Update: timestamp=%llu values=%d", (unsigned long long)timestamp, (int)data.size());
+}
+
+void EnhancedPositionClient::SatelliteUpdate(const uint64_t& timestamp, const std::vector< ::DBus::Struct< uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, bool > >& satelliteInfo)
+{
+  int inUse = 0;
+  for (size_t i = 0; i < satelliteInfo.size(); i++)
+  {
+    if (satelliteInfo[i]._6)
+    {
+      inUse++;
+    }
+  }
+  LOG_INFO(gCtx,"Satellite Update: timestamp=%llu satellites=%d inUse=%d", (unsigned long long)timestamp, (int)satelliteInfo.size(), inUse);
+}
+
+void EnhancedPositionClient::TimeUpdate(const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& time)
+{
+  std::map< uint64_t, ::DBus::Variant > timeData = time;
+
+  if (timeData.count(GENIVI_ENHANCEDPOSITIONSERVICE_HOUR))
+  {
+    LOG_INFO(gCtx,"Time Update: %02d:%02d:%02d",
+             timeData[GENIVI_ENHANCEDPOSITIONSERVICE_HOUR].reader().get_byte(),
+             timeData[GENIVI_ENHANCEDPOSITIONSERVICE_MINUTE].reader().get_byte(),
+             timeData[GENIVI_ENHANCEDPOSITIONSERVICE_SECOND].reader().get_byte());
+  }
+}
+
 void signalhandler(int sig)
 {
   LOG_INFO_MSG(gCtx,"Signal received");
   dispatcher.leave();
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+  //-p: receive the values with PositionUpdateData instead of calling GetPositionInfo
+  bool pushMode = (argc > 1) && (strcmp(argv[1], "-p") == 0);
+  //-f: receive the values with FilteredPositionUpdate at most once per second and 10m or 10 degree
+  bool filterMode = (argc > 1) && (strcmp(argv[1], "-f") == 0);
+
   DLT_REGISTER_APP("ENHPOS", "EnhancedPositionClient");
   DLT_REGISTER_CONTEXT(gCtx,"EPCL", "Global Context"); // EPCL = EnhancedPositionService Client Application
 
@@ -109,7 +202,18 @@ int main()
 
   EnhancedPositionClient client(conn, 
                                 "/org/genivi/positioning/EnhancedPosition",
-                                "org.genivi.positioning.EnhancedPosition");
+                                "org.genivi.positioning.EnhancedPosition",
+                                pushMode);
+
+  if (filterMode)
+  {
+    client.subscribe(GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE |
+                     GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE |
+                     GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE |
+                     GENIVI_ENHANCEDPOSITIONSERVICE_HEADING |
+                     GENIVI_ENHANCEDPOSITIONSERVICE_SPEED,
+                     1, 10.0, 10.0);
+  }
 
   // dispatch
   dispatcher.enter();
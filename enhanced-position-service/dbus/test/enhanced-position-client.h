@@ -31,10 +31,33 @@ class EnhancedPositionClient
 {
 public:
 
-  EnhancedPositionClient(DBus::Connection &connection, const char *path, const char *name);
+  EnhancedPositionClient(DBus::Connection &connection, const char *path, const char *name, bool pushMode);
 
   void PositionUpdate(const uint64_t& changedValues);
 
+  void PositionUpdateData(const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data);
+
+  void PredictedPositionUpdate(const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data);
+
+  void SatelliteUpdate(const uint64_t& timestamp, const std::vector< ::DBus::Struct< uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, bool > >& satelliteInfo);
+
+  void TimeUpdate(const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& time);
+
+  void FilteredPositionUpdate(const uint32_t& subscriptionId, const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data);
+
+  /**
+   * Receive the position with FilteredPositionUpdate only:
+   * subscribe and stop receiving the broadcast signals of the interface
+   */
+  bool subscribe(uint64_t valuesToReturn, uint16_t maxRate, double minDistance, double minHeadingChange);
+
+private:
+
+  void logPositionInfo(uint64_t changedValues, std::map< uint64_t, ::DBus::Variant >& posData);
+
+  bool mPushMode;
+  bool mIsSubscribed;
+  uint32_t mSubscriptionId;
 };
 
 #endif//__ENHANCED_POSITION_CLIENT_H
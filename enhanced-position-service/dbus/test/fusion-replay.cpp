@@ -0,0 +1,424 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Offline replay of a log file through the fusion engine
+*
+* \details Reads a log file in the format of the log-replayer
+* ($GVGNSPOS, $GVGNSTIM, $GVSNSGYR, $GVSNSACC, $GVSNSVSP) and feeds the records
+* in file order into the fusion engine of the EnhancedPositionService.
+* No D-Bus, GNSS service or sensors service is involved, so the results
+* are fully deterministic and can be compared between versions.
+* Reported are
+*   - the CPU time per processed record (time update and measurement update),
+*   - the distance between the fused position and each GNSS position,
+*   - the dead-reckoning error after a simulated GNSS outage (option -o),
+*   - the error of the position extrapolated by a given latency (option -x),
+*     compared to the error of the unextrapolated position of that age.
+* Option -p prints the fused position after each gyroscope record,
+* i.e. at the rate at which the service publishes PositionUpdate,
+* with the UTC [ms since 1970] derived from $GVGNSTIM in the last column.
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include <inttypes.h>
+
+#include "fusion-engine.h"
+
+#define LINE_LEN 1024
+#define DEG2RAD (3.14159265358979323846/180.0)
+#define EARTH_RADIUS 6371000.0
+//number of stored extrapolated positions, must cover the latency at the gyroscope rate
+#define PREDICTION_RING 256
+
+typedef struct
+{
+    uint64_t timestamp;
+    double latitude;            //extrapolated to timestamp
+    double longitude;
+    double latitudeAge;         //not extrapolated, i.e. valid for timestamp - latency
+    double longitudeAge;
+} TPrediction;
+
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+static double distance(double lat1, double lon1, double lat2, double lon2)
+{
+    double dN = (lat2 - lat1)*DEG2RAD*EARTH_RADIUS;
+    double dE = (lon2 - lon1)*DEG2RAD*EARTH_RADIUS*cos(lat1*DEG2RAD);
+    return sqrt(dN*dN + dE*dE);
+}
+
+static bool parseGNSS(const char* line, TGNSSPosition& pos)
+{
+    uint64_t timestamp;
+    uint16_t countdown;
+    unsigned int fixStatus;
+    memset(&pos, 0, sizeof(pos));
+    int n = sscanf(line,
+        "%" SCNu64 ",%" SCNu16 ",$GVGNSPOS,%" SCNu64 ",%lf,%lf,%f,%f,%f,%f,%f,%f,%f,%f,%" SCNu16 ",%" SCNu16 ",%" SCNu16 ",%f,%f,%f,%f,%f,%u,%x,%x,%x,%" SCNu16 ",%x",
+        &timestamp, &countdown, &pos.timestamp, &pos.latitude, &pos.longitude,
+        &pos.altitudeMSL, &pos.altitudeEll, &pos.hSpeed, &pos.vSpeed, &pos.heading,
+        &pos.pdop, &pos.hdop, &pos.vdop,
+        &pos.usedSatellites, &pos.trackedSatellites, &pos.visibleSatellites,
+        &pos.sigmaHPosition, &pos.sigmaAltitude, &pos.sigmaHSpeed, &pos.sigmaVSpeed, &pos.sigmaHeading,
+        &fixStatus, &pos.fixTypeBits, &pos.activatedSystems, &pos.usedSystems,
+        &pos.correctionAge, &pos.validityBits);
+    if (n != 27)
+    {
+        //old version without correctionAge
+        n = sscanf(line,
+            "%" SCNu64 ",%" SCNu16 ",$GVGNSPOS,%" SCNu64 ",%lf,%lf,%f,%f,%f,%f,%f,%f,%f,%f,%" SCNu16 ",%" SCNu16 ",%" SCNu16 ",%f,%f,%f,%f,%f,%u,%x,%x,%x,%x",
+            &timestamp, &countdown, &pos.timestamp, &pos.latitude, &pos.longitude,
+            &pos.altitudeMSL, &pos.altitudeEll, &pos.hSpeed, &pos.vSpeed, &pos.heading,
+            &pos.pdop, &pos.hdop, &pos.vdop,
+            &pos.usedSatellites, &pos.trackedSatellites, &pos.visibleSatellites,
+            &pos.sigmaHPosition, &pos.sigmaAltitude, &pos.sigmaHSpeed, &pos.sigmaVSpeed, &pos.sigmaHeading,
+            &fixStatus, &pos.fixTypeBits, &pos.activatedSystems, &pos.usedSystems,
+            &pos.validityBits);
+        pos.validityBits &= ~GNSS_POSITION_CORRAGE_VALID;
+        if (n != 26)
+        {
+            return false;
+        }
+    }
+    pos.fixStatus = (EGNSSFixStatus)fixStatus;
+    return true;
+}
+
+static bool parseGyroscope(const char* line, TGyroscopeData& gyro)
+{
+    uint64_t timestamp;
+    uint16_t countdown;
+    memset(&gyro, 0, sizeof(gyro));
+    int n = sscanf(line, "%" SCNu64 ",%" SCNu16 ",$GVSNSGYR,%" SCNu64 ",%f,%f,%f,%f,%u,%x",
+        &timestamp, &countdown, &gyro.timestamp, &gyro.yawRate, &gyro.pitchRate, &gyro.rollRate,
+        &gyro.temperature, &gyro.measurementInterval, &gyro.validityBits);
+    if (n != 9)
+    {
+        n = sscanf(line, "%" SCNu64 ",%" SCNu16 ",$GVSNSGYR,%" SCNu64 ",%f,%f,%f,%f,%x",
+            &timestamp, &countdown, &gyro.timestamp, &gyro.yawRate, &gyro.pitchRate, &gyro.rollRate,
+            &gyro.temperature, &gyro.validityBits);
+        return (n == 8);
+    }
+    return true;
+}
+
+static bool parseAcceleration(const char* line, TAccelerationData& acc)
+{
+    uint64_t timestamp;
+    uint16_t countdown;
+    memset(&acc, 0, sizeof(acc));
+    int n = sscanf(line, "%" SCNu64 ",%" SCNu16 ",$GVSNSACC,%" SCNu64 ",%f,%f,%f,%f,%u,%x",
+        &timestamp, &countdown, &acc.timestamp, &acc.x, &acc.y, &acc.z,
+        &acc.temperature, &acc.measurementInterval, &acc.validityBits);
+    if (n != 9)
+    {
+        n = sscanf(line, "%" SCNu64 ",%" SCNu16 ",$GVSNSACC,%" SCNu64 ",%f,%f,%f,%f,%x",
+            &timestamp, &countdown, &acc.timestamp, &acc.x, &acc.y, &acc.z,
+            &acc.temperature, &acc.validityBits);
+        return (n == 8);
+    }
+    return true;
+}
+
+static bool parseVehicleSpeed(const char* line, TVehicleSpeedData& vsp)
+{
+    uint64_t timestamp;
+    uint16_t countdown;
+    memset(&vsp, 0, sizeof(vsp));
+    int n = sscanf(line, "%" SCNu64 ",%" SCNu16 ",$GVSNSVSP,%" SCNu64 ",%f,%u,%x",
+        &timestamp, &countdown, &vsp.timestamp, &vsp.vehicleSpeed,
+        &vsp.measurementInterval, &vsp.validityBits);
+    if (n != 6)
+    {
+        n = sscanf(line, "%" SCNu64 ",%" SCNu16 ",$GVSNSVSP,%" SCNu64 ",%f,%x",
+            &timestamp, &countdown, &vsp.timestamp, &vsp.vehicleSpeed, &vsp.validityBits);
+        return (n == 5);
+    }
+    return true;
+}
+
+static bool parseTime(const char* line, TGNSSTime& time)
+{
+    uint64_t timestamp;
+    uint16_t countdown;
+    unsigned int scale;
+    int leapSeconds;
+    unsigned int year, month, day, hour, minute, second, ms;
+    memset(&time, 0, sizeof(time));
+    int n = sscanf(line, "%" SCNu64 ",%" SCNu16 ",$GVGNSTIM,%" SCNu64 ",%u,%u,%u,%u,%u,%u,%u,%u,%d,%x",
+        &timestamp, &countdown, &time.timestamp, &year, &month, &day, &hour, &minute, &second, &ms,
+        &scale, &leapSeconds, &time.validityBits);
+    time.year = year;
+    time.month = month;
+    time.day = day;
+    time.hour = hour;
+    time.minute = minute;
+    time.second = second;
+    time.ms = ms;
+    time.scale = (EGNSSTimeScale)scale;
+    time.leapSeconds = leapSeconds;
+    return (n == 13);
+}
+
+static void usage(const char* name)
+{
+    printf("Usage: %s [-p] [-o start,duration] [-x latency] logfile\n", name);
+    printf("  -p                 print the fused position after each gyroscope record\n");
+    printf("  -o start,duration  ignore GNSS positions from start for duration [s],\n");
+    printf("                     counted from the first GNSS position\n");
+    printf("  -x latency         compare the GNSS positions with the positions\n");
+    printf("                     extrapolated latency [ms] in advance\n");
+}
+
+int main(int argc, char* argv[])
+{
+    bool print = false;
+    double outageStart = -1;
+    double outageDuration = 0;
+    int latency = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "po:x:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'p':
+                print = true;
+                break;
+            case 'o':
+                if (sscanf(optarg, "%lf,%lf", &outageStart, &outageDuration) != 2)
+                {
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'x':
+                latency = atoi(optarg);
+                if (latency <= 0)
+                {
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind >= argc)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE* file = fopen(argv[optind], "r");
+    if (!file)
+    {
+        printf("cannot open %s\n", argv[optind]);
+        return EXIT_FAILURE;
+    }
+
+    static FusionEngine engine;
+    char line[LINE_LEN];
+    uint64_t records = 0;
+    uint64_t cpu = 0;
+    uint64_t cpuMax = 0;
+    uint64_t numGNSS = 0;
+    double errorSum = 0;
+    double errorMax = 0;
+    uint64_t firstGNSS = 0;
+    bool firstGNSSValid = false;
+    bool inOutage = false;
+    bool outageDone = false;
+    double outageError = -1;
+    double outageSigma = 0;
+    TFusionPosition fused;
+    static TPrediction predictions[PREDICTION_RING];
+    uint16_t numPredictions = 0;
+    uint16_t nextPrediction = 0;
+    uint64_t numExtrapolated = 0;
+    double extrapolatedSum = 0;
+    double ageSum = 0;
+
+    while (fgets(line, LINE_LEN, file))
+    {
+        TGNSSPosition pos;
+        TGNSSTime time;
+        TGyroscopeData gyro;
+        TAccelerationData acc;
+        TVehicleSpeedData vsp;
+        uint64_t start = 0;
+        bool isGyro = false;
+
+        if (strstr(line, "$GVGNSPOS") && parseGNSS(line, pos))
+        {
+            if (!firstGNSSValid)
+            {
+                firstGNSS = pos.timestamp;
+                firstGNSSValid = true;
+            }
+            double t = (pos.timestamp - firstGNSS)/1000.0;
+            if ((outageStart >= 0) && (t >= outageStart) && (t < outageStart + outageDuration))
+            {
+                inOutage = true;
+                continue;
+            }
+            //compare the positions predicted latency ms before with the GNSS position
+            if ((latency > 0) && (numPredictions > 0) &&
+                !((pos.validityBits & GNSS_POSITION_STAT_VALID) && (pos.fixStatus < GNSS_FIX_STATUS_2D)))
+            {
+                const TPrediction* best = 0;
+                for (uint16_t i = 0; i < numPredictions; i++)
+                {
+                    const TPrediction* p = &predictions[i];
+                    if (!best || (llabs((int64_t)(p->timestamp - pos.timestamp)) < llabs((int64_t)(best->timestamp - pos.timestamp))))
+                    {
+                        best = p;
+                    }
+                }
+                if (llabs((int64_t)(best->timestamp - pos.timestamp)) <= 20)
+                {
+                    extrapolatedSum += distance(pos.latitude, pos.longitude, best->latitude, best->longitude);
+                    ageSum += distance(pos.latitude, pos.longitude, best->latitudeAge, best->longitudeAge);
+                    numExtrapolated++;
+                }
+            }
+            //compare the dead reckoned position with the first GNSS position after the outage
+            if (inOutage && !outageDone && engine.getPosition(fused))
+            {
+                outageError = distance(pos.latitude, pos.longitude, fused.latitude, fused.longitude);
+                outageSigma = fused.sigmaHPosition;
+                outageDone = true;
+            }
+            start = now_ns();
+            engine.processGNSSPosition(pos);
+            //positions without a fix are not used by the engine, so they are not compared either
+            if (engine.getPosition(fused) && (pos.validityBits & GNSS_POSITION_LATITUDE_VALID) &&
+                (pos.validityBits & GNSS_POSITION_LONGITUDE_VALID) &&
+                !((pos.validityBits & GNSS_POSITION_STAT_VALID) && (pos.fixStatus < GNSS_FIX_STATUS_2D)))
+            {
+                double error = distance(pos.latitude, pos.longitude, fused.latitude, fused.longitude);
+                errorSum += error;
+                if (error > errorMax)
+                {
+                    errorMax = error;
+                }
+                numGNSS++;
+            }
+        }
+        else if (strstr(line, "$GVGNSTIM") && parseTime(line, time))
+        {
+            start = now_ns();
+            engine.processGNSSTime(time);
+        }
+        else if (strstr(line, "$GVSNSGYR") && parseGyroscope(line, gyro))
+        {
+            start = now_ns();
+            engine.processGyroscope(gyro);
+            isGyro = true;
+        }
+        else if (strstr(line, "$GVSNSACC") && parseAcceleration(line, acc))
+        {
+            start = now_ns();
+            engine.processAcceleration(acc);
+        }
+        else if (strstr(line, "$GVSNSVSP") && parseVehicleSpeed(line, vsp))
+        {
+            start = now_ns();
+            engine.processVehicleSpeed(vsp);
+        }
+        else
+        {
+            continue;
+        }
+        uint64_t duration = now_ns() - start;
+        cpu += duration;
+        if (duration > cpuMax)
+        {
+            cpuMax = duration;
+        }
+        records++;
+
+        if ((latency > 0) && isGyro && engine.getPosition(fused))
+        {
+            TFusionPosition extrapolated;
+            engine.extrapolate(fused.timestamp + latency, extrapolated);
+            TPrediction* p = &predictions[nextPrediction];
+            p->timestamp = extrapolated.timestamp;
+            p->latitude = extrapolated.latitude;
+            p->longitude = extrapolated.longitude;
+            p->latitudeAge = fused.latitude;
+            p->longitudeAge = fused.longitude;
+            nextPrediction = (nextPrediction + 1) % PREDICTION_RING;
+            if (numPredictions < PREDICTION_RING)
+            {
+                numPredictions++;
+            }
+        }
+
+        if (print && isGyro && engine.getPosition(fused))
+        {
+            printf("%" PRIu64 ",%.7f,%.7f,%.1f,%.1f,%.2f,%.2f,%.1f,%d,%" PRIu64 "\n",
+                fused.timestamp, fused.latitude, fused.longitude, fused.altitude,
+                fused.heading, fused.speed, fused.yawRate, fused.sigmaHPosition, fused.drStatus ? 1 : 0,
+                (fused.validityBits & FUSION_POSITION_UTC_VALID) ? fused.utcTime : 0);
+        }
+    }
+    fclose(file);
+
+    TFusionStatistics statistics;
+    engine.getStatistics(statistics);
+
+    printf("records:          %" PRIu64 "\n", records);
+    printf("time updates:     %" PRIu64 "\n", statistics.predictions);
+    printf("updates:          %" PRIu64 " (%" PRIu64 " rejected, %" PRIu64 " resets)\n",
+        statistics.updates, statistics.rejections, statistics.resets);
+    printf("cpu per record:   %.0f ns (max %" PRIu64 " ns)\n", records ? (double)cpu/records : 0.0, cpuMax);
+    printf("distance to GNSS: mean %.2f m, max %.2f m (%" PRIu64 " positions)\n",
+        numGNSS ? errorSum/numGNSS : 0.0, errorMax, numGNSS);
+    if (latency > 0)
+    {
+        printf("latency %4d ms:  mean error %.2f m extrapolated, %.2f m not extrapolated (%" PRIu64 " positions)\n",
+            latency, numExtrapolated ? extrapolatedSum/numExtrapolated : 0.0,
+            numExtrapolated ? ageSum/numExtrapolated : 0.0, numExtrapolated);
+    }
+    if (outageStart >= 0)
+    {
+        if (outageDone)
+        {
+            printf("outage error:     %.2f m after %.0f s (sigma %.2f m)\n", outageError, outageDuration, outageSigma);
+        }
+        else
+        {
+            printf("outage error:     no GNSS position after the outage\n");
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
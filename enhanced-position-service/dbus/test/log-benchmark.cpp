@@ -0,0 +1,282 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Benchmark of the logging overhead per position update
+*
+* \details Runs the debug traces of EnhancedPosition::sigPositionUpdate
+* (three messages per element) for the given number of updates and prints
+* the time per update, including the filling of the positions.
+* The output depends on the build:
+*   - default build: the debug level is compiled out (logging disabled),
+*   - WITH_DEBUG: the messages are written to stderr (redirect it to /dev/null),
+*   - WITH_DLT: a context with log level verbose (DLT enabled) and a context
+*     with log level info (DLT filtered) are compared, the latter also with
+*     the message formatted before the level check as done by the former log.h.
+* Each run also checks that the arguments of a message are only evaluated
+* when the message is logged, and that the rate-limited message is logged
+* at most once per second.
+* Usage: log-benchmark [updates [elements per update]]
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "gnss.h"
+#include "log.h"
+
+#define DEFAULT_UPDATES 100000
+#define DEFAULT_ELEMENTS 1
+#define MAX_ELEMENTS 16
+#define RATE_LIMIT_INTERVAL 1000
+
+DLT_DECLARE_CONTEXT(gCtx)
+#if (DLT_ENABLED)
+DLT_DECLARE_CONTEXT(gFilteredCtx)
+
+//the DLT branch of the former log.h: formatted before DLT_LOG checks the level
+#define LOG_DEBUG_EAGER(context, fmt, ...) \
+        { \
+            char logBuffer[256]; \
+            sprintf(logBuffer, fmt, __VA_ARGS__); \
+            DLT_LOG(context, DLT_LOG_DEBUG, DLT_STRING(logBuffer)); \
+        }
+#endif
+
+//true if the debug messages of the context reach the log
+#define IS_DEBUG_LOGGED(context) \
+        ((LOG_MIN_LEVEL >= LOG_LEVEL_DEBUG) && LOG_IS_ENABLED(context, LOG_LEVEL_DEBUG))
+
+static bool gOk = true;
+static uint64_t gEvaluations = 0;
+
+static uint64_t now_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+//counts the evaluations of the arguments
+static inline double evaluated(double value)
+{
+  gEvaluations++;
+  return value;
+}
+
+static void fillPositions(int update, TGNSSPosition position[], uint16_t numElements)
+{
+  for (int i = 0; i < numElements; i++)
+  {
+    position[i].timestamp = (uint64_t)update*100 + i;
+    position[i].latitude = 48.0 + update*1e-7;
+    position[i].longitude = 11.0 + update*1e-7;
+    position[i].altitudeMSL = 500.0 + i;
+    position[i].pdop = 1.8;
+    position[i].hdop = 1.2;
+    position[i].vdop = 1.4;
+    position[i].sigmaHPosition = 3.5;
+    position[i].sigmaAltitude = 5.0;
+    position[i].fixStatus = GNSS_FIX_STATUS_3D;
+    position[i].fixTypeBits = GNSS_FIX_TYPE_SINGLE_FREQUENCY;
+  }
+}
+
+//same traces as EnhancedPosition::sigPositionUpdate
+template <typename TContext>
+static void logPositionUpdate(TContext& context, const TGNSSPosition position[], uint16_t numElements)
+{
+  //unused if the debug level is compiled out
+  (void)context;
+  (void)position;
+  (void)numElements;
+
+  for (int i = 0; i < numElements; i++)
+  {
+    LOG_DEBUG(context,"Position Update[%d/%d]: lat=%f lon=%f alt=%f",
+              i+1,
+              numElements,
+              evaluated(position[i].latitude),
+              position[i].longitude,
+              position[i].altitudeMSL);
+
+    LOG_DEBUG(context,"Accuracy Update[%d/%d]: pdop=%f hdop=%f vdop=%f sigmaHPosition=%f sigmaAltitude=%f",
+              i+1,
+              numElements,
+              position[i].pdop,
+              position[i].hdop,
+              position[i].vdop,
+              position[i].sigmaHPosition,
+              position[i].sigmaAltitude);
+
+    LOG_DEBUG(context,"Status Update[%d/%d]: fixStatus=%d fixTypeBits=0x%08X",
+              i+1,
+              numElements,
+              position[i].fixStatus,
+              position[i].fixTypeBits);
+  }
+}
+
+template <typename TContext>
+static void logPositionUpdateRateLimited(TContext& context, const TGNSSPosition position[], uint16_t numElements)
+{
+  (void)context;
+  (void)position;
+  (void)numElements;
+
+  LOG_DEBUG_RATE_LIMITED(context, RATE_LIMIT_INTERVAL, "Position Update: lat=%f lon=%f alt=%f fixStatus=%d",
+                         evaluated(position[numElements-1].latitude),
+                         position[numElements-1].longitude,
+                         position[numElements-1].altitudeMSL,
+                         position[numElements-1].fixStatus);
+}
+
+#if (DLT_ENABLED)
+template <typename TContext>
+static void logPositionUpdateEager(TContext& context, const TGNSSPosition position[], uint16_t numElements)
+{
+  for (int i = 0; i < numElements; i++)
+  {
+    LOG_DEBUG_EAGER(context,"Position Update[%d/%d]: lat=%f lon=%f alt=%f",
+                    i+1,
+                    numElements,
+                    evaluated(position[i].latitude),
+                    position[i].longitude,
+                    position[i].altitudeMSL);
+
+    LOG_DEBUG_EAGER(context,"Accuracy Update[%d/%d]: pdop=%f hdop=%f vdop=%f sigmaHPosition=%f sigmaAltitude=%f",
+                    i+1,
+                    numElements,
+                    position[i].pdop,
+                    position[i].hdop,
+                    position[i].vdop,
+                    position[i].sigmaHPosition,
+                    position[i].sigmaAltitude);
+
+    LOG_DEBUG_EAGER(context,"Status Update[%d/%d]: fixStatus=%d fixTypeBits=0x%08X",
+                    i+1,
+                    numElements,
+                    position[i].fixStatus,
+                    position[i].fixTypeBits);
+  }
+}
+#endif
+
+template <typename TContext, void (*logUpdate)(TContext&, const TGNSSPosition[], uint16_t)>
+static void run(const char* name, TContext& context, bool isLogged, bool isRateLimited, int updates, uint16_t numElements)
+{
+  TGNSSPosition position[MAX_ELEMENTS];
+  memset(position, 0, sizeof(position));
+
+  gEvaluations = 0;
+  uint64_t start = now_ns();
+  for (int update = 0; update < updates; update++)
+  {
+    fillPositions(update, position, numElements);
+    logUpdate(context, position, numElements);
+  }
+  uint64_t elapsed = now_ns() - start;
+
+  printf("%-40s %10.1f %12llu\n", name, (double)elapsed/updates, (unsigned long long)gEvaluations);
+
+  if (!isLogged)
+  {
+    if (gEvaluations != 0)
+    {
+      printf("FAILED: %s: arguments evaluated although the message is not logged\n", name);
+      gOk = false;
+    }
+  }
+  else if (isRateLimited)
+  {
+    uint64_t maxMessages = elapsed/(RATE_LIMIT_INTERVAL*1000000ULL) + 1;
+    if ((gEvaluations < 1) || (gEvaluations > maxMessages))
+    {
+      printf("FAILED: %s: %llu messages, expected 1..%llu\n", name,
+             (unsigned long long)gEvaluations, (unsigned long long)maxMessages);
+      gOk = false;
+    }
+  }
+  else if (gEvaluations != (uint64_t)updates*numElements)
+  {
+    printf("FAILED: %s: %llu messages, expected %llu\n", name,
+           (unsigned long long)gEvaluations, (unsigned long long)updates*numElements);
+    gOk = false;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  int updates = DEFAULT_UPDATES;
+  int elements = DEFAULT_ELEMENTS;
+
+  if (argc > 1)
+  {
+    updates = atoi(argv[1]);
+  }
+  if (argc > 2)
+  {
+    elements = atoi(argv[2]);
+  }
+  if ((updates < 1) || (elements < 1) || (elements > MAX_ELEMENTS))
+  {
+    printf("Usage: %s [updates [elements per update (1..%d)]]\n", argv[0], MAX_ELEMENTS);
+    return EXIT_FAILURE;
+  }
+
+  DLT_REGISTER_APP("LOGB", "Logging benchmark");
+#if (DLT_ENABLED)
+  DLT_REGISTER_CONTEXT_LL_TS(gCtx, "LOGE", "Log level verbose", DLT_LOG_VERBOSE, DLT_TRACE_STATUS_OFF);
+  DLT_REGISTER_CONTEXT_LL_TS(gFilteredCtx, "LOGF", "Log level info", DLT_LOG_INFO, DLT_TRACE_STATUS_OFF);
+#else
+  DLT_REGISTER_CONTEXT(gCtx, "LOGB", "Logging benchmark");
+#endif
+
+  uint16_t numElements = (uint16_t)elements;
+  printf("Time per update [ns], %d updates with %d elements\n", updates, elements);
+  printf("%-40s %10s %12s\n", "", "time", "messages");
+
+#if (DLT_ENABLED)
+  run<DltContext, logPositionUpdate>("DLT enabled", gCtx,
+      IS_DEBUG_LOGGED(gCtx), false, updates, numElements);
+  run<DltContext, logPositionUpdateRateLimited>("DLT enabled, rate-limited", gCtx,
+      IS_DEBUG_LOGGED(gCtx), true, updates, numElements);
+  run<DltContext, logPositionUpdate>("DLT filtered", gFilteredCtx,
+      IS_DEBUG_LOGGED(gFilteredCtx), false, updates, numElements);
+  run<DltContext, logPositionUpdateRateLimited>("DLT filtered, rate-limited", gFilteredCtx,
+      IS_DEBUG_LOGGED(gFilteredCtx), true, updates, numElements);
+  //formatted anyway, the messages count the evaluations
+  run<DltContext, logPositionUpdateEager>("DLT filtered, formatted before check", gFilteredCtx,
+      true, false, updates, numElements);
+#else
+  run<NoDltContext, logPositionUpdate>((LOG_MIN_LEVEL >= LOG_LEVEL_DEBUG) ? "stderr" : "logging disabled", gCtx,
+      IS_DEBUG_LOGGED(gCtx), false, updates, numElements);
+  run<NoDltContext, logPositionUpdateRateLimited>((LOG_MIN_LEVEL >= LOG_LEVEL_DEBUG) ? "stderr, rate-limited" : "logging disabled, rate-limited", gCtx,
+      IS_DEBUG_LOGGED(gCtx), true, updates, numElements);
+#endif
+
+#if (DLT_ENABLED)
+  DLT_UNREGISTER_CONTEXT(gFilteredCtx);
+#endif
+  DLT_UNREGISTER_CONTEXT(gCtx);
+  DLT_UNREGISTER_APP();
+
+  printf("%s\n", gOk ? "OK" : "FAILED");
+  return gOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,248 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Micro-benchmark of the fixed-size matrix library
+*
+* \details Measures the CPU time of the typical operations of a Kalman
+* filter for several state sizes N and measurement sizes M:
+*   - predict: P = F*P*F' + Q with a dense F,
+*   - update: innovation covariance, LDL' solve, gain and Joseph form update,
+*   - Cholesky and LDL' decomposition followed by a solve with one right hand side.
+* Each operation is also checked for correctness (residual of the solve,
+* symmetry and positive definiteness of the updated covariance),
+* so the benchmark doubles as a test on each target (x86-64, ARM).
+* Usage: matrix-benchmark [iterations]
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include "matrix.h"
+
+#define DEFAULT_ITERATIONS 100000
+
+static bool gOk = true;
+//prevents that the compiler optimizes the benchmarked code away
+static volatile double gSink = 0;
+
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+//deterministic pseudo random numbers in [-1,1]
+static double random_value()
+{
+    static uint32_t state = 12345;
+    state = state*1103515245 + 12345;
+    return ((state >> 8) & 0xFFFF)/32768.0 - 1.0;
+}
+
+template<typename T, int R, int C>
+static void random_matrix(Matrix<T,R,C>& m)
+{
+    for (int i = 0; i < R*C; i++)
+    {
+        m[i] = random_value();
+    }
+}
+
+//random positive definite matrix A*A' + N*I
+template<typename T, int N>
+static void random_covariance(SymmetricMatrix<T,N>& p)
+{
+    Matrix<T,N,N> a;
+    random_matrix(a);
+    p = congruence(a, SymmetricMatrix<T,N>::identity());
+    for (int i = 0; i < N; i++)
+    {
+        p(i,i) += N;
+    }
+}
+
+static void check(bool condition, const char* what, int n, int m)
+{
+    if (!condition)
+    {
+        printf("FAILED: %s (N=%d M=%d)\n", what, n, m);
+        gOk = false;
+    }
+}
+
+template<int N, int M>
+static void benchmark(int iterations)
+{
+    typedef double T;
+    SymmetricMatrix<T,N> p0;
+    SymmetricMatrix<T,N> p;
+    Matrix<T,N,N> f;
+    Matrix<T,N,1> q;
+    Matrix<T,M,N> h;
+    Matrix<T,M,1> y;
+    Matrix<T,N,1> dx;
+    SymmetricMatrix<T,M> r = SymmetricMatrix<T,M>::identity();
+
+    random_covariance(p0);
+    random_matrix(f);
+    for (int i = 0; i < N; i++)
+    {
+        f(i,i) += 1.0;
+        q[i] = 0.01;
+    }
+    random_matrix(h);
+    random_matrix(y);
+
+    //predict
+    p = p0;
+    uint64_t start = now_ns();
+    for (int i = 0; i < iterations; i++)
+    {
+        predictCovariance(p, f, q);
+        //keep the magnitude bounded
+        if ((i & 15) == 15)
+        {
+            p = p0;
+        }
+    }
+    double tPredict = (double)(now_ns() - start)/iterations;
+    gSink += p(0,0);
+
+    //update
+    uint64_t accepted = 0;
+    start = now_ns();
+    for (int i = 0; i < iterations; i++)
+    {
+        p = p0;
+        if (kalmanUpdate(p, dx, h, y, r, 1e9))
+        {
+            accepted++;
+        }
+        gSink += dx[0];
+    }
+    double tUpdate = (double)(now_ns() - start)/iterations;
+    check(accepted == (uint64_t)iterations, "update accepted", N, M);
+
+    //the updated covariance must stay symmetric positive definite and shrink
+    SymmetricMatrix<T,N> c = p;
+    check(choleskyDecompose(c), "updated covariance positive definite", N, M);
+    for (int i = 0; i < N; i++)
+    {
+        check(p(i,i) <= p0(i,i)*(1+1e-12), "updated variance does not grow", N, M);
+    }
+    //compare with the standard form P - K*S*K' = P - P*H'*inv(S)*H*P
+    {
+        SymmetricMatrix<T,M> s = congruence(h, p0);
+        s += r;
+        ldltDecompose(s);
+        Matrix<T,N,M> pht = multiplyTransposed(p0.toMatrix(), h);
+        Matrix<T,M,N> x = pht.transpose();
+        ldltSolve(s, x);
+        Matrix<T,N,N> reduction = pht*x;
+        double err = 0;
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                err = fmax(err, fabs(p0(i,j) - reduction(i,j) - p(i,j)));
+            }
+        }
+        check(err < 1e-9*N, "Joseph form equals standard form", N, M);
+    }
+
+    //Cholesky decomposition and solve
+    Matrix<T,N,1> b;
+    Matrix<T,N,1> x;
+    random_matrix(b);
+    start = now_ns();
+    for (int i = 0; i < iterations; i++)
+    {
+        c = p0;
+        choleskyDecompose(c);
+        x = b;
+        choleskySolve(c, x);
+        gSink += x[0];
+    }
+    double tCholesky = (double)(now_ns() - start)/iterations;
+    {
+        Matrix<T,N,1> res = p0.toMatrix()*x - b;
+        double err = 0;
+        for (int i = 0; i < N; i++)
+        {
+            err = fmax(err, fabs(res[i]));
+        }
+        check(err < 1e-10, "Cholesky solve residual", N, M);
+    }
+
+    //LDL' decomposition and solve
+    start = now_ns();
+    for (int i = 0; i < iterations; i++)
+    {
+        c = p0;
+        ldltDecompose(c);
+        x = b;
+        ldltSolve(c, x);
+        gSink += x[0];
+    }
+    double tLdlt = (double)(now_ns() - start)/iterations;
+    {
+        Matrix<T,N,1> res = p0.toMatrix()*x - b;
+        double err = 0;
+        for (int i = 0; i < N; i++)
+        {
+            err = fmax(err, fabs(res[i]));
+        }
+        check(err < 1e-10, "LDL' solve residual", N, M);
+    }
+
+    printf("%3d %3d %12.0f %12.0f %12.0f %12.0f\n", N, M, tPredict, tUpdate, tCholesky, tLdlt);
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = DEFAULT_ITERATIONS;
+    if (argc > 1)
+    {
+        iterations = atoi(argv[1]);
+        if (iterations <= 0)
+        {
+            printf("Usage: %s [iterations]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("CPU time per operation [ns], %d iterations\n", iterations);
+    printf("  N   M      predict       update     cholesky         ldlt\n");
+    benchmark<3,1>(iterations);
+    benchmark<3,3>(iterations);
+    benchmark<6,2>(iterations);
+    benchmark<6,3>(iterations);
+    benchmark<9,1>(iterations);
+    benchmark<9,2>(iterations);
+    benchmark<12,3>(iterations);
+    benchmark<15,3>(iterations);
+    benchmark<15,6>(iterations);
+    benchmark<24,3>(iterations);
+    benchmark<24,6>(iterations);
+
+    printf("%s\n", gOk ? "OK" : "FAILED");
+    return gOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,266 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Benchmark of GetPositionInfo with many concurrent polling clients
+*
+* \details Forks the given number of client processes, each with its own
+* connection to the session bus. Each client calls GetPositionInfo in a
+* loop for the given duration and reports the latency histogram to the
+* parent, which prints the total call rate and the latency percentiles.
+* The enhanced-position-service must be running on the session bus. To
+* compare the direct marshalling with the generated adaptor, run the
+* benchmark against a service started with ENHANCED_POSITION_MARSHALLING=map.
+* Usage: position-info-benchmark [clients [duration in s [valuesToReturn]]]
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#ifndef DBUS_HAS_RECURSIVE_MUTEX
+#define DBUS_HAS_RECURSIVE_MUTEX
+#endif
+#include <dbus-c++/dbus.h>
+#include "enhanced-position-proxy.h"
+#include "positioning-constants.h"
+
+#define DEFAULT_CLIENTS 32
+#define DEFAULT_DURATION 10
+#define MAX_CLIENTS 256
+//latency histogram: 10us bins up to 100ms, the last bin collects everything above
+#define BIN_WIDTH 10
+#define BINS 10000
+
+typedef struct
+{
+  uint64_t calls;
+  uint64_t errors;
+  uint64_t sumLatency;          //[us]
+  uint32_t histogram[BINS];
+} TClientResult;
+
+//the signals are not evaluated, the client only polls
+class BenchmarkClient
+  : public org::genivi::positioning::EnhancedPosition_proxy,
+  public DBus::IntrospectableProxy,
+  public DBus::ObjectProxy
+{
+public:
+
+  BenchmarkClient(DBus::Connection &connection)
+    : DBus::ObjectProxy(connection,
+                        "/org/genivi/positioning/EnhancedPosition",
+                        "org.genivi.positioning.EnhancedPosition")
+  {
+  }
+
+  void PositionUpdate(const uint64_t& changedValues) {}
+  void PositionUpdateData(const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data) {}
+  void PredictedPositionUpdate(const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data) {}
+  void SatelliteUpdate(const uint64_t& timestamp, const std::vector< ::DBus::Struct< uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, bool > >& satelliteInfo) {}
+  void TimeUpdate(const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& time) {}
+  void FilteredPositionUpdate(const uint32_t& subscriptionId, const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data) {}
+};
+
+static uint64_t now_us()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000000 + ts.tv_nsec/1000;
+}
+
+static void runClient(int fd, int duration, uint64_t valuesToReturn)
+{
+  static TClientResult result;
+  memset(&result, 0, sizeof(result));
+
+  //blocking calls only: the dispatcher is needed by the connection but never entered
+  DBus::BusDispatcher dispatcher;
+  DBus::default_dispatcher = &dispatcher;
+  DBus::Connection conn = DBus::Connection::SessionBus();
+  BenchmarkClient client(conn);
+
+  uint64_t end = now_us() + (uint64_t)duration*1000000;
+  uint64_t start;
+  while ((start = now_us()) < end)
+  {
+    uint64_t timestamp = 0;
+    std::map< uint64_t, ::DBus::Variant > data;
+    try
+    {
+      client.GetPositionInfo(valuesToReturn, timestamp, data);
+    }
+    catch (DBus::Error& e)
+    {
+      result.errors++;
+    }
+    uint64_t latency = now_us() - start;
+    uint32_t bin = latency/BIN_WIDTH;
+    result.histogram[bin < BINS ? bin : BINS-1]++;
+    result.sumLatency += latency;
+    result.calls++;
+  }
+
+  const char* p = (const char*)&result;
+  size_t remaining = sizeof(result);
+  while (remaining > 0)
+  {
+    ssize_t written = write(fd, p, remaining);
+    if (written <= 0)
+    {
+      break;
+    }
+    p += written;
+    remaining -= written;
+  }
+}
+
+static bool readResult(int fd, TClientResult& result)
+{
+  char* p = (char*)&result;
+  size_t remaining = sizeof(result);
+  while (remaining > 0)
+  {
+    ssize_t got = read(fd, p, remaining);
+    if (got <= 0)
+    {
+      return false;
+    }
+    p += got;
+    remaining -= got;
+  }
+  return true;
+}
+
+static uint64_t percentile(const uint32_t histogram[], uint64_t calls, double fraction)
+{
+  uint64_t limit = (uint64_t)(calls*fraction);
+  uint64_t count = 0;
+  for (int i = 0; i < BINS; i++)
+  {
+    count += histogram[i];
+    if (count > limit)
+    {
+      return (uint64_t)(i + 1)*BIN_WIDTH;
+    }
+  }
+  return (uint64_t)BINS*BIN_WIDTH;
+}
+
+int main(int argc, char* argv[])
+{
+  int clients = DEFAULT_CLIENTS;
+  int duration = DEFAULT_DURATION;
+  uint64_t valuesToReturn = GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE |
+                            GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE |
+                            GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE |
+                            GENIVI_ENHANCEDPOSITIONSERVICE_HEADING |
+                            GENIVI_ENHANCEDPOSITIONSERVICE_SPEED;
+
+  if (argc > 1)
+  {
+    clients = atoi(argv[1]);
+  }
+  if (argc > 2)
+  {
+    duration = atoi(argv[2]);
+  }
+  if (argc > 3)
+  {
+    valuesToReturn = strtoull(argv[3], NULL, 0);
+  }
+  if ((clients <= 0) || (clients > MAX_CLIENTS) || (duration <= 0))
+  {
+    printf("Usage: %s [clients [duration in s [valuesToReturn]]]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int fds[MAX_CLIENTS];
+  pid_t pids[MAX_CLIENTS];
+
+  for (int i = 0; i < clients; i++)
+  {
+    int pipefd[2];
+    if (pipe(pipefd) != 0)
+    {
+      printf("FAILED: pipe\n");
+      return EXIT_FAILURE;
+    }
+    pids[i] = fork();
+    if (pids[i] == 0)
+    {
+      close(pipefd[0]);
+      runClient(pipefd[1], duration, valuesToReturn);
+      close(pipefd[1]);
+      _exit(EXIT_SUCCESS);
+    }
+    close(pipefd[1]);
+    fds[i] = pipefd[0];
+  }
+
+  static TClientResult total;
+  static TClientResult result;
+  bool ok = true;
+
+  memset(&total, 0, sizeof(total));
+  for (int i = 0; i < clients; i++)
+  {
+    if (!readResult(fds[i], result))
+    {
+      printf("FAILED: no result from client %d\n", i);
+      ok = false;
+    }
+    else
+    {
+      total.calls += result.calls;
+      total.errors += result.errors;
+      total.sumLatency += result.sumLatency;
+      for (int j = 0; j < BINS; j++)
+      {
+        total.histogram[j] += result.histogram[j];
+      }
+    }
+    close(fds[i]);
+    waitpid(pids[i], NULL, 0);
+  }
+
+  printf("clients %d, duration %d s, valuesToReturn 0x%llx\n",
+         clients, duration, (unsigned long long)valuesToReturn);
+  if (total.calls > 0)
+  {
+    printf("calls %llu (%.0f/s), errors %llu, latency mean %.0f us p50 %llu us p99 %llu us\n",
+           (unsigned long long)total.calls,
+           (double)total.calls/duration,
+           (unsigned long long)total.errors,
+           (double)total.sumLatency/total.calls,
+           (unsigned long long)percentile(total.histogram, total.calls, 0.5),
+           (unsigned long long)percentile(total.histogram, total.calls, 0.99));
+  }
+
+  if ((total.calls == 0) || (total.errors > 0))
+  {
+    printf("FAILED: GetPositionInfo errors - is the enhanced-position-service running?\n");
+    ok = false;
+  }
+
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
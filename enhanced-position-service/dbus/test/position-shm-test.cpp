@@ -0,0 +1,261 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Stress test of the enhanced position shared memory segment
+*
+* \details Creates the shared memory segment like the service does and
+* publishes records as fast as possible from a writer thread. Reader threads
+* concurrently read the latest record and the history through the client
+* library. All fields of a record are derived from its timestamp, so a torn
+* read is detected; the history must be consecutive and the latest record
+* must never go backwards. Must not run while the enhanced-position-service
+* is running, as it uses the same shared memory object.
+* Usage: position-shm-test [records [readers]]
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <atomic>
+
+#include "position-shm.h"
+
+#define DEFAULT_RECORDS 1000000
+#define DEFAULT_READERS 2
+#define MAX_READERS 16
+
+typedef struct
+{
+  uint64_t reads;
+  uint64_t historyReads;
+  uint64_t errors;
+  uint64_t elapsed;         //[ns]
+} TReaderResult;
+
+static uint64_t gRecords = DEFAULT_RECORDS;
+static std::atomic<bool> gWriterDone(false);
+
+static uint64_t now_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+static void fillRecord(uint64_t timestamp, TEnhancedPositionRecord& record)
+{
+  memset(&record, 0, sizeof(record));
+  record.timestamp = timestamp;
+  record.latitude = timestamp*1e-6;
+  record.longitude = -record.latitude;
+  record.altitude = (double)(timestamp % 1000);
+  record.heading = (double)(timestamp % 360);
+  record.speed = timestamp*0.5;
+  record.sigmaHPosition = timestamp*0.25;
+  record.fixStatus = (uint16_t)(timestamp % 5);
+  record.usedSystems = (uint32_t)timestamp;
+  record.timeTimestamp = timestamp;
+  record.ms = (uint16_t)(timestamp % 1000);
+  record.validityBits = EPS_RECORD_LATLON_VALID | EPS_RECORD_ALTITUDE_VALID |
+                        EPS_RECORD_HEADING_VALID | EPS_RECORD_SPEED_VALID |
+                        EPS_RECORD_FIX_STATUS_VALID | EPS_RECORD_USED_SYSTEMS_VALID |
+                        EPS_RECORD_TIME_VALID;
+}
+
+static bool checkRecord(const TEnhancedPositionRecord& record)
+{
+  TEnhancedPositionRecord expected;
+  fillRecord(record.timestamp, expected);
+  return memcmp(&record, &expected, sizeof(record)) == 0;
+}
+
+static void* writer(void*)
+{
+  TEnhancedPositionRecord record;
+
+  //timestamps start at 1, 0 is never published
+  for (uint64_t i = 1; i <= gRecords; i++)
+  {
+    fillRecord(i, record);
+    epsShmPublish(&record);
+    if ((i % 256) == 0)
+    {
+      sched_yield();
+    }
+  }
+  gWriterDone.store(true);
+  return NULL;
+}
+
+static void* reader(void* arg)
+{
+  TReaderResult* result = (TReaderResult*)arg;
+  TEnhancedPositionRecord latest;
+  TEnhancedPositionRecord history[EPS_SHM_HISTORY_SIZE];
+  uint64_t last = 0;
+  uint64_t loops = 0;
+
+  uint64_t start = now_ns();
+  while (!gWriterDone.load())
+  {
+    loops++;
+    if (epsShmGetLatest(&latest))
+    {
+      result->reads++;
+      if (!checkRecord(latest) || (latest.timestamp < last))
+      {
+        result->errors++;
+      }
+      last = latest.timestamp;
+    }
+
+    //the history is read less often, it is not the hot path
+    if ((loops % 64) == 0)
+    {
+      uint16_t numRecords = 0;
+      if (epsShmGetHistory(history, EPS_SHM_HISTORY_SIZE, &numRecords))
+      {
+        result->historyReads++;
+        for (uint16_t i = 0; i < numRecords; i++)
+        {
+          if (!checkRecord(history[i]) ||
+              ((i > 0) && (history[i].timestamp != history[i-1].timestamp + 1)))
+          {
+            result->errors++;
+            break;
+          }
+        }
+      }
+      sched_yield();
+    }
+  }
+  result->elapsed = now_ns() - start;
+  return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+  int readers = DEFAULT_READERS;
+
+  if (argc > 1)
+  {
+    gRecords = strtoull(argv[1], NULL, 10);
+  }
+  if (argc > 2)
+  {
+    readers = atoi(argv[2]);
+  }
+  if ((gRecords < EPS_SHM_HISTORY_SIZE) || (readers <= 0) || (readers > MAX_READERS))
+  {
+    printf("Usage: %s [records [readers]]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  bool ok = true;
+
+  if (!epsShmCreate())
+  {
+    printf("FAILED: epsShmCreate\n");
+    return EXIT_FAILURE;
+  }
+  if (!epsShmOpen())
+  {
+    printf("FAILED: epsShmOpen\n");
+    epsShmDestroy();
+    return EXIT_FAILURE;
+  }
+
+  TEnhancedPositionRecord record;
+  if (epsShmGetLatest(&record))
+  {
+    printf("FAILED: record available before the first update\n");
+    ok = false;
+  }
+
+  static TReaderResult results[MAX_READERS];
+  pthread_t readerThreads[MAX_READERS];
+  pthread_t writerThread;
+
+  memset(results, 0, sizeof(results));
+  for (int i = 0; i < readers; i++)
+  {
+    pthread_create(&readerThreads[i], NULL, reader, &results[i]);
+  }
+  uint64_t start = now_ns();
+  pthread_create(&writerThread, NULL, writer, NULL);
+  pthread_join(writerThread, NULL);
+  double elapsed = (now_ns() - start)/1e9;
+
+  uint64_t reads = 0;
+  uint64_t historyReads = 0;
+  uint64_t errors = 0;
+  uint64_t readTime = 0;
+  for (int i = 0; i < readers; i++)
+  {
+    pthread_join(readerThreads[i], NULL);
+    reads += results[i].reads;
+    historyReads += results[i].historyReads;
+    errors += results[i].errors;
+    readTime += results[i].elapsed;
+  }
+
+  //after the writer has finished, the latest record and the history are complete
+  TEnhancedPositionRecord history[EPS_SHM_HISTORY_SIZE];
+  uint16_t numRecords = 0;
+  if (!epsShmGetLatest(&record) || (record.timestamp != gRecords) || !checkRecord(record))
+  {
+    printf("FAILED: latest record\n");
+    ok = false;
+  }
+  if (!epsShmGetHistory(history, EPS_SHM_HISTORY_SIZE, &numRecords) ||
+      (numRecords != EPS_SHM_HISTORY_SIZE) ||
+      (history[0].timestamp != gRecords - EPS_SHM_HISTORY_SIZE + 1) ||
+      (history[EPS_SHM_HISTORY_SIZE-1].timestamp != gRecords))
+  {
+    printf("FAILED: history\n");
+    ok = false;
+  }
+
+  epsShmDestroy();
+  if (epsShmGetLatest(&record))
+  {
+    printf("FAILED: record available after the service has stopped\n");
+    ok = false;
+  }
+  epsShmClose();
+
+  printf("records %llu (%.1f ns per update), readers %d, reads %llu, history reads %llu, %.1f ns per read\n",
+         (unsigned long long)gRecords,
+         elapsed*1e9/gRecords,
+         readers,
+         (unsigned long long)reads,
+         (unsigned long long)historyReads,
+         reads > 0 ? (double)readTime/reads : 0.0);
+
+  if (errors > 0)
+  {
+    printf("FAILED: %llu inconsistent reads\n", (unsigned long long)errors);
+    ok = false;
+  }
+
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,137 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Test of the publish scheduler
+*
+* \details Simulates GNSS updates at 1Hz and gyroscope batches at a
+* configurable rate against a publish timer, without D-Bus, and checks that
+*   - at most one update is published per interval,
+*   - the changedValues of all updates within an interval are merged,
+*   - no update is lost and nothing is published in idle intervals,
+*   - the latency from an update to its publication is below one interval.
+* Usage: publish-scheduler-test [interval [gyroscope rate]]
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "publish-scheduler.h"
+
+#define GNSS_BITS 0x001F0000ULL
+#define GYRO_BITS 0x0000001FULL
+#define DURATION 60000
+//no input data in the last part of the simulation
+#define IDLE_TIME 5000
+
+static bool gOk = true;
+
+static void check(bool condition, const char* what)
+{
+  if (!condition)
+  {
+    printf("FAILED: %s\n", what);
+    gOk = false;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  int interval = 100;
+  int gyroRate = 50;
+
+  if (argc > 1)
+  {
+    interval = atoi(argv[1]);
+  }
+  if (argc > 2)
+  {
+    gyroRate = atoi(argv[2]);
+  }
+  if ((interval <= 0) || (gyroRate <= 0) || (gyroRate > 1000))
+  {
+    printf("Usage: %s [interval [gyroscope rate]]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  PublishScheduler scheduler;
+  uint64_t posted = 0;
+  uint64_t emissions = 0;
+  uint64_t emittedBits = 0;
+  uint64_t nextTimer = interval;
+  //the timer is not aligned to the input data
+  uint64_t nextGNSS = 37;
+  uint64_t nextGyro = 3;
+  uint64_t gyroPeriod = 1000/gyroRate;
+
+  for (uint64_t t = 0; t < DURATION; t++)
+  {
+    if (t < DURATION - IDLE_TIME)
+    {
+      if (t == nextGNSS)
+      {
+        scheduler.post(GNSS_BITS, t);
+        posted++;
+        nextGNSS += 1000;
+      }
+      if (t == nextGyro)
+      {
+        scheduler.post(GYRO_BITS, t);
+        posted++;
+        nextGyro += gyroPeriod;
+      }
+    }
+
+    if (t == nextTimer)
+    {
+      uint64_t changedValues = 0;
+      if (scheduler.take(t, changedValues))
+      {
+        check(changedValues != 0, "merged changedValues not empty");
+        check(t < (uint64_t)(DURATION - IDLE_TIME + interval), "nothing published when idle");
+        emissions++;
+        emittedBits |= changedValues;
+      }
+      nextTimer += interval;
+    }
+  }
+
+  TPublishStatistics statistics;
+  scheduler.getStatistics(statistics, true);
+
+  printf("interval %d ms, gyroscope %d Hz\n", interval, gyroRate);
+  printf("intervals %llu, emissions %llu, updates %llu, max merged %u, latency mean %.1f ms max %llu ms\n",
+         (unsigned long long)statistics.intervals,
+         (unsigned long long)statistics.emissions,
+         (unsigned long long)statistics.updates,
+         statistics.maxUpdatesPerEmission,
+         statistics.emissions ? (double)statistics.sumLatency/statistics.emissions : 0.0,
+         (unsigned long long)statistics.maxLatency);
+
+  check(statistics.intervals == (uint64_t)((DURATION - 1)/interval), "one take per interval");
+  check(statistics.emissions == emissions, "emissions counted");
+  check(statistics.emissions <= statistics.intervals, "at most one emission per interval");
+  check(statistics.updates == posted, "no update lost");
+  check(emittedBits == (GNSS_BITS | GYRO_BITS), "changedValues merged");
+  check(statistics.maxLatency < (uint64_t)interval, "latency below one interval");
+
+  scheduler.getStatistics(statistics, false);
+  check(statistics.intervals == 0, "statistics reset");
+
+  printf("%s\n", gOk ? "OK" : "FAILED");
+  return gOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,160 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Stress test of the lock-free single producer single consumer queue
+*
+* \details A producer thread pushes sequence numbers as fast as possible,
+* a consumer thread pops them and checks that they arrive in order.
+* By default, the producer retries when the queue is full, so all items
+* must arrive. With a consumer delay, the consumer is slowed down and the
+* producer drops the items that do not fit, like the GNSS thread does;
+* then every item must be either received or counted as dropped.
+* Usage: spsc-queue-test [items [consumer delay in us every 1000 items]]
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+
+#include "spsc-queue.h"
+
+#define DEFAULT_ITEMS 10000000
+
+typedef struct
+{
+  uint64_t sequence;
+  double payload[8];        //roughly the size of a small position record
+} TItem;
+
+static SpscQueue<TItem, 64> gQueue;
+static uint64_t gItems = DEFAULT_ITEMS;
+static int gDelay = 0;
+static std::atomic<bool> gProducerDone(false);
+
+static uint64_t now_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+static void* producer(void*)
+{
+  TItem item;
+
+  for (uint64_t i = 0; i < gItems; i++)
+  {
+    item.sequence = i;
+    item.payload[0] = (double)i;
+    while (!gQueue.push(item) && (gDelay == 0))
+    {
+      sched_yield();
+    }
+  }
+  gProducerDone.store(true);
+  return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc > 1)
+  {
+    gItems = strtoull(argv[1], NULL, 10);
+  }
+  if (argc > 2)
+  {
+    gDelay = atoi(argv[2]);
+  }
+  if ((gItems == 0) || (gDelay < 0))
+  {
+    printf("Usage: %s [items [consumer delay in us every 1000 items]]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  bool ok = true;
+  uint64_t received = 0;
+  uint64_t next = 0;
+  TItem item;
+  pthread_t thread;
+
+  uint64_t start = now_ns();
+  pthread_create(&thread, NULL, producer, NULL);
+
+  for (;;)
+  {
+    //read the flag before popping: once the producer is done, an empty queue means the end
+    bool done = gProducerDone.load();
+    if (!gQueue.pop(item))
+    {
+      if (done)
+      {
+        break;
+      }
+      sched_yield();
+      continue;
+    }
+
+    if ((item.sequence < next) || (item.payload[0] != (double)item.sequence))
+    {
+      printf("FAILED: item %llu received after %llu\n",
+             (unsigned long long)item.sequence, (unsigned long long)next);
+      ok = false;
+      break;
+    }
+    next = item.sequence + 1;
+    received++;
+
+    if ((gDelay > 0) && ((received % 1000) == 0))
+    {
+      usleep(gDelay);
+    }
+  }
+
+  pthread_join(thread, NULL);
+  double elapsed = (now_ns() - start)/1e9;
+
+  printf("items %llu, received %llu, full %llu, max depth %u/%u, %.1f ns per item\n",
+         (unsigned long long)gItems,
+         (unsigned long long)received,
+         (unsigned long long)gQueue.getDrops(),
+         gQueue.takeMaxDepth(),
+         gQueue.capacity(),
+         elapsed*1e9/gItems);
+
+  if ((gDelay == 0) && (received != gItems))
+  {
+    printf("FAILED: items lost\n");
+    ok = false;
+  }
+  if ((gDelay > 0) && (received + gQueue.getDrops() != gItems))
+  {
+    printf("FAILED: items lost\n");
+    ok = false;
+  }
+  if (gQueue.getPushes() != received)
+  {
+    printf("FAILED: push counter\n");
+    ok = false;
+  }
+
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
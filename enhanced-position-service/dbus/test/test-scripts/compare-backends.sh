@@ -0,0 +1,137 @@
+#!/bin/bash
+
+###########################################################################
+# @licence app begin@
+# SPDX-License-Identifier: MPL-2.0
+#
+# Component Name: EnhancedPositionService
+# Author: agent <agent@local>
+#
+# Copyright (C) 2026, agent
+#
+# License:
+# This Source Code Form is subject to the terms of the
+# Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+# this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# @licence end@
+###########################################################################
+
+# Compares the dbus-c++ and the sd-bus build of the enhanced-position-service
+# on a private session bus: introspection, GetPositionInfo call rate and
+# latency (position-info-benchmark), signal rate, CPU time and memory.
+# Requires a build of both backends: -DWITH_TESTS=ON -DWITH_DBUS_CPP=ON -DWITH_SDBUS=ON.
+
+TOP_DIR=../../../..
+BUILD_DIR=$TOP_DIR/build
+
+LOG=$TOP_DIR/log-replayer/logs/geneve-cologny.log
+DURATION=10
+CLIENTS=4
+
+REPLAYER=$BUILD_DIR/log-replayer/src/log-replayer
+BENCHMARK=$BUILD_DIR/enhanced-position-service/dbus/test/position-info-benchmark
+BACKENDS="enhanced-position-service enhanced-position-service-sdbus"
+
+SERVICE=org.genivi.positioning.EnhancedPosition
+OBJECTS="/org/genivi/positioning/EnhancedPosition /org/genivi/positioning/Configuration /org/genivi/positioning/PositionFeedback"
+
+usage() {
+    echo "Usage: "
+    echo "  compare-backends.sh [duration in s [clients]]"
+    echo
+}
+
+if [ "$1" = "-h" ]; then
+    usage
+    exit 0
+fi
+if [ $# -ge 1 ]; then
+    DURATION=$1
+fi
+if [ $# -ge 2 ]; then
+    CLIENTS=$2
+fi
+
+for BACKEND in $BACKENDS; do
+    if [ ! -x $BUILD_DIR/enhanced-position-service/dbus/src/$BACKEND ]; then
+        echo "FAILED: $BACKEND not built"
+        exit 1
+    fi
+done
+
+# private bus, so that no other traffic disturbs the measurement
+eval $(dbus-launch --sh-syntax)
+trap "kill $DBUS_SESSION_BUS_PID > /dev/null 2>&1" EXIT
+
+WORK_DIR=$(mktemp -d)
+
+# ticks of the process since start, see proc(5)
+cpu_ticks() {
+    awk '{ print $14 + $15 }' /proc/$1/stat
+}
+
+mem_kb() {
+    grep "^$2:" /proc/$1/status | awk '{ print $2 }'
+}
+
+# the org.genivi interfaces only, with the attributes in a fixed order:
+# dbus-c++ and sd-bus format the XML differently
+introspect() {
+    for OBJECT in $OBJECTS; do
+        dbus-send --session --print-reply=literal --dest=$SERVICE $OBJECT \
+            org.freedesktop.DBus.Introspectable.Introspect
+    done | awk '
+        function attr(key) { return match($0, key "=\"[^\"]*\"") ? " " substr($0, RSTART, RLENGTH) : "" }
+        /<interface name="org.genivi/ { p = 1 }
+        p && /<(interface|method|signal) / { tag = $1; sub(/^ *</, "", tag); print tag attr("name") }
+        p && /<arg / { print "  arg" attr("name") attr("type") (tag == "signal" ? "" : attr("direction")) }
+        /<\/interface>/ { p = 0 }'
+}
+
+for BACKEND in $BACKENDS; do
+    echo "Starting $BACKEND..."
+    $REPLAYER $LOG > /dev/null 2>&1 &
+    REPLAYER_PID=$!
+    $BUILD_DIR/enhanced-position-service/dbus/src/$BACKEND > /dev/null 2>&1 &
+    SERVICE_PID=$!
+    sleep 2
+
+    introspect > $WORK_DIR/$BACKEND.introspection
+
+    dbus-monitor --session "type='signal',interface='$SERVICE'" > $WORK_DIR/$BACKEND.signals 2> /dev/null &
+    MONITOR_PID=$!
+
+    TICKS_START=$(cpu_ticks $SERVICE_PID)
+    $BENCHMARK $CLIENTS $DURATION > $WORK_DIR/$BACKEND.benchmark
+    TICKS_END=$(cpu_ticks $SERVICE_PID)
+
+    kill $MONITOR_PID
+    SIGNALS=$(grep -c "^signal" $WORK_DIR/$BACKEND.signals)
+
+    echo "$BACKEND" \
+         "$(grep "^calls" $WORK_DIR/$BACKEND.benchmark)" \
+         "signals $SIGNALS ($((SIGNALS / DURATION))/s)" \
+         "cpu $(((TICKS_END - TICKS_START) * 100 / $(getconf CLK_TCK) / DURATION))%" \
+         "VmRSS $(mem_kb $SERVICE_PID VmRSS) kB VmHWM $(mem_kb $SERVICE_PID VmHWM) kB" \
+         >> $WORK_DIR/results
+
+    kill $SERVICE_PID
+    kill $REPLAYER_PID
+    wait $SERVICE_PID $REPLAYER_PID 2> /dev/null
+done
+
+echo
+cat $WORK_DIR/results
+echo
+
+if diff $WORK_DIR/enhanced-position-service.introspection $WORK_DIR/enhanced-position-service-sdbus.introspection; then
+    echo "OK"
+    RESULT=0
+else
+    echo "FAILED: the introspection data differ"
+    RESULT=1
+fi
+
+rm -rf $WORK_DIR
+exit $RESULT
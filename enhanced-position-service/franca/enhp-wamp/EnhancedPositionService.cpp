@@ -25,6 +25,7 @@
 * @licence end@
 */
 
+#include <signal.h>
 #include <iostream>
 #include <thread>
 
@@ -34,12 +35,18 @@
 
 #define REGISTER_COUNTER 10
 #define REGISTER_SLEEP 50
-#define LOOP_GNSS 500
 
 using namespace v5::org::genivi::enhancedpositionservice;
 
 int main(int argc, const char * const argv[])
 {
+    //before any thread is started: SIGINT and SIGTERM are received by sigwait() only
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
     CommonAPI::Runtime::setProperty("LibraryBase", "EnhancedPositionService");
 
 	std::shared_ptr<CommonAPI::Runtime> runtime = CommonAPI::Runtime::get();
@@ -60,11 +67,18 @@ int main(int argc, const char * const argv[])
         successfullyRegistered = runtime->registerService(domain, instanceEnhp, serviceEnhp);
     }
 
-    std::cout << "Waiting for calls... (Abort with CTRL+C)" << std::endl;
-    while (true) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(LOOP_GNSS));
+    if (!serviceEnhp->run()) {
+        std::cout << "unable to connect to the GNSS service" << std::endl;
+        runtime->unregisterService(domain, EnhancedPosition::getInterface(), instanceEnhp);
+        return EXIT_FAILURE;
     }
 
+    std::cout << "Waiting for calls... (Abort with CTRL+C)" << std::endl;
+    int signal = 0;
+    sigwait(&signals, &signal);
+
+    serviceEnhp->shutdown();
+    runtime->unregisterService(domain, EnhancedPosition::getInterface(), instanceEnhp);
+
 	return 0;
 }
-
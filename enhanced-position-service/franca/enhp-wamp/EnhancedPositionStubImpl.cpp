@@ -25,40 +25,326 @@
 * @licence end@
 */
 
+#include <string.h>
+#include <iostream>
+
 #include "EnhancedPositionStubImpl.hpp"
 
+//EnhancedPosition-interface version
+#define VER_MAJOR 5
+#define VER_MINOR 1
+#define VER_MICRO 0
+#define VER_DATE "18-10-2026"
+
+//minimum interval between two PositionUpdate broadcasts [ms], the interface allows 10Hz at most
+#define PUBLISH_INTERVAL 100
+//maximum number of epochs waiting for the publisher, the oldest ones are dropped beyond
+#define EPOCHS_MAX 50
+
 namespace v5 {
 namespace org {
 namespace genivi {
 namespace enhancedpositionservice {
 
-EnhancedPositionStubImpl::EnhancedPositionStubImpl() : EnhancedPositionStubDefault(){
-    std::cout << "EnhancedPositionStubImpl constructor called" << std::endl;
-//    m_PositionInfo[EnhancedPositionServiceTypes::PositionInfoKey::LATITUDE]=47.31608607;
-//    m_PositionInfo[EnhancedPositionServiceTypes::PositionInfoKey::LONGITUDE]=6.23329262;
-//    m_PositionInfo[EnhancedPositionServiceTypes::PositionInfoKey::ALTITUDE]=337;
+EnhancedPositionStubImpl* EnhancedPositionStubImpl::mpSelf = 0;
+
+EnhancedPositionStubImpl::EnhancedPositionStubImpl() : EnhancedPositionStubDefault(),
+    mDroppedEpochs(0),
+    mIsRunning(false)
+{
+    mpSelf = this;
 }
 
 EnhancedPositionStubImpl::~EnhancedPositionStubImpl(){
+    shutdown();
+    mpSelf = 0;
+}
+
+bool EnhancedPositionStubImpl::run()
+{
+    int major = -1;
 
+    gnssGetVersion(&major, 0, 0);
+    if (major != GENIVI_GNSS_API_MAJOR)
+    {
+        std::cerr << "Wrong API version: gnssGetVersion returned unexpected value " << major << std::endl;
+        return false;
+    }
+
+    if (!gnssInit())
+    {
+        std::cerr << "gnssInit failed" << std::endl;
+        return false;
+    }
+
+    mIsRunning = true;
+    mPublisher = std::thread(&EnhancedPositionStubImpl::publish, this);
+
+    gnssRegisterPositionCallback(&cbPosition);
+    return true;
+}
+
+void EnhancedPositionStubImpl::shutdown()
+{
+    if (!mPublisher.joinable())
+    {
+        return;
+    }
+
+    gnssDeregisterPositionCallback(&cbPosition);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsRunning = false;
+    }
+    mCondition.notify_one();
+    mPublisher.join();
+
+    gnssDestroy();
+
+    if (mDroppedEpochs)
+    {
+        std::cout << "PositionUpdateData: " << mDroppedEpochs << " epochs dropped" << std::endl;
+    }
+}
+
+void EnhancedPositionStubImpl::cbPosition(const TGNSSPosition position[], uint16_t numElements)
+{
+    if (position == NULL || numElements < 1 || !mpSelf)
+    {
+        return;
+    }
+
+    mpSelf->addEpochs(position, numElements);
+}
+
+//GNSS thread: queue the epochs for the publisher thread
+void EnhancedPositionStubImpl::addEpochs(const TGNSSPosition position[], uint16_t numElements)
+{
+    std::vector<EnhancedPositionServiceTypes::PositionEpoch> epochs;
+
+    //the data are converted outside of the lock
+    for (uint16_t i = 0; i < numElements; i++)
+    {
+        EnhancedPositionServiceTypes::Bitmask changedValues = getChangedValues(position[i]);
+        EnhancedPositionServiceTypes::PositionInfo data;
+
+        if (changedValues == 0)
+        {
+            continue;
+        }
+
+        getPositionInfo(position[i], changedValues, data);
+        epochs.push_back(EnhancedPositionServiceTypes::PositionEpoch(changedValues, position[i].timestamp, data));
+    }
+
+    if (epochs.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (size_t i = 0; i < epochs.size(); i++)
+        {
+            if (mEpochs.size() >= EPOCHS_MAX)
+            {
+                mEpochs.pop_front();
+                mDroppedEpochs++;
+            }
+            mEpochs.push_back(epochs[i]);
+        }
+    }
+    mCondition.notify_one();
+}
+
+//publisher thread: one PositionUpdate and one PositionUpdateData per interval at most.
+//When the GNSS epochs arrive faster, or the transport is slow to accept a publication,
+//the epochs received in the meantime are sent together in the next PositionUpdateData.
+void EnhancedPositionStubImpl::publish()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    std::chrono::steady_clock::time_point nextPublication = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        mCondition.wait(lock, [this]() { return !mIsRunning || !mEpochs.empty(); });
+        if (!mIsRunning)
+        {
+            break;
+        }
+
+        if (mCondition.wait_until(lock, nextPublication, [this]() { return !mIsRunning; }))
+        {
+            break;
+        }
+
+        std::vector<EnhancedPositionServiceTypes::PositionEpoch> epochs(mEpochs.begin(), mEpochs.end());
+        mEpochs.clear();
+        lock.unlock();
+
+        EnhancedPositionServiceTypes::Bitmask changedValues = 0;
+        for (size_t i = 0; i < epochs.size(); i++)
+        {
+            changedValues |= epochs[i].getChangedValues();
+        }
+
+        firePositionUpdateEvent(changedValues);
+        firePositionUpdateDataEvent(epochs);
+
+        nextPublication = std::chrono::steady_clock::now() + std::chrono::milliseconds(PUBLISH_INTERVAL);
+        lock.lock();
+    }
+}
+
+EnhancedPositionServiceTypes::Bitmask EnhancedPositionStubImpl::getChangedValues(const TGNSSPosition& position)
+{
+    static const struct {
+        uint32_t validityBit;
+        EnhancedPositionServiceTypes::PositionInfoKey::Literal key;
+    } keys[] = {
+        { GNSS_POSITION_LATITUDE_VALID, EnhancedPositionServiceTypes::PositionInfoKey::LATITUDE },
+        { GNSS_POSITION_LONGITUDE_VALID, EnhancedPositionServiceTypes::PositionInfoKey::LONGITUDE },
+        { GNSS_POSITION_ALTITUDEMSL_VALID, EnhancedPositionServiceTypes::PositionInfoKey::ALTITUDE },
+        { GNSS_POSITION_HEADING_VALID, EnhancedPositionServiceTypes::PositionInfoKey::HEADING },
+        { GNSS_POSITION_HSPEED_VALID, EnhancedPositionServiceTypes::PositionInfoKey::SPEED },
+        { GNSS_POSITION_VSPEED_VALID, EnhancedPositionServiceTypes::PositionInfoKey::CLIMB },
+        { GNSS_POSITION_PDOP_VALID, EnhancedPositionServiceTypes::PositionInfoKey::PDOP },
+        { GNSS_POSITION_HDOP_VALID, EnhancedPositionServiceTypes::PositionInfoKey::HDOP },
+        { GNSS_POSITION_VDOP_VALID, EnhancedPositionServiceTypes::PositionInfoKey::VDOP },
+        { GNSS_POSITION_USAT_VALID, EnhancedPositionServiceTypes::PositionInfoKey::USED_SATELLITES },
+        { GNSS_POSITION_TSAT_VALID, EnhancedPositionServiceTypes::PositionInfoKey::TRACKED_SATELLITES },
+        { GNSS_POSITION_VSAT_VALID, EnhancedPositionServiceTypes::PositionInfoKey::VISIBLE_SATELLITES },
+        { GNSS_POSITION_SHPOS_VALID, EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HPOSITION },
+        { GNSS_POSITION_SALT_VALID, EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_ALTITUDE },
+        { GNSS_POSITION_SHEADING_VALID, EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HEADING },
+        { GNSS_POSITION_SHSPEED_VALID, EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_SPEED },
+        { GNSS_POSITION_SVSPEED_VALID, EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_CLIMB },
+        { GNSS_POSITION_STAT_VALID, EnhancedPositionServiceTypes::PositionInfoKey::GNSS_FIX_STATUS }
+    };
+    EnhancedPositionServiceTypes::Bitmask changedValues = 0;
+
+    for (size_t i = 0; i < sizeof(keys)/sizeof(keys[0]); i++)
+    {
+        if (position.validityBits & keys[i].validityBit)
+        {
+            changedValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(keys[i].key);
+        }
+    }
+
+    return changedValues;
+}
+
+//requested values of one epoch, the invalid ones are not returned
+void EnhancedPositionStubImpl::getPositionInfo(const TGNSSPosition& position, EnhancedPositionServiceTypes::Bitmask valuesToReturn, EnhancedPositionServiceTypes::PositionInfo& data)
+{
+    EnhancedPositionServiceTypes::Bitmask values = valuesToReturn & getChangedValues(position);
+
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::LATITUDE))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::LATITUDE] = position.latitude;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::LONGITUDE))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::LONGITUDE] = position.longitude;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::ALTITUDE))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::ALTITUDE] = (double) position.altitudeMSL;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::HEADING))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::HEADING] = (double) position.heading;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SPEED))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::SPEED] = (double) position.hSpeed;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::CLIMB))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::CLIMB] = (double) position.vSpeed;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::PDOP))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::PDOP] = (double) position.pdop;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::HDOP))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::HDOP] = (double) position.hdop;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::VDOP))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::VDOP] = (double) position.vdop;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::USED_SATELLITES))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::USED_SATELLITES] = (uint64_t) position.usedSatellites;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::TRACKED_SATELLITES))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::TRACKED_SATELLITES] = (uint64_t) position.trackedSatellites;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::VISIBLE_SATELLITES))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::VISIBLE_SATELLITES] = (uint64_t) position.visibleSatellites;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HPOSITION))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HPOSITION] = (double) position.sigmaHPosition;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_ALTITUDE))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_ALTITUDE] = (double) position.sigmaAltitude;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HEADING))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HEADING] = (double) position.sigmaHeading;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_SPEED))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_SPEED] = (double) position.sigmaHSpeed;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_CLIMB))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_CLIMB] = (double) position.sigmaVSpeed;
+    }
+    if (values & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::GNSS_FIX_STATUS))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::GNSS_FIX_STATUS] = (uint64_t) position.fixStatus;
+    }
+}
+
+void EnhancedPositionStubImpl::GetVersion(const std::shared_ptr<CommonAPI::ClientId> _client, GetVersionReply_t _reply){
+    EnhancedPositionServiceTypes::Version version(VER_MAJOR, VER_MINOR, VER_MICRO, std::string(VER_DATE));
+    _reply(version);
 }
 
 void EnhancedPositionStubImpl::GetPositionInfo(const std::shared_ptr<CommonAPI::ClientId> _client, EnhancedPositionServiceTypes::Bitmask _valuesToReturn, GetPositionInfoReply_t _reply){
-    EnhancedPositionServiceTypes::Timestamp _timestamp;
+    EnhancedPositionServiceTypes::Timestamp _timestamp = 0;
     EnhancedPositionServiceTypes::PositionInfo _data;
+    TGNSSPosition position;
 
+    if (gnssGetPosition(&position))
+    {
+        _timestamp = position.timestamp;
+        getPositionInfo(position, _valuesToReturn, _data);
+    }
     _reply(_timestamp,_data);
 }
 
 void EnhancedPositionStubImpl::GetSatelliteInfo(const std::shared_ptr<CommonAPI::ClientId> _client, GetSatelliteInfoReply_t _reply){
     EnhancedPositionServiceTypes::Timestamp _timestamp;
-    EnhancedPositionServiceTypes::SatelliteInfo _satelliteInfo;
+    std::vector<EnhancedPositionServiceTypes::SatelliteInfo> _satelliteInfo;
+
+    getGnssSatelliteInfo<EnhancedPositionServiceTypes>(_timestamp, _satelliteInfo);
     _reply(_timestamp,_satelliteInfo);
 }
 
 void EnhancedPositionStubImpl::GetTime(const std::shared_ptr<CommonAPI::ClientId> _client, GetTimeReply_t _reply){
     EnhancedPositionServiceTypes::Timestamp _timestamp;
     EnhancedPositionServiceTypes::TimeInfo _time;
+
+    getGnssTimeInfo<EnhancedPositionServiceTypes>(_timestamp, _time);
     _reply(_timestamp,_time);
 }
 
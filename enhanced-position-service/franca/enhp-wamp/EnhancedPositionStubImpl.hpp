@@ -28,8 +28,19 @@
 #ifndef EnhancedPositionStubImpl_H_
 #define EnhancedPositionStubImpl_H_
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "v5/org/genivi/enhancedpositionservice/EnhancedPositionStubDefault.hpp"
 
+#include "gnss-init.h"
+#include "gnss.h"
+#include "GnssConversion.hpp"
+
 namespace v5 {
 namespace org {
 namespace genivi {
@@ -43,17 +54,40 @@ public:
 
     virtual const CommonAPI::Version& getInterfaceVersion(std::shared_ptr<CommonAPI::ClientId> clientId);
 
+    virtual void GetVersion(const std::shared_ptr<CommonAPI::ClientId> _client, GetVersionReply_t _reply);
+
     virtual void GetPositionInfo(const std::shared_ptr<CommonAPI::ClientId> _client, ::v5::org::genivi::enhancedpositionservice::EnhancedPositionServiceTypes::Bitmask _valuesToReturn, GetPositionInfoReply_t _reply);
 
     virtual void GetSatelliteInfo(const std::shared_ptr<CommonAPI::ClientId> _client, GetSatelliteInfoReply_t _reply);
 
     virtual void GetTime(const std::shared_ptr<CommonAPI::ClientId> _client, GetTimeReply_t _reply);
 
-    EnhancedPositionServiceTypes::PositionInfo m_PositionInfo;
-    EnhancedPositionServiceTypes::SatelliteInfo m_constSatelliteInfo;
-    EnhancedPositionServiceTypes::TimeInfo m_constTimeInfo;
+    /**
+     * Connect to the GNSS service and start publishing the position updates
+     * @return false if the GNSS service is not available
+     */
+    bool run();
+
+    /**
+     * Stop publishing and disconnect from the GNSS service
+     */
+    void shutdown();
+
 private:
+    static void cbPosition(const TGNSSPosition position[], uint16_t numElements);
+    static EnhancedPositionServiceTypes::Bitmask getChangedValues(const TGNSSPosition& position);
+    static void getPositionInfo(const TGNSSPosition& position, EnhancedPositionServiceTypes::Bitmask valuesToReturn, EnhancedPositionServiceTypes::PositionInfo& data);
+    void addEpochs(const TGNSSPosition position[], uint16_t numElements);
+    void publish();
 
+    //epochs received from the GNSS thread, waiting for the publisher thread
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<EnhancedPositionServiceTypes::PositionEpoch> mEpochs;
+    uint64_t mDroppedEpochs;
+    bool mIsRunning;
+    std::thread mPublisher;
+    static EnhancedPositionStubImpl* mpSelf;
 };
 
 } // namespace enhancedpositionservice
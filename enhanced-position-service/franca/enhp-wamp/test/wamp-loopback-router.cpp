@@ -0,0 +1,1726 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Minimal WAMP router on the loopback interface for the enhp-wamp tests
+*
+* \details The router implements the WAMP basic profile (publish/subscribe and
+* routed calls) over RawSocket with MessagePack serialization, the transport
+* of autobahn-cpp. It accepts connections on 127.0.0.1 only, uses a single
+* realm and no authentication, so the WAMP service can be tested and measured
+* without any external router.
+*
+* Usage:
+*   wamp-loopback-router [-p port] [-v]
+*     routes until SIGINT/SIGTERM, -v prints the statistics every second
+*   wamp-loopback-router -b [-n epochs] [-B epochs per message] [-r rate] [-c calls]
+*     benchmark: starts the router and a publisher, a subscriber and a callee
+*     on the loopback interface, and reports the throughput and the latency
+*     of the PositionUpdateData-like events and of the calls
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define DEFAULT_PORT 8000
+//2^(9+15) = 16 MB, the largest message length RawSocket allows
+#define RAWSOCKET_MAX_LENGTH_EXP 15
+#define RAWSOCKET_MAGIC 0x7F
+#define RAWSOCKET_SERIALIZER_MSGPACK 2
+#define RAWSOCKET_ERROR_SERIALIZER_UNSUPPORTED 1
+//events for a subscriber that does not read are dropped beyond this [bytes]
+#define OUTPUT_LIMIT (4*1024*1024)
+#define EPOLL_EVENTS_MAX 64
+#define BENCH_TOPIC "org.genivi.enhancedpositionservice.bench.PositionUpdateData"
+#define BENCH_PROCEDURE "org.genivi.enhancedpositionservice.bench.GetPositionInfo"
+#define BENCH_TIMEOUT 10000
+
+enum WampMessage
+{
+    HELLO = 1,
+    WELCOME = 2,
+    ABORT = 3,
+    GOODBYE = 6,
+    ERROR = 8,
+    PUBLISH = 16,
+    PUBLISHED = 17,
+    SUBSCRIBE = 32,
+    SUBSCRIBED = 33,
+    UNSUBSCRIBE = 34,
+    UNSUBSCRIBED = 35,
+    EVENT = 36,
+    CALL = 48,
+    RESULT = 50,
+    REGISTER = 64,
+    REGISTERED = 65,
+    UNREGISTER = 66,
+    UNREGISTERED = 67,
+    INVOCATION = 68,
+    YIELD = 70
+};
+
+static uint64_t getMonotonicTimeUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000 + ts.tv_nsec/1000;
+}
+
+/**
+ * MessagePack encoding of the few types a WAMP router needs,
+ * arguments are copied as they are
+ */
+class MsgPackWriter
+{
+public:
+    void array(uint32_t size)
+    {
+        if (size < 16)
+        {
+            byte(0x90 | size);
+        }
+        else
+        {
+            byte(0xdd);
+            be(size, 4);
+        }
+    }
+
+    void map(uint32_t size)
+    {
+        if (size < 16)
+        {
+            byte(0x80 | size);
+        }
+        else
+        {
+            byte(0xdf);
+            be(size, 4);
+        }
+    }
+
+    void uint(uint64_t value)
+    {
+        if (value < 128)
+        {
+            byte((uint8_t)value);
+        }
+        else if (value <= 0xFFFFFFFF)
+        {
+            byte(0xce);
+            be(value, 4);
+        }
+        else
+        {
+            byte(0xcf);
+            be(value, 8);
+        }
+    }
+
+    void dbl(double value)
+    {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        byte(0xcb);
+        be(bits, 8);
+    }
+
+    void boolean(bool value)
+    {
+        byte(value ? 0xc3 : 0xc2);
+    }
+
+    void str(const std::string& value)
+    {
+        if (value.size() < 32)
+        {
+            byte(0xa0 | value.size());
+        }
+        else
+        {
+            byte(0xdb);
+            be(value.size(), 4);
+        }
+        mBuffer.append(value);
+    }
+
+    void raw(const std::string& encoded)
+    {
+        mBuffer.append(encoded);
+    }
+
+    const std::string& buffer() const
+    {
+        return mBuffer;
+    }
+
+private:
+    void byte(uint8_t value)
+    {
+        mBuffer.push_back((char)value);
+    }
+
+    void be(uint64_t value, int size)
+    {
+        for (int i = size - 1; i >= 0; i--)
+        {
+            byte((uint8_t)(value >> (8*i)));
+        }
+    }
+
+    std::string mBuffer;
+};
+
+class MsgPackReader
+{
+public:
+    MsgPackReader(const std::string& buffer)
+        : mBuffer(buffer)
+        , mPos(0)
+    {
+    }
+
+    bool array(uint32_t& size)
+    {
+        uint8_t type;
+        if (!byte(type))
+        {
+            return false;
+        }
+        if ((type & 0xf0) == 0x90)
+        {
+            size = type & 0x0f;
+            return true;
+        }
+        uint64_t value;
+        if (type == 0xdc && be(2, value))
+        {
+            size = (uint32_t)value;
+            return true;
+        }
+        if (type == 0xdd && be(4, value))
+        {
+            size = (uint32_t)value;
+            return true;
+        }
+        return false;
+    }
+
+    bool map(uint32_t& size)
+    {
+        uint8_t type;
+        if (!byte(type))
+        {
+            return false;
+        }
+        if ((type & 0xf0) == 0x80)
+        {
+            size = type & 0x0f;
+            return true;
+        }
+        uint64_t value;
+        if (type == 0xde && be(2, value))
+        {
+            size = (uint32_t)value;
+            return true;
+        }
+        if (type == 0xdf && be(4, value))
+        {
+            size = (uint32_t)value;
+            return true;
+        }
+        return false;
+    }
+
+    bool uint(uint64_t& value)
+    {
+        uint8_t type;
+        if (!byte(type))
+        {
+            return false;
+        }
+        if (type < 0x80)
+        {
+            value = type;
+            return true;
+        }
+        switch (type)
+        {
+            case 0xcc: return be(1, value);
+            case 0xcd: return be(2, value);
+            case 0xce: return be(4, value);
+            case 0xcf: return be(8, value);
+            //non-negative signed integers as some encoders write them
+            case 0xd0: return be(1, value) && value < 0x80;
+            case 0xd1: return be(2, value) && value < 0x8000;
+            case 0xd2: return be(4, value) && value < 0x80000000;
+            case 0xd3: return be(8, value) && value < 0x8000000000000000ULL;
+            default: return false;
+        }
+    }
+
+    bool dbl(double& value)
+    {
+        uint8_t type;
+        uint64_t bits;
+        if (!byte(type) || type != 0xcb || !be(8, bits))
+        {
+            return false;
+        }
+        memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+
+    bool boolean(bool& value)
+    {
+        uint8_t type;
+        if (!byte(type) || (type != 0xc2 && type != 0xc3))
+        {
+            return false;
+        }
+        value = (type == 0xc3);
+        return true;
+    }
+
+    bool str(std::string& value)
+    {
+        uint8_t type;
+        uint64_t length;
+        if (!byte(type))
+        {
+            return false;
+        }
+        if ((type & 0xe0) == 0xa0)
+        {
+            length = type & 0x1f;
+        }
+        else if (!((type == 0xd9 && be(1, length)) || (type == 0xda && be(2, length)) || (type == 0xdb && be(4, length))))
+        {
+            return false;
+        }
+        if (length > mBuffer.size() - mPos)
+        {
+            return false;
+        }
+        value = mBuffer.substr(mPos, length);
+        mPos += length;
+        return true;
+    }
+
+    /**
+     * Skip one value, nested values included
+     * @param encoded the encoded value if not null
+     */
+    bool skip(std::string* encoded = 0)
+    {
+        size_t start = mPos;
+        if (!skipValue(0))
+        {
+            return false;
+        }
+        if (encoded)
+        {
+            encoded->assign(mBuffer, start, mPos - start);
+        }
+        return true;
+    }
+
+    bool atEnd() const
+    {
+        return mPos >= mBuffer.size();
+    }
+
+private:
+    bool byte(uint8_t& value)
+    {
+        if (mPos >= mBuffer.size())
+        {
+            return false;
+        }
+        value = (uint8_t)mBuffer[mPos++];
+        return true;
+    }
+
+    bool be(int size, uint64_t& value)
+    {
+        if ((size_t)size > mBuffer.size() - mPos)
+        {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < size; i++)
+        {
+            value = (value << 8) | (uint8_t)mBuffer[mPos++];
+        }
+        return true;
+    }
+
+    bool skipBytes(uint64_t length)
+    {
+        if (length > mBuffer.size() - mPos)
+        {
+            return false;
+        }
+        mPos += length;
+        return true;
+    }
+
+    bool skipValues(uint64_t count, int depth)
+    {
+        for (uint64_t i = 0; i < count; i++)
+        {
+            if (!skipValue(depth + 1))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool skipValue(int depth)
+    {
+        uint8_t type;
+        uint64_t length;
+
+        if (depth > 32 || !byte(type))
+        {
+            return false;
+        }
+        if (type < 0x80 || type >= 0xe0 || type == 0xc0 || type == 0xc2 || type == 0xc3)
+        {
+            return true;
+        }
+        if ((type & 0xf0) == 0x80)
+        {
+            return skipValues(2*(type & 0x0f), depth);
+        }
+        if ((type & 0xf0) == 0x90)
+        {
+            return skipValues(type & 0x0f, depth);
+        }
+        if ((type & 0xe0) == 0xa0)
+        {
+            return skipBytes(type & 0x1f);
+        }
+        switch (type)
+        {
+            case 0xc4: case 0xd9: return be(1, length) && skipBytes(length);
+            case 0xc5: case 0xda: return be(2, length) && skipBytes(length);
+            case 0xc6: case 0xdb: return be(4, length) && skipBytes(length);
+            case 0xc7: return be(1, length) && skipBytes(length + 1);
+            case 0xc8: return be(2, length) && skipBytes(length + 1);
+            case 0xc9: return be(4, length) && skipBytes(length + 1);
+            case 0xca: return skipBytes(4);
+            case 0xcb: return skipBytes(8);
+            case 0xcc: case 0xd0: return skipBytes(1);
+            case 0xcd: case 0xd1: return skipBytes(2);
+            case 0xce: case 0xd2: return skipBytes(4);
+            case 0xcf: case 0xd3: return skipBytes(8);
+            case 0xd4: return skipBytes(2);
+            case 0xd5: return skipBytes(3);
+            case 0xd6: return skipBytes(5);
+            case 0xd7: return skipBytes(9);
+            case 0xd8: return skipBytes(17);
+            case 0xdc: return be(2, length) && skipValues(length, depth);
+            case 0xdd: return be(4, length) && skipValues(length, depth);
+            case 0xde: return be(2, length) && skipValues(2*length, depth);
+            case 0xdf: return be(4, length) && skipValues(2*length, depth);
+            default: return false;
+        }
+    }
+
+    const std::string& mBuffer;
+    size_t mPos;
+};
+
+//the rest of a message after the fixed fields: Arguments|list and ArgumentsKw|dict, both optional
+static bool readPayload(MsgPackReader& reader, uint32_t remaining, std::vector<std::string>& payload)
+{
+    payload.resize(remaining);
+    for (uint32_t i = 0; i < remaining; i++)
+    {
+        if (!reader.skip(&payload[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void writePayload(MsgPackWriter& writer, const std::vector<std::string>& payload)
+{
+    for (size_t i = 0; i < payload.size(); i++)
+    {
+        writer.raw(payload[i]);
+    }
+}
+
+//the keys of interest of an Options|dict
+static bool readOptions(MsgPackReader& reader, bool* acknowledge)
+{
+    uint32_t size;
+    if (!reader.map(size))
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < size; i++)
+    {
+        std::string key;
+        if (!reader.str(key))
+        {
+            return false;
+        }
+        if (acknowledge && key == "acknowledge")
+        {
+            if (!reader.boolean(*acknowledge))
+            {
+                return false;
+            }
+        }
+        else if (!reader.skip())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Statistics of the router, read by the benchmark from another thread
+ */
+struct RouterStatistics
+{
+    std::atomic<uint64_t> publications;
+    std::atomic<uint64_t> events;
+    std::atomic<uint64_t> droppedEvents;
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> callTime; //sum of CALL to YIELD [us]
+    std::atomic<uint64_t> maxCallTime;
+    std::atomic<uint64_t> bytesIn;
+    std::atomic<uint64_t> bytesOut;
+
+    RouterStatistics()
+        : publications(0), events(0), droppedEvents(0), calls(0)
+        , callTime(0), maxCallTime(0), bytesIn(0), bytesOut(0)
+    {
+    }
+};
+
+class Router
+{
+public:
+    Router()
+        : mListenFd(-1)
+        , mEpollFd(-1)
+        , mPort(0)
+        , mQuit(false)
+        , mNextId(1)
+    {
+    }
+
+    ~Router()
+    {
+        while (!mSessions.empty())
+        {
+            closeSession(mSessions.begin()->first);
+        }
+        if (mListenFd >= 0)
+        {
+            close(mListenFd);
+        }
+        if (mEpollFd >= 0)
+        {
+            close(mEpollFd);
+        }
+    }
+
+    /**
+     * @param port 0 for any free port, see getPort()
+     */
+    bool init(uint16_t port)
+    {
+        struct sockaddr_in address;
+        socklen_t length = sizeof(address);
+        int on = 1;
+
+        mListenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (mListenFd < 0 || mEpollFd < 0)
+        {
+            perror("socket");
+            return false;
+        }
+
+        setsockopt(mListenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        if (bind(mListenFd, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+            listen(mListenFd, 16) < 0 ||
+            getsockname(mListenFd, (struct sockaddr*)&address, &length) < 0)
+        {
+            perror("bind");
+            return false;
+        }
+        mPort = ntohs(address.sin_port);
+
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = mListenFd;
+        return epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mListenFd, &event) == 0;
+    }
+
+    uint16_t getPort() const
+    {
+        return mPort;
+    }
+
+    /**
+     * Route until quit() is called
+     * @param onSecond called every second on the router thread, may be empty
+     */
+    void run(std::function<void()> onSecond)
+    {
+        struct epoll_event events[EPOLL_EVENTS_MAX];
+        uint64_t nextSecond = getMonotonicTimeUs() + 1000000;
+
+        while (!mQuit)
+        {
+            int count = epoll_wait(mEpollFd, events, EPOLL_EVENTS_MAX, 100);
+            if (count < 0 && errno != EINTR)
+            {
+                perror("epoll_wait");
+                break;
+            }
+            for (int i = 0; i < count; i++)
+            {
+                if (events[i].data.fd == mListenFd)
+                {
+                    accept();
+                }
+                else
+                {
+                    onSessionReady(events[i].data.fd, events[i].events);
+                }
+            }
+            if (onSecond && getMonotonicTimeUs() >= nextSecond)
+            {
+                onSecond();
+                nextSecond += 1000000;
+            }
+        }
+    }
+
+    void quit()
+    {
+        mQuit = true;
+    }
+
+    RouterStatistics mStatistics;
+
+private:
+    struct Session
+    {
+        Session()
+            : id(0)
+            , isConnected(false)
+            , maxLength(0)
+            , isClosing(false)
+        {
+        }
+
+        uint64_t id;            //0 until WELCOME
+        bool isConnected;       //RawSocket handshake done
+        uint32_t maxLength;     //largest message the peer accepts
+        bool isClosing;         //close when the output is sent
+        std::string input;
+        std::string output;
+    };
+
+    struct Subscription
+    {
+        uint64_t id;
+        std::set<int> subscribers;
+    };
+
+    struct Registration
+    {
+        uint64_t id;
+        int callee;
+    };
+
+    struct Invocation
+    {
+        int caller;
+        uint64_t request;
+        uint64_t start;
+    };
+
+    uint64_t nextId()
+    {
+        return mNextId++;
+    }
+
+    void accept()
+    {
+        int fd;
+        int on = 1;
+
+        while ((fd = accept4(mListenFd, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+        {
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &event);
+            mSessions[fd] = Session();
+        }
+    }
+
+    void onSessionReady(int fd, uint32_t events)
+    {
+        std::map<int, Session>::iterator it = mSessions.find(fd);
+        if (it == mSessions.end())
+        {
+            return;
+        }
+
+        if (events & (EPOLLERR | EPOLLHUP))
+        {
+            closeSession(fd);
+            return;
+        }
+
+        if (events & EPOLLOUT)
+        {
+            flush(fd);
+            if (mSessions.find(fd) == mSessions.end())
+            {
+                return;
+            }
+        }
+
+        if (events & EPOLLIN)
+        {
+            char buffer[65536];
+            ssize_t length = read(fd, buffer, sizeof(buffer));
+            if (length <= 0)
+            {
+                if (length == 0 || (errno != EAGAIN && errno != EINTR))
+                {
+                    closeSession(fd);
+                }
+                return;
+            }
+            mStatistics.bytesIn += length;
+            it->second.input.append(buffer, length);
+            if (!processInput(fd))
+            {
+                closeSession(fd);
+            }
+        }
+    }
+
+    bool processInput(int fd)
+    {
+        Session& session = mSessions[fd];
+        size_t pos = 0;
+
+        if (!session.isConnected)
+        {
+            if (session.input.size() < 4)
+            {
+                return true;
+            }
+            const uint8_t* handshake = (const uint8_t*)session.input.data();
+            if (handshake[0] != RAWSOCKET_MAGIC)
+            {
+                return false;
+            }
+            if ((handshake[1] & 0x0f) != RAWSOCKET_SERIALIZER_MSGPACK)
+            {
+                const char reply[4] = { (char)RAWSOCKET_MAGIC, (char)(RAWSOCKET_ERROR_SERIALIZER_UNSUPPORTED << 4), 0, 0 };
+                session.output.append(reply, 4);
+                session.isClosing = true;
+                flush(fd);
+                return true;
+            }
+            session.maxLength = 1 << (9 + (handshake[1] >> 4));
+            const char reply[4] = { (char)RAWSOCKET_MAGIC, (char)((RAWSOCKET_MAX_LENGTH_EXP << 4) | RAWSOCKET_SERIALIZER_MSGPACK), 0, 0 };
+            session.output.append(reply, 4);
+            session.isConnected = true;
+            pos = 4;
+        }
+
+        while (session.input.size() - pos >= 4)
+        {
+            const uint8_t* header = (const uint8_t*)session.input.data() + pos;
+            uint32_t length = (header[1] << 16) | (header[2] << 8) | header[3];
+            uint8_t type = header[0] & 0x07;
+
+            if (session.input.size() - pos - 4 < length)
+            {
+                break;
+            }
+            std::string message = session.input.substr(pos + 4, length);
+            pos += 4 + length;
+
+            if (type == 1)
+            {
+                //ping: pong with the same payload
+                send(fd, message, 2);
+            }
+            else if (type == 0 && !route(fd, message))
+            {
+                return false;
+            }
+            if (mSessions.find(fd) == mSessions.end())
+            {
+                return true;
+            }
+        }
+
+        session.input.erase(0, pos);
+        flush(fd);
+        return true;
+    }
+
+    bool route(int fd, const std::string& message)
+    {
+        MsgPackReader reader(message);
+        uint32_t size;
+        uint64_t type;
+        uint64_t request;
+
+        if (!reader.array(size) || size < 1 || !reader.uint(type))
+        {
+            return false;
+        }
+
+        if (type == HELLO)
+        {
+            std::string realm;
+            if (size < 3 || !reader.str(realm) || !reader.skip())
+            {
+                return false;
+            }
+            Session& session = mSessions[fd];
+            session.id = nextId();
+            MsgPackWriter writer;
+            writer.array(3);
+            writer.uint(WELCOME);
+            writer.uint(session.id);
+            writer.map(1);
+            writer.str("roles");
+            writer.map(2);
+            writer.str("broker");
+            writer.map(0);
+            writer.str("dealer");
+            writer.map(0);
+            send(fd, writer.buffer());
+            return true;
+        }
+
+        if (mSessions[fd].id == 0)
+        {
+            return false;
+        }
+
+        if (type == GOODBYE)
+        {
+            MsgPackWriter writer;
+            writer.array(3);
+            writer.uint(GOODBYE);
+            writer.map(0);
+            writer.str("wamp.close.goodbye_and_out");
+            send(fd, writer.buffer());
+            mSessions[fd].isClosing = true;
+            return true;
+        }
+
+        if (size < 2 || !reader.uint(request))
+        {
+            return false;
+        }
+
+        switch (type)
+        {
+            case SUBSCRIBE:
+            {
+                std::string topic;
+                if (size != 4 || !readOptions(reader, 0) || !reader.str(topic))
+                {
+                    return false;
+                }
+                std::map<std::string, Subscription>::iterator it = mSubscriptions.find(topic);
+                if (it == mSubscriptions.end())
+                {
+                    Subscription subscription;
+                    subscription.id = nextId();
+                    it = mSubscriptions.insert(std::make_pair(topic, subscription)).first;
+                }
+                it->second.subscribers.insert(fd);
+                reply(fd, SUBSCRIBED, request, it->second.id);
+                return true;
+            }
+            case UNSUBSCRIBE:
+            {
+                uint64_t id;
+                if (size != 3 || !reader.uint(id))
+                {
+                    return false;
+                }
+                for (std::map<std::string, Subscription>::iterator it = mSubscriptions.begin(); it != mSubscriptions.end(); ++it)
+                {
+                    if (it->second.id == id)
+                    {
+                        it->second.subscribers.erase(fd);
+                    }
+                }
+                reply(fd, UNSUBSCRIBED, request);
+                return true;
+            }
+            case PUBLISH:
+            {
+                std::string topic;
+                std::vector<std::string> payload;
+                bool acknowledge = false;
+                if (size < 4 || !readOptions(reader, &acknowledge) || !reader.str(topic) ||
+                    !readPayload(reader, size - 4, payload))
+                {
+                    return false;
+                }
+                publish(fd, topic, payload, request, acknowledge);
+                return true;
+            }
+            case REGISTER:
+            {
+                std::string procedure;
+                if (size != 4 || !readOptions(reader, 0) || !reader.str(procedure))
+                {
+                    return false;
+                }
+                if (mRegistrations.find(procedure) != mRegistrations.end())
+                {
+                    error(fd, REGISTER, request, "wamp.error.procedure_already_exists", std::vector<std::string>());
+                    return true;
+                }
+                Registration registration;
+                registration.id = nextId();
+                registration.callee = fd;
+                mRegistrations[procedure] = registration;
+                reply(fd, REGISTERED, request, registration.id);
+                return true;
+            }
+            case UNREGISTER:
+            {
+                uint64_t id;
+                if (size != 3 || !reader.uint(id))
+                {
+                    return false;
+                }
+                for (std::map<std::string, Registration>::iterator it = mRegistrations.begin(); it != mRegistrations.end(); ++it)
+                {
+                    if (it->second.id == id && it->second.callee == fd)
+                    {
+                        mRegistrations.erase(it);
+                        break;
+                    }
+                }
+                reply(fd, UNREGISTERED, request);
+                return true;
+            }
+            case CALL:
+            {
+                std::string procedure;
+                std::vector<std::string> payload;
+                if (size < 4 || !readOptions(reader, 0) || !reader.str(procedure) ||
+                    !readPayload(reader, size - 4, payload))
+                {
+                    return false;
+                }
+                call(fd, request, procedure, payload);
+                return true;
+            }
+            case YIELD:
+            case ERROR:
+                return result(type, request, size, reader);
+            default:
+                return false;
+        }
+    }
+
+    void publish(int fd, const std::string& topic, const std::vector<std::string>& payload, uint64_t request, bool acknowledge)
+    {
+        uint64_t publication = nextId();
+        std::map<std::string, Subscription>::iterator it = mSubscriptions.find(topic);
+
+        mStatistics.publications++;
+        if (it != mSubscriptions.end())
+        {
+            MsgPackWriter writer;
+            writer.array(4 + payload.size());
+            writer.uint(EVENT);
+            writer.uint(it->second.id);
+            writer.uint(publication);
+            writer.map(0);
+            writePayload(writer, payload);
+
+            //a subscriber may be closed on the way
+            std::set<int> subscribers = it->second.subscribers;
+            for (std::set<int>::iterator subscriber = subscribers.begin(); subscriber != subscribers.end(); ++subscriber)
+            {
+                //the publisher is excluded as WAMP requires by default
+                std::map<int, Session>::iterator session = mSessions.find(*subscriber);
+                if (*subscriber == fd || session == mSessions.end())
+                {
+                    continue;
+                }
+                if (session->second.output.size() > OUTPUT_LIMIT || writer.buffer().size() > session->second.maxLength)
+                {
+                    mStatistics.droppedEvents++;
+                    continue;
+                }
+                send(*subscriber, writer.buffer());
+                flush(*subscriber);
+                mStatistics.events++;
+            }
+        }
+
+        if (acknowledge)
+        {
+            reply(fd, PUBLISHED, request, publication);
+        }
+    }
+
+    void call(int fd, uint64_t request, const std::string& procedure, const std::vector<std::string>& payload)
+    {
+        std::map<std::string, Registration>::iterator it = mRegistrations.find(procedure);
+        if (it == mRegistrations.end())
+        {
+            error(fd, CALL, request, "wamp.error.no_such_procedure", std::vector<std::string>());
+            return;
+        }
+
+        uint64_t invocation = nextId();
+        Invocation pending;
+        pending.caller = fd;
+        pending.request = request;
+        pending.start = getMonotonicTimeUs();
+        mInvocations[invocation] = pending;
+
+        MsgPackWriter writer;
+        writer.array(4 + payload.size());
+        writer.uint(INVOCATION);
+        writer.uint(invocation);
+        writer.uint(it->second.id);
+        writer.map(0);
+        writePayload(writer, payload);
+        send(it->second.callee, writer.buffer());
+        flush(it->second.callee);
+    }
+
+    //YIELD [70, INVOCATION.Request, Options, ...] or ERROR [8, 68, INVOCATION.Request, Details, Error, ...]
+    bool result(uint64_t type, uint64_t request, uint32_t size, MsgPackReader& reader)
+    {
+        std::string errorUri;
+        std::vector<std::string> payload;
+        uint64_t invocation = request;
+
+        if (type == YIELD)
+        {
+            if (size < 3 || !readOptions(reader, 0) || !readPayload(reader, size - 3, payload))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            //errors of the other requests are not forwarded
+            if (request != INVOCATION)
+            {
+                return true;
+            }
+            if (size < 5 || !reader.uint(invocation) || !readOptions(reader, 0) || !reader.str(errorUri) ||
+                !readPayload(reader, size - 5, payload))
+            {
+                return false;
+            }
+        }
+
+        std::map<uint64_t, Invocation>::iterator it = mInvocations.find(invocation);
+        if (it == mInvocations.end())
+        {
+            return true;
+        }
+        Invocation pending = it->second;
+        mInvocations.erase(it);
+
+        uint64_t time = getMonotonicTimeUs() - pending.start;
+        mStatistics.calls++;
+        mStatistics.callTime += time;
+        if (time > mStatistics.maxCallTime)
+        {
+            mStatistics.maxCallTime = time;
+        }
+
+        if (mSessions.find(pending.caller) == mSessions.end())
+        {
+            return true;
+        }
+        if (type == ERROR)
+        {
+            error(pending.caller, CALL, pending.request, errorUri, payload);
+            return true;
+        }
+
+        MsgPackWriter writer;
+        writer.array(3 + payload.size());
+        writer.uint(RESULT);
+        writer.uint(pending.request);
+        writer.map(0);
+        writePayload(writer, payload);
+        send(pending.caller, writer.buffer());
+        flush(pending.caller);
+        return true;
+    }
+
+    void reply(int fd, uint64_t type, uint64_t request)
+    {
+        MsgPackWriter writer;
+        writer.array(2);
+        writer.uint(type);
+        writer.uint(request);
+        send(fd, writer.buffer());
+    }
+
+    void reply(int fd, uint64_t type, uint64_t request, uint64_t id)
+    {
+        MsgPackWriter writer;
+        writer.array(3);
+        writer.uint(type);
+        writer.uint(request);
+        writer.uint(id);
+        send(fd, writer.buffer());
+    }
+
+    void error(int fd, uint64_t type, uint64_t request, const std::string& uri, const std::vector<std::string>& payload)
+    {
+        MsgPackWriter writer;
+        writer.array(5 + payload.size());
+        writer.uint(ERROR);
+        writer.uint(type);
+        writer.uint(request);
+        writer.map(0);
+        writer.str(uri);
+        writePayload(writer, payload);
+        send(fd, writer.buffer());
+    }
+
+    //queue one RawSocket frame, type 0: message, 2: pong
+    void send(int fd, const std::string& message, uint8_t type = 0)
+    {
+        std::map<int, Session>::iterator it = mSessions.find(fd);
+        if (it == mSessions.end())
+        {
+            return;
+        }
+        Session& session = it->second;
+        char header[4] = { (char)type, (char)(message.size() >> 16), (char)(message.size() >> 8), (char)message.size() };
+        session.output.append(header, 4);
+        session.output.append(message);
+    }
+
+    void flush(int fd)
+    {
+        std::map<int, Session>::iterator it = mSessions.find(fd);
+        if (it == mSessions.end())
+        {
+            return;
+        }
+        Session& session = it->second;
+
+        while (!session.output.empty())
+        {
+            ssize_t length = write(fd, session.output.data(), session.output.size());
+            if (length < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (errno != EAGAIN)
+                {
+                    closeSession(fd);
+                    return;
+                }
+                break;
+            }
+            mStatistics.bytesOut += length;
+            session.output.erase(0, length);
+        }
+
+        if (session.output.empty() && session.isClosing)
+        {
+            closeSession(fd);
+            return;
+        }
+
+        //wait for the socket to be writable only while there is something left
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN | (session.output.empty() ? 0 : (uint32_t)EPOLLOUT);
+        event.data.fd = fd;
+        epoll_ctl(mEpollFd, EPOLL_CTL_MOD, fd, &event);
+    }
+
+    void closeSession(int fd)
+    {
+        for (std::map<std::string, Subscription>::iterator it = mSubscriptions.begin(); it != mSubscriptions.end(); ++it)
+        {
+            it->second.subscribers.erase(fd);
+        }
+        for (std::map<std::string, Registration>::iterator it = mRegistrations.begin(); it != mRegistrations.end(); )
+        {
+            if (it->second.callee == fd)
+            {
+                mRegistrations.erase(it++);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        for (std::map<uint64_t, Invocation>::iterator it = mInvocations.begin(); it != mInvocations.end(); )
+        {
+            if (it->second.caller == fd)
+            {
+                mInvocations.erase(it++);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, 0);
+        close(fd);
+        mSessions.erase(fd);
+    }
+
+    int mListenFd;
+    int mEpollFd;
+    uint16_t mPort;
+    std::atomic<bool> mQuit;
+    uint64_t mNextId;
+    std::map<int, Session> mSessions;
+    std::map<std::string, Subscription> mSubscriptions;
+    std::map<std::string, Registration> mRegistrations;
+    std::map<uint64_t, Invocation> mInvocations;
+};
+
+/**
+ * Blocking WAMP client for the benchmark
+ */
+class Client
+{
+public:
+    Client()
+        : mFd(-1)
+        , mRequest(0)
+    {
+    }
+
+    ~Client()
+    {
+        if (mFd >= 0)
+        {
+            close(mFd);
+        }
+    }
+
+    bool connect(uint16_t port)
+    {
+        struct sockaddr_in address;
+        int on = 1;
+        unsigned char handshake[4] = { RAWSOCKET_MAGIC, (RAWSOCKET_MAX_LENGTH_EXP << 4) | RAWSOCKET_SERIALIZER_MSGPACK, 0, 0 };
+        std::string message;
+        uint64_t type;
+
+        mFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        if (mFd < 0 || ::connect(mFd, (struct sockaddr*)&address, sizeof(address)) < 0)
+        {
+            return false;
+        }
+        setsockopt(mFd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        if (!writeAll((const char*)handshake, 4) || !readAll((char*)handshake, 4) ||
+            handshake[0] != RAWSOCKET_MAGIC || (handshake[1] & 0x0f) != RAWSOCKET_SERIALIZER_MSGPACK)
+        {
+            return false;
+        }
+
+        MsgPackWriter hello;
+        hello.array(3);
+        hello.uint(HELLO);
+        hello.str("realm1");
+        hello.map(1);
+        hello.str("roles");
+        hello.map(3);
+        hello.str("publisher");
+        hello.map(0);
+        hello.str("subscriber");
+        hello.map(0);
+        hello.str("caller");
+        hello.map(0);
+        return send(hello.buffer()) && receive(message, type) && type == WELCOME;
+    }
+
+    //subscribe resp. register and wait for the acknowledgment
+    bool request(uint64_t type, const std::string& uri)
+    {
+        std::string message;
+        uint64_t replyType;
+
+        MsgPackWriter writer;
+        writer.array(4);
+        writer.uint(type);
+        writer.uint(++mRequest);
+        writer.map(0);
+        writer.str(uri);
+        return send(writer.buffer()) && receive(message, replyType) && replyType == type + 1;
+    }
+
+    bool send(const std::string& message)
+    {
+        char header[4] = { 0, (char)(message.size() >> 16), (char)(message.size() >> 8), (char)message.size() };
+        return writeAll(header, 4) && writeAll(message.data(), message.size());
+    }
+
+    /**
+     * Next WAMP message
+     * @param type the message type, the reader of the message is positioned behind
+     */
+    bool receive(std::string& message, uint64_t& type)
+    {
+        unsigned char header[4];
+
+        while (true)
+        {
+            if (!readAll((char*)header, 4))
+            {
+                return false;
+            }
+            message.resize((header[1] << 16) | (header[2] << 8) | header[3]);
+            if (!message.empty() && !readAll(&message[0], message.size()))
+            {
+                return false;
+            }
+            if ((header[0] & 0x07) == 0)
+            {
+                MsgPackReader reader(message);
+                uint32_t size;
+                return reader.array(size) && reader.uint(type);
+            }
+        }
+    }
+
+    uint64_t nextRequest()
+    {
+        return ++mRequest;
+    }
+
+    void shutdown()
+    {
+        ::shutdown(mFd, SHUT_RDWR);
+    }
+
+private:
+    bool writeAll(const char* data, size_t length)
+    {
+        while (length > 0)
+        {
+            ssize_t written = write(mFd, data, length);
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (written <= 0)
+            {
+                return false;
+            }
+            data += written;
+            length -= written;
+        }
+        return true;
+    }
+
+    bool readAll(char* data, size_t length)
+    {
+        while (length > 0)
+        {
+            ssize_t received = read(mFd, data, length);
+            if (received < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (received <= 0)
+            {
+                return false;
+            }
+            data += received;
+            length -= received;
+        }
+        return true;
+    }
+
+    int mFd;
+    uint64_t mRequest;
+};
+
+static void printStatistics(const char* prefix, const RouterStatistics& statistics)
+{
+    uint64_t calls = statistics.calls;
+    printf("%spublications %llu events %llu dropped %llu calls %llu (avg %llu us, max %llu us) in %llu bytes out %llu bytes\n",
+           prefix,
+           (unsigned long long)statistics.publications,
+           (unsigned long long)statistics.events,
+           (unsigned long long)statistics.droppedEvents,
+           (unsigned long long)calls,
+           (unsigned long long)(calls ? statistics.callTime / calls : 0),
+           (unsigned long long)statistics.maxCallTime,
+           (unsigned long long)statistics.bytesIn,
+           (unsigned long long)statistics.bytesOut);
+}
+
+static uint64_t percentile(std::vector<uint64_t>& values, int percent)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+    size_t index = (values.size() - 1) * percent / 100;
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+/**
+ * PositionUpdateData-like event: [[changedValues, timestamp, {key: value}], ...]
+ * The timestamp is the time of the publication [us], for the latency.
+ */
+static void writeEpochs(MsgPackWriter& writer, int count, uint64_t timestamp)
+{
+    writer.array(1);
+    writer.array(count);
+    for (int i = 0; i < count; i++)
+    {
+        writer.array(3);
+        writer.uint(1 | 2 | 4);
+        writer.uint(timestamp);
+        writer.map(3);
+        writer.uint(1);
+        writer.dbl(48.053250);
+        writer.uint(2);
+        writer.dbl(8.324500);
+        writer.uint(4);
+        writer.dbl(337.0);
+    }
+}
+
+static void subscriber(Client* client, std::atomic<uint64_t>* received, std::vector<uint64_t>* latencies)
+{
+    std::string message;
+    uint64_t type;
+
+    while (client->receive(message, type))
+    {
+        if (type != EVENT)
+        {
+            continue;
+        }
+
+        MsgPackReader reader(message);
+        uint32_t size;
+        uint32_t epochs;
+        uint64_t value;
+        if (!reader.array(size) || size < 5 || !reader.uint(type) || !reader.uint(value) ||
+            !reader.uint(value) || !reader.skip() || !reader.array(size) || !reader.array(epochs))
+        {
+            continue;
+        }
+
+        uint64_t now = getMonotonicTimeUs();
+        for (uint32_t i = 0; i < epochs; i++)
+        {
+            uint64_t changedValues;
+            uint64_t timestamp;
+            if (!reader.array(size) || !reader.uint(changedValues) || !reader.uint(timestamp) || !reader.skip())
+            {
+                break;
+            }
+            latencies->push_back(now - timestamp);
+        }
+        //counted last: the main thread waits for the count
+        *received += epochs;
+    }
+}
+
+static void callee(Client* client)
+{
+    std::string message;
+    uint64_t type;
+
+    while (client->receive(message, type))
+    {
+        uint64_t invocation;
+        MsgPackReader reader(message);
+        uint32_t size;
+        if (type != INVOCATION || !reader.array(size) || !reader.uint(type) || !reader.uint(invocation))
+        {
+            continue;
+        }
+
+        MsgPackWriter writer;
+        writer.array(4);
+        writer.uint(YIELD);
+        writer.uint(invocation);
+        writer.map(0);
+        writer.array(2);
+        writer.uint(getMonotonicTimeUs());
+        writer.map(2);
+        writer.uint(1);
+        writer.dbl(48.053250);
+        writer.uint(2);
+        writer.dbl(8.324500);
+        client->send(writer.buffer());
+    }
+}
+
+static int benchmark(int numEpochs, int batch, int rate, int numCalls)
+{
+    Router router;
+    Client publisher;
+    Client subscriberClient;
+    Client calleeClient;
+    std::atomic<uint64_t> received(0);
+    std::vector<uint64_t> latencies;
+    std::vector<uint64_t> callTimes;
+    bool isOk = true;
+
+    if (!router.init(0))
+    {
+        printf("FAILED: router\n");
+        return EXIT_FAILURE;
+    }
+    std::thread routerThread(&Router::run, &router, std::function<void()>());
+
+    if (!publisher.connect(router.getPort()) ||
+        !subscriberClient.connect(router.getPort()) || !subscriberClient.request(SUBSCRIBE, BENCH_TOPIC) ||
+        !calleeClient.connect(router.getPort()) || !calleeClient.request(REGISTER, BENCH_PROCEDURE))
+    {
+        printf("FAILED: connection to the router\n");
+        router.quit();
+        routerThread.join();
+        return EXIT_FAILURE;
+    }
+    latencies.reserve(numEpochs);
+    std::thread subscriberThread(subscriber, &subscriberClient, &received, &latencies);
+    std::thread calleeThread(callee, &calleeClient);
+
+    //publications: batch epochs each, at the given rate of epochs or as fast as possible
+    int numPublications = (numEpochs + batch - 1) / batch;
+    uint64_t start = getMonotonicTimeUs();
+    for (int i = 0; i < numPublications; i++)
+    {
+        if (rate > 0)
+        {
+            uint64_t due = start + (uint64_t)i * batch * 1000000 / rate;
+            uint64_t now = getMonotonicTimeUs();
+            if (due > now)
+            {
+                usleep(due - now);
+            }
+        }
+        int count = std::min(batch, numEpochs - i*batch);
+        MsgPackWriter writer;
+        writer.array(5);
+        writer.uint(PUBLISH);
+        writer.uint(publisher.nextRequest());
+        writer.map(0);
+        writer.str(BENCH_TOPIC);
+        writeEpochs(writer, count, getMonotonicTimeUs());
+        if (!publisher.send(writer.buffer()))
+        {
+            isOk = false;
+            break;
+        }
+    }
+
+    //all the epochs are either received or dropped by the router
+    uint64_t timeout = getMonotonicTimeUs() + (uint64_t)BENCH_TIMEOUT*1000;
+    while (received + router.mStatistics.droppedEvents * batch < (uint64_t)numEpochs && getMonotonicTimeUs() < timeout)
+    {
+        usleep(1000);
+    }
+    uint64_t duration = getMonotonicTimeUs() - start;
+
+    //calls one after the other: round trip time
+    for (int i = 0; i < numCalls && isOk; i++)
+    {
+        std::string message;
+        uint64_t type;
+        MsgPackWriter writer;
+        writer.array(5);
+        writer.uint(CALL);
+        writer.uint(publisher.nextRequest());
+        writer.map(0);
+        writer.str(BENCH_PROCEDURE);
+        writer.array(1);
+        writer.uint(1 | 2);
+        uint64_t callStart = getMonotonicTimeUs();
+        if (!publisher.send(writer.buffer()) || !publisher.receive(message, type) || type != RESULT)
+        {
+            isOk = false;
+            break;
+        }
+        callTimes.push_back(getMonotonicTimeUs() - callStart);
+    }
+
+    subscriberClient.shutdown();
+    calleeClient.shutdown();
+    subscriberThread.join();
+    calleeThread.join();
+    router.quit();
+    routerThread.join();
+
+    uint64_t numReceived = received;
+    printf("epochs: %d published in %d messages (%d per message), %llu received, %llu messages dropped\n",
+           numEpochs, numPublications, batch,
+           (unsigned long long)numReceived,
+           (unsigned long long)router.mStatistics.droppedEvents);
+    printf("throughput: %.0f epochs/s, %.0f messages/s\n",
+           duration ? numReceived * 1e6 / duration : 0.0,
+           duration ? numReceived * 1e6 / duration / batch : 0.0);
+    printf("event latency [us]: p50 %llu p99 %llu max %llu\n",
+           (unsigned long long)percentile(latencies, 50),
+           (unsigned long long)percentile(latencies, 99),
+           (unsigned long long)percentile(latencies, 100));
+    printf("call round trip [us]: p50 %llu p99 %llu max %llu (%d calls)\n",
+           (unsigned long long)percentile(callTimes, 50),
+           (unsigned long long)percentile(callTimes, 99),
+           (unsigned long long)percentile(callTimes, 100),
+           (int)callTimes.size());
+    printStatistics("router: ", router.mStatistics);
+
+    if (numReceived + router.mStatistics.droppedEvents * batch < (uint64_t)numEpochs)
+    {
+        isOk = false;
+    }
+    printf("%s\n", isOk ? "OK" : "FAILED");
+    return isOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static Router* gRouter = 0;
+
+static void onSignal(int)
+{
+    if (gRouter)
+    {
+        gRouter->quit();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int port = DEFAULT_PORT;
+    bool isVerbose = false;
+    bool isBenchmark = false;
+    int numEpochs = 100000;
+    int batch = 1;
+    int rate = 0;
+    int numCalls = 1000;
+    int option;
+
+    while ((option = getopt(argc, argv, "p:vbn:B:r:c:")) != -1)
+    {
+        switch (option)
+        {
+            case 'p': port = atoi(optarg); break;
+            case 'v': isVerbose = true; break;
+            case 'b': isBenchmark = true; break;
+            case 'n': numEpochs = atoi(optarg); break;
+            case 'B': batch = atoi(optarg); break;
+            case 'r': rate = atoi(optarg); break;
+            case 'c': numCalls = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-p port] [-v] | -b [-n epochs] [-B epochs per message] [-r epochs/s] [-c calls]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    if (isBenchmark)
+    {
+        if (numEpochs < 1 || batch < 1)
+        {
+            fprintf(stderr, "invalid number of epochs\n");
+            return EXIT_FAILURE;
+        }
+        return benchmark(numEpochs, batch, rate, numCalls);
+    }
+
+    Router router;
+    if (!router.init(port))
+    {
+        return EXIT_FAILURE;
+    }
+    gRouter = &router;
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    printf("WAMP router on 127.0.0.1:%d (RawSocket, MessagePack)\n", router.getPort());
+    router.run(isVerbose ? std::function<void()>([&router]() { printStatistics("", router.mStatistics); }) : std::function<void()>());
+    printStatistics("", router.mStatistics);
+    return EXIT_SUCCESS;
+}
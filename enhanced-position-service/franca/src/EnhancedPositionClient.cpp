@@ -15,13 +15,8 @@ DLT_DECLARE_CONTEXT(gCtx);
 using namespace v5::org::genivi::EnhancedPositionService;
 using namespace org::genivi::EnhancedPositionService;
 
-void getPositionInfoAsyncCallback(const CommonAPI::CallStatus& callStatus, const EnhancedPositionServiceTypes::Timestamp& timestamp, const EnhancedPositionServiceTypes::PositionInfo& posInfo)
+void logPositionInfo(const EnhancedPositionServiceTypes::PositionInfo& posInfo)
 {
-    if (callStatus != CommonAPI::CallStatus::SUCCESS) {
-        LOG_ERROR_MSG(gCtx,"Remote call failed!\n");
-        return;
-    }
-
     for ( auto it = posInfo.begin(); it != posInfo.end(); ++it ) {
         if (it->first == EnhancedPositionServiceTypes::PositionInfoKey::LATITUDE)
         {
@@ -50,6 +45,16 @@ void getPositionInfoAsyncCallback(const CommonAPI::CallStatus& callStatus, const
     }
 }
 
+void getPositionInfoAsyncCallback(const CommonAPI::CallStatus& callStatus, const EnhancedPositionServiceTypes::Timestamp& timestamp, const EnhancedPositionServiceTypes::PositionInfo& posInfo)
+{
+    if (callStatus != CommonAPI::CallStatus::SUCCESS) {
+        LOG_ERROR_MSG(gCtx,"Remote call failed!\n");
+        return;
+    }
+
+    logPositionInfo(posInfo);
+}
+
 void positionUpdate(std::shared_ptr<EnhancedPositionProxyDefault> proxy, const EnhancedPositionServiceTypes::Bitmask& changedValues)
 {
     LOG_INFO_MSG(gCtx,"Position Update");
@@ -69,7 +74,7 @@ void positionUpdate(std::shared_ptr<EnhancedPositionProxyDefault> proxy, const E
     LOG_INFO_MSG(gCtx,"Position Update finished");
 }
 
-int main() {
+int main(int argc, char* argv[]) {
 
     DLT_REGISTER_APP("ENHC","ENHANCED-POSITION-CLIENT");
     DLT_REGISTER_CONTEXT(gCtx,"ENHC","Global Context");
@@ -91,9 +96,29 @@ int main() {
 
     std::cout << "Proxy available" << std::endl;
 
-    myProxy->getPositionUpdateEvent().subscribe([&](const EnhancedPositionServiceTypes::Bitmask& changedValues) {
-        positionUpdate(myProxy, changedValues);
-    });
+    //-p: receive the values with PositionUpdateData instead of calling GetPositionInfo
+    if ((argc > 1) && (std::string(argv[1]) == "-p")) {
+        myProxy->getPositionUpdateDataSelectiveEvent().subscribe([&](const EnhancedPositionServiceTypes::Bitmask& changedValues,
+                                                                     const EnhancedPositionServiceTypes::Timestamp& timestamp,
+                                                                     const EnhancedPositionServiceTypes::PositionInfo& posInfo) {
+            LOG_INFO_MSG(gCtx,"Position Update Data");
+            logPositionInfo(posInfo);
+        });
+    //-f: receive the position field, on-change and cyclic
+    } else if ((argc > 1) && (std::string(argv[1]) == "-f")) {
+        myProxy->getPositionAttribute().getChangedEvent().subscribe([&](const EnhancedPositionServiceTypes::PositionSample& sample) {
+            LOG_INFO(gCtx,"Position (on-change): timestamp=%llu LAT=%lf LON=%lf",
+                     (unsigned long long)sample.getTimestamp(), sample.getLatitude(), sample.getLongitude());
+        });
+        myProxy->getPositionCycleEvent().subscribe([&](const EnhancedPositionServiceTypes::PositionSample& sample) {
+            LOG_INFO(gCtx,"Position (cyclic): timestamp=%llu LAT=%lf LON=%lf",
+                     (unsigned long long)sample.getTimestamp(), sample.getLatitude(), sample.getLongitude());
+        });
+    } else {
+        myProxy->getPositionUpdateEvent().subscribe([&](const EnhancedPositionServiceTypes::Bitmask& changedValues) {
+            positionUpdate(myProxy, changedValues);
+        });
+    }
 
     while (true) {
         std::this_thread::sleep_for(std::chrono::seconds(20));
@@ -4,65 +4,171 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
-#include <thread>
+#include <signal.h>
+#include <time.h>
 #include <CommonAPI/CommonAPI.hpp>
 #include "EnhancedPositionStubImpl.hpp"
 #include "PositionFeedbackStubImpl.hpp"
 #include "ConfigurationStubImpl.hpp"
+#include "MainLoop.hpp"
 #include "log.h"
 
+//interval between two attempts to register the services [ms]
+#define REGISTER_RETRY_INTERVAL 100
+
 DLT_DECLARE_CONTEXT(gCtx);
 
 using namespace std;
 
+static uint64_t getMonotonicTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000 + ts.tv_nsec/1000000;
+}
+
+//the services are registered one after the other, each one is started as soon as it is registered
+class ServiceRegistration {
+
+public:
+    ServiceRegistration(std::shared_ptr<CommonAPI::MainLoopContext> context)
+        : mRuntime(CommonAPI::Runtime::get())
+        , mContext(context)
+        , mDomain("local")
+        , mInstance("EnhancedPositionService")
+        , mEnhancedPosition(std::make_shared<EnhancedPositionStubImpl>())
+        , mPositionFeedback(std::make_shared<PositionFeedbackStubImpl>())
+        , mConfiguration(std::make_shared<ConfigurationStubImpl>())
+        , mIsEnhancedPositionRegistered(false)
+        , mIsPositionFeedbackRegistered(false)
+        , mIsConfigurationRegistered(false)
+    {
+    }
+
+    /**
+     * @return true when all services are registered
+     */
+    bool registerServices()
+    {
+        if (!mIsEnhancedPositionRegistered)
+        {
+            mIsEnhancedPositionRegistered = mRuntime->registerService(mDomain, mInstance, mEnhancedPosition, mContext);
+            if (!mIsEnhancedPositionRegistered)
+            {
+                return false;
+            }
+            mEnhancedPosition->run();
+        }
+
+        if (!mIsPositionFeedbackRegistered)
+        {
+            mIsPositionFeedbackRegistered = mRuntime->registerService(mDomain, mInstance, mPositionFeedback, mContext);
+            if (!mIsPositionFeedbackRegistered)
+            {
+                return false;
+            }
+            mPositionFeedback->run();
+        }
+
+        if (!mIsConfigurationRegistered)
+        {
+            mIsConfigurationRegistered = mRuntime->registerService(mDomain, mInstance, mConfiguration, mContext);
+            if (!mIsConfigurationRegistered)
+            {
+                return false;
+            }
+            mConfiguration->run();
+        }
+
+        return true;
+    }
+
+    void unregisterServices()
+    {
+        if (mIsConfigurationRegistered)
+        {
+            mConfiguration->shutdown();
+            mRuntime->unregisterService(mDomain, Configuration::getInterface(), mInstance);
+        }
+
+        if (mIsPositionFeedbackRegistered)
+        {
+            mPositionFeedback->shutdown();
+            mRuntime->unregisterService(mDomain, PositionFeedback::getInterface(), mInstance);
+        }
+
+        if (mIsEnhancedPositionRegistered)
+        {
+            mEnhancedPosition->shutdown();
+            mRuntime->unregisterService(mDomain, EnhancedPosition::getInterface(), mInstance);
+        }
+    }
+
+    std::shared_ptr<EnhancedPositionStubImpl> getEnhancedPosition()
+    {
+        return mEnhancedPosition;
+    }
+
+private:
+    std::shared_ptr<CommonAPI::Runtime> mRuntime;
+    std::shared_ptr<CommonAPI::MainLoopContext> mContext;
+    std::string mDomain;
+    std::string mInstance;
+    std::shared_ptr<EnhancedPositionStubImpl> mEnhancedPosition;
+    std::shared_ptr<PositionFeedbackStubImpl> mPositionFeedback;
+    std::shared_ptr<ConfigurationStubImpl> mConfiguration;
+    bool mIsEnhancedPositionRegistered;
+    bool mIsPositionFeedbackRegistered;
+    bool mIsConfigurationRegistered;
+};
+
 int main() {
 
+    uint64_t startTime = getMonotonicTime();
+
+    std::shared_ptr<CommonAPI::MainLoopContext> context = std::make_shared<CommonAPI::MainLoopContext>("EnhancedPositionService");
+    MainLoop mainLoop(context);
+
+    //before any thread is started, including the one of DLT:
+    //SIGINT and SIGTERM end the main loop instead of the process
+    bool isMainLoopInitialized = mainLoop.init() && mainLoop.quitOnSignals({SIGINT, SIGTERM});
+
     DLT_REGISTER_APP("ENHS","ENHANCED-POSITION-SERVICE");
     DLT_REGISTER_CONTEXT(gCtx,"ENHS","Global Context");
 
-    std::shared_ptr<CommonAPI::Runtime> runtime = CommonAPI::Runtime::get();
-
-    std::string domain = "local";
-    std::string instance = "EnhancedPositionService";
-
-    std::shared_ptr<EnhancedPositionStubImpl> myServiceEnhancedPosition = std::make_shared<EnhancedPositionStubImpl>();
-    
-    bool successfullyRegistered = runtime->registerService(domain, instance, myServiceEnhancedPosition);
-    while (!successfullyRegistered) {
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-		successfullyRegistered = runtime->registerService(domain, instance, myServiceEnhancedPosition);
-	}
-    myServiceEnhancedPosition->run();
-
-    std::shared_ptr<PositionFeedbackStubImpl> myServicePositionFeedback = std::make_shared<PositionFeedbackStubImpl>();
-    successfullyRegistered = runtime->registerService(domain, instance, myServicePositionFeedback);
-    while (!successfullyRegistered) {
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-		successfullyRegistered = runtime->registerService(domain, instance, myServicePositionFeedback);
-	}
-    myServicePositionFeedback->run();
-
-    std::shared_ptr<ConfigurationStubImpl> myServiceConfiguration = std::make_shared<ConfigurationStubImpl>();
-    successfullyRegistered = runtime->registerService(domain, instance, myServiceConfiguration);
-    while (!successfullyRegistered) {
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-		successfullyRegistered = runtime->registerService(domain, instance, myServiceConfiguration);
-	}
-    myServiceConfiguration->run();
-    
-    while (true) {
-        //LOG_INFO_MSG(gCtx,"Waiting for calls... (Abort with CTRL+C)");
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (!isMainLoopInitialized)
+    {
+        LOG_ERROR_MSG(gCtx,"Main loop initialization failed - exiting!");
+        return EXIT_FAILURE;
     }
 
-    myServiceEnhancedPosition->shutdown();
-    myServicePositionFeedback->shutdown();
-    myServiceConfiguration->shutdown();
-
-    return 0;
-}
-
+    ServiceRegistration registration(context);
+    registration.getEnhancedPosition()->attach(mainLoop);
+    registration.getEnhancedPosition()->setStartTime(startTime);
 
+    //retry in the main loop, so that a signal still ends the service while the bus is not available
+    int retryTimer = -1;
+    if (registration.registerServices())
+    {
+        LOG_INFO(gCtx,"Startup: services registered %llu ms after start",
+                 (unsigned long long)(getMonotonicTime() - startTime));
+    }
+    else
+    {
+        retryTimer = mainLoop.addTimer(REGISTER_RETRY_INTERVAL, [&]()
+        {
+            if (registration.registerServices())
+            {
+                LOG_INFO(gCtx,"Startup: services registered %llu ms after start",
+                         (unsigned long long)(getMonotonicTime() - startTime));
+                mainLoop.removeTimer(retryTimer);
+            }
+        });
+    }
 
+    mainLoop.run();
 
+    registration.unregisterServices();
 
+    return 0;
+}
@@ -16,22 +16,50 @@
 * @licence end@
 **************************************************************************/
 
+#include <string.h>
+#include <time.h>
 #include "EnhancedPositionStubImpl.hpp"
 #include "log.h"
 
 //EnhancedPosition-interface version
 #define VER_MAJOR 4
-#define VER_MINOR 0
+#define VER_MINOR 3
 #define VER_MICRO 0
-#define VER_DATE "25-04-2016"
+#define VER_DATE "18-10-2026"
+
+//minimum interval between two SatelliteUpdate resp. TimeUpdate broadcasts [ms]
+#define GNSS_UPDATE_INTERVAL 500
+//interval of the cyclic PositionCycle broadcast [ms]
+#define POSITION_CYCLE_INTERVAL 1000
 
 DLT_IMPORT_CONTEXT(gCtx);
 
 using namespace org::genivi::EnhancedPositionService;
 
 EnhancedPositionStubImpl* EnhancedPositionStubImpl::mpSelf = 0;
+std::mutex EnhancedPositionStubImpl::mFusionMutex;
+FusionEngine EnhancedPositionStubImpl::mFusion;
 
-EnhancedPositionStubImpl::EnhancedPositionStubImpl() {
+static uint64_t getMonotonicTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000 + ts.tv_nsec/1000000;
+}
+
+EnhancedPositionStubImpl::EnhancedPositionStubImpl()
+    : mLastSatelliteUpdate(0)
+    , mLastTimeUpdate(0)
+    , mpMainLoop(0)
+    , mInputEvent(-1)
+    , mPendingPositionChanges(0)
+    , mIsSatelliteUpdatePending(false)
+    , mIsTimeUpdatePending(false)
+    , mIsPositionSamplePending(false)
+    , mPositionCycleTimer(-1)
+    , mStartTime(0)
+    , mIsSnsInitialized(false)
+{
     mpSelf = this;
 }
 
@@ -126,7 +154,7 @@ void EnhancedPositionStubImpl::sigPositionUpdate(const TGNSSPosition position[],
     //extend this OR statement if necessary (when more notifications are supported)
     if(latChanged || lonChanged || altChanged)
     {
-        LOG_INFO(gCtx,"Position Update[%d/%d]: lat=%f, lon=%f, alt=%f",
+        LOG_DEBUG(gCtx,"Position Update[%d/%d]: lat=%f, lon=%f, alt=%f",
              i+1,
        		 numElements,
        		 position[i].latitude,
@@ -167,9 +195,8 @@ void EnhancedPositionStubImpl::sigPositionUpdate(const TGNSSPosition position[],
      }
   }
 
-  //in a real product, the coordinates would be used for dead-reckoning.
-  //in this proof of concept, the client application is simply notified 
-  //about changes of latitude, longitude and/or altitude
+  //the positions have already been passed to the fusion engine,
+  //the clients read the fused values with GetPositionInfo
 
   if (latChanged)
   {
@@ -232,19 +259,438 @@ void EnhancedPositionStubImpl::sigPositionUpdate(const TGNSSPosition position[],
       return;
   }
 
+  //the position attribute holds the latest epoch
+  mpSelf->publishPositionSample(position[numElements-1]);
+
   //extend this OR statement if necessary (when more notifications are supported)
   if(latChanged || lonChanged || altChanged)
   {
-    mpSelf->firePositionUpdateEvent(changedValues);
+    mpSelf->publishPositionUpdate(changedValues);
   }
 
 }
 
+void EnhancedPositionStubImpl::publishPositionUpdate(EnhancedPositionServiceTypes::Bitmask changedValues)
+{
+    //mpMainLoop is set before the callbacks are registered and not changed afterwards
+    if (mpMainLoop)
+    {
+        mPendingPositionChanges.fetch_or(changedValues);
+        mpMainLoop->triggerEvent(mInputEvent);
+        return;
+    }
+
+    firePositionUpdate(changedValues);
+}
+
+void EnhancedPositionStubImpl::firePositionUpdate(EnhancedPositionServiceTypes::Bitmask changedValues)
+{
+    firePositionUpdateEvent(changedValues);
+    firePositionUpdateData(changedValues);
+
+    if (mStartTime != 0)
+    {
+        LOG_INFO(gCtx,"Startup: first PositionUpdate %llu ms after start",
+                 (unsigned long long)(getMonotonicTime() - mStartTime));
+        mStartTime = 0;
+    }
+}
+
+void EnhancedPositionStubImpl::getPositionSample(const TGNSSPosition& position, EnhancedPositionServiceTypes::PositionSample& sample)
+{
+    EnhancedPositionServiceTypes::Bitmask validValues = 0;
+
+    //the layout of the sample is fixed: the invalid values stay 0
+    sample = EnhancedPositionServiceTypes::PositionSample();
+    sample.setTimestamp(position.timestamp);
+
+    if (position.validityBits & GNSS_POSITION_LATITUDE_VALID)
+    {
+        sample.setLatitude(position.latitude);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::LATITUDE);
+    }
+
+    if (position.validityBits & GNSS_POSITION_LONGITUDE_VALID)
+    {
+        sample.setLongitude(position.longitude);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::LONGITUDE);
+    }
+
+    if (position.validityBits & GNSS_POSITION_ALTITUDEMSL_VALID)
+    {
+        sample.setAltitude(position.altitudeMSL);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::ALTITUDE);
+    }
+
+    if (position.validityBits & GNSS_POSITION_HEADING_VALID)
+    {
+        sample.setHeading(position.heading);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::HEADING);
+    }
+
+    if (position.validityBits & GNSS_POSITION_HSPEED_VALID)
+    {
+        sample.setSpeed(position.hSpeed);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SPEED);
+    }
+
+    if (position.validityBits & GNSS_POSITION_VSPEED_VALID)
+    {
+        sample.setClimb(position.vSpeed);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::CLIMB);
+    }
+
+    if (position.validityBits & GNSS_POSITION_HDOP_VALID)
+    {
+        sample.setHdop(position.hdop);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::HDOP);
+    }
+
+    if (position.validityBits & GNSS_POSITION_SHPOS_VALID)
+    {
+        sample.setSigmaHPosition(position.sigmaHPosition);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HPOSITION);
+    }
+
+    if (position.validityBits & GNSS_POSITION_SALT_VALID)
+    {
+        sample.setSigmaAltitude(position.sigmaAltitude);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_ALTITUDE);
+    }
+
+    if (position.validityBits & GNSS_POSITION_SHEADING_VALID)
+    {
+        sample.setSigmaHeading(position.sigmaHeading);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HEADING);
+    }
+
+    if (position.validityBits & GNSS_POSITION_SHSPEED_VALID)
+    {
+        sample.setSigmaSpeed(position.sigmaHSpeed);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_SPEED);
+    }
+
+    if (position.validityBits & GNSS_POSITION_USAT_VALID)
+    {
+        sample.setUsedSatellites((uint8_t) position.usedSatellites);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::USED_SATELLITES);
+    }
+
+    if (position.validityBits & GNSS_POSITION_STAT_VALID)
+    {
+        sample.setFixStatus((uint8_t) position.fixStatus);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::GNSS_FIX_STATUS);
+    }
+
+    sample.setValidValues(validValues);
+}
+
+void EnhancedPositionStubImpl::publishPositionSample(const TGNSSPosition& position)
+{
+    EnhancedPositionServiceTypes::PositionSample sample;
+
+    getPositionSample(position, sample);
+    TFusionPosition fused;
+    if (getFusedPosition(fused))
+    {
+        applyFusedPosition(fused, sample);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mPositionSampleMutex);
+        mPositionSample = sample;
+    }
+
+    if (mpMainLoop)
+    {
+        mIsPositionSamplePending = true;
+        mpMainLoop->triggerEvent(mInputEvent);
+        return;
+    }
+
+    updatePositionAttribute();
+}
+
+//on-change notification: the attribute notifies its subscribers when it is set to a new value
+void EnhancedPositionStubImpl::updatePositionAttribute()
+{
+    EnhancedPositionServiceTypes::PositionSample sample;
+    {
+        std::lock_guard<std::mutex> lock(mPositionSampleMutex);
+        sample = mPositionSample;
+    }
+
+    setPositionAttribute(sample);
+}
+
+//cyclic notification, main loop timer
+void EnhancedPositionStubImpl::firePositionCycle()
+{
+    EnhancedPositionServiceTypes::PositionSample sample;
+    {
+        std::lock_guard<std::mutex> lock(mPositionSampleMutex);
+        sample = mPositionSample;
+    }
+
+    if (sample.getTimestamp() != 0)
+    {
+        firePositionCycleEvent(sample);
+    }
+}
+
+//main loop thread: broadcast what the GNSS callbacks have recorded since the last event
+void EnhancedPositionStubImpl::onInput()
+{
+    EnhancedPositionServiceTypes::Bitmask changedValues = mPendingPositionChanges.exchange(0);
+    if (changedValues)
+    {
+        firePositionUpdate(changedValues);
+    }
+
+    if (mIsPositionSamplePending.exchange(false))
+    {
+        updatePositionAttribute();
+    }
+
+    if (mIsSatelliteUpdatePending.exchange(false))
+    {
+        fireSatelliteUpdate();
+    }
+
+    if (mIsTimeUpdatePending.exchange(false))
+    {
+        fireTimeUpdate();
+    }
+}
+
 void EnhancedPositionStubImpl::cbPosition(const TGNSSPosition position[], uint16_t numElements)
 {
+    if (position != NULL)
+    {
+        std::lock_guard<std::mutex> lock(mFusionMutex);
+        for (int i = 0; i < numElements; i++)
+        {
+            mFusion.processGNSSPosition(position[i]);
+        }
+    }
+
     sigPositionUpdate(position, numElements);
 }
 
+void EnhancedPositionStubImpl::cbGyroscope(const TGyroscopeData gyroData[], uint16_t numElements)
+{
+    TFusionPosition fused;
+    bool isFused;
+    {
+        std::lock_guard<std::mutex> lock(mFusionMutex);
+        for (int i = 0; i < numElements; i++)
+        {
+            mFusion.processGyroscope(gyroData[i]);
+        }
+        isFused = mFusion.getPosition(fused);
+    }
+
+    //the fused position changes with each gyroscope batch,
+    //PositionUpdate is only broadcast from the main loop thread
+    if (isFused && mpSelf && mpSelf->mpMainLoop)
+    {
+        mpSelf->mPendingPositionChanges.fetch_or(getFusedChangedValues(fused));
+        mpSelf->mpMainLoop->triggerEvent(mpSelf->mInputEvent);
+    }
+}
+
+void EnhancedPositionStubImpl::cbAcceleration(const TAccelerationData accelerationData[], uint16_t numElements)
+{
+    std::lock_guard<std::mutex> lock(mFusionMutex);
+    for (int i = 0; i < numElements; i++)
+    {
+        mFusion.processAcceleration(accelerationData[i]);
+    }
+}
+
+void EnhancedPositionStubImpl::cbVehicleSpeed(const TVehicleSpeedData vehicleSpeedData[], uint16_t numElements)
+{
+    std::lock_guard<std::mutex> lock(mFusionMutex);
+    for (int i = 0; i < numElements; i++)
+    {
+        mFusion.processVehicleSpeed(vehicleSpeedData[i]);
+    }
+}
+
+void EnhancedPositionStubImpl::cbOdometer(const TOdometerData odometerData[], uint16_t numElements)
+{
+    std::lock_guard<std::mutex> lock(mFusionMutex);
+    for (int i = 0; i < numElements; i++)
+    {
+        mFusion.processOdometer(odometerData[i]);
+    }
+}
+
+bool EnhancedPositionStubImpl::getFusedPosition(TFusionPosition& fused)
+{
+    std::lock_guard<std::mutex> lock(mFusionMutex);
+    return mFusion.getPosition(fused);
+}
+
+EnhancedPositionServiceTypes::Bitmask EnhancedPositionStubImpl::getFusedChangedValues(const TFusionPosition& fused)
+{
+    EnhancedPositionServiceTypes::Bitmask changedValues = static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::DR_STATUS);
+
+    if (fused.validityBits & FUSION_POSITION_LATLON_VALID)
+    {
+        changedValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::LATITUDE) |
+                         static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::LONGITUDE) |
+                         static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HPOSITION);
+    }
+    if (fused.validityBits & FUSION_POSITION_ALTITUDE_VALID)
+    {
+        changedValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::ALTITUDE) |
+                         static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_ALTITUDE);
+    }
+    if (fused.validityBits & FUSION_POSITION_HEADING_VALID)
+    {
+        changedValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::HEADING) |
+                         static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HEADING);
+    }
+    if (fused.validityBits & FUSION_POSITION_SPEED_VALID)
+    {
+        changedValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SPEED) |
+                         static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_SPEED);
+    }
+    if (fused.validityBits & FUSION_POSITION_CLIMB_VALID)
+    {
+        changedValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::CLIMB);
+    }
+    if (fused.validityBits & FUSION_POSITION_YAWRATE_VALID)
+    {
+        changedValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::YAW_RATE);
+    }
+
+    return changedValues;
+}
+
+//position and course from the fusion engine, the status values are taken from GNSS
+void EnhancedPositionStubImpl::addFusedPositionInfo(EnhancedPositionServiceTypes::Bitmask valuesToReturn, const TFusionPosition& fused, EnhancedPositionServiceTypes::PositionInfo& data)
+{
+    if (fused.validityBits & FUSION_POSITION_LATLON_VALID)
+    {
+        if (valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::LATITUDE))
+        {
+            data[EnhancedPositionServiceTypes::PositionInfoKey::LATITUDE] = fused.latitude;
+        }
+        if (valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::LONGITUDE))
+        {
+            data[EnhancedPositionServiceTypes::PositionInfoKey::LONGITUDE] = fused.longitude;
+        }
+        if (valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HPOSITION))
+        {
+            data[EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HPOSITION] = (double) fused.sigmaHPosition;
+        }
+    }
+
+    if (fused.validityBits & FUSION_POSITION_ALTITUDE_VALID)
+    {
+        if (valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::ALTITUDE))
+        {
+            data[EnhancedPositionServiceTypes::PositionInfoKey::ALTITUDE] = (double) fused.altitude;
+        }
+        if (valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_ALTITUDE))
+        {
+            data[EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_ALTITUDE] = (double) fused.sigmaAltitude;
+        }
+    }
+
+    if (fused.validityBits & FUSION_POSITION_HEADING_VALID)
+    {
+        if (valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::HEADING))
+        {
+            data[EnhancedPositionServiceTypes::PositionInfoKey::HEADING] = (double) fused.heading;
+        }
+        if (valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HEADING))
+        {
+            data[EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HEADING] = (double) fused.sigmaHeading;
+        }
+    }
+
+    if (fused.validityBits & FUSION_POSITION_SPEED_VALID)
+    {
+        if (valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SPEED))
+        {
+            data[EnhancedPositionServiceTypes::PositionInfoKey::SPEED] = (double) fused.speed;
+        }
+        if (valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_SPEED))
+        {
+            data[EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_SPEED] = (double) fused.sigmaSpeed;
+        }
+    }
+
+    if ((fused.validityBits & FUSION_POSITION_CLIMB_VALID) &&
+        (valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::CLIMB)))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::CLIMB] = (double) fused.climb;
+    }
+
+    if ((fused.validityBits & FUSION_POSITION_YAWRATE_VALID) &&
+        (valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::YAW_RATE)))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::YAW_RATE] = (double) fused.yawRate;
+    }
+
+    //the Value union has no boolean member
+    if (valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::DR_STATUS))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::DR_STATUS] = (uint64_t) (fused.drStatus ? 1 : 0);
+    }
+}
+
+void EnhancedPositionStubImpl::applyFusedPosition(const TFusionPosition& fused, EnhancedPositionServiceTypes::PositionSample& sample)
+{
+    EnhancedPositionServiceTypes::Bitmask validValues = sample.getValidValues();
+
+    sample.setTimestamp(fused.timestamp);
+
+    if (fused.validityBits & FUSION_POSITION_LATLON_VALID)
+    {
+        sample.setLatitude(fused.latitude);
+        sample.setLongitude(fused.longitude);
+        sample.setSigmaHPosition(fused.sigmaHPosition);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::LATITUDE) |
+                       static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::LONGITUDE) |
+                       static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HPOSITION);
+    }
+
+    if (fused.validityBits & FUSION_POSITION_ALTITUDE_VALID)
+    {
+        sample.setAltitude(fused.altitude);
+        sample.setSigmaAltitude(fused.sigmaAltitude);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::ALTITUDE) |
+                       static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_ALTITUDE);
+    }
+
+    if (fused.validityBits & FUSION_POSITION_HEADING_VALID)
+    {
+        sample.setHeading(fused.heading);
+        sample.setSigmaHeading(fused.sigmaHeading);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::HEADING) |
+                       static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_HEADING);
+    }
+
+    if (fused.validityBits & FUSION_POSITION_SPEED_VALID)
+    {
+        sample.setSpeed(fused.speed);
+        sample.setSigmaSpeed(fused.sigmaSpeed);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SPEED) |
+                       static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::SIGMA_SPEED);
+    }
+
+    if (fused.validityBits & FUSION_POSITION_CLIMB_VALID)
+    {
+        sample.setClimb(fused.climb);
+        validValues |= static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::CLIMB);
+    }
+
+    sample.setValidValues(validValues);
+}
+
 void EnhancedPositionStubImpl::cbSatelliteDetail(const TGNSSSatelliteDetail satelliteDetail[], uint16_t numElements)
 {
   if (satelliteDetail == NULL || numElements < 1)
@@ -255,7 +701,7 @@ void EnhancedPositionStubImpl::cbSatelliteDetail(const TGNSSSatelliteDetail sate
 
   for (int i = 0; i<numElements; i++)
   {
-    LOG_INFO(gCtx,"SatelliteDetail Update[%d/%d]: satelliteId=%d azimuth=%d elevation=%d CNo=%d",
+    LOG_DEBUG(gCtx,"SatelliteDetail Update[%d/%d]: satelliteId=%d azimuth=%d elevation=%d CNo=%d",
              i+1,
              numElements,
              satelliteDetail[i].satelliteId, 
@@ -264,13 +710,100 @@ void EnhancedPositionStubImpl::cbSatelliteDetail(const TGNSSSatelliteDetail sate
              satelliteDetail[i].CNo);
   }  
 
-  /*if (!mpSelf)
+  if (!mpSelf)
   {
       LOG_ERROR_MSG(gCtx,"Null pointer!");    
       return;
-  }*/
+  }
+
+  if (mpSelf->mpMainLoop)
+  {
+      mpSelf->mIsSatelliteUpdatePending = true;
+      mpSelf->mpMainLoop->triggerEvent(mpSelf->mInputEvent);
+      return;
+  }
+
+  mpSelf->fireSatelliteUpdate();
+}
+
+void EnhancedPositionStubImpl::fireSatelliteUpdate()
+{
+  uint64_t now = getMonotonicTime();
+  if (now - mLastSatelliteUpdate >= GNSS_UPDATE_INTERVAL)
+  {
+      EnhancedPositionServiceTypes::Timestamp timestamp;
+      std::vector<EnhancedPositionServiceTypes::SatelliteInfo> satelliteInfo;
+
+      getGnssSatelliteInfo<EnhancedPositionServiceTypes>(timestamp, satelliteInfo);
+      fireSatelliteUpdateEvent(timestamp, satelliteInfo);
+      mLastSatelliteUpdate = now;
+  }
+}
+
+void EnhancedPositionStubImpl::cbTime(const TGNSSTime time[], uint16_t numElements)
+{
+  if (time == NULL || numElements < 1)
+  {
+    LOG_ERROR_MSG(gCtx,"cbTime failed!");
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mFusionMutex);
+    for (int i = 0; i < numElements; i++)
+    {
+      mFusion.processGNSSTime(time[i]);
+    }
+  }
+
+  if (!mpSelf)
+  {
+      LOG_ERROR_MSG(gCtx,"Null pointer!");
+      return;
+  }
+
+  if (mpSelf->mpMainLoop)
+  {
+      mpSelf->mIsTimeUpdatePending = true;
+      mpSelf->mpMainLoop->triggerEvent(mpSelf->mInputEvent);
+      return;
+  }
+
+  mpSelf->fireTimeUpdate();
+}
+
+void EnhancedPositionStubImpl::fireTimeUpdate()
+{
+  uint64_t now = getMonotonicTime();
+  if (now - mLastTimeUpdate >= GNSS_UPDATE_INTERVAL)
+  {
+      EnhancedPositionServiceTypes::Timestamp timestamp;
+      EnhancedPositionServiceTypes::TimeInfo timeInfo;
+
+      getGnssTimeInfo<EnhancedPositionServiceTypes>(timestamp, timeInfo);
+      fireTimeUpdateEvent(timestamp, timeInfo);
+      mLastTimeUpdate = now;
+  }
+}
+
+void EnhancedPositionStubImpl::GetSatelliteInfo(const std::shared_ptr<CommonAPI::ClientId> _client, GetSatelliteInfoReply_t _reply)
+{
+    EnhancedPositionServiceTypes::Timestamp timestamp;
+    std::vector<EnhancedPositionServiceTypes::SatelliteInfo> satelliteInfo;
+
+    getGnssSatelliteInfo<EnhancedPositionServiceTypes>(timestamp, satelliteInfo);
+
+    _reply(timestamp, satelliteInfo);
+}
+
+void EnhancedPositionStubImpl::GetTime(const std::shared_ptr<CommonAPI::ClientId> _client, GetTimeReply_t _reply)
+{
+    EnhancedPositionServiceTypes::Timestamp timestamp;
+    EnhancedPositionServiceTypes::TimeInfo time;
 
-  //mpSelf->fireSatelliteInfoUpdateEvent(changedValues);
+    getGnssTimeInfo<EnhancedPositionServiceTypes>(timestamp, time);
+
+    _reply(timestamp, time);
 }
 
 bool EnhancedPositionStubImpl::checkMajorVersion(int expectedMajor)
@@ -303,10 +836,82 @@ void EnhancedPositionStubImpl::run()
         exit(EXIT_FAILURE);
     }
 
+    initSensors();
+
     LOG_INFO_MSG(gCtx,"Starting EnhancedPosition dispatcher...");
 
     gnssRegisterPositionCallback(&cbPosition);
     gnssRegisterSatelliteDetailCallback(&cbSatelliteDetail);
+    gnssRegisterTimeCallback(&cbTime);
+    if (mIsSnsInitialized)
+    {
+        snsGyroscopeRegisterCallback(&cbGyroscope);
+        snsAccelerationRegisterCallback(&cbAcceleration);
+        snsVehicleSpeedRegisterCallback(&cbVehicleSpeed);
+        snsOdometerRegisterCallback(&cbOdometer);
+    }
+}
+
+//the sensors are optional: without them, the position is plain GNSS
+void EnhancedPositionStubImpl::initSensors()
+{
+    mIsSnsInitialized = snsInit();
+    if (!mIsSnsInitialized)
+    {
+        LOG_WARNING_MSG(gCtx,"snsInit failure - no dead reckoning");
+        return;
+    }
+
+    if (!snsGyroscopeInit())
+        LOG_WARNING_MSG(gCtx,"snsGyroscopeInit failure");
+    if (!snsAccelerationInit())
+        LOG_WARNING_MSG(gCtx,"snsAccelerationInit failure");
+    if (!snsVehicleSpeedInit())
+        LOG_WARNING_MSG(gCtx,"snsVehicleSpeedInit failure");
+    if (!snsOdometerInit())
+        LOG_WARNING_MSG(gCtx,"snsOdometerInit failure");
+}
+
+void EnhancedPositionStubImpl::destroySensors()
+{
+    if (!mIsSnsInitialized)
+    {
+        return;
+    }
+
+    snsGyroscopeDeregisterCallback(&cbGyroscope);
+    snsAccelerationDeregisterCallback(&cbAcceleration);
+    snsVehicleSpeedDeregisterCallback(&cbVehicleSpeed);
+    snsOdometerDeregisterCallback(&cbOdometer);
+
+    snsOdometerDestroy();
+    snsVehicleSpeedDestroy();
+    snsAccelerationDestroy();
+    snsGyroscopeDestroy();
+    snsDestroy();
+    mIsSnsInitialized = false;
+}
+
+void EnhancedPositionStubImpl::attach(MainLoop& mainLoop)
+{
+    mInputEvent = mainLoop.addEvent(std::bind(&EnhancedPositionStubImpl::onInput, this));
+    if (mInputEvent < 0)
+    {
+        LOG_ERROR_MSG(gCtx,"No main loop event - broadcasting from the GNSS thread");
+        return;
+    }
+    mpMainLoop = &mainLoop;
+
+    mPositionCycleTimer = mainLoop.addTimer(POSITION_CYCLE_INTERVAL, std::bind(&EnhancedPositionStubImpl::firePositionCycle, this));
+    if (mPositionCycleTimer < 0)
+    {
+        LOG_ERROR_MSG(gCtx,"No main loop timer - no PositionCycle broadcast");
+    }
+}
+
+void EnhancedPositionStubImpl::setStartTime(uint64_t startTime)
+{
+    mStartTime = startTime;
 }
 
 void EnhancedPositionStubImpl::GetVersion(const std::shared_ptr<CommonAPI::ClientId> _client, GetVersionReply_t _reply)
@@ -318,14 +923,42 @@ void EnhancedPositionStubImpl::GetVersion(const std::shared_ptr<CommonAPI::Clien
     _reply(EnhancedPositionVersion);
 }
 
+void EnhancedPositionStubImpl::firePositionUpdateData(EnhancedPositionServiceTypes::Bitmask changedValues)
+{
+    //the payload is only assembled when some client has subscribed to it
+    std::shared_ptr<CommonAPI::ClientIdList> subscribers = getSubscribersForPositionUpdateDataSelective();
+    if (!subscribers || subscribers->empty())
+    {
+        return;
+    }
+
+    EnhancedPositionServiceTypes::Timestamp timestamp;
+    EnhancedPositionServiceTypes::PositionInfo data;
+
+    getPositionInfo(changedValues, timestamp, data);
+
+    firePositionUpdateDataSelective(changedValues, timestamp, data, subscribers);
+}
+
 void EnhancedPositionStubImpl::GetPositionInfo(const std::shared_ptr<CommonAPI::ClientId> _client, ::org::genivi::EnhancedPositionService::EnhancedPositionServiceTypes::Bitmask _valuesToReturn, GetPositionInfoReply_t _reply)
 {
-    TGNSSPosition position;
+    EnhancedPositionServiceTypes::Timestamp timestamp;
     EnhancedPositionServiceTypes::PositionInfo data;
 
+    getPositionInfo(_valuesToReturn, timestamp, data);
+
+    _reply(timestamp,data);
+}
+
+void EnhancedPositionStubImpl::getPositionInfo(EnhancedPositionServiceTypes::Bitmask _valuesToReturn, EnhancedPositionServiceTypes::Timestamp& timestamp, EnhancedPositionServiceTypes::PositionInfo& data)
+{
+    TGNSSPosition position;
+
     bool isPosRequested = false;
     bool isCourseRequested = false;
 
+    memset(&position, 0, sizeof(position));
+
     if ((_valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::LATITUDE)) ||
         (_valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::LONGITUDE)) ||
         (_valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::ALTITUDE)))
@@ -340,8 +973,17 @@ void EnhancedPositionStubImpl::GetPositionInfo(const std::shared_ptr<CommonAPI::
         isCourseRequested = true;
     }
 
-    if(gnssGetPosition(&position))
+    TFusionPosition fused;
+    bool isFused = getFusedPosition(fused);
+    bool isGNSSValid = gnssGetPosition(&position);
+
+    if (isFused)
+    {
+        addFusedPositionInfo(_valuesToReturn, fused, data);
+    }
+    else if (isGNSSValid)
     {
+        //no sensor fusion yet: plain GNSS
         if(isPosRequested)
         {
             if (position.validityBits & GNSS_POSITION_LATITUDE_VALID)
@@ -379,7 +1021,13 @@ void EnhancedPositionStubImpl::GetPositionInfo(const std::shared_ptr<CommonAPI::
         }
     }
 
-    _reply(position.timestamp,data);
+    if (isGNSSValid && (position.validityBits & GNSS_POSITION_STAT_VALID) &&
+        (_valuesToReturn & static_cast<EnhancedPositionServiceTypes::Bitmask>(EnhancedPositionServiceTypes::PositionInfoKey::GNSS_FIX_STATUS)))
+    {
+        data[EnhancedPositionServiceTypes::PositionInfoKey::GNSS_FIX_STATUS] = (uint64_t) position.fixStatus;
+    }
+
+    timestamp = isFused ? fused.timestamp : position.timestamp;
 }
 
 void EnhancedPositionStubImpl::shutdown()
@@ -388,5 +1036,24 @@ void EnhancedPositionStubImpl::shutdown()
 
   gnssDeregisterPositionCallback(&cbPosition);
   gnssDeregisterSatelliteDetailCallback(&cbSatelliteDetail);
+  gnssDeregisterTimeCallback(&cbTime);
   gnssDestroy();
+  destroySensors();
+
+  {
+    std::lock_guard<std::mutex> lock(mFusionMutex);
+    mFusion.reset();
+  }
+
+  if (mpMainLoop)
+  {
+      mpMainLoop->removeEvent(mInputEvent);
+      if (mPositionCycleTimer >= 0)
+      {
+          mpMainLoop->removeTimer(mPositionCycleTimer);
+          mPositionCycleTimer = -1;
+      }
+      mpMainLoop = 0;
+      mInputEvent = -1;
+  }
 }
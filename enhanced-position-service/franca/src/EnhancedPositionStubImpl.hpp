@@ -19,10 +19,20 @@
 #ifndef ENHANCEDPOSITIONSTUBIMPL_H_
 #define ENHANCEDPOSITIONSTUBIMPL_H_
 
+#include <atomic>
+#include <mutex>
 #include <CommonAPI/CommonAPI.hpp>
 #include <v5/org/genivi/EnhancedPositionService/EnhancedPositionStubDefault.hpp>
 #include "gnss-init.h"
 #include "gnss.h"
+#include "sns-init.h"
+#include "gyroscope.h"
+#include "acceleration.h"
+#include "vehicle-speed.h"
+#include "odometer.h"
+#include "fusion-engine.h"
+#include "GnssConversion.hpp"
+#include "MainLoop.hpp"
 
 using namespace v5::org::genivi::EnhancedPositionService;
 
@@ -36,13 +46,71 @@ public:
     void GetVersion(const std::shared_ptr<CommonAPI::ClientId> _client, GetVersionReply_t _reply);
 
     void GetPositionInfo(const std::shared_ptr<CommonAPI::ClientId> _client, ::org::genivi::EnhancedPositionService::EnhancedPositionServiceTypes::Bitmask _valuesToReturn, GetPositionInfoReply_t _reply);
+
+    void GetSatelliteInfo(const std::shared_ptr<CommonAPI::ClientId> _client, GetSatelliteInfoReply_t _reply);
+
+    void GetTime(const std::shared_ptr<CommonAPI::ClientId> _client, GetTimeReply_t _reply);
     void run();
     void shutdown();
+
+    /**
+     * Broadcast from the main loop thread: the GNSS callbacks only record
+     * what has changed and trigger an event of the loop.
+     * The loop also drives the cyclic PositionCycle broadcast.
+     * To be called before run().
+     */
+    void attach(MainLoop& mainLoop);
+
+    /**
+     * Log the time from the start of the service to the first PositionUpdate
+     * @param startTime CLOCK_MONOTONIC [ms]
+     */
+    void setStartTime(uint64_t startTime);
 private:
     bool checkMajorVersion(int expectedMajor);
     static void cbPosition(const TGNSSPosition position[], uint16_t numElements);
     static void cbSatelliteDetail(const TGNSSSatelliteDetail satelliteDetail[], uint16_t numElements);
+    static void cbTime(const TGNSSTime time[], uint16_t numElements);
+    static void cbGyroscope(const TGyroscopeData gyroData[], uint16_t numElements);
+    static void cbAcceleration(const TAccelerationData accelerationData[], uint16_t numElements);
+    static void cbVehicleSpeed(const TVehicleSpeedData vehicleSpeedData[], uint16_t numElements);
+    static void cbOdometer(const TOdometerData odometerData[], uint16_t numElements);
+    static bool getFusedPosition(TFusionPosition& fused);
+    static ::org::genivi::EnhancedPositionService::EnhancedPositionServiceTypes::Bitmask getFusedChangedValues(const TFusionPosition& fused);
+    static void addFusedPositionInfo(::org::genivi::EnhancedPositionService::EnhancedPositionServiceTypes::Bitmask valuesToReturn, const TFusionPosition& fused, ::org::genivi::EnhancedPositionService::EnhancedPositionServiceTypes::PositionInfo& data);
+    static void applyFusedPosition(const TFusionPosition& fused, ::org::genivi::EnhancedPositionService::EnhancedPositionServiceTypes::PositionSample& sample);
+    void initSensors();
+    void destroySensors();
     static void sigPositionUpdate(const TGNSSPosition position[], uint16_t numElements);
+    static void getPositionInfo(::org::genivi::EnhancedPositionService::EnhancedPositionServiceTypes::Bitmask valuesToReturn, ::org::genivi::EnhancedPositionService::EnhancedPositionServiceTypes::Timestamp& timestamp, ::org::genivi::EnhancedPositionService::EnhancedPositionServiceTypes::PositionInfo& data);
+    void publishPositionUpdate(::org::genivi::EnhancedPositionService::EnhancedPositionServiceTypes::Bitmask changedValues);
+    static void getPositionSample(const TGNSSPosition& position, ::org::genivi::EnhancedPositionService::EnhancedPositionServiceTypes::PositionSample& sample);
+    void publishPositionSample(const TGNSSPosition& position);
+    void updatePositionAttribute();
+    void firePositionCycle();
+    void firePositionUpdate(::org::genivi::EnhancedPositionService::EnhancedPositionServiceTypes::Bitmask changedValues);
+    void firePositionUpdateData(::org::genivi::EnhancedPositionService::EnhancedPositionServiceTypes::Bitmask changedValues);
+    void fireSatelliteUpdate();
+    void fireTimeUpdate();
+    void onInput();
+    uint64_t mLastSatelliteUpdate;
+    uint64_t mLastTimeUpdate;
+    MainLoop* mpMainLoop;
+    int mInputEvent;
+    //written by the GNSS thread, taken by the main loop thread
+    std::atomic<uint64_t> mPendingPositionChanges;
+    std::atomic<bool> mIsSatelliteUpdatePending;
+    std::atomic<bool> mIsTimeUpdatePending;
+    std::atomic<bool> mIsPositionSamplePending;
+    //latest position for the position attribute and the PositionCycle broadcast
+    std::mutex mPositionSampleMutex;
+    ::org::genivi::EnhancedPositionService::EnhancedPositionServiceTypes::PositionSample mPositionSample;
+    int mPositionCycleTimer;
+    uint64_t mStartTime;
+    bool mIsSnsInitialized;
+    //dead reckoning, fed by the GNSS and the sensors threads
+    static std::mutex mFusionMutex;
+    static FusionEngine mFusion;
     static EnhancedPositionStubImpl* mpSelf;
 };
 
@@ -0,0 +1,141 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief Conversion of the GNSS snapshot into the Franca EnhancedPosition types
+*
+* \details Shared by the CommonAPI stub (src) and the WAMP stub (enhp-wamp).
+* Their generated types are identical but live in different namespaces,
+* so the functions take the EnhancedPositionServiceTypes struct of the
+* stub as template parameter.
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#ifndef GNSSCONVERSION_H_
+#define GNSSCONVERSION_H_
+
+#include <string.h>
+#include <vector>
+#include "gnss.h"
+
+//maximum number of satellites of one GNSS epoch
+#define SATELLITE_DETAILS_MAX 64
+
+/**
+ * Satellites of the latest GNSS epoch from the GNSS snapshot
+ * @param timestamp set to 0 if no satellites are available
+ */
+template<class Types>
+void getGnssSatelliteInfo(typename Types::Timestamp& timestamp, std::vector<typename Types::SatelliteInfo>& satelliteInfo)
+{
+    TGNSSSatelliteDetail details[SATELLITE_DETAILS_MAX];
+    uint16_t numDetails = 0;
+
+    timestamp = 0;
+    if (!gnssGetSatelliteDetails(details, SATELLITE_DETAILS_MAX, &numDetails))
+    {
+        return;
+    }
+
+    for (uint16_t i = 0; i < numDetails; i++)
+    {
+        if (details[i].timestamp > timestamp)
+        {
+            timestamp = details[i].timestamp;
+        }
+    }
+
+    satelliteInfo.reserve(numDetails);
+    for (uint16_t i = 0; i < numDetails; i++)
+    {
+        const TGNSSSatelliteDetail& detail = details[i];
+        typename Types::SatelliteSystem system;
+
+        if ((detail.timestamp != timestamp) ||
+            !(detail.validityBits & GNSS_SATELLITE_ID_VALID) ||
+            !(detail.validityBits & GNSS_SATELLITE_SYSTEM_VALID))
+        {
+            continue;
+        }
+
+        //the SatelliteSystem enumeration knows the main systems only, SBAS satellites are skipped
+        switch (detail.system)
+        {
+            case GNSS_SYSTEM_GPS:
+            case GNSS_SYSTEM_GPS_L2:
+            case GNSS_SYSTEM_GPS_L5:
+                system = Types::SatelliteSystem::GPS;
+                break;
+            case GNSS_SYSTEM_GLONASS:
+            case GNSS_SYSTEM_GLONASS_L2:
+                system = Types::SatelliteSystem::GLONASS;
+                break;
+            case GNSS_SYSTEM_GALILEO:
+                system = Types::SatelliteSystem::GALILEO;
+                break;
+            case GNSS_SYSTEM_BEIDOU:
+            case GNSS_SYSTEM_BEIDOU_B2:
+                system = Types::SatelliteSystem::COMPASS;
+                break;
+            default:
+                continue;
+        }
+
+        satelliteInfo.push_back(typename Types::SatelliteInfo(
+            system,
+            detail.satelliteId,
+            (detail.validityBits & GNSS_SATELLITE_AZIMUTH_VALID) ? detail.azimuth : 0,
+            (detail.validityBits & GNSS_SATELLITE_ELEVATION_VALID) ? detail.elevation : 0,
+            (detail.validityBits & GNSS_SATELLITE_CNO_VALID) ? detail.CNo : 0,
+            (detail.validityBits & GNSS_SATELLITE_USED_VALID) && (detail.statusBits & GNSS_SATELLITE_USED)));
+    }
+}
+
+/**
+ * UTC date/time from the GNSS snapshot
+ * @param timestamp set to 0 if no time is available
+ */
+template<class Types>
+void getGnssTimeInfo(typename Types::Timestamp& timestamp, typename Types::TimeInfo& time)
+{
+    TGNSSTime utc;
+
+    memset(&utc, 0, sizeof(utc));
+    timestamp = 0;
+    if (!gnssGetTime(&utc))
+    {
+        return;
+    }
+
+    timestamp = utc.timestamp;
+
+    if (utc.validityBits & GNSS_TIME_DATE_VALID)
+    {
+        time[Types::TimeInfoKey::YEAR] = (uint64_t) utc.year;
+        //the GNSS service counts the months from 0 like struct tm
+        time[Types::TimeInfoKey::MONTH] = (uint64_t) (utc.month + 1);
+        time[Types::TimeInfoKey::DAY] = (uint64_t) utc.day;
+    }
+
+    if (utc.validityBits & GNSS_TIME_TIME_VALID)
+    {
+        time[Types::TimeInfoKey::HOUR] = (uint64_t) utc.hour;
+        time[Types::TimeInfoKey::MINUTE] = (uint64_t) utc.minute;
+        time[Types::TimeInfoKey::SECOND] = (uint64_t) utc.second;
+        time[Types::TimeInfoKey::MS] = (uint64_t) utc.ms;
+    }
+}
+
+#endif /* GNSSCONVERSION_H_ */
@@ -0,0 +1,588 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief epoll based main loop for the CommonAPI services
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <algorithm>
+#include "MainLoop.hpp"
+#include "log.h"
+
+//maximum number of file descriptors handled per epoll_wait
+#define EPOLL_EVENTS_MAX 16
+
+DLT_IMPORT_CONTEXT(gCtx);
+
+//the watches use poll() flags
+static uint32_t pollToEpoll(short events)
+{
+    uint32_t flags = 0;
+    if (events & POLLIN)  flags |= EPOLLIN;
+    if (events & POLLPRI) flags |= EPOLLPRI;
+    if (events & POLLOUT) flags |= EPOLLOUT;
+    return flags;
+}
+
+static unsigned int epollToPoll(uint32_t events)
+{
+    unsigned int flags = 0;
+    if (events & EPOLLIN)  flags |= POLLIN;
+    if (events & EPOLLPRI) flags |= POLLPRI;
+    if (events & EPOLLOUT) flags |= POLLOUT;
+    if (events & EPOLLERR) flags |= POLLERR;
+    if (events & EPOLLHUP) flags |= POLLHUP;
+    return flags;
+}
+
+static void readCounter(int fd)
+{
+    uint64_t counter;
+    while (read(fd, &counter, sizeof(counter)) == sizeof(counter))
+    {
+        //drain
+    }
+}
+
+MainLoop::MainLoop(std::shared_ptr<CommonAPI::MainLoopContext> context)
+    : mContext(context)
+    , mIsSubscribed(false)
+    , mEpollFd(-1)
+    , mWakeupFd(-1)
+    , mSignalFd(-1)
+    , mQuit(false)
+{
+}
+
+MainLoop::~MainLoop()
+{
+    if (mIsSubscribed)
+    {
+        mContext->unsubscribeForDispatchSources(mDispatchSourceSubscription);
+        mContext->unsubscribeForWatches(mWatchSubscription);
+        mContext->unsubscribeForTimeouts(mTimeoutSubscription);
+        mContext->unsubscribeForWakeupEvents(mWakeupSubscription);
+    }
+
+    //the timers and events are owned by the loop
+    for (std::map<int, FdHandler>::iterator it = mHandlers.begin(); it != mHandlers.end(); ++it)
+    {
+        if (it->first != mWakeupFd)
+        {
+            close(it->first);
+        }
+    }
+    if (mWakeupFd >= 0)
+    {
+        close(mWakeupFd);
+    }
+    if (mEpollFd >= 0)
+    {
+        close(mEpollFd);
+    }
+}
+
+bool MainLoop::init()
+{
+    mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (mEpollFd < 0)
+    {
+        LOG_ERROR(gCtx,"epoll_create1 failed: %s", strerror(errno));
+        return false;
+    }
+
+    mWakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mWakeupFd < 0)
+    {
+        LOG_ERROR(gCtx,"eventfd failed: %s", strerror(errno));
+        return false;
+    }
+    int wakeupFd = mWakeupFd;
+    if (!addFd(mWakeupFd, EPOLLIN, [wakeupFd](uint32_t) { readCounter(wakeupFd); }))
+    {
+        return false;
+    }
+
+    using namespace std::placeholders;
+    mDispatchSourceSubscription = mContext->subscribeForDispatchSources(
+        std::bind(&MainLoop::onDispatchSourceAdded, this, _1, _2),
+        std::bind(&MainLoop::onDispatchSourceRemoved, this, _1));
+    mWatchSubscription = mContext->subscribeForWatches(
+        std::bind(&MainLoop::onWatchAdded, this, _1, _2),
+        std::bind(&MainLoop::onWatchRemoved, this, _1));
+    mTimeoutSubscription = mContext->subscribeForTimeouts(
+        std::bind(&MainLoop::onTimeoutAdded, this, _1, _2),
+        std::bind(&MainLoop::onTimeoutRemoved, this, _1));
+    mWakeupSubscription = mContext->subscribeForWakeupEvents(
+        std::bind(&MainLoop::wakeup, this));
+    mIsSubscribed = true;
+
+    return true;
+}
+
+bool MainLoop::quitOnSignals(const std::vector<int>& signals)
+{
+    sigset_t mask;
+
+    sigemptyset(&mask);
+    for (size_t i = 0; i < signals.size(); i++)
+    {
+        sigaddset(&mask, signals[i]);
+    }
+
+    if (sigprocmask(SIG_BLOCK, &mask, 0) < 0)
+    {
+        LOG_ERROR(gCtx,"sigprocmask failed: %s", strerror(errno));
+        return false;
+    }
+
+    mSignalFd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (mSignalFd < 0)
+    {
+        LOG_ERROR(gCtx,"signalfd failed: %s", strerror(errno));
+        return false;
+    }
+
+    int signalFd = mSignalFd;
+    return addFd(mSignalFd, EPOLLIN, [this, signalFd](uint32_t)
+    {
+        struct signalfd_siginfo info;
+        while (read(signalFd, &info, sizeof(info)) == sizeof(info))
+        {
+            LOG_INFO(gCtx,"Signal %d received", info.ssi_signo);
+            quit();
+        }
+    });
+}
+
+bool MainLoop::addFd(int fd, uint32_t events, FdHandler handler)
+{
+    struct epoll_event event;
+
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.fd = fd;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+    {
+        LOG_ERROR(gCtx,"epoll_ctl(ADD, %d) failed: %s", fd, strerror(errno));
+        return false;
+    }
+    mHandlers[fd] = handler;
+    return true;
+}
+
+void MainLoop::removeFd(int fd)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mHandlers.erase(fd) > 0)
+    {
+        epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, 0);
+    }
+}
+
+int MainLoop::addTimer(int64_t interval, Handler handler)
+{
+    struct itimerspec spec;
+
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0)
+    {
+        LOG_ERROR(gCtx,"timerfd_create failed: %s", strerror(errno));
+        return -1;
+    }
+
+    spec.it_interval.tv_sec = interval / 1000;
+    spec.it_interval.tv_nsec = (interval % 1000) * 1000000;
+    spec.it_value = spec.it_interval;
+    if ((timerfd_settime(fd, 0, &spec, 0) < 0) ||
+        !addFd(fd, EPOLLIN, [fd, handler](uint32_t) { readCounter(fd); handler(); }))
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void MainLoop::removeTimer(int timer)
+{
+    if (timer >= 0)
+    {
+        removeFd(timer);
+        close(timer);
+    }
+}
+
+int MainLoop::addEvent(Handler handler)
+{
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0)
+    {
+        LOG_ERROR(gCtx,"eventfd failed: %s", strerror(errno));
+        return -1;
+    }
+
+    if (!addFd(fd, EPOLLIN, [fd, handler](uint32_t) { readCounter(fd); handler(); }))
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void MainLoop::triggerEvent(int event)
+{
+    uint64_t one = 1;
+    if (write(event, &one, sizeof(one)) != sizeof(one))
+    {
+        //EAGAIN: the counter is saturated, the loop is woken anyway
+    }
+}
+
+void MainLoop::removeEvent(int event)
+{
+    if (event >= 0)
+    {
+        removeFd(event);
+        close(event);
+    }
+}
+
+void MainLoop::wakeup()
+{
+    triggerEvent(mWakeupFd);
+}
+
+void MainLoop::quit()
+{
+    mQuit = true;
+    wakeup();
+}
+
+void MainLoop::run()
+{
+    struct epoll_event events[EPOLL_EVENTS_MAX];
+
+    LOG_INFO_MSG(gCtx,"Main loop running");
+
+    while (!mQuit)
+    {
+        std::vector<CommonAPI::DispatchSource*> readySources;
+        int64_t timeout = prepareDispatchSources(readySources);
+
+        int n = epoll_wait(mEpollFd, events, EPOLL_EVENTS_MAX, (timeout > INT32_MAX) ? -1 : (int)timeout);
+        if ((n < 0) && (errno != EINTR))
+        {
+            LOG_ERROR(gCtx,"epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            int fd = events[i].data.fd;
+            FdHandler handler;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                std::map<int, FdHandler>::iterator it = mHandlers.find(fd);
+                if (it != mHandlers.end())
+                {
+                    //a copy: the handler may remove itself
+                    handler = it->second;
+                }
+            }
+            if (handler)
+            {
+                handler(events[i].events);
+            }
+            else
+            {
+                dispatchWatches(fd, events[i].events);
+            }
+        }
+
+        dispatchSources(readySources);
+        dispatchTimeouts();
+    }
+
+    LOG_INFO_MSG(gCtx,"Main loop left");
+}
+
+//the first watch of a file descriptor may remove the others, so each one is checked before its dispatch
+void MainLoop::dispatchWatches(int fd, uint32_t events)
+{
+    std::vector<CommonAPI::Watch*> watches;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::map<int, std::vector<CommonAPI::Watch*> >::iterator it = mWatches.find(fd);
+        if (it == mWatches.end())
+        {
+            return;
+        }
+        watches = it->second;
+    }
+
+    unsigned int flags = epollToPoll(events);
+    for (size_t i = 0; i < watches.size(); i++)
+    {
+        CommonAPI::Watch* watch = watches[i];
+        if (!isWatchRegistered(fd, watch))
+        {
+            continue;
+        }
+
+        const pollfd& pfd = watch->getAssociatedFileDescriptor();
+        unsigned int watchFlags = flags & (pfd.events | POLLERR | POLLHUP);
+        if (watchFlags == 0)
+        {
+            continue;
+        }
+
+        watch->dispatch(watchFlags);
+
+        if (isWatchRegistered(fd, watch))
+        {
+            const std::vector<CommonAPI::DispatchSource*>& sources = watch->getDependentDispatchSources();
+            for (size_t j = 0; j < sources.size(); j++)
+            {
+                while (sources[j]->dispatch())
+                {
+                }
+            }
+        }
+    }
+}
+
+bool MainLoop::isWatchRegistered(int fd, CommonAPI::Watch* watch)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::map<int, std::vector<CommonAPI::Watch*> >::iterator it = mWatches.find(fd);
+    return (it != mWatches.end()) && (std::find(it->second.begin(), it->second.end(), watch) != it->second.end());
+}
+
+//epoll allows each file descriptor only once, but the reading and the writing watch may share one
+void MainLoop::updateWatchFd(int fd)
+{
+    std::map<int, std::vector<CommonAPI::Watch*> >::iterator it = mWatches.find(fd);
+    if (it == mWatches.end())
+    {
+        return;
+    }
+
+    if (it->second.empty())
+    {
+        epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, 0);
+        mWatches.erase(it);
+        return;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.data.fd = fd;
+    for (size_t i = 0; i < it->second.size(); i++)
+    {
+        event.events |= pollToEpoll(it->second[i]->getAssociatedFileDescriptor().events);
+    }
+
+    if (epoll_ctl(mEpollFd, EPOLL_CTL_MOD, fd, &event) < 0)
+    {
+        if ((errno != ENOENT) || (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &event) < 0))
+        {
+            LOG_ERROR(gCtx,"epoll_ctl(%d) failed for a watch: %s", fd, strerror(errno));
+        }
+    }
+}
+
+//@return the epoll timeout [ms], 0 if some source is ready already
+int64_t MainLoop::prepareDispatchSources(std::vector<CommonAPI::DispatchSource*>& readySources)
+{
+    int64_t timeout = CommonAPI::TIMEOUT_INFINITE;
+    std::vector<std::pair<CommonAPI::DispatchPriority, CommonAPI::DispatchSource*> > sources;
+    std::vector<CommonAPI::Timeout*> timeouts;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        sources = mDispatchSources;
+        timeouts = mTimeouts;
+    }
+
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        int64_t sourceTimeout = CommonAPI::TIMEOUT_INFINITE;
+        if (sources[i].second->prepare(sourceTimeout))
+        {
+            readySources.push_back(sources[i].second);
+            timeout = 0;
+        }
+        else if (sourceTimeout < timeout)
+        {
+            timeout = sourceTimeout;
+        }
+    }
+
+    int64_t now = CommonAPI::getCurrentTimeInMs();
+    for (size_t i = 0; i < timeouts.size(); i++)
+    {
+        int64_t remaining = timeouts[i]->getReadyTime() - now;
+        if (remaining < timeout)
+        {
+            timeout = (remaining > 0) ? remaining : 0;
+        }
+    }
+
+    return timeout;
+}
+
+void MainLoop::dispatchSources(const std::vector<CommonAPI::DispatchSource*>& readySources)
+{
+    std::vector<std::pair<CommonAPI::DispatchPriority, CommonAPI::DispatchSource*> > sources;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        sources = mDispatchSources;
+    }
+
+    //sorted by priority, see onDispatchSourceAdded()
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        CommonAPI::DispatchSource* source = sources[i].second;
+        if (!isDispatchSourceRegistered(source))
+        {
+            continue;
+        }
+
+        bool isReady = (std::find(readySources.begin(), readySources.end(), source) != readySources.end()) ||
+                       source->check();
+        if (isReady)
+        {
+            while (source->dispatch())
+            {
+            }
+        }
+    }
+}
+
+bool MainLoop::isDispatchSourceRegistered(CommonAPI::DispatchSource* source)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (size_t i = 0; i < mDispatchSources.size(); i++)
+    {
+        if (mDispatchSources[i].second == source)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MainLoop::dispatchTimeouts()
+{
+    std::vector<CommonAPI::Timeout*> timeouts;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        timeouts = mTimeouts;
+    }
+
+    int64_t now = CommonAPI::getCurrentTimeInMs();
+    for (size_t i = 0; i < timeouts.size(); i++)
+    {
+        bool isRegistered;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            isRegistered = std::find(mTimeouts.begin(), mTimeouts.end(), timeouts[i]) != mTimeouts.end();
+        }
+        if (isRegistered && (timeouts[i]->getReadyTime() <= now))
+        {
+            timeouts[i]->dispatch();
+        }
+    }
+}
+
+void MainLoop::onDispatchSourceAdded(CommonAPI::DispatchSource* source, const CommonAPI::DispatchPriority priority)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        //VERY_HIGH is the smallest value
+        std::vector<std::pair<CommonAPI::DispatchPriority, CommonAPI::DispatchSource*> >::iterator it = mDispatchSources.begin();
+        while ((it != mDispatchSources.end()) && (static_cast<int>(it->first) <= static_cast<int>(priority)))
+        {
+            ++it;
+        }
+        mDispatchSources.insert(it, std::make_pair(priority, source));
+    }
+    wakeup();
+}
+
+void MainLoop::onDispatchSourceRemoved(CommonAPI::DispatchSource* source)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (size_t i = 0; i < mDispatchSources.size(); i++)
+    {
+        if (mDispatchSources[i].second == source)
+        {
+            mDispatchSources.erase(mDispatchSources.begin() + i);
+            break;
+        }
+    }
+}
+
+void MainLoop::onWatchAdded(CommonAPI::Watch* watch, const CommonAPI::DispatchPriority priority)
+{
+    int fd = watch->getAssociatedFileDescriptor().fd;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mWatches[fd].push_back(watch);
+        updateWatchFd(fd);
+    }
+    wakeup();
+}
+
+void MainLoop::onWatchRemoved(CommonAPI::Watch* watch)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (std::map<int, std::vector<CommonAPI::Watch*> >::iterator it = mWatches.begin(); it != mWatches.end(); ++it)
+    {
+        std::vector<CommonAPI::Watch*>::iterator found = std::find(it->second.begin(), it->second.end(), watch);
+        if (found != it->second.end())
+        {
+            it->second.erase(found);
+            updateWatchFd(it->first);
+            break;
+        }
+    }
+}
+
+void MainLoop::onTimeoutAdded(CommonAPI::Timeout* timeout, const CommonAPI::DispatchPriority priority)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTimeouts.push_back(timeout);
+    }
+    wakeup();
+}
+
+void MainLoop::onTimeoutRemoved(CommonAPI::Timeout* timeout)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mTimeouts.erase(std::remove(mTimeouts.begin(), mTimeouts.end(), timeout), mTimeouts.end());
+}
@@ -0,0 +1,132 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup EnhancedPositionService
+* \brief epoll based main loop for the CommonAPI services
+*
+* \details The loop serves the watches, timeouts and dispatch sources of a
+* CommonAPI::MainLoopContext and, on the same thread, its own file
+* descriptors: events triggered from other threads (e.g. the GNSS
+* callbacks), periodic timers and the termination signals.
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#ifndef MAINLOOP_H_
+#define MAINLOOP_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <CommonAPI/MainLoopContext.hpp>
+
+class MainLoop {
+
+public:
+    typedef std::function<void(uint32_t events)> FdHandler;
+    typedef std::function<void()> Handler;
+
+    MainLoop(std::shared_ptr<CommonAPI::MainLoopContext> context);
+    ~MainLoop();
+
+    /**
+     * Create the epoll instance and subscribe to the main loop context
+     * @return false if a file descriptor could not be created
+     */
+    bool init();
+
+    /**
+     * Block the given signals and quit the loop when one of them is received.
+     * Must be called after init() but before any other thread is started,
+     * the threads inherit the signal mask.
+     */
+    bool quitOnSignals(const std::vector<int>& signals);
+
+    /**
+     * Call the handler on the loop thread when the file descriptor is ready
+     * @param events EPOLLIN, EPOLLOUT...
+     */
+    bool addFd(int fd, uint32_t events, FdHandler handler);
+    void removeFd(int fd);
+
+    /**
+     * Call the handler on the loop thread after each interval
+     * @param interval [ms]
+     * @return id of the timer for removeTimer(), -1 on error
+     */
+    int addTimer(int64_t interval, Handler handler);
+    void removeTimer(int timer);
+
+    /**
+     * Event to be triggered from any thread. Several triggers before the
+     * loop gets to the event result in one call of the handler.
+     * @return id of the event for triggerEvent() and removeEvent(), -1 on error
+     */
+    int addEvent(Handler handler);
+    void triggerEvent(int event);
+    void removeEvent(int event);
+
+    /**
+     * Dispatch until quit() is called
+     */
+    void run();
+
+    /**
+     * Leave run(), may be called from any thread
+     */
+    void quit();
+
+private:
+    void wakeup();
+    void dispatchWatches(int fd, uint32_t events);
+    bool isWatchRegistered(int fd, CommonAPI::Watch* watch);
+    void updateWatchFd(int fd);
+    int64_t prepareDispatchSources(std::vector<CommonAPI::DispatchSource*>& readySources);
+    void dispatchSources(const std::vector<CommonAPI::DispatchSource*>& readySources);
+    bool isDispatchSourceRegistered(CommonAPI::DispatchSource* source);
+    void dispatchTimeouts();
+
+    void onDispatchSourceAdded(CommonAPI::DispatchSource* source, const CommonAPI::DispatchPriority priority);
+    void onDispatchSourceRemoved(CommonAPI::DispatchSource* source);
+    void onWatchAdded(CommonAPI::Watch* watch, const CommonAPI::DispatchPriority priority);
+    void onWatchRemoved(CommonAPI::Watch* watch);
+    void onTimeoutAdded(CommonAPI::Timeout* timeout, const CommonAPI::DispatchPriority priority);
+    void onTimeoutRemoved(CommonAPI::Timeout* timeout);
+
+    std::shared_ptr<CommonAPI::MainLoopContext> mContext;
+    CommonAPI::DispatchSourceListenerSubscription mDispatchSourceSubscription;
+    CommonAPI::WatchListenerSubscription mWatchSubscription;
+    CommonAPI::TimeoutSourceListenerSubscription mTimeoutSubscription;
+    CommonAPI::WakeupListenerSubscription mWakeupSubscription;
+    bool mIsSubscribed;
+
+    int mEpollFd;
+    int mWakeupFd;
+    int mSignalFd;
+    std::atomic<bool> mQuit;
+
+    //the context may add and remove sources from other threads
+    std::mutex mMutex;
+    std::map<int, FdHandler> mHandlers;
+    std::map<int, std::vector<CommonAPI::Watch*> > mWatches;
+    std::vector<std::pair<CommonAPI::DispatchPriority, CommonAPI::DispatchSource*> > mDispatchSources;
+    std::vector<CommonAPI::Timeout*> mTimeouts;
+};
+
+#endif /* MAINLOOP_H_ */
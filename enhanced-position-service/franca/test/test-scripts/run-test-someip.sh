@@ -24,21 +24,45 @@ LOGREPLAYER_DIR=$TOP_DIR/build/log-replayer/src
 ENHPOS_DIR=$TOP_DIR/build/enhanced-position-service/franca/src
 ENHPOS_RES=$TOP_DIR/enhanced-position-service/franca/res
 
+#all the applications use a local vsomeip routing manager over loopback
+#-c <file>: another vsomeip configuration, e.g. EnhancedPositionService.json
+#-m <option>: client option, -f (position field, default), -p (PositionUpdateData), - (GetPositionInfo)
+VSOMEIP_CONFIG=$ENHPOS_RES/vsomeip-loopback.json
+CLIENT_MODE=-f
+ROUTINGMANAGERD=${ROUTINGMANAGERD:-routingmanagerd}
+
+while getopts "c:m:" opt; do
+    case $opt in
+        c) VSOMEIP_CONFIG=$OPTARG ;;
+        m) CLIENT_MODE=$OPTARG ;;
+        *) echo "usage: $0 [-c vsomeip-config] [-m client-option]"; exit 1 ;;
+    esac
+done
+
 echo "Test started"
 
+if grep -q '"routing" *: *"routingmanagerd"' $VSOMEIP_CONFIG; then
+    VSOMEIP_CONFIGURATION=$VSOMEIP_CONFIG \
+    $ROUTINGMANAGERD > /dev/null 2>&1 &
+    ROUTING_PID=$!
+    sleep 1
+fi
+
 $LOGREPLAYER_DIR/log-replayer $LOGS_DIR/geneve-cologny.log > /dev/null 2>&1 &
 
 COMMONAPI_DEFAULT_CONFIG=$ENHPOS_RES/commonapi4someip.ini \
-VSOMEIP_CONFIGURATION_FILE=$ENHPOS_RES/EnhancedPositionService.json \
+VSOMEIP_CONFIGURATION=$VSOMEIP_CONFIG \
+VSOMEIP_CONFIGURATION_FILE=$VSOMEIP_CONFIG \
 VSOMEIP_APPLICATION_NAME=EnhancedPositionService \
 $ENHPOS_DIR/EnhancedPositionServiceSomeIP &
 
 sleep 1
 
 COMMONAPI_DEFAULT_CONFIG=$ENHPOS_RES/commonapi4someip.ini \
-VSOMEIP_CONFIGURATION_FILE=$ENHPOS_RES/EnhancedPositionService.json \
+VSOMEIP_CONFIGURATION=$VSOMEIP_CONFIG \
+VSOMEIP_CONFIGURATION_FILE=$VSOMEIP_CONFIG \
 VSOMEIP_APPLICATION_NAME=EnhancedPositionClient \
-$ENHPOS_DIR/EnhancedPositionClientSomeIP &
+$ENHPOS_DIR/EnhancedPositionClientSomeIP $CLIENT_MODE &
 
 sleep 10
 
@@ -47,5 +71,7 @@ echo "Test finished"
 killall EnhancedPositionClientSomeIP
 killall EnhancedPositionServiceSomeIP
 killall log-replayer
-
+if [ -n "$ROUTING_PID" ]; then
+    kill $ROUTING_PID
+fi
 
@@ -26,7 +26,10 @@ static pthread_mutex_t mutexData = PTHREAD_MUTEX_INITIALIZER;  //protects the da
 
 TGNSSConfiguration gGNSSConfiguration = {0};
 
-static TGNSSSatelliteDetail gSatelliteDetail = {0}; //TODO: buffer full set of satellite details for one point in time
+//full set of satellite details for one point in time (the latest epoch)
+#define GNSS_SATELLITE_DETAILS_MAX 64
+static TGNSSSatelliteDetail gSatelliteDetail[GNSS_SATELLITE_DETAILS_MAX];
+static uint16_t gNumSatelliteDetails = 0;
 static GNSSSatelliteDetailCallback cbSatelliteDetail = 0;
 
 static TGNSSPosition gPosition = {0};
@@ -109,12 +112,15 @@ bool gnssGetSatelliteDetails(TGNSSSatelliteDetail* satelliteDetails, uint16_t co
 {
     bool retval = false;
 
-    if(satelliteDetails && count)
+    if(satelliteDetails && count && numSatelliteDetails)
     {
-//TODO: return full set of satellite details for one point in time
+        uint16_t i;
         pthread_mutex_lock(&mutexData);
-        *satelliteDetails = gSatelliteDetail;
-        *numSatelliteDetails = 1;
+        *numSatelliteDetails = (gNumSatelliteDetails < count) ? gNumSatelliteDetails : count;
+        for (i = 0; i < *numSatelliteDetails; i++)
+        {
+            satelliteDetails[i] = gSatelliteDetail[i];
+        }
         pthread_mutex_unlock(&mutexData);
         retval = true;
     }
@@ -301,8 +307,20 @@ void updateGNSSSatelliteDetail(const TGNSSSatelliteDetail satelliteDetail[], uin
 {
     if (satelliteDetail != NULL && numElements > 0)
     {
+        uint16_t i;
         pthread_mutex_lock(&mutexData);
-        gSatelliteDetail = satelliteDetail[numElements-1];
+        for (i = 0; i < numElements; i++)
+        {
+            //a new timestamp starts a new epoch
+            if ((gNumSatelliteDetails > 0) && (gSatelliteDetail[0].timestamp != satelliteDetail[i].timestamp))
+            {
+                gNumSatelliteDetails = 0;
+            }
+            if (gNumSatelliteDetails < GNSS_SATELLITE_DETAILS_MAX)
+            {
+                gSatelliteDetail[gNumSatelliteDetails++] = satelliteDetail[i];
+            }
+        }
         pthread_mutex_unlock(&mutexData);
         pthread_mutex_lock(&mutexCb);
         if (cbSatelliteDetail)
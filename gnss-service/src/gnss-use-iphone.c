@@ -0,0 +1,143 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup GNSSService
+* \author Marco Residori <marco.residori@xse.de>
+*
+* \copyright Copyright (C) 2013, XS Embedded GmbH
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+/*
+ * GNSS service backend for the SensorLogger iPhone app.
+ *
+ * The datagrams of the app are received by the iPhone listener shared with
+ * the sensors service, see iphone-listener.h. Only the GPS records
+ *   1,<latitude>,<longitude>,<altitude>
+ * are evaluated here; gyroscope and acceleration records are evaluated
+ * by the iPhone backend of the sensors service.
+ * All positions of one datagram are passed to the callback at once.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <memory.h>
+
+#include "globals.h"
+#include "gnss-init.h"
+#include "iphone-listener.h"
+#include "log.h"
+
+//Maximum number of positions per datagram
+#define IPHONE_MAX_POSITIONS 16
+
+DLT_DECLARE_CONTEXT(gContext);
+
+//Positions of the current datagram, only accessed by the listener thread
+static TGNSSPosition positions[IPHONE_MAX_POSITIONS];
+static uint16_t numPositions = 0;
+
+static void onRecord(int sensorId, uint64_t timestamp, double phoneTime, const double values[], uint64_t now);
+static void onFlush(uint64_t now);
+
+static const TIphoneListenerClient listenerClient = { onRecord, onFlush };
+static bool isRunning = false;
+
+bool gnssInit()
+{
+    DLT_REGISTER_APP("GNSS", "GNSS-SERVICE");
+    DLT_REGISTER_CONTEXT(gContext,"GSRV", "Global Context");
+
+    iGnssInit();
+
+    numPositions = 0;
+
+    if (!iphoneListenerAdd(&listenerClient))
+    {
+        LOG_ERROR_MSG(gContext,"cannot start the iPhone listener");
+        iGnssDestroy();
+        return false;
+    }
+
+    isRunning = true;
+    return true;
+}
+
+bool gnssDestroy()
+{
+    if (!isRunning)
+    {
+        return false;
+    }
+
+    isRunning = false;
+    iphoneListenerRemove(&listenerClient);
+
+    iGnssDestroy();
+
+    return true;
+}
+
+void gnssGetVersion(int *major, int *minor, int *micro)
+{
+    if(major)
+    {
+        *major = GENIVI_GNSS_API_MAJOR;
+    }
+
+    if (minor)
+    {
+        *minor = GENIVI_GNSS_API_MINOR;
+    }
+
+    if (micro)
+    {
+        *micro = GENIVI_GNSS_API_MICRO;
+    }
+}
+
+bool gnssSetGNSSSystems(uint32_t activate_systems)
+{
+    //the app only delivers GPS positions, which are always active
+    return (activate_systems == GNSS_SYSTEM_GPS);
+}
+
+static void onRecord(int sensorId, uint64_t timestamp, double phoneTime, const double values[], uint64_t now)
+{
+    (void)phoneTime;
+    (void)now;
+
+    if ((sensorId == IPHONE_GPS_SENSOR) && (numPositions < IPHONE_MAX_POSITIONS))
+    {
+        TGNSSPosition* pos = &positions[numPositions++];
+        memset(pos, 0, sizeof(TGNSSPosition));
+        pos->timestamp = timestamp;
+        pos->latitude = values[0];
+        pos->longitude = values[1];
+        pos->altitudeMSL = values[2];
+        pos->fixStatus = GNSS_FIX_STATUS_3D;
+        pos->validityBits = GNSS_POSITION_LATITUDE_VALID | GNSS_POSITION_LONGITUDE_VALID |
+                            GNSS_POSITION_ALTITUDEMSL_VALID | GNSS_POSITION_STAT_VALID;
+    }
+}
+
+static void onFlush(uint64_t now)
+{
+    (void)now;
+
+    if (numPositions > 0)
+    {
+        updateGNSSPosition(positions, numPositions);
+        numPositions = 0;
+    }
+}
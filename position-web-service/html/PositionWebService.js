@@ -18,6 +18,10 @@
 //
 /////////////////////////////////////////////////////////////////////////////////
 
+// The positions are streamed by the position-web-server over a WebSocket:
+// one JSON frame per position, with short keys and only the valid values, e.g.
+// {"t":1234,"lat":46.2044000,"lon":6.1432000,"alt":375.0,"hdg":90.0,"spd":13.9,"acc":5.0}
+
 var Position = {
        latitude: 0, 
        longitude: 0,
@@ -25,7 +29,8 @@ var Position = {
        accuracy: 0,
        altitudeAccuracy: 0,
        heading: 0,
-       speed: 0
+       speed: 0,
+       timestamp: 0
     };
 
 var PositionError = {
@@ -33,6 +38,13 @@ var PositionError = {
        message: ""
 }
 
+var POSITION_UNAVAILABLE = 2;
+
+//server of the stream, if the page is not loaded from it
+var DEFAULT_SERVER = "localhost:8080";
+//delay before a lost stream is opened again [ms]
+var RECONNECT_DELAY = 1000;
+
 //flags
 var isGetPending = false;
 var isWatchActive = false;
@@ -43,9 +55,67 @@ var PositionErrorCallback;
 var WatchCallback; 
 var WatchErrorCallback; 
 
-window.onload = function() {
-    console.log( "Get plugin");
-    plugin = document.getElementById('plugin');
+//stream
+var socket = null;
+//maximum rate of the positions [Hz], 0 for every position
+var rate = 0;
+var reconnectTimer = null;
+
+function openStream()
+{
+    if (socket != null) {
+        return;
+    }
+
+    var server = (location.protocol == "http:" || location.protocol == "https:") ? location.host : DEFAULT_SERVER;
+    var scheme = (location.protocol == "https:") ? "wss://" : "ws://";
+    console.log( "openStream() " + server );
+
+    socket = new WebSocket(scheme + server + "/position?rate=" + rate);
+    socket.onmessage = function(event) {
+        PositionUpdate(JSON.parse(event.data));
+    };
+    socket.onclose = function(event) {
+        console.log( "stream closed" );
+        socket = null;
+        PositionError.code = POSITION_UNAVAILABLE;
+        PositionError.message = "Connection to the position web service lost";
+        if (isGetPending == true)
+        {
+            isGetPending = false;
+            PositionErrorCallback(PositionError);
+        }
+        if (isWatchActive == true)
+        {
+            WatchErrorCallback(PositionError);
+            reconnectTimer = setTimeout(function() { reconnectTimer = null; openStream(); }, RECONNECT_DELAY);
+        }
+    };
+}
+
+function closeStream()
+{
+    if (reconnectTimer != null) {
+        clearTimeout(reconnectTimer);
+        reconnectTimer = null;
+    }
+    if (socket != null) {
+        socket.onclose = null;
+        socket.close();
+        socket = null;
+    }
+}
+
+function setRate(options)
+{
+    //non-standard option: maximum rate of the watch [Hz]
+    var newRate = (options && options.rate) ? options.rate : 0;
+    if (newRate != rate) {
+        rate = newRate;
+        if (socket != null && socket.readyState == WebSocket.OPEN) {
+            socket.send("rate=" + rate);
+        }
+    }
 }
 
 function getCurrentPosition(successCallback, errorCallback, options){
@@ -55,51 +125,72 @@ function getCurrentPosition(successCallback, errorCallback, options){
 
    PositionCallback = successCallback;
    PositionErrorCallback = errorCallback;
+
+   //the server sends the latest position as soon as the stream is open
+   openStream();
 }
 
 function watchPosition(successCallback, errorCallback, options)
 {
-    plugin.addEventListener('PositionUpdate', PositionUpdate, false);
     isWatchActive = true;
 
     WatchCallback = successCallback;
     WatchErrorCallback = errorCallback;
+
+    setRate(options);
+    openStream();
 }
 
 function clearWatch()
 {
-    plugin.removeEventListener('PositionUpdate', PositionUpdate, false);
     isWatchActive = false;
     WatchCallback = 'undefined';
     WatchErrorCallback = 'undefined';
+
+    if (isGetPending == false) {
+        closeStream();
+    }
 }
 
 function PositionUpdate(data) {
    console.log( "PositionUpdate" );
 
-   var pos = plugin.GetPosition();
+   //the values which are not in the frame keep their previous value
+   if ("lat" in data) {
+       Position.latitude = data.lat;
+   }
 
-   if (data.indexOf("LATITUDE") > -1) {
-       Position.latitude = pos["LATITUDE"].toFixed(4);
+   if ("lon" in data) {
+       Position.longitude = data.lon;
    }
 
-   if (data.indexOf("LONGITUDE") > -1) {
-       Position.longitude = pos["LONGITUDE"].toFixed(4);
+   if ("alt" in data) {
+       Position.altitude = data.alt;
    }
 
-   if (data.indexOf("ALTITUDE") > -1) {
-       Position.altitude = pos["ALTITUDE"].toFixed(2);
+   if ("hdg" in data) {
+       Position.heading = data.hdg;
    }
 
-   if (data.indexOf("SPEED") > -1) {
-       Position.speed = pos["SPEED"].toFixed(4);
+   if ("spd" in data) {
+       Position.speed = data.spd;
    }
 
+   if ("acc" in data) {
+       Position.accuracy = data.acc;
+   }
+
+   Position.timestamp = data.t;
+
    if (isGetPending == true)
    {
       console.log( "calling PositionCallback");
       isGetPending = false;
       PositionCallback(Position);   
+      if (isWatchActive == false)
+      {
+         closeStream();
+      }
    }
    
    if (isWatchActive == true)
@@ -108,7 +199,3 @@ function PositionUpdate(data) {
       WatchCallback(Position);   
    }
 }
-
-
-
-
@@ -23,6 +23,7 @@
 
 usage() {
 	echo "Usage: ./build-all.sh Build all"
+	echo "       (the position-web-server, the NPAPI plugin is built by build-plugin.sh)"
 	echo "   or: ./build-all.sh [mode]"
 	echo
 	echo "Mode:"
@@ -41,23 +42,21 @@ if [ $# -eq 1 ]; then
 	elif [ $1 = --help ]; then
 		usage
 	elif [ $1 = make ]; then
-		./build-plugin.sh prepmake
-		./build-plugin.sh make
+		./build-server.sh make
 	elif [ $1 = install ]; then
-		./build-plugin.sh install
+		./build-server.sh make
 	elif [ $1 = clean ]; then
-		./build-plugin.sh clean
+		./build-server.sh clean
 	elif [ $1 = distclean ]; then
-		./build-plugin.sh distclean
+		./build-server.sh clean
 	elif [ $1 = new ]; then
-		./build-plugin.sh new
+		./build-server.sh clean
+		./build-server.sh make
 	else
 		usage
 	fi
 elif [ $# -eq 0 ]; then
-	./build-plugin.sh prepmake 
-	./build-plugin.sh make
-	./build-plugin.sh install
+	./build-server.sh make
 else
 	usage
 fi
@@ -0,0 +1,60 @@
+#!/bin/bash
+
+###########################################################################
+# @licence app begin@
+# SPDX-License-Identifier: MPL-2.0
+#
+# Component Name: PositionWebService
+#
+# Author: agent <agent@local>
+#
+# Copyright (C) 2026, agent
+#
+# License:
+# This Source Code Form is subject to the terms of the
+# Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+# this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# @licence end@
+###########################################################################
+
+# SRC_DIR: source directory
+SRC_DIR=$PWD/../src/server
+# BUILD_DIR: build directory
+BUILD_DIR=$PWD/../build
+
+usage() {
+	echo "Usage: ./build-server.sh [mode]"
+	echo
+	echo "Mode:"
+	echo "  make 		Build the position-web-server and the load test"
+	echo "  test 		Run the load test (many simulated browser clients)"
+	echo "  clean 	Remove the build directory"
+	echo "  -h or --help 	Print help (this message)"
+	echo
+	exit 1
+}
+
+if [ $# -ne 1 ]; then
+	usage
+else
+	if [ $1 = -h ]; then
+		usage
+	elif [ $1 = --help ]; then
+		usage
+	elif [ $1 = make ]; then
+		mkdir -p $BUILD_DIR
+		cd $BUILD_DIR
+		cmake -DWITH_TESTS=ON $SRC_DIR && make
+	elif [ $1 = test ]; then
+		if [ ! -x "$BUILD_DIR/test/position-web-loadtest" ]; then
+			echo "Run make first"
+			exit 1
+		fi
+		$BUILD_DIR/test/position-web-loadtest
+	elif [ $1 = clean ]; then
+		rm -rvf $BUILD_DIR
+	else
+		usage
+	fi
+fi
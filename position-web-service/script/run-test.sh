@@ -21,6 +21,7 @@
 killall enhanced-position-client > /dev/null  2>&1
 killall enhanced-position-service > /dev/null  2>&1 
 killall log-replayer > /dev/null  2>&1  
+killall position-web-server > /dev/null  2>&1
 
 cd ../..
 
@@ -34,5 +35,11 @@ build/enhanced-position-service/dbus/src/enhanced-position-service > /dev/null 2
 
 sleep 2
 
-cd position-web-service/html
-firefox ./pos.html
+echo 'Starting PositionWebServer...'
+position-web-service/build/position-web-server -p 8080 -d position-web-service/html &
+
+sleep 1
+
+firefox http://localhost:8080/pos.html
+
+killall position-web-server > /dev/null  2>&1
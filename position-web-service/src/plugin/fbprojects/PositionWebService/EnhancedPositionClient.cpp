@@ -18,11 +18,12 @@
 
 #include <signal.h>
 #include <stdio.h>
+#include <string.h>
 #include "EnhancedPositionClient.h"
 #include "PositionWebServiceAPI.h"
 #include "positioning-constants.h"
 #include "SharedData.h"
-#include "Log.h"
+#include "log.h"
 
 using namespace std;
 
@@ -33,62 +34,127 @@ DLT_IMPORT_CONTEXT(gCtx);
 EnhancedPositionClient::EnhancedPositionClient(DBus::Connection &connection, const char *path, const char *name, PositionWebServiceAPI& positionWebServiceAPI)
 : DBus::ObjectProxy(connection, path, name)
 , mPositionWebServiceAPI(positionWebServiceAPI)
+, mIsSubscribed(false)
 {
   mEnhancedPositionClient = this;
+  memset(&mPosition, 0, sizeof(mPosition));
+
+  //only the values the web service provides, the service filters the other updates
+  try
+  {
+    Subscribe(GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE |
+              GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE |
+              GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE |
+              GENIVI_ENHANCEDPOSITIONSERVICE_HEADING |
+              GENIVI_ENHANCEDPOSITIONSERVICE_SPEED |
+              GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_HPOSITION,
+              0, 0, 0);
+    //the proxy matches all signals of the interface, the filtered updates are sent to this client directly
+    conn().remove_match("type='signal',interface='org.genivi.positioning.EnhancedPosition',path='/org/genivi/positioning/EnhancedPosition'", false);
+    mIsSubscribed = true;
+  }
+  catch (DBus::Error& e)
+  {
+    LOG_WARNING_MSG(gCtx,"Subscribe failed - using PositionUpdateData");
+  }
 }
 
 void EnhancedPositionClient::PositionUpdate(const uint64_t& changedValues)
+{
+  //the values are delivered by PositionUpdateData, no need to call GetPositionInfo
+}
+
+void EnhancedPositionClient::PositionUpdateData(const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data)
+{
+  if (!mIsSubscribed)
+  {
+    updatePosition(changedValues, timestamp, data);
+  }
+}
+
+void EnhancedPositionClient::FilteredPositionUpdate(const uint32_t& subscriptionId, const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data)
+{
+  updatePosition(changedValues, timestamp, data);
+}
+
+void EnhancedPositionClient::updatePosition(const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data)
 {
   LOG_INFO_MSG(gCtx,"Position Update");
   
-  std::map< uint64_t, ::DBus::Variant > posData;
-  uint64_t timestamp;
-  
-  GetPositionInfo(changedValues, timestamp, posData);
+  std::map< uint64_t, ::DBus::Variant > posData = data;
 
   FB::VariantList changedValuesList;
 
-  SharedData& PositioningData = SharedData::getInstance();
-  
+  //the update only contains the changed values, the others are kept from the previous updates
   if (changedValues & GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE)
   {
     changedValuesList.push_back("LATITUDE");
-    double latitude = posData[(uint64_t)GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE].reader().get_double();
-    PositioningData.setLatitude(latitude);
-    LOG_INFO(gCtx,"LAT=%lf", latitude);
+    mPosition.latitude = posData[(uint64_t)GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE].reader().get_double();
+    LOG_INFO(gCtx,"LAT=%lf", mPosition.latitude);
   }
 
   if (changedValues & GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE)
   {
     changedValuesList.push_back("LONGITUDE");
-    double longitude = posData[(uint64_t)GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE].reader().get_double();
-    PositioningData.setLongitude(longitude);
-    LOG_INFO(gCtx,"LON=%lf", longitude);
+    mPosition.longitude = posData[(uint64_t)GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE].reader().get_double();
+    LOG_INFO(gCtx,"LON=%lf", mPosition.longitude);
   }
 
   if (changedValues & GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE)
   {
     changedValuesList.push_back("ALTITUDE");
-    double altitude = posData[(uint64_t)GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE].reader().get_double();
-    PositioningData.setAltitude(altitude);
-    LOG_INFO(gCtx,"ALT=%lf", altitude);  
+    mPosition.altitude = posData[(uint64_t)GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE].reader().get_double();
+    LOG_INFO(gCtx,"ALT=%lf", mPosition.altitude);
+  }
+
+  if (changedValues & GENIVI_ENHANCEDPOSITIONSERVICE_HEADING)
+  {
+    changedValuesList.push_back("HEADING");
+    mPosition.heading = posData[(uint64_t)GENIVI_ENHANCEDPOSITIONSERVICE_HEADING].reader().get_double();
+    LOG_INFO(gCtx,"HEADING=%lf", mPosition.heading);
   }
 
   if (changedValues & GENIVI_ENHANCEDPOSITIONSERVICE_SPEED)
   {
     changedValuesList.push_back("SPEED");
-    double speed = posData[(uint64_t)GENIVI_ENHANCEDPOSITIONSERVICE_SPEED].reader().get_double();
-    PositioningData.setSpeed(speed);
-    LOG_INFO(gCtx,"SPEED=%lf", speed);
+    mPosition.speed = posData[(uint64_t)GENIVI_ENHANCEDPOSITIONSERVICE_SPEED].reader().get_double();
+    LOG_INFO(gCtx,"SPEED=%lf", mPosition.speed);
   }
+
+  if (changedValues & GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_HPOSITION)
+  {
+    changedValuesList.push_back("ACCURACY");
+    mPosition.sigmaHPosition = posData[(uint64_t)GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_HPOSITION].reader().get_double();
+    LOG_INFO(gCtx,"ACCURACY=%lf", mPosition.sigmaHPosition);
+  }
+
+  mPosition.timestamp = timestamp;
+  mPosition.validValues |= changedValues & (GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE |
+                                            GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE |
+                                            GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE |
+                                            GENIVI_ENHANCEDPOSITIONSERVICE_HEADING |
+                                            GENIVI_ENHANCEDPOSITIONSERVICE_SPEED |
+                                            GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_HPOSITION);
+
+  //all the values of the update are published at once
+  SharedData::getInstance().setPosition(mPosition);
   
   LOG_INFO_MSG(gCtx,"fire_PositionUpdate");
 
   mPositionWebServiceAPI.fire_PositionUpdate(changedValuesList);
 }
 
+void EnhancedPositionClient::PredictedPositionUpdate(const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data)
+{
+  //the web service forwards the measured positions only
+}
 
+void EnhancedPositionClient::SatelliteUpdate(const uint64_t& timestamp, const std::vector< ::DBus::Struct< uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, bool > >& satelliteInfo)
+{
+  //the web service does not provide the satellite constellation
+}
 
-
-
-
+void EnhancedPositionClient::TimeUpdate(const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& time)
+{
+  //the web service does not provide the time
+}
@@ -20,6 +20,7 @@
 
 #include <dbus-c++/dbus.h>
 #include "enhanced-position-proxy.h"
+#include "SharedData.h"
 
 class PositionWebServiceAPI;
 
@@ -34,8 +35,24 @@ public:
 
   void PositionUpdate(const uint64_t& changedValues);
 
+  void PositionUpdateData(const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data);
+
+  void PredictedPositionUpdate(const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data);
+
+  void SatelliteUpdate(const uint64_t& timestamp, const std::vector< ::DBus::Struct< uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, bool > >& satelliteInfo);
+
+  void TimeUpdate(const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& time);
+
+  void FilteredPositionUpdate(const uint32_t& subscriptionId, const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data);
+
 private:
+  void updatePosition(const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data);
+
   PositionWebServiceAPI& mPositionWebServiceAPI;
+  //true if the position is received with FilteredPositionUpdate instead of PositionUpdateData
+  bool mIsSubscribed;
+  //position of the dispatcher thread, copied to SharedData after each update
+  TPositionRecord mPosition;
 
   static EnhancedPositionClient* mEnhancedPositionClient;
 };
@@ -10,7 +10,7 @@
 #include "PositionWebServiceAPI.h"
 
 #include "PositionWebService.h"
-#include "Log.h"
+#include "log.h"
 
 DLT_DECLARE_CONTEXT(gCtx);
 
@@ -23,7 +23,7 @@
 
 #include "PositionWebServiceAPI.h"
 #include "SharedData.h"
-#include "Log.h"
+#include "log.h"
 
 DLT_IMPORT_CONTEXT(gCtx);
 
@@ -48,21 +48,19 @@ PositionWebServicePtr PositionWebServiceAPI::getPlugin()
 FB::VariantMap PositionWebServiceAPI::GetPosition()
 {
   LOG_INFO_MSG(gCtx,"GetPosition");
-  double val = 0;
 
-  SharedData& PositioningData = SharedData::getInstance();
-  
-  PositioningData.getLatitude(val);
-  m_position["LATITUDE"] = val;
+  //one consistent snapshot, the D-Bus dispatcher thread is never blocked by the reader
+  TPositionRecord position;
+  uint32_t version = SharedData::getInstance().getPosition(position);
 
-  PositioningData.getLongitude(val);
-  m_position["LONGITUDE"] = val;
-
-  PositioningData.getAltitude(val);
-  m_position["ALTITUDE"] = val;
-
-  PositioningData.getSpeed(val);
-  m_position["SPEED"] = val;
+  m_position["LATITUDE"] = position.latitude;
+  m_position["LONGITUDE"] = position.longitude;
+  m_position["ALTITUDE"] = position.altitude;
+  m_position["HEADING"] = position.heading;
+  m_position["SPEED"] = position.speed;
+  m_position["ACCURACY"] = position.sigmaHPosition;
+  m_position["TIMESTAMP"] = (double)position.timestamp;
+  m_position["VERSION"] = version;
 
   return m_position;
 }
@@ -16,75 +16,42 @@
 * @licence end@
 **************************************************************************/
 
-#include <stdio.h>
+#include <sched.h>
+#include <string.h>
 #include "SharedData.h"
 
 SharedData::SharedData()
-: mLatitude(0)
-, mLongitude(0)
-, mAltitude(0)
-, mSpeed(0)
+: mSequence(0)
 {
+  memset(&mPosition, 0, sizeof(mPosition));
 }
 
-void SharedData::setLatitude(double val)
+void SharedData::setPosition(const TPositionRecord& position)
 {
-   pthread_mutex_lock(&mMutex);
-   mLatitude = val;
-   pthread_mutex_unlock(&mMutex);
-}
-
-void SharedData::getLatitude(double& val)
-{
-   pthread_mutex_lock(&mMutex);
-   val = mLatitude;
-   pthread_mutex_unlock(&mMutex);
-}
-
-void SharedData::setLongitude(double val)
-{
-   pthread_mutex_lock(&mMutex);
-   mLongitude = val;
-   pthread_mutex_unlock(&mMutex);
-}
-
-void SharedData::getLongitude(double& val)
-{
-   pthread_mutex_lock(&mMutex);
-   val = mLongitude;
-   pthread_mutex_unlock(&mMutex);
-}
-
-void SharedData::setAltitude(double val)
-{
-   pthread_mutex_lock(&mMutex);
-   mAltitude = val;
-   pthread_mutex_unlock(&mMutex);
-}
+  uint32_t sequence = mSequence;
+  __atomic_store_n(&mSequence, sequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
 
-void SharedData::getAltitude(double& val)
-{
-   pthread_mutex_lock(&mMutex);
-   val = mAltitude;
-   pthread_mutex_unlock(&mMutex);
-}
+  mPosition = position;
 
-void SharedData::setSpeed(double val)
-{
-   pthread_mutex_lock(&mMutex);
-   mSpeed = val;
-   pthread_mutex_unlock(&mMutex);
+  __atomic_store_n(&mSequence, sequence + 2, __ATOMIC_RELEASE);
 }
 
-void SharedData::getSpeed(double& val)
+uint32_t SharedData::getPosition(TPositionRecord& position)
 {
-   pthread_mutex_lock(&mMutex);
-   val = mSpeed;
-   pthread_mutex_unlock(&mMutex);
+  for (;;)
+  {
+    uint32_t sequence = __atomic_load_n(&mSequence, __ATOMIC_ACQUIRE);
+    if ((sequence & 1) == 0)
+    {
+      //the copy may be torn, it is only used if the sequence has not changed
+      position = mPosition;
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&mSequence, __ATOMIC_RELAXED) == sequence)
+      {
+        return sequence / 2;
+      }
+    }
+    sched_yield();
+  }
 }
-
-
-
-
-
-
@@ -18,8 +18,29 @@
 #ifndef __SHARED_DATA_H
 #define __SHARED_DATA_H
 
-#include <pthread.h>
+#include <stdint.h>
 
+/**
+ * Latest position, published as a whole by the D-Bus dispatcher thread
+ */
+typedef struct
+{
+  uint64_t timestamp;     //timestamp of the position [ms]
+  uint64_t validValues;   //bitwise OR of the GENIVI_ENHANCEDPOSITIONSERVICE_* keys of the valid values
+  double latitude;        //[degree]
+  double longitude;       //[degree]
+  double altitude;        //[m]
+  double heading;         //[degree]
+  double speed;           //[m/s]
+  double sigmaHPosition;  //accuracy of the horizontal position [m]
+} TPositionRecord;
+
+/**
+ * The position record is protected by a sequence lock:
+ * the writer never waits for the readers, a reader copies the record
+ * and retries if the writer has been active meanwhile.
+ * So a reader always gets all the values of the same update.
+ */
 class SharedData
 {
 
@@ -30,32 +51,29 @@ public:
      static SharedData mInstance;
      return mInstance;
   }
-  
-  void setLatitude(double val);
-  void getLatitude(double& val);
 
-  void setLongitude(double val);
-  void getLongitude(double& val);
+  /**
+   * Publish a new position.
+   * Must not be called concurrently from different threads.
+   */
+  void setPosition(const TPositionRecord& position);
 
-  void setAltitude(double val);
-  void getAltitude(double& val);
-
-  void setSpeed(double val);
-  void getSpeed(double& val);
+  /**
+   * @param position the latest position
+   * @return version of the position, incremented by each setPosition(), 0 if there is no position yet
+   */
+  uint32_t getPosition(TPositionRecord& position);
 
 private:
 
   SharedData();
   ~SharedData(){};
-  SharedData(SharedData const&){};
-  SharedData& operator=(SharedData const&){};
-
-  double mLatitude;
-  double mLongitude;
-  double mAltitude;
-  double mSpeed;
+  SharedData(SharedData const&);
+  SharedData& operator=(SharedData const&);
 
-  pthread_mutex_t mMutex;
+  //odd while the writer updates the record
+  uint32_t mSequence;
+  TPositionRecord mPosition;
 
 };
 
@@ -0,0 +1,141 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup PositionWebService
+* \brief D-Bus client of the EnhancedPositionService feeding the WebSocketServer
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include "EnhancedPositionClient.h"
+#include "WebSocketServer.h"
+#include "positioning-constants.h"
+#include "log.h"
+
+DLT_IMPORT_CONTEXT(gCtx);
+
+static const struct
+{
+  uint64_t key;
+  uint32_t value;
+  double PositionFrame::*field;
+} gValues[] =
+{
+  { GENIVI_ENHANCEDPOSITIONSERVICE_LATITUDE,        PositionFrame::LATITUDE,  &PositionFrame::latitude },
+  { GENIVI_ENHANCEDPOSITIONSERVICE_LONGITUDE,       PositionFrame::LONGITUDE, &PositionFrame::longitude },
+  { GENIVI_ENHANCEDPOSITIONSERVICE_ALTITUDE,        PositionFrame::ALTITUDE,  &PositionFrame::altitude },
+  { GENIVI_ENHANCEDPOSITIONSERVICE_HEADING,         PositionFrame::HEADING,   &PositionFrame::heading },
+  { GENIVI_ENHANCEDPOSITIONSERVICE_SPEED,           PositionFrame::SPEED,     &PositionFrame::speed },
+  { GENIVI_ENHANCEDPOSITIONSERVICE_SIGMA_HPOSITION, PositionFrame::ACCURACY,  &PositionFrame::accuracy }
+};
+
+EnhancedPositionClient::EnhancedPositionClient(DBus::Connection &connection, const char *path, const char *name, WebSocketServer& server)
+: DBus::ObjectProxy(connection, path, name)
+, mServer(server)
+, mIsSubscribed(false)
+, mSubscriptionId(0)
+{
+  uint64_t valuesToReturn = 0;
+  for (size_t i = 0; i < sizeof(gValues)/sizeof(gValues[0]); i++)
+  {
+    valuesToReturn |= gValues[i].key;
+  }
+
+  //one subscription for all the browser clients, their rates are applied by the WebSocketServer
+  try
+  {
+    mSubscriptionId = Subscribe(valuesToReturn, 0, 0, 0);
+    //the proxy matches all signals of the interface, the filtered updates are sent to this client directly
+    conn().remove_match("type='signal',interface='org.genivi.positioning.EnhancedPosition',path='/org/genivi/positioning/EnhancedPosition'", false);
+    mIsSubscribed = true;
+  }
+  catch (DBus::Error& e)
+  {
+    LOG_WARNING_MSG(gCtx,"Subscribe failed - using PositionUpdateData");
+  }
+}
+
+EnhancedPositionClient::~EnhancedPositionClient()
+{
+  if (mIsSubscribed)
+  {
+    try
+    {
+      Unsubscribe(mSubscriptionId);
+    }
+    catch (DBus::Error& e)
+    {
+      //the subscription ends with the connection anyway
+    }
+  }
+}
+
+void EnhancedPositionClient::PositionUpdate(const uint64_t& changedValues)
+{
+  //the values are delivered by PositionUpdateData, no need to call GetPositionInfo
+}
+
+void EnhancedPositionClient::PositionUpdateData(const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data)
+{
+  if (!mIsSubscribed)
+  {
+    updatePosition(changedValues, timestamp, data);
+  }
+}
+
+void EnhancedPositionClient::FilteredPositionUpdate(const uint32_t& subscriptionId, const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data)
+{
+  updatePosition(changedValues, timestamp, data);
+}
+
+void EnhancedPositionClient::updatePosition(const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data)
+{
+  bool isChanged = false;
+
+  for (size_t i = 0; i < sizeof(gValues)/sizeof(gValues[0]); i++)
+  {
+    if (!(changedValues & gValues[i].key))
+    {
+      continue;
+    }
+    std::map< uint64_t, ::DBus::Variant >::const_iterator it = data.find(gValues[i].key);
+    if (it != data.end())
+    {
+      mPosition.*gValues[i].field = it->second.reader().get_double();
+      mPosition.validValues |= gValues[i].value;
+      isChanged = true;
+    }
+  }
+
+  if (isChanged)
+  {
+    mPosition.timestamp = timestamp;
+    mServer.publish(mPosition);
+  }
+}
+
+void EnhancedPositionClient::PredictedPositionUpdate(const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data)
+{
+  //the web service forwards the measured positions only
+}
+
+void EnhancedPositionClient::SatelliteUpdate(const uint64_t& timestamp, const std::vector< ::DBus::Struct< uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, bool > >& satelliteInfo)
+{
+  //the web service does not provide the satellite constellation
+}
+
+void EnhancedPositionClient::TimeUpdate(const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& time)
+{
+  //the web service does not provide the time
+}
@@ -0,0 +1,66 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup PositionWebService
+* \brief D-Bus client of the EnhancedPositionService feeding the WebSocketServer
+*
+* \details The server has a single subscription for all its browser clients:
+*          the positions are received with FilteredPositionUpdate,
+*          or with PositionUpdateData from a service without Subscribe.
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+#ifndef __ENHANCED_POSITION_CLIENT_H
+#define __ENHANCED_POSITION_CLIENT_H
+
+#include <dbus-c++/dbus.h>
+#include "enhanced-position-proxy.h"
+#include "PositionFrame.h"
+
+class WebSocketServer;
+
+class EnhancedPositionClient
+  : public org::genivi::positioning::EnhancedPosition_proxy,
+  public DBus::IntrospectableProxy,
+  public DBus::ObjectProxy
+{
+public:
+
+  EnhancedPositionClient(DBus::Connection &connection, const char *path, const char *name, WebSocketServer& server);
+  ~EnhancedPositionClient();
+
+  void PositionUpdate(const uint64_t& changedValues);
+
+  void PositionUpdateData(const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data);
+
+  void PredictedPositionUpdate(const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data);
+
+  void SatelliteUpdate(const uint64_t& timestamp, const std::vector< ::DBus::Struct< uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, bool > >& satelliteInfo);
+
+  void TimeUpdate(const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& time);
+
+  void FilteredPositionUpdate(const uint32_t& subscriptionId, const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data);
+
+private:
+  void updatePosition(const uint64_t& changedValues, const uint64_t& timestamp, const std::map< uint64_t, ::DBus::Variant >& data);
+
+  WebSocketServer& mServer;
+  //true if the position is received with FilteredPositionUpdate instead of PositionUpdateData
+  bool mIsSubscribed;
+  uint32_t mSubscriptionId;
+  //the updates only contain the changed values
+  PositionFrame mPosition;
+};
+
+#endif//__ENHANCED_POSITION_CLIENT_H
@@ -0,0 +1,81 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup PositionWebService
+* \brief Compact position frame streamed to the browser clients
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <stdio.h>
+#include <cmath>
+#include "PositionFrame.h"
+
+static void appendValue(std::string& json, const char* key, const char* format, double value)
+{
+  //NaN and infinity are not valid JSON numbers
+  if (!std::isfinite(value))
+  {
+    return;
+  }
+
+  char buffer[64];
+  int len = snprintf(buffer, sizeof(buffer), format, value);
+  if ((len > 0) && (len < (int)sizeof(buffer)))
+  {
+    json += ",\"";
+    json += key;
+    json += "\":";
+    json.append(buffer, len);
+  }
+}
+
+std::string PositionFrame::toJson() const
+{
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "{\"t\":%llu", (unsigned long long)timestamp);
+
+  std::string json;
+  json.reserve(128);
+  json = buffer;
+
+  //7 decimals of a degree are ~1cm, the other values are not more accurate than 0.1
+  if (validValues & LATITUDE)
+  {
+    appendValue(json, "lat", "%.7f", latitude);
+  }
+  if (validValues & LONGITUDE)
+  {
+    appendValue(json, "lon", "%.7f", longitude);
+  }
+  if (validValues & ALTITUDE)
+  {
+    appendValue(json, "alt", "%.1f", altitude);
+  }
+  if (validValues & HEADING)
+  {
+    appendValue(json, "hdg", "%.1f", heading);
+  }
+  if (validValues & SPEED)
+  {
+    appendValue(json, "spd", "%.1f", speed);
+  }
+  if (validValues & ACCURACY)
+  {
+    appendValue(json, "acc", "%.1f", accuracy);
+  }
+  json += "}";
+
+  return json;
+}
@@ -0,0 +1,69 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup PositionWebService
+* \brief Compact position frame streamed to the browser clients
+*
+* \details The frame is a JSON object with short keys, only the valid
+*          values are contained, e.g.
+*          {"t":1234,"lat":46.2044000,"lon":6.1432000,"alt":375.0,"hdg":90.0,"spd":13.9,"acc":5.0}
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+#ifndef __POSITION_FRAME_H
+#define __POSITION_FRAME_H
+
+#include <stdint.h>
+#include <string>
+
+struct PositionFrame
+{
+  enum
+  {
+    LATITUDE  = 0x01,
+    LONGITUDE = 0x02,
+    ALTITUDE  = 0x04,
+    HEADING   = 0x08,
+    SPEED     = 0x10,
+    ACCURACY  = 0x20
+  };
+
+  uint64_t timestamp;     //timestamp of the position [ms]
+  uint32_t validValues;   //bitwise OR of the values above
+  double latitude;        //[degree]
+  double longitude;       //[degree]
+  double altitude;        //[m]
+  double heading;         //[degree]
+  double speed;           //[m/s]
+  double accuracy;        //standard deviation of the horizontal position [m]
+
+  PositionFrame()
+  : timestamp(0)
+  , validValues(0)
+  , latitude(0)
+  , longitude(0)
+  , altitude(0)
+  , heading(0)
+  , speed(0)
+  , accuracy(0)
+  {
+  }
+
+  /**
+   * @return the JSON text of the frame
+   */
+  std::string toJson() const;
+};
+
+#endif//__POSITION_FRAME_H
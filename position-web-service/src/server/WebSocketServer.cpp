@@ -0,0 +1,1053 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup PositionWebService
+* \brief Embedded HTTP/WebSocket server streaming the position to the browser clients
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "WebSocketServer.h"
+
+//maximum number of connected clients
+#define MAX_CLIENTS 4096
+//maximum size of the HTTP request header [bytes]
+#define MAX_REQUEST_SIZE 8192
+//maximum size of a message of a client [bytes]
+#define MAX_MESSAGE_SIZE 1024
+//a client is disconnected when its socket does not drain within this time [ms]
+#define STALL_TIMEOUT 60000
+//interval of the check of the stalled clients [ms]
+#define STALL_CHECK_INTERVAL 1000
+//kernel send buffer of a stream [bytes]: kept small, so that the positions of a slow
+//client are skipped by the server instead of being delivered late from the buffer
+#define STREAM_SNDBUF 8192
+//number of epoll events handled per wakeup
+#define MAX_EVENTS 256
+
+#define WS_OPCODE_TEXT   0x1
+#define WS_OPCODE_CLOSE  0x8
+#define WS_OPCODE_PING   0x9
+#define WS_OPCODE_PONG   0xA
+
+#define WS_CLOSE_PROTOCOL_ERROR 1002
+#define WS_CLOSE_UNSUPPORTED    1003
+#define WS_CLOSE_TOO_BIG        1009
+
+struct WebSocketServer::Client
+{
+  enum State
+  {
+    HTTP,      //waiting for the request
+    STREAM,    //position stream
+    CLOSING    //closed as soon as the output is sent
+  };
+
+  int fd;
+  State state;
+  bool isStream;
+  bool isEpollOut;
+  std::string input;
+  std::string output;
+  //bytes of output already sent
+  size_t outputOffset;
+  //time the output became pending [ms], 0 when the output is empty
+  uint64_t stallSince;
+  //minimum interval between two frames [ms]
+  uint64_t interval;
+  //time of the last frame [ms]
+  uint64_t lastSent;
+  //sequence number of the last frame
+  uint64_t sentSequence;
+
+  Client(int fd)
+  : fd(fd)
+  , state(HTTP)
+  , isStream(false)
+  , isEpollOut(false)
+  , outputOffset(0)
+  , stallSince(0)
+  , interval(0)
+  , lastSent(0)
+  , sentSequence(0)
+  {
+  }
+
+  size_t queued() const
+  {
+    return output.size() - outputOffset;
+  }
+};
+
+static uint64_t getMonotonicTime()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000 + ts.tv_nsec/1000000;
+}
+
+static uint32_t rotl(uint32_t value, int bits)
+{
+  return (value << bits) | (value >> (32 - bits));
+}
+
+//SHA-1 (RFC 3174), only used for the WebSocket handshake
+static void sha1(const std::string& message, uint8_t digest[20])
+{
+  uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+
+  std::string data = message;
+  uint64_t bits = (uint64_t)message.size() * 8;
+  data += (char)0x80;
+  while ((data.size() % 64) != 56)
+  {
+    data += (char)0x00;
+  }
+  for (int i = 7; i >= 0; i--)
+  {
+    data += (char)((bits >> (i * 8)) & 0xFF);
+  }
+
+  for (size_t block = 0; block < data.size(); block += 64)
+  {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++)
+    {
+      const uint8_t* p = (const uint8_t*)data.data() + block + i * 4;
+      w[i] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    }
+    for (int i = 16; i < 80; i++)
+    {
+      w[i] = rotl(w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16], 1);
+    }
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++)
+    {
+      uint32_t f, k;
+      if (i < 20)
+      {
+        f = (b & c) | (~b & d);
+        k = 0x5A827999;
+      }
+      else if (i < 40)
+      {
+        f = b ^ c ^ d;
+        k = 0x6ED9EBA1;
+      }
+      else if (i < 60)
+      {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8F1BBCDC;
+      }
+      else
+      {
+        f = b ^ c ^ d;
+        k = 0xCA62C1D6;
+      }
+      uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = rotl(b, 30);
+      b = a;
+      a = temp;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+  }
+
+  for (int i = 0; i < 20; i++)
+  {
+    digest[i] = (uint8_t)(h[i/4] >> ((3 - (i % 4)) * 8));
+  }
+}
+
+static std::string base64(const uint8_t* data, size_t size)
+{
+  static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string result;
+  for (size_t i = 0; i < size; i += 3)
+  {
+    uint32_t n = (uint32_t)data[i] << 16;
+    if (i + 1 < size)
+    {
+      n |= (uint32_t)data[i+1] << 8;
+    }
+    if (i + 2 < size)
+    {
+      n |= data[i+2];
+    }
+    result += table[(n >> 18) & 0x3F];
+    result += table[(n >> 12) & 0x3F];
+    result += (i + 1 < size) ? table[(n >> 6) & 0x3F] : '=';
+    result += (i + 2 < size) ? table[n & 0x3F] : '=';
+  }
+  return result;
+}
+
+//header of a frame of the server (not masked)
+static std::string frameHeader(uint8_t opcode, uint64_t size)
+{
+  std::string header;
+  header += (char)(0x80 | opcode);
+  if (size < 126)
+  {
+    header += (char)size;
+  }
+  else if (size < 65536)
+  {
+    header += (char)126;
+    header += (char)(size >> 8);
+    header += (char)(size & 0xFF);
+  }
+  else
+  {
+    header += (char)127;
+    for (int i = 7; i >= 0; i--)
+    {
+      header += (char)((size >> (i * 8)) & 0xFF);
+    }
+  }
+  return header;
+}
+
+//payload of a close frame
+static std::string closeStatus(uint16_t status)
+{
+  std::string payload;
+  payload += (char)(status >> 8);
+  payload += (char)(status & 0xFF);
+  return payload;
+}
+
+static std::string toLower(const std::string& text)
+{
+  std::string result = text;
+  for (size_t i = 0; i < result.size(); i++)
+  {
+    if ((result[i] >= 'A') && (result[i] <= 'Z'))
+    {
+      result[i] = result[i] - 'A' + 'a';
+    }
+  }
+  return result;
+}
+
+static std::string trim(const std::string& text)
+{
+  size_t begin = text.find_first_not_of(" \t");
+  if (begin == std::string::npos)
+  {
+    return std::string();
+  }
+  size_t end = text.find_last_not_of(" \t\r");
+  return text.substr(begin, end - begin + 1);
+}
+
+std::string WebSocketServer::acceptKey(const std::string& key)
+{
+  uint8_t digest[20];
+  sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11", digest);
+  return base64(digest, sizeof(digest));
+}
+
+WebSocketServer::WebSocketServer(const std::string& documentRoot)
+: mDocumentRoot(documentRoot)
+, mListenFd(-1)
+, mEpollFd(-1)
+, mWakeupFd(-1)
+, mPort(0)
+, mIsRunning(false)
+, mNextFlush(0)
+, mLoopSequence(0)
+, mIsStopRequested(false)
+, mFrameSequence(0)
+{
+  pthread_mutex_init(&mMutex, NULL);
+  memset(&mLoopStatistics, 0, sizeof(mLoopStatistics));
+  memset(&mStatistics, 0, sizeof(mStatistics));
+}
+
+WebSocketServer::~WebSocketServer()
+{
+  while (!mClients.empty())
+  {
+    close(mClients.begin()->first);
+  }
+  if (mListenFd >= 0)
+  {
+    ::close(mListenFd);
+  }
+  if (mWakeupFd >= 0)
+  {
+    ::close(mWakeupFd);
+  }
+  if (mEpollFd >= 0)
+  {
+    ::close(mEpollFd);
+  }
+  pthread_mutex_destroy(&mMutex);
+}
+
+bool WebSocketServer::open(uint16_t port)
+{
+  mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+  mWakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  mListenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if ((mEpollFd < 0) || (mWakeupFd < 0) || (mListenFd < 0))
+  {
+    return false;
+  }
+
+  int on = 1;
+  setsockopt(mListenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+  if ((bind(mListenFd, (struct sockaddr*)&address, sizeof(address)) < 0) ||
+      (listen(mListenFd, SOMAXCONN) < 0))
+  {
+    return false;
+  }
+
+  socklen_t length = sizeof(address);
+  getsockname(mListenFd, (struct sockaddr*)&address, &length);
+  mPort = ntohs(address.sin_port);
+
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = mListenFd;
+  epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mListenFd, &event);
+  event.data.fd = mWakeupFd;
+  epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mWakeupFd, &event);
+
+  return true;
+}
+
+uint16_t WebSocketServer::getPort() const
+{
+  return mPort;
+}
+
+void WebSocketServer::run()
+{
+  struct epoll_event events[MAX_EVENTS];
+  uint64_t nextStallCheck = getMonotonicTime() + STALL_CHECK_INTERVAL;
+
+  mIsRunning = true;
+  while (mIsRunning)
+  {
+    uint64_t now = getMonotonicTime();
+    uint64_t deadline = nextStallCheck;
+    if (mNextFlush && (mNextFlush < deadline))
+    {
+      deadline = mNextFlush;
+    }
+    int timeout = (deadline > now) ? (int)(deadline - now) : 0;
+
+    int count = epoll_wait(mEpollFd, events, MAX_EVENTS, timeout);
+    if ((count < 0) && (errno != EINTR))
+    {
+      break;
+    }
+
+    bool isFrameAvailable = false;
+    for (int i = 0; i < count; i++)
+    {
+      int fd = events[i].data.fd;
+      if (fd == mListenFd)
+      {
+        accept();
+      }
+      else if (fd == mWakeupFd)
+      {
+        uint64_t value;
+        while (read(mWakeupFd, &value, sizeof(value)) > 0)
+        {
+        }
+        pthread_mutex_lock(&mMutex);
+        if (mFrameSequence != mLoopSequence)
+        {
+          mLoopFrame = mFrame;
+          mLoopSequence = mFrameSequence;
+          isFrameAvailable = true;
+        }
+        if (mIsStopRequested)
+        {
+          mIsRunning = false;
+        }
+        pthread_mutex_unlock(&mMutex);
+      }
+      else
+      {
+        std::map<int, std::unique_ptr<Client> >::iterator it = mClients.find(fd);
+        if (it == mClients.end())
+        {
+          continue;
+        }
+        Client& client = *it->second;
+        if (events[i].events & EPOLLOUT)
+        {
+          onOutput(client);
+        }
+        if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+        {
+          onInput(client);
+        }
+        if ((client.state == Client::CLOSING) && (client.queued() == 0))
+        {
+          close(fd);
+        }
+      }
+    }
+
+    now = getMonotonicTime();
+    if (isFrameAvailable || (mNextFlush && (now >= mNextFlush)) || (now >= nextStallCheck))
+    {
+      flushStreams(now);
+      if (now >= nextStallCheck)
+      {
+        nextStallCheck = now + STALL_CHECK_INTERVAL;
+      }
+    }
+
+    pthread_mutex_lock(&mMutex);
+    uint64_t framesPublished = mStatistics.framesPublished;
+    mStatistics = mLoopStatistics;
+    mStatistics.framesPublished = framesPublished;
+    pthread_mutex_unlock(&mMutex);
+  }
+}
+
+void WebSocketServer::stop()
+{
+  pthread_mutex_lock(&mMutex);
+  mIsStopRequested = true;
+  pthread_mutex_unlock(&mMutex);
+
+  uint64_t value = 1;
+  if (write(mWakeupFd, &value, sizeof(value)) < 0)
+  {
+    //the loop is woken up already
+  }
+}
+
+void WebSocketServer::publish(const PositionFrame& frame)
+{
+  //encoded once for all the streams, a frame of the server is not masked
+  std::string json = frame.toJson();
+  std::shared_ptr<std::string> message = std::make_shared<std::string>(frameHeader(WS_OPCODE_TEXT, json.size()));
+  message->append(json);
+
+  pthread_mutex_lock(&mMutex);
+  mFrame = message;
+  mFrameSequence++;
+  mStatistics.framesPublished++;
+  pthread_mutex_unlock(&mMutex);
+
+  uint64_t value = 1;
+  if (write(mWakeupFd, &value, sizeof(value)) < 0)
+  {
+    //the loop is woken up already
+  }
+}
+
+WebSocketServer::Statistics WebSocketServer::getStatistics()
+{
+  pthread_mutex_lock(&mMutex);
+  Statistics statistics = mStatistics;
+  pthread_mutex_unlock(&mMutex);
+  return statistics;
+}
+
+void WebSocketServer::accept()
+{
+  for (;;)
+  {
+    int fd = accept4(mListenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0)
+    {
+      return;
+    }
+    if (mClients.size() >= MAX_CLIENTS)
+    {
+      ::close(fd);
+      continue;
+    }
+
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+    {
+      ::close(fd);
+      continue;
+    }
+    mClients[fd].reset(new Client(fd));
+  }
+}
+
+void WebSocketServer::close(int fd)
+{
+  std::map<int, std::unique_ptr<Client> >::iterator it = mClients.find(fd);
+  if (it == mClients.end())
+  {
+    return;
+  }
+  if (it->second->isStream)
+  {
+    mLoopStatistics.streams--;
+  }
+  epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, NULL);
+  ::close(fd);
+  mClients.erase(it);
+}
+
+void WebSocketServer::onInput(Client& client)
+{
+  char buffer[4096];
+  bool isPeerClosed = false;
+  for (;;)
+  {
+    ssize_t size = recv(client.fd, buffer, sizeof(buffer), 0);
+    if (size == 0)
+    {
+      //closed by the peer, a pending request is still answered
+      isPeerClosed = true;
+      break;
+    }
+    if (size < 0)
+    {
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+      {
+        break;
+      }
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      client.state = Client::CLOSING;
+      client.output.clear();
+      client.outputOffset = 0;
+      return;
+    }
+    if (client.state != Client::CLOSING)
+    {
+      client.input.append(buffer, size);
+    }
+  }
+
+  if (client.state == Client::HTTP)
+  {
+    size_t end = client.input.find("\r\n\r\n");
+    if (end == std::string::npos)
+    {
+      if (client.input.size() > MAX_REQUEST_SIZE)
+      {
+        sendResponse(client, "431 Request Header Fields Too Large", "text/plain", "");
+      }
+      if (isPeerClosed)
+      {
+        client.state = Client::CLOSING;
+      }
+      return;
+    }
+    std::string request = client.input.substr(0, end);
+    client.input.erase(0, end + 4);
+    onRequest(client, request);
+  }
+
+  if (client.state == Client::STREAM)
+  {
+    parseMessages(client);
+  }
+  else
+  {
+    client.input.clear();
+  }
+
+  if (isPeerClosed)
+  {
+    client.state = Client::CLOSING;
+  }
+}
+
+void WebSocketServer::onOutput(Client& client)
+{
+  while (client.queued() > 0)
+  {
+    ssize_t size = send(client.fd, client.output.data() + client.outputOffset, client.queued(), MSG_NOSIGNAL);
+    if (size < 0)
+    {
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+      {
+        break;
+      }
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      client.state = Client::CLOSING;
+      client.output.clear();
+      client.outputOffset = 0;
+      break;
+    }
+    client.outputOffset += size;
+  }
+
+  if (client.queued() == 0)
+  {
+    client.output.clear();
+    client.outputOffset = 0;
+    client.stallSince = 0;
+
+    //the latest position that was held back by the backpressure
+    uint64_t now = getMonotonicTime();
+    if ((client.state == Client::STREAM) && (client.sentSequence != mLoopSequence))
+    {
+      if (now >= client.lastSent + client.interval)
+      {
+        sendFrame(client, now);
+      }
+      else if (!mNextFlush || (client.lastSent + client.interval < mNextFlush))
+      {
+        mNextFlush = client.lastSent + client.interval;
+      }
+    }
+  }
+  updateOutput(client);
+}
+
+void WebSocketServer::onRequest(Client& client, const std::string& request)
+{
+  std::istringstream lines(request);
+  std::string line;
+  std::getline(lines, line);
+
+  std::istringstream requestLine(trim(line));
+  std::string method, target, version;
+  requestLine >> method >> target >> version;
+
+  std::map<std::string, std::string> headers;
+  while (std::getline(lines, line))
+  {
+    size_t colon = line.find(':');
+    if (colon != std::string::npos)
+    {
+      headers[toLower(trim(line.substr(0, colon)))] = trim(line.substr(colon + 1));
+    }
+  }
+
+  if (method != "GET")
+  {
+    sendResponse(client, "405 Method Not Allowed", "text/plain", "");
+    return;
+  }
+
+  std::string path = target;
+  std::string query;
+  size_t question = target.find('?');
+  if (question != std::string::npos)
+  {
+    path = target.substr(0, question);
+    query = target.substr(question + 1);
+  }
+
+  if (path != "/position")
+  {
+    sendFile(client, path);
+    return;
+  }
+
+  if ((toLower(headers["upgrade"]) != "websocket") || headers["sec-websocket-key"].empty())
+  {
+    sendResponse(client, "400 Bad Request", "text/plain", "WebSocket upgrade expected\n");
+    return;
+  }
+  if (headers["sec-websocket-version"] != "13")
+  {
+    sendResponse(client, "426 Upgrade Required", "text/plain", "");
+    return;
+  }
+
+  std::string response =
+    "HTTP/1.1 101 Switching Protocols\r\n"
+    "Upgrade: websocket\r\n"
+    "Connection: Upgrade\r\n"
+    "Sec-WebSocket-Accept: " + acceptKey(headers["sec-websocket-key"]) + "\r\n\r\n";
+  queue(client, response.data(), response.size());
+  if (client.state == Client::CLOSING)
+  {
+    return;
+  }
+
+  int size = STREAM_SNDBUF;
+  setsockopt(client.fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+  client.state = Client::STREAM;
+  client.isStream = true;
+  mLoopStatistics.streams++;
+
+  double rate = 0;
+  size_t pos = query.find("rate=");
+  if ((pos != std::string::npos) && ((pos == 0) || (query[pos-1] == '&')))
+  {
+    rate = strtod(query.c_str() + pos + 5, NULL);
+  }
+  setRate(client, rate);
+
+  //the latest position is sent right away, if there is one
+  if (mLoopSequence != 0)
+  {
+    sendFrame(client, getMonotonicTime());
+  }
+}
+
+void WebSocketServer::parseMessages(Client& client)
+{
+  size_t offset = 0;
+  while (client.state == Client::STREAM)
+  {
+    const uint8_t* data = (const uint8_t*)client.input.data() + offset;
+    size_t available = client.input.size() - offset;
+    if (available < 2)
+    {
+      break;
+    }
+
+    bool isFinal = (data[0] & 0x80) != 0;
+    uint8_t opcode = data[0] & 0x0F;
+    bool isMasked = (data[1] & 0x80) != 0;
+    uint64_t size = data[1] & 0x7F;
+    size_t headerSize = 2;
+    if (size == 126)
+    {
+      headerSize = 4;
+    }
+    else if (size == 127)
+    {
+      headerSize = 10;
+    }
+    if (available < headerSize)
+    {
+      break;
+    }
+    if (size >= 126)
+    {
+      size = 0;
+      for (size_t i = 2; i < headerSize; i++)
+      {
+        size = (size << 8) | data[i];
+      }
+    }
+
+    //the frames of a client must be masked (RFC 6455, 5.1)
+    if (!isMasked)
+    {
+      sendControl(client, WS_OPCODE_CLOSE, closeStatus(WS_CLOSE_PROTOCOL_ERROR));
+      client.state = Client::CLOSING;
+      break;
+    }
+    if (size > MAX_MESSAGE_SIZE)
+    {
+      sendControl(client, WS_OPCODE_CLOSE, closeStatus(WS_CLOSE_TOO_BIG));
+      client.state = Client::CLOSING;
+      break;
+    }
+    //the messages of this protocol are short, fragmented messages are not supported
+    if (!isFinal || (opcode == 0))
+    {
+      sendControl(client, WS_OPCODE_CLOSE, closeStatus(WS_CLOSE_UNSUPPORTED));
+      client.state = Client::CLOSING;
+      break;
+    }
+    if (available < headerSize + 4 + size)
+    {
+      break;
+    }
+
+    const uint8_t* mask = data + headerSize;
+    std::string payload((const char*)mask + 4, (size_t)size);
+    for (size_t i = 0; i < payload.size(); i++)
+    {
+      payload[i] ^= mask[i % 4];
+    }
+    offset += headerSize + 4 + size;
+
+    onMessage(client, opcode, payload);
+  }
+  client.input.erase(0, offset);
+}
+
+void WebSocketServer::onMessage(Client& client, uint8_t opcode, const std::string& payload)
+{
+  switch (opcode)
+  {
+  case WS_OPCODE_TEXT:
+    if (payload.compare(0, 5, "rate=") == 0)
+    {
+      setRate(client, strtod(payload.c_str() + 5, NULL));
+    }
+    break;
+  case WS_OPCODE_CLOSE:
+    //the status of the client is echoed (RFC 6455, 5.5.1)
+    sendControl(client, WS_OPCODE_CLOSE, payload.substr(0, 2));
+    client.state = Client::CLOSING;
+    break;
+  case WS_OPCODE_PING:
+    sendControl(client, WS_OPCODE_PONG, payload);
+    break;
+  default:
+    //binary messages and pongs are ignored
+    break;
+  }
+}
+
+void WebSocketServer::setRate(Client& client, double rate)
+{
+  if (!std::isfinite(rate) || (rate <= 0) || (rate >= 1000))
+  {
+    client.interval = 0;
+  }
+  else
+  {
+    client.interval = (uint64_t)(1000.0 / rate);
+  }
+}
+
+void WebSocketServer::sendFile(Client& client, const std::string& path)
+{
+  std::string file = (path == "/") ? "/pos.html" : path;
+  if (mDocumentRoot.empty() || (file.find("..") != std::string::npos))
+  {
+    sendResponse(client, "404 Not Found", "text/plain", "Not found\n");
+    return;
+  }
+
+  std::string fullPath = mDocumentRoot + file;
+  struct stat status;
+  std::ifstream stream;
+  if ((stat(fullPath.c_str(), &status) == 0) && S_ISREG(status.st_mode))
+  {
+    stream.open(fullPath.c_str(), std::ios::in | std::ios::binary);
+  }
+  if (!stream.is_open())
+  {
+    sendResponse(client, "404 Not Found", "text/plain", "Not found\n");
+    return;
+  }
+  std::ostringstream content;
+  content << stream.rdbuf();
+
+  const char* contentType = "application/octet-stream";
+  size_t dot = file.rfind('.');
+  std::string extension = (dot != std::string::npos) ? toLower(file.substr(dot)) : "";
+  if (extension == ".html")
+  {
+    contentType = "text/html; charset=utf-8";
+  }
+  else if (extension == ".js")
+  {
+    contentType = "application/javascript";
+  }
+  else if (extension == ".css")
+  {
+    contentType = "text/css";
+  }
+  else if (extension == ".png")
+  {
+    contentType = "image/png";
+  }
+
+  sendResponse(client, "200 OK", contentType, content.str());
+}
+
+void WebSocketServer::sendResponse(Client& client, const char* status, const char* contentType, const std::string& body)
+{
+  char header[256];
+  int size = snprintf(header, sizeof(header),
+                      "HTTP/1.1 %s\r\n"
+                      "Content-Type: %s\r\n"
+                      "Content-Length: %lu\r\n"
+                      "Cache-Control: no-cache\r\n"
+                      "Connection: close\r\n\r\n",
+                      status, contentType, (unsigned long)body.size());
+  std::string response(header, size);
+  response += body;
+  queue(client, response.data(), response.size());
+  client.state = Client::CLOSING;
+}
+
+void WebSocketServer::sendControl(Client& client, uint8_t opcode, const std::string& payload)
+{
+  //the payload of a control frame is limited to 125 bytes
+  std::string frame = frameHeader(opcode, payload.size() < 126 ? payload.size() : 125);
+  frame.append(payload, 0, 125);
+  queue(client, frame.data(), frame.size());
+}
+
+bool WebSocketServer::sendFrame(Client& client, uint64_t now)
+{
+  if (!mLoopFrame || (client.sentSequence == mLoopSequence) || (client.queued() > 0))
+  {
+    return false;
+  }
+
+  if (client.sentSequence != 0)
+  {
+    mLoopStatistics.framesSkipped += mLoopSequence - client.sentSequence - 1;
+  }
+  client.sentSequence = mLoopSequence;
+  client.lastSent = now;
+  mLoopStatistics.framesSent++;
+  queue(client, mLoopFrame->data(), mLoopFrame->size());
+  return true;
+}
+
+void WebSocketServer::queue(Client& client, const char* data, size_t size)
+{
+  if (client.state == Client::CLOSING)
+  {
+    return;
+  }
+
+  //sent directly when nothing is pending, the rest is kept until the socket is writable
+  size_t sent = 0;
+  if (client.queued() == 0)
+  {
+    while (sent < size)
+    {
+      ssize_t result = send(client.fd, data + sent, size - sent, MSG_NOSIGNAL);
+      if (result < 0)
+      {
+        if (errno == EINTR)
+        {
+          continue;
+        }
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+        {
+          client.state = Client::CLOSING;
+          client.output.clear();
+          client.outputOffset = 0;
+          return;
+        }
+        break;
+      }
+      sent += result;
+    }
+  }
+
+  if (sent < size)
+  {
+    if (client.queued() == 0)
+    {
+      client.output.clear();
+      client.outputOffset = 0;
+      client.stallSince = getMonotonicTime();
+    }
+    client.output.append(data + sent, size - sent);
+    if (client.queued() > mLoopStatistics.maxQueuedBytes)
+    {
+      mLoopStatistics.maxQueuedBytes = client.queued();
+    }
+    updateOutput(client);
+  }
+}
+
+void WebSocketServer::updateOutput(Client& client)
+{
+  bool isEpollOut = client.queued() > 0;
+  if (isEpollOut == client.isEpollOut)
+  {
+    return;
+  }
+
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = isEpollOut ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+  event.data.fd = client.fd;
+  epoll_ctl(mEpollFd, EPOLL_CTL_MOD, client.fd, &event);
+  client.isEpollOut = isEpollOut;
+}
+
+void WebSocketServer::flushStreams(uint64_t now)
+{
+  std::vector<int> closing;
+
+  mNextFlush = 0;
+  for (std::map<int, std::unique_ptr<Client> >::iterator it = mClients.begin(); it != mClients.end(); ++it)
+  {
+    Client& client = *it->second;
+
+    if ((client.queued() > 0) && (now - client.stallSince > STALL_TIMEOUT))
+    {
+      mLoopStatistics.clientsDropped++;
+      closing.push_back(client.fd);
+      continue;
+    }
+
+    //a stream with pending output gets the latest position when it has drained, see onOutput()
+    if ((client.state != Client::STREAM) || (client.sentSequence == mLoopSequence) || (client.queued() > 0))
+    {
+      continue;
+    }
+
+    uint64_t due = client.lastSent + client.interval;
+    if (now >= due)
+    {
+      sendFrame(client, now);
+    }
+    else if (!mNextFlush || (due < mNextFlush))
+    {
+      mNextFlush = due;
+    }
+
+    if ((client.state == Client::CLOSING) && (client.queued() == 0))
+    {
+      closing.push_back(client.fd);
+    }
+  }
+
+  for (size_t i = 0; i < closing.size(); i++)
+  {
+    close(closing[i]);
+  }
+}
@@ -0,0 +1,139 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup PositionWebService
+* \brief Embedded HTTP/WebSocket server streaming the position to the browser clients
+*
+* \details The server runs an epoll loop in the thread calling run().
+*          GET /position with a WebSocket upgrade (RFC 6455) opens a position stream,
+*          any other GET request is answered with a file of the document root.
+*          The rate of a stream is given by the query, e.g. /position?rate=2 [Hz],
+*          and can be changed by the client with a text message "rate=<Hz>".
+*          rate=0 (default) streams every position.
+*
+*          publish() may be called from any thread: the frame is encoded once
+*          and shared by all the streams.
+*          A stream only holds the latest position: while the socket of a slow
+*          client is full, the positions in between are skipped and the latest
+*          one is sent when the socket is writable again (backpressure).
+*          A client whose socket does not drain within STALL_TIMEOUT is disconnected.
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+#ifndef __WEB_SOCKET_SERVER_H
+#define __WEB_SOCKET_SERVER_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <map>
+#include <memory>
+#include <string>
+#include "PositionFrame.h"
+
+class WebSocketServer
+{
+public:
+
+  struct Statistics
+  {
+    uint32_t streams;           //open position streams
+    uint64_t framesPublished;   //calls of publish()
+    uint64_t framesSent;        //frames sent to the streams
+    uint64_t framesSkipped;     //frames not sent because of the rate of the stream or backpressure
+    uint64_t clientsDropped;    //clients disconnected because their socket did not drain
+    uint32_t maxQueuedBytes;    //maximum of the bytes queued for a single client
+  };
+
+  /**
+   * @param documentRoot directory of the files served by HTTP, empty to serve no files
+   */
+  WebSocketServer(const std::string& documentRoot);
+  ~WebSocketServer();
+
+  /**
+   * @param port TCP port, 0 for any free port
+   * @return true on success
+   */
+  bool open(uint16_t port);
+
+  /**
+   * @return the port the server listens on, valid after open()
+   */
+  uint16_t getPort() const;
+
+  /**
+   * Run the loop until stop() is called
+   */
+  void run();
+
+  /**
+   * End run(), may be called from any thread
+   */
+  void stop();
+
+  /**
+   * Stream a position to the clients, may be called from any thread
+   */
+  void publish(const PositionFrame& frame);
+
+  Statistics getStatistics();
+
+  /**
+   * @return Sec-WebSocket-Accept for the Sec-WebSocket-Key of a client
+   */
+  static std::string acceptKey(const std::string& key);
+
+private:
+
+  struct Client;
+
+  void accept();
+  void onInput(Client& client);
+  void onOutput(Client& client);
+  void onRequest(Client& client, const std::string& request);
+  void onMessage(Client& client, uint8_t opcode, const std::string& payload);
+  void parseMessages(Client& client);
+  void sendFile(Client& client, const std::string& path);
+  void sendResponse(Client& client, const char* status, const char* contentType, const std::string& body);
+  void sendControl(Client& client, uint8_t opcode, const std::string& payload);
+  void queue(Client& client, const char* data, size_t size);
+  void updateOutput(Client& client);
+  void flushStreams(uint64_t now);
+  bool sendFrame(Client& client, uint64_t now);
+  void close(int fd);
+  void setRate(Client& client, double rate);
+
+  std::string mDocumentRoot;
+  int mListenFd;
+  int mEpollFd;
+  int mWakeupFd;
+  uint16_t mPort;
+  bool mIsRunning;
+  std::map<int, std::unique_ptr<Client> > mClients;
+  //earliest time a deferred stream is due [ms], 0 if none
+  uint64_t mNextFlush;
+  //latest frame taken by the loop
+  std::shared_ptr<const std::string> mLoopFrame;
+  uint64_t mLoopSequence;
+  Statistics mLoopStatistics;
+
+  //written by publish() and stop(), taken by the loop
+  pthread_mutex_t mMutex;
+  bool mIsStopRequested;
+  std::shared_ptr<const std::string> mFrame;
+  uint64_t mFrameSequence;
+  Statistics mStatistics;
+};
+
+#endif//__WEB_SOCKET_SERVER_H
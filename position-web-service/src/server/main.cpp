@@ -0,0 +1,128 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup PositionWebService
+* \brief Standalone web service streaming the position of the EnhancedPositionService to web browsers
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <dbus-c++/dbus.h>
+#include "EnhancedPositionClient.h"
+#include "WebSocketServer.h"
+#include "log.h"
+
+#define DEFAULT_PORT 8080
+
+DLT_DECLARE_CONTEXT(gCtx);
+
+DBus::BusDispatcher dispatcher;
+
+static void *dispatchDBus(void *ptr)
+{
+  dispatcher.enter();
+  return NULL;
+}
+
+static void *waitForSignal(void *ptr)
+{
+  WebSocketServer* server = (WebSocketServer*)ptr;
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  int signal;
+  sigwait(&signals, &signal);
+  server->stop();
+  return NULL;
+}
+
+static void usage(const char* name)
+{
+  printf("Usage: %s [-p port] [-d document root]\n", name);
+  printf("  -p  TCP port of the HTTP/WebSocket server (default %d)\n", DEFAULT_PORT);
+  printf("  -d  directory of the web pages, e.g. position-web-service/html\n");
+}
+
+int main(int argc, char* argv[])
+{
+  int port = DEFAULT_PORT;
+  std::string documentRoot;
+
+  int option;
+  while ((option = getopt(argc, argv, "p:d:h")) != -1)
+  {
+    switch (option)
+    {
+    case 'p':
+      port = atoi(optarg);
+      break;
+    case 'd':
+      documentRoot = optarg;
+      break;
+    default:
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  //before any thread is started: SIGINT and SIGTERM end the server loop
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+  DLT_REGISTER_APP("PWSV","POSITION-WEB-SERVICE");
+  DLT_REGISTER_CONTEXT(gCtx,"PWSV","Global Context");
+
+  WebSocketServer server(documentRoot);
+  if (!server.open(port))
+  {
+    LOG_ERROR(gCtx,"Cannot listen on port %d", port);
+    return EXIT_FAILURE;
+  }
+
+  DBus::default_dispatcher = &dispatcher;
+  DBus::Connection conn = DBus::Connection::SessionBus();
+  EnhancedPositionClient client(conn, "/org/genivi/positioning/EnhancedPosition",
+                                "org.genivi.positioning.EnhancedPosition", server);
+
+  pthread_t dispatcherThread;
+  pthread_t signalThread;
+  pthread_create(&dispatcherThread, NULL, dispatchDBus, NULL);
+  pthread_create(&signalThread, NULL, waitForSignal, &server);
+
+  LOG_INFO(gCtx,"Listening on port %u", server.getPort());
+
+  server.run();
+
+  dispatcher.leave();
+  pthread_join(dispatcherThread, NULL);
+  //still waiting if the loop ended on an error
+  pthread_cancel(signalThread);
+  pthread_join(signalThread, NULL);
+
+  LOG_INFO_MSG(gCtx,"Stopped");
+
+  DLT_UNREGISTER_CONTEXT(gCtx);
+  DLT_UNREGISTER_APP();
+
+  return EXIT_SUCCESS;
+}
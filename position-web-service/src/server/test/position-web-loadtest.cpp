@@ -0,0 +1,643 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup PositionWebService
+* \brief Load test of the WebSocketServer with many simulated browser clients
+*
+* \details The server runs in the test process with a synthetic position source,
+*          no EnhancedPositionService is required.
+*          The clients use the rates 0 (every position), 1, 2 and 5 Hz, the rate 2
+*          is set with a message instead of the query. The slow clients stop reading
+*          after the handshake to check that the server skips positions instead of
+*          queuing them (backpressure).
+*          The timestamp of a frame is the CLOCK_MONOTONIC time of publish() [us],
+*          the latency is measured up to the reception by the client.
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "WebSocketServer.h"
+
+//time to establish all the connections [ms]
+#define CONNECT_TIMEOUT 10000
+//time to receive the last positions and the close frames [ms]
+#define DRAIN_TIMEOUT 2000
+//time to receive the last position [ms]
+#define LAST_POSITION_TIMEOUT 1200
+//receive buffer of the slow clients [bytes]
+#define SLOW_CLIENT_RCVBUF 4096
+
+static uint64_t getTimeUs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000000 + ts.tv_nsec/1000;
+}
+
+struct TestClient
+{
+  enum State
+  {
+    CONNECTING,
+    HANDSHAKE,
+    OPEN,
+    CLOSED
+  };
+
+  int fd;
+  State state;
+  bool isSlow;
+  //requested rate [Hz], 0 for every position
+  int rate;
+  bool isRateInMessage;
+  std::string input;
+  uint64_t frames;
+  uint64_t lastTimestamp;
+  uint64_t orderErrors;
+  bool isCloseReceived;
+};
+
+struct Publisher
+{
+  WebSocketServer* server;
+  int rate;
+  int duration;
+  uint64_t published;
+  uint64_t lastTimestamp;
+  uint64_t elapsedUs;
+  volatile bool isDone;
+};
+
+static std::vector<uint32_t> gLatencies;
+
+static void* publish(void* ptr)
+{
+  Publisher* publisher = (Publisher*)ptr;
+  uint64_t start = getTimeUs();
+  uint64_t count = (uint64_t)publisher->rate * publisher->duration;
+  PositionFrame frame;
+  frame.validValues = PositionFrame::LATITUDE | PositionFrame::LONGITUDE | PositionFrame::ALTITUDE |
+                      PositionFrame::HEADING | PositionFrame::SPEED | PositionFrame::ACCURACY;
+  frame.latitude = 46.2044;
+  frame.longitude = 6.1432;
+  frame.altitude = 375.0;
+  frame.heading = 90.0;
+  frame.speed = 13.9;
+  frame.accuracy = 5.0;
+
+  for (uint64_t i = 0; i < count; i++)
+  {
+    uint64_t due = start + i * 1000000 / publisher->rate;
+    uint64_t now = getTimeUs();
+    if (due > now)
+    {
+      usleep(due - now);
+    }
+    frame.longitude += 0.00002;
+    frame.timestamp = getTimeUs();
+    publisher->server->publish(frame);
+  }
+
+  publisher->published = count;
+  publisher->lastTimestamp = frame.timestamp;
+  publisher->elapsedUs = getTimeUs() - start;
+  publisher->isDone = true;
+  return NULL;
+}
+
+static void* runServer(void* ptr)
+{
+  ((WebSocketServer*)ptr)->run();
+  return NULL;
+}
+
+//a frame of a client is masked (RFC 6455, 5.3)
+static void sendMessage(TestClient& client, uint8_t opcode, const std::string& payload)
+{
+  static const uint8_t mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+  std::string frame;
+  frame += (char)(0x80 | opcode);
+  frame += (char)(0x80 | payload.size());
+  frame.append((const char*)mask, 4);
+  for (size_t i = 0; i < payload.size(); i++)
+  {
+    frame += (char)(payload[i] ^ mask[i % 4]);
+  }
+  if (send(client.fd, frame.data(), frame.size(), MSG_NOSIGNAL) != (ssize_t)frame.size())
+  {
+    client.state = TestClient::CLOSED;
+  }
+}
+
+static void sendRequest(TestClient& client, int index)
+{
+  char request[512];
+  char query[32] = "";
+  if ((client.rate > 0) && !client.isRateInMessage)
+  {
+    snprintf(query, sizeof(query), "?rate=%d", client.rate);
+  }
+  snprintf(request, sizeof(request),
+           "GET /position%s HTTP/1.1\r\n"
+           "Host: 127.0.0.1\r\n"
+           "Upgrade: websocket\r\n"
+           "Connection: Upgrade\r\n"
+           "Sec-WebSocket-Key: dGVzdGNsaWVudCUwNmQ=%d\r\n"
+           "Sec-WebSocket-Version: 13\r\n\r\n",
+           query, index);
+  size_t size = strlen(request);
+  if (send(client.fd, request, size, MSG_NOSIGNAL) != (ssize_t)size)
+  {
+    client.state = TestClient::CLOSED;
+  }
+}
+
+static bool checkHandshake(TestClient& client, int index)
+{
+  size_t end = client.input.find("\r\n\r\n");
+  if (end == std::string::npos)
+  {
+    return true;
+  }
+  char key[64];
+  snprintf(key, sizeof(key), "dGVzdGNsaWVudCUwNmQ=%d", index);
+  std::string accept = "Sec-WebSocket-Accept: " + WebSocketServer::acceptKey(key) + "\r\n";
+  if ((client.input.compare(0, 12, "HTTP/1.1 101") != 0) || (client.input.find(accept) == std::string::npos))
+  {
+    return false;
+  }
+  client.input.erase(0, end + 4);
+  client.state = TestClient::OPEN;
+  if (client.isRateInMessage)
+  {
+    char message[32];
+    snprintf(message, sizeof(message), "rate=%d", client.rate);
+    sendMessage(client, 0x1, message);
+  }
+  return true;
+}
+
+static void parseFrames(TestClient& client)
+{
+  size_t offset = 0;
+  for (;;)
+  {
+    const uint8_t* data = (const uint8_t*)client.input.data() + offset;
+    size_t available = client.input.size() - offset;
+    if (available < 2)
+    {
+      break;
+    }
+    uint8_t opcode = data[0] & 0x0F;
+    size_t size = data[1] & 0x7F;
+    size_t header = 2;
+    if (size == 126)
+    {
+      if (available < 4)
+      {
+        break;
+      }
+      size = ((size_t)data[2] << 8) | data[3];
+      header = 4;
+    }
+    if (available < header + size)
+    {
+      break;
+    }
+
+    std::string payload((const char*)data + header, size);
+    offset += header + size;
+
+    if (opcode == 0x1)
+    {
+      uint64_t timestamp = strtoull(payload.c_str() + 5, NULL, 10);
+      if ((payload.compare(0, 5, "{\"t\":") != 0) || (timestamp <= client.lastTimestamp))
+      {
+        client.orderErrors++;
+      }
+      client.lastTimestamp = timestamp;
+      client.frames++;
+      if (!client.isSlow)
+      {
+        gLatencies.push_back((uint32_t)(getTimeUs() - timestamp));
+      }
+    }
+    else if (opcode == 0x8)
+    {
+      client.isCloseReceived = true;
+    }
+  }
+  client.input.erase(0, offset);
+}
+
+//@return false on a protocol error
+static bool onEvent(TestClient& client, int index, uint32_t events, int epollFd)
+{
+  if ((client.state == TestClient::CONNECTING) && (events & EPOLLOUT))
+  {
+    int error = 0;
+    socklen_t length = sizeof(error);
+    getsockopt(client.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+    if (error != 0)
+    {
+      client.state = TestClient::CLOSED;
+      return false;
+    }
+    client.state = TestClient::HANDSHAKE;
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = index;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, client.fd, &event);
+    sendRequest(client, index);
+    return true;
+  }
+
+  if (!(events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+  {
+    return true;
+  }
+
+  char buffer[16384];
+  for (;;)
+  {
+    ssize_t size = recv(client.fd, buffer, sizeof(buffer), 0);
+    if (size <= 0)
+    {
+      if ((size < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+      {
+        break;
+      }
+      epoll_ctl(epollFd, EPOLL_CTL_DEL, client.fd, NULL);
+      client.state = TestClient::CLOSED;
+      break;
+    }
+    client.input.append(buffer, size);
+    //the slow clients only read the handshake
+    if (client.isSlow && (client.state == TestClient::OPEN))
+    {
+      break;
+    }
+  }
+
+  if (client.state == TestClient::HANDSHAKE)
+  {
+    if (!checkHandshake(client, index))
+    {
+      return false;
+    }
+    if (client.isSlow && (client.state == TestClient::OPEN))
+    {
+      epoll_ctl(epollFd, EPOLL_CTL_DEL, client.fd, NULL);
+    }
+  }
+  if (client.state != TestClient::HANDSHAKE)
+  {
+    parseFrames(client);
+  }
+  return true;
+}
+
+static void poll(std::vector<TestClient>& clients, int epollFd, int timeout, int& protocolErrors)
+{
+  struct epoll_event events[256];
+  int count = epoll_wait(epollFd, events, 256, timeout);
+  for (int i = 0; i < count; i++)
+  {
+    int index = events[i].data.u32;
+    if (!onEvent(clients[index], index, events[i].events, epollFd))
+    {
+      protocolErrors++;
+    }
+  }
+}
+
+static uint32_t percentile(const std::vector<uint32_t>& sorted, int percent)
+{
+  if (sorted.empty())
+  {
+    return 0;
+  }
+  return sorted[(sorted.size() - 1) * percent / 100];
+}
+
+static void usage(const char* name)
+{
+  printf("Usage: %s [-n clients] [-s slow clients] [-r positions/s] [-t duration s]\n", name);
+}
+
+int main(int argc, char* argv[])
+{
+  int numClients = 1000;
+  int numSlowClients = 20;
+  int rate = 100;
+  int duration = 5;
+
+  int option;
+  while ((option = getopt(argc, argv, "n:s:r:t:h")) != -1)
+  {
+    switch (option)
+    {
+    case 'n':
+      numClients = atoi(optarg);
+      break;
+    case 's':
+      numSlowClients = atoi(optarg);
+      break;
+    case 'r':
+      rate = atoi(optarg);
+      break;
+    case 't':
+      duration = atoi(optarg);
+      break;
+    default:
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if ((numClients < 1) || (numSlowClients < 0) || (rate < 1) || (duration < 1))
+  {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  signal(SIGPIPE, SIG_IGN);
+
+  bool isOk = true;
+
+  //example of RFC 6455, 1.3
+  if (WebSocketServer::acceptKey("dGhlIHNhbXBsZSBub25jZQ==") != "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=")
+  {
+    printf("FAILED: Sec-WebSocket-Accept\n");
+    isOk = false;
+  }
+
+  //client and server side of each connection
+  int total = numClients + numSlowClients;
+  struct rlimit limit;
+  getrlimit(RLIMIT_NOFILE, &limit);
+  if (limit.rlim_cur < (rlim_t)(2 * total + 64))
+  {
+    limit.rlim_cur = std::min(limit.rlim_max, (rlim_t)(2 * total + 64));
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+
+  WebSocketServer server("");
+  if (!server.open(0))
+  {
+    printf("FAILED: server\n");
+    return EXIT_FAILURE;
+  }
+  pthread_t serverThread;
+  pthread_create(&serverThread, NULL, runServer, &server);
+
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(server.getPort());
+
+  int epollFd = epoll_create1(0);
+  std::vector<TestClient> clients(total);
+  static const int rates[] = { 0, 1, 2, 5 };
+  for (int i = 0; i < total; i++)
+  {
+    TestClient& client = clients[i];
+    client.state = TestClient::CONNECTING;
+    client.isSlow = i >= numClients;
+    client.rate = client.isSlow ? 0 : rates[i % 4];
+    client.isRateInMessage = client.rate == 2;
+    client.frames = 0;
+    client.lastTimestamp = 0;
+    client.orderErrors = 0;
+    client.isCloseReceived = false;
+    client.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (client.fd < 0)
+    {
+      printf("FAILED: socket of client %d (%s)\n", i, strerror(errno));
+      return EXIT_FAILURE;
+    }
+    if (client.isSlow)
+    {
+      int size = SLOW_CLIENT_RCVBUF;
+      setsockopt(client.fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+    connect(client.fd, (struct sockaddr*)&address, sizeof(address));
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLOUT;
+    event.data.u32 = i;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, client.fd, &event);
+  }
+
+  int protocolErrors = 0;
+  uint64_t start = getTimeUs();
+  int numOpen = 0;
+  while ((numOpen < total) && (getTimeUs() - start < CONNECT_TIMEOUT * 1000ULL))
+  {
+    poll(clients, epollFd, 100, protocolErrors);
+    numOpen = 0;
+    for (int i = 0; i < total; i++)
+    {
+      if (clients[i].state == TestClient::OPEN)
+      {
+        numOpen++;
+      }
+    }
+  }
+  printf("clients: %d connected in %llu ms (%d slow)\n", numOpen,
+         (unsigned long long)(getTimeUs() - start) / 1000, numSlowClients);
+  if (numOpen < total)
+  {
+    printf("FAILED: %d clients not connected\n", total - numOpen);
+    isOk = false;
+  }
+
+  //the rate messages must be handled before the first position
+  usleep(100000);
+
+  gLatencies.reserve((size_t)numClients * rate * duration / 4 + 1024);
+  Publisher publisher;
+  publisher.server = &server;
+  publisher.rate = rate;
+  publisher.duration = duration;
+  publisher.published = 0;
+  publisher.lastTimestamp = 0;
+  publisher.elapsedUs = 0;
+  publisher.isDone = false;
+  pthread_t publisherThread;
+  pthread_create(&publisherThread, NULL, publish, &publisher);
+
+  while (!publisher.isDone)
+  {
+    poll(clients, epollFd, 100, protocolErrors);
+  }
+  pthread_join(publisherThread, NULL);
+
+  //the last position is sent to a client of 1 Hz within 1 s
+  start = getTimeUs();
+  while (getTimeUs() - start < LAST_POSITION_TIMEOUT * 1000ULL)
+  {
+    poll(clients, epollFd, 50, protocolErrors);
+  }
+  WebSocketServer::Statistics statistics = server.getStatistics();
+
+  //close handshake of the fast clients
+  for (int i = 0; i < numClients; i++)
+  {
+    if (clients[i].state == TestClient::OPEN)
+    {
+      sendMessage(clients[i], 0x8, std::string("\x03\xE8", 2));
+    }
+  }
+  int numCloseReceived = 0;
+  start = getTimeUs();
+  while ((numCloseReceived < numClients) && (getTimeUs() - start < DRAIN_TIMEOUT * 1000ULL))
+  {
+    poll(clients, epollFd, 50, protocolErrors);
+    numCloseReceived = 0;
+    for (int i = 0; i < numClients; i++)
+    {
+      if (clients[i].isCloseReceived)
+      {
+        numCloseReceived++;
+      }
+    }
+  }
+
+  server.stop();
+  pthread_join(serverThread, NULL);
+
+  //the positions still in the sockets of the slow clients
+  uint64_t slowFrames = 0;
+  for (int i = numClients; i < total; i++)
+  {
+    TestClient& client = clients[i];
+    char buffer[16384];
+    ssize_t size;
+    while ((size = recv(client.fd, buffer, sizeof(buffer), 0)) > 0)
+    {
+      client.input.append(buffer, size);
+      parseFrames(client);
+    }
+    slowFrames += client.frames;
+  }
+
+  double seconds = publisher.elapsedUs / 1e6;
+  uint64_t received = 0;
+  uint64_t orderErrors = 0;
+  int rateErrors = 0;
+  for (int i = 0; i < total; i++)
+  {
+    TestClient& client = clients[i];
+    orderErrors += client.orderErrors;
+    if (client.isSlow)
+    {
+      continue;
+    }
+    received += client.frames;
+
+    //the server skips positions when it falls behind, but never exceeds the rate
+    //and always delivers the latest position
+    uint64_t expected = 1;
+    uint64_t maximum = publisher.published;
+    if (client.rate > 0)
+    {
+      expected = std::min(publisher.published, (uint64_t)(client.rate * seconds * 0.8));
+      maximum = std::min(maximum, (uint64_t)(client.rate * seconds) + 2);
+    }
+    if ((client.frames > maximum) || (client.frames < expected) ||
+        (client.lastTimestamp != publisher.lastTimestamp))
+    {
+      if (rateErrors < 5)
+      {
+        printf("client %d (rate %d Hz): %llu positions, expected %llu..%llu%s\n", i, client.rate,
+               (unsigned long long)client.frames, (unsigned long long)expected, (unsigned long long)maximum,
+               (client.lastTimestamp != publisher.lastTimestamp) ? ", last position missing" : "");
+      }
+      rateErrors++;
+    }
+    close(client.fd);
+  }
+  for (int i = numClients; i < total; i++)
+  {
+    close(clients[i].fd);
+  }
+  close(epollFd);
+
+  std::sort(gLatencies.begin(), gLatencies.end());
+  printf("positions: %llu published in %.1f s, %llu received by the clients (%.0f/s)\n",
+         (unsigned long long)publisher.published, seconds,
+         (unsigned long long)received, received / seconds);
+  printf("latency [us]: p50 %u p99 %u max %u\n",
+         percentile(gLatencies, 50), percentile(gLatencies, 99), percentile(gLatencies, 100));
+  printf("slow clients: %llu positions received of %llu published\n",
+         (unsigned long long)slowFrames, (unsigned long long)publisher.published * numSlowClients);
+  printf("server: %llu frames sent, %llu skipped, %llu clients dropped, max %u bytes queued per client\n",
+         (unsigned long long)statistics.framesSent, (unsigned long long)statistics.framesSkipped,
+         (unsigned long long)statistics.clientsDropped, statistics.maxQueuedBytes);
+  printf("close handshake: %d of %d\n", numCloseReceived, numClients);
+
+  if (protocolErrors > 0)
+  {
+    printf("FAILED: %d protocol errors\n", protocolErrors);
+    isOk = false;
+  }
+  if (orderErrors > 0)
+  {
+    printf("FAILED: %llu positions out of order\n", (unsigned long long)orderErrors);
+    isOk = false;
+  }
+  if (rateErrors > 0)
+  {
+    printf("FAILED: %d clients with an unexpected number of positions\n", rateErrors);
+    isOk = false;
+  }
+  if (numCloseReceived < numClients)
+  {
+    printf("FAILED: %d clients without close frame\n", numClients - numCloseReceived);
+    isOk = false;
+  }
+  //a slow client is only dropped after the stall timeout of the server
+  if (statistics.streams + statistics.clientsDropped != (uint64_t)total)
+  {
+    printf("FAILED: %u streams open, expected %d\n", statistics.streams, total);
+    isOk = false;
+  }
+  //the backpressure: at most one position is queued, never the backlog of a slow client
+  if ((numSlowClients > 0) && ((statistics.framesSkipped == 0) || (statistics.maxQueuedBytes > 1024)))
+  {
+    printf("FAILED: backpressure of the slow clients\n");
+    isOk = false;
+  }
+
+  printf("%s\n", isOk ? "OK" : "FAILED");
+  return isOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
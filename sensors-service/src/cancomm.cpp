@@ -0,0 +1,329 @@
+/**************************************************************************
+ * @brief Access library for CAN frames via SocketCAN
+ *
+ * @author agent <agent@local>
+ * @copyright Copyright (C) 2026, agent
+ *
+ * @license MPL-2.0 <http://spdx.org/licenses/MPL-2.0>
+ *
+ **************************************************************************/
+
+
+/** ===================================================================
+ * 1.) INCLUDES
+ */
+
+//recvmmsg
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+ //provided interface
+#include "cancomm.h"
+
+//linux socketcan
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <sys/eventfd.h>
+
+//standard c library functions
+#include <pthread.h>
+#include <poll.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+
+#ifndef SO_RXQ_OVFL
+#define SO_RXQ_OVFL 40
+#endif
+
+
+/** ===================================================================
+ * 2.) Local variables
+ */
+
+static int _can_fd = -1;
+static int _wakeup_fd = -1;
+static volatile int _cancomm_reader_loop = 0;
+static pthread_t _reader_thread;
+static pthread_mutex_t _mutex_cb  = PTHREAD_MUTEX_INITIALIZER;
+static volatile CanFrameCallback _callback = NULL;
+static pthread_mutex_t _mutex_stats  = PTHREAD_MUTEX_INITIALIZER;
+static TCanCommStatistics _stats;
+
+
+/** ===================================================================
+ * 3.) LOCAL FUNCTIONS
+ */
+
+static uint64_t cancomm_get_time(clockid_t clock)
+{
+    struct timespec time_value;
+    clock_gettime(clock, &time_value);
+    return (uint64_t)time_value.tv_sec*1000000000 + time_value.tv_nsec;
+}
+
+static bool cancomm_fire_callback(const TCanFrame frames[], uint16_t num_frames, uint32_t dropped)
+{
+    pthread_mutex_lock(&_mutex_cb);
+    if (_callback)
+    {
+        _callback(frames, num_frames, dropped);
+    }
+    pthread_mutex_unlock(&_mutex_cb);
+    return true;
+}
+
+static void* cancomm_reader_thread(void*)
+{
+    //all buffers are allocated once - nothing is allocated per frame
+    struct can_frame can_frames[CANCOMM_MAX_FRAMES];
+    struct iovec iov[CANCOMM_MAX_FRAMES];
+    struct mmsghdr msgs[CANCOMM_MAX_FRAMES];
+    char control[CANCOMM_MAX_FRAMES][CMSG_SPACE(sizeof(struct timespec)) + CMSG_SPACE(sizeof(uint32_t))];
+    TCanFrame frames[CANCOMM_MAX_FRAMES];
+    uint32_t overflow = 0;
+    bool overflow_valid = false;
+
+    memset(msgs, 0, sizeof(msgs));
+    for (uint16_t i=0; i<CANCOMM_MAX_FRAMES; i++)
+    {
+        iov[i].iov_base = &can_frames[i];
+        iov[i].iov_len = sizeof(struct can_frame);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = control[i];
+    }
+
+    while (_cancomm_reader_loop)
+    {
+        struct pollfd fds[2];
+        fds[0].fd = _can_fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = _wakeup_fd;
+        fds[1].events = POLLIN;
+        if (poll(fds, 2, -1) < 0)
+        {
+            continue;
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            break;
+        }
+
+        for (uint16_t i=0; i<CANCOMM_MAX_FRAMES; i++)
+        {
+            msgs[i].msg_hdr.msg_controllen = sizeof(control[i]);
+        }
+        int num = recvmmsg(_can_fd, msgs, CANCOMM_MAX_FRAMES, MSG_DONTWAIT, NULL);
+        if (num <= 0)
+        {
+            if ((num < 0) && (errno != EAGAIN) && (errno != EINTR))
+            {
+                pthread_mutex_lock(&_mutex_stats);
+                _stats.errors++;
+                pthread_mutex_unlock(&_mutex_stats);
+            }
+            continue;
+        }
+
+        //kernel timestamps are CLOCK_REALTIME: map them to CLOCK_MONOTONIC once per batch
+        uint64_t now_monotonic = cancomm_get_time(CLOCK_MONOTONIC);
+        int64_t realtime_to_monotonic = now_monotonic - cancomm_get_time(CLOCK_REALTIME);
+        uint32_t dropped = 0;
+
+        for (int i=0; i<num; i++)
+        {
+            frames[i].timestamp = now_monotonic;
+            for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg))
+            {
+                if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPNS))
+                {
+                    struct timespec ts;
+                    memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                    frames[i].timestamp = (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec + realtime_to_monotonic;
+                }
+                else if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SO_RXQ_OVFL))
+                {
+                    //the kernel reports the total number of dropped frames of the socket
+                    uint32_t total;
+                    memcpy(&total, CMSG_DATA(cmsg), sizeof(total));
+                    dropped += overflow_valid ? total - overflow : total;
+                    overflow = total;
+                    overflow_valid = true;
+                }
+            }
+            frames[i].can_id = can_frames[i].can_id & (CAN_EFF_FLAG | CAN_EFF_MASK);
+            frames[i].len = (can_frames[i].can_dlc <= 8) ? can_frames[i].can_dlc : 8;
+            memcpy(frames[i].data, can_frames[i].data, 8);
+        }
+
+        cancomm_fire_callback(frames, num, dropped);
+
+        pthread_mutex_lock(&_mutex_stats);
+        _stats.frames += num;
+        _stats.batches++;
+        _stats.dropped += dropped;
+        if ((uint64_t)num > _stats.max_batch)
+        {
+            _stats.max_batch = num;
+        }
+        pthread_mutex_unlock(&_mutex_stats);
+    }
+    return NULL;
+}
+
+
+/** ===================================================================
+ * 4.) FUNCTIONS IMPLEMENTING THE PUBLIC INTERFACE OF cancomm.h
+ */
+
+bool cancomm_init(const char* interface, const uint32_t can_ids[], uint16_t num_ids)
+{
+    struct can_filter filters[CANCOMM_MAX_FILTERS];
+    struct sockaddr_can addr;
+    struct ifreq ifr;
+    int on = 1;
+
+    if ((_can_fd >= 0) || (interface == NULL) || (strlen(interface) >= IFNAMSIZ) ||
+        (can_ids == NULL) || (num_ids == 0) || (num_ids > CANCOMM_MAX_FILTERS))
+    {
+        return false;
+    }
+
+    for (uint16_t i=0; i<num_ids; i++)
+    {
+        //exact match on the identifier, no RTR frames, no mix-up of standard and extended identifiers
+        filters[i].can_id = can_ids[i];
+        filters[i].can_mask = CAN_EFF_FLAG | CAN_RTR_FLAG | ((can_ids[i] & CAN_EFF_FLAG) ? CAN_EFF_MASK : CAN_SFF_MASK);
+    }
+
+    int fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (fd < 0)
+    {
+        return false;
+    }
+    memset(&ifr, 0, sizeof(ifr));
+    strcpy(ifr.ifr_name, interface);
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    bool is_ok = (ioctl(fd, SIOCGIFINDEX, &ifr) == 0);
+    addr.can_ifindex = ifr.ifr_ifindex;
+    is_ok = is_ok && (setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, filters, num_ids*sizeof(struct can_filter)) == 0);
+    is_ok = is_ok && (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0);
+    //drop counter is optional - not available on old kernels
+    setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on));
+    is_ok = is_ok && (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    if (!is_ok)
+    {
+        close(fd);
+        return false;
+    }
+    _wakeup_fd = eventfd(0, 0);
+    if (_wakeup_fd < 0)
+    {
+        close(fd);
+        return false;
+    }
+    _can_fd = fd;
+    pthread_mutex_lock(&_mutex_stats);
+    memset(&_stats, 0, sizeof(_stats));
+    pthread_mutex_unlock(&_mutex_stats);
+    return true;
+}
+
+bool cancomm_deinit()
+{
+    if ((_can_fd < 0) || _cancomm_reader_loop)
+    {
+        return false;
+    }
+    close(_can_fd);
+    close(_wakeup_fd);
+    _can_fd = -1;
+    _wakeup_fd = -1;
+    return true;
+}
+
+bool cancomm_register_callback(CanFrameCallback callback)
+{
+    bool is_ok = false;
+    pthread_mutex_lock(&_mutex_cb);
+    if ((_callback == NULL) && (callback != NULL))
+    {
+        _callback = callback;
+        is_ok = true;
+    }
+    pthread_mutex_unlock(&_mutex_cb);
+    return is_ok;
+}
+
+bool cancomm_deregister_callback(CanFrameCallback callback)
+{
+    bool is_ok = false;
+    pthread_mutex_lock(&_mutex_cb);
+    if ((_callback == callback) && (callback != NULL))
+    {
+        _callback = NULL;
+        is_ok = true;
+    }
+    pthread_mutex_unlock(&_mutex_cb);
+    return is_ok;
+}
+
+bool cancomm_start_reader_thread()
+{
+    if (_cancomm_reader_loop || (_can_fd < 0))
+    {
+        return false;
+    }
+    _cancomm_reader_loop = 1;
+    int res = pthread_create(&_reader_thread, NULL, cancomm_reader_thread, NULL);
+    if (res != 0)
+    {
+        _cancomm_reader_loop = 0;
+        return false;
+    }
+    return true;
+}
+
+bool cancomm_stop_reader_thread()
+{
+    uint64_t one = 1;
+    bool is_woken_up;
+    if (!_cancomm_reader_loop)
+    {
+        return false;
+    }
+    _cancomm_reader_loop = 0;
+    //wake up the reader thread from poll()
+    //without the wakeup, the thread terminates after the next CAN frame
+    is_woken_up = (write(_wakeup_fd, &one, sizeof(one)) == sizeof(one));
+    pthread_join(_reader_thread, NULL);
+    if (!is_woken_up)
+    {
+        return false;
+    }
+    //consume the wakeup so that a restarted thread does not stop immediately
+    if (read(_wakeup_fd, &one, sizeof(one)) != sizeof(one))
+    {
+        return false;
+    }
+    return true;
+}
+
+bool cancomm_get_statistics(TCanCommStatistics* stats)
+{
+    if (stats == NULL)
+    {
+        return false;
+    }
+    pthread_mutex_lock(&_mutex_stats);
+    *stats = _stats;
+    pthread_mutex_unlock(&_mutex_stats);
+    return true;
+}
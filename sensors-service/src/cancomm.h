@@ -0,0 +1,129 @@
+/**************************************************************************
+ * @brief Access library for CAN frames via SocketCAN
+ *
+ * @details Receives CAN frames from a SocketCAN network interface
+ * (e.g. can0, or vcan0 for testing) in a reader thread.
+ *   - Only the configured CAN identifiers pass the kernel-side receive
+ *     filter (CAN_RAW_FILTER), so the reader thread does not wake up
+ *     for the bulk of the vehicle bus traffic.
+ *   - All frames available at a wakeup are fetched with a single
+ *     recvmmsg() call and passed to the callback as one batch.
+ *   - Each frame carries the kernel receive timestamp (SO_TIMESTAMPNS),
+ *     converted to the CLOCK_MONOTONIC time base of the other sensors.
+ *   - Frames dropped by the kernel due to socket buffer overflow
+ *     (SO_RXQ_OVFL) are reported with the next batch.
+ *
+ * @author agent <agent@local>
+ * @copyright Copyright (C) 2026, agent
+ *
+ * @license MPL-2.0 <http://spdx.org/licenses/MPL-2.0>
+ *
+ **************************************************************************/
+
+#ifndef INCLUDE_CANCOMM
+#define INCLUDE_CANCOMM
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Maximum number of frames fetched and passed to the callback at once
+  */
+#define CANCOMM_MAX_FRAMES 32
+
+/** Maximum number of CAN identifiers in the receive filter
+  */
+#define CANCOMM_MAX_FILTERS 32
+
+/**
+ * One received CAN frame
+ */
+typedef struct
+{
+    uint64_t timestamp;     /**< Kernel receive timestamp in ns, based on CLOCK_MONOTONIC */
+    uint32_t can_id;        /**< CAN identifier, extended identifiers are or'ed with CAN_EFF_FLAG */
+    uint8_t len;            /**< Payload length 0..8 */
+    uint8_t data[8];        /**< Payload */
+} TCanFrame;
+
+/**
+ * Reception statistics
+ */
+typedef struct
+{
+    uint64_t frames;        /**< Number of received frames */
+    uint64_t batches;       /**< Number of callback invocations */
+    uint64_t max_batch;     /**< Maximum number of frames per callback invocation */
+    uint64_t dropped;       /**< Number of frames dropped by the kernel (socket buffer overflow) */
+    uint64_t errors;        /**< Number of failed receive calls */
+} TCanCommStatistics;
+
+/**
+ * Callback type for received CAN frames.
+ * Use this type of callback if you want to register for CAN frames.
+ * @param frames pointer to an array of TCanFrame with size num_frames, ordered by reception
+ * @param num_frames number of frames 1..CANCOMM_MAX_FRAMES
+ * @param dropped number of frames dropped by the kernel since the previous callback
+ */
+typedef void (*CanFrameCallback)(const TCanFrame frames[], uint16_t num_frames, uint32_t dropped);
+
+/**
+ * Open a SocketCAN network interface
+ * @param interface name of the network interface, e.g. "can0"
+ * @param can_ids the CAN identifiers to receive, extended identifiers or'ed with CAN_EFF_FLAG
+ * @param num_ids number of CAN identifiers 1..CANCOMM_MAX_FILTERS
+ * @return true on success.
+ */
+bool cancomm_init(const char* interface, const uint32_t can_ids[], uint16_t num_ids);
+
+/**
+ * Close the network interface
+ * @return true on success.
+ */
+bool cancomm_deinit();
+
+/**
+ * Register callback function for received CAN frames.
+ * Only one callback function can be registered.
+ * @param callback pointer to the callback function
+ * @return true on success.
+ */
+bool cancomm_register_callback(CanFrameCallback callback);
+
+/**
+ * Deregister the callback function
+ * @param callback pointer to the callback function
+ * @return true on success.
+ */
+bool cancomm_deregister_callback(CanFrameCallback callback);
+
+/**
+ * Start the reader thread
+ * @return true on success.
+ */
+bool cancomm_start_reader_thread();
+
+/**
+ * Stop the reader thread
+ * The thread is woken up immediately, no need to wait for the next frame.
+ * If the wakeup fails, the thread is still stopped and joined:
+ * it terminates after the next received frame.
+ * @return true on success, false if the wakeup failed.
+ */
+bool cancomm_stop_reader_thread();
+
+/**
+ * Get the reception statistics
+ * @param stats returns the statistics
+ * @return true on success.
+ */
+bool cancomm_get_statistics(TCanCommStatistics* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //INCLUDE_CANCOMM
@@ -0,0 +1,394 @@
+/**************************************************************************
+ * @brief Signal database for vehicle signals received via CAN
+ *
+ * @author agent <agent@local>
+ * @copyright Copyright (C) 2026, agent
+ *
+ * @license MPL-2.0 <http://spdx.org/licenses/MPL-2.0>
+ *
+ **************************************************************************/
+
+
+/** ===================================================================
+ * 1.) INCLUDES
+ */
+
+ //provided interface
+#include "cansignal.h"
+
+//standard c library functions
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+
+/** ===================================================================
+ * 2.) LOCAL FUNCTIONS
+ */
+
+/** Names of the signals in the database file, see ECanSignal
+ */
+static const char* const signal_names[CAN_SIGNAL_NUM] =
+{
+    "wheel0", "wheel1", "wheel2", "wheel3", "wheel4", "wheel5", "wheel6", "wheel7",
+    "wheel_valid", "vehicle_speed", "reverse_gear"
+};
+
+/**
+ * Position of the least significant bit of the signal in the 64 bit word
+ * built from the payload in the byte order of the signal.
+ * @return false if the signal is not completely contained in the payload
+ */
+static bool cansignal_get_lsb(const TCanSignal* signal, uint8_t len, uint8_t* lsb)
+{
+    if ((signal->length == 0) || (signal->length > 64) || (len > CAN_SIGNAL_MAX_DATA))
+    {
+        return false;
+    }
+    if (!signal->motorola)
+    {
+        //Intel: data[0] is the least significant byte, the start bit is the LSB
+        if (signal->start_bit + signal->length > 8*len)
+        {
+            return false;
+        }
+        *lsb = signal->start_bit;
+    }
+    else
+    {
+        //Motorola: data[0] is the most significant byte, the start bit is the MSB
+        //bit b of data[k] is bit 8*(7-k)+b of the 64 bit word
+        int msb = 8*(7 - signal->start_bit/8) + signal->start_bit%8;
+        int pos = msb - (signal->length-1);
+        if ((signal->start_bit >= 64) || (pos < 0) || (7 - pos/8 >= len))
+        {
+            return false;
+        }
+        *lsb = pos;
+    }
+    return true;
+}
+
+static uint64_t cansignal_load(const TCanSignal* signal, const uint8_t data[], uint8_t len)
+{
+    uint64_t word = 0;
+    for (uint8_t k=0; k<len; k++)
+    {
+        word |= (uint64_t)data[k] << (signal->motorola ? 8*(7-k) : 8*k);
+    }
+    return word;
+}
+
+static void cansignal_store(const TCanSignal* signal, uint64_t word, uint8_t data[], uint8_t len)
+{
+    for (uint8_t k=0; k<len; k++)
+    {
+        data[k] = word >> (signal->motorola ? 8*(7-k) : 8*k);
+    }
+}
+
+static uint64_t cansignal_mask(uint8_t length)
+{
+    return (length >= 64) ? ~(uint64_t)0 : ((uint64_t)1 << length) - 1;
+}
+
+/**
+ * Remove leading and trailing white space in place
+ */
+static char* cansignal_trim(char* s)
+{
+    while (isspace((unsigned char)*s))
+    {
+        s++;
+    }
+    char* end = s + strlen(s);
+    while ((end > s) && isspace((unsigned char)end[-1]))
+    {
+        end--;
+    }
+    *end = '\0';
+    return s;
+}
+
+static bool cansignal_parse_signal(const char* value, TCanSignal* signal)
+{
+    char id[16];
+    char byte_order[16];
+    char sign[16];
+    unsigned int start_bit = 0;
+    unsigned int length = 0;
+    double factor = 1.0;
+    double offset = 0.0;
+
+    if (sscanf(value, "%15s %u %u %15s %15s %lf %lf", id, &start_bit, &length, byte_order, sign, &factor, &offset) != 7)
+    {
+        return false;
+    }
+    char* end = NULL;
+    unsigned long can_id = strtoul(id, &end, 0);
+    bool extended = (can_id > 0x7FF);
+    if ((*end == 'x') || (*end == 'X'))
+    {
+        extended = true;
+        end++;
+    }
+    if ((end == id) || (*end != '\0') || (can_id > 0x1FFFFFFF) || (start_bit > 63) || (length == 0) || (length > 64))
+    {
+        return false;
+    }
+    if ((strcmp(byte_order, "intel") != 0) && (strcmp(byte_order, "motorola") != 0))
+    {
+        return false;
+    }
+    if ((strcmp(sign, "signed") != 0) && (strcmp(sign, "unsigned") != 0))
+    {
+        return false;
+    }
+    signal->defined = true;
+    signal->can_id = can_id | (extended ? CAN_SIGNAL_EFF_FLAG : 0);
+    signal->start_bit = start_bit;
+    signal->length = length;
+    signal->motorola = (strcmp(byte_order, "motorola") == 0);
+    signal->is_signed = (strcmp(sign, "signed") == 0);
+    signal->factor = factor;
+    signal->offset = offset;
+    //the signal must fit into a CAN frame
+    uint8_t lsb;
+    return cansignal_get_lsb(signal, CAN_SIGNAL_MAX_DATA, &lsb);
+}
+
+/**
+ * Wheel configuration: <axle> <wheel> <ticks_per_rev> <circumference> <x> <y> <z> [driven|steered|-]...
+ * The driven and steered flags are only valid if at least one flag (or "-" for none) is given
+ */
+static bool cansignal_parse_wheel(const char* value, TWheelConfiguration* wheel)
+{
+    unsigned int axle = 0;
+    unsigned int index = 0;
+    unsigned int ticks = 0;
+    float circumference = 0;
+    float x = 0;
+    float y = 0;
+    float z = 0;
+    char flags[2][16];
+
+    int num = sscanf(value, "%u %u %u %f %f %f %f %15s %15s", &axle, &index, &ticks, &circumference, &x, &y, &z, flags[0], flags[1]);
+    if ((num < 7) || (axle > 255) || (index > 255) || (ticks == 0) || (ticks > 0xFFFF) || (circumference <= 0))
+    {
+        return false;
+    }
+    memset(wheel, 0, sizeof(TWheelConfiguration));
+    wheel->wheelUnit = WHEEL_UNIT_TICKS;
+    wheel->axleIndex = axle;
+    wheel->wheelIndex = index;
+    wheel->wheelticksPerRevolution = ticks;
+    wheel->tireRollingCircumference = circumference;
+    wheel->dist2RefPointX = x;
+    wheel->dist2RefPointY = y;
+    wheel->dist2RefPointZ = z;
+    wheel->validityBits = WHEEL_CONFIG_TICKS_PER_REV_VALID | WHEEL_CONFIG_TIRE_CIRC_VALID |
+                          WHEEL_CONFIG_DISTX_VALID | WHEEL_CONFIG_DISTY_VALID | WHEEL_CONFIG_DISTZ_VALID;
+    for (int i=0; i<num-7; i++)
+    {
+        if (strcmp(flags[i], "driven") == 0)
+        {
+            wheel->statusBits |= WHEEL_CONFIG_DRIVEN;
+        }
+        else if (strcmp(flags[i], "steered") == 0)
+        {
+            wheel->statusBits |= WHEEL_CONFIG_STEERED;
+        }
+        else if (strcmp(flags[i], "-") != 0)
+        {
+            return false;
+        }
+        wheel->validityBits |= WHEEL_CONFIG_DRIVEN_VALID | WHEEL_CONFIG_STEERED_VALID;
+    }
+    return true;
+}
+
+static bool cansignal_parse_line(const char* key, const char* value, TCanSignalDb* db)
+{
+    unsigned int w = 0;
+    int n = 0;
+    if ((sscanf(key, "wheel%u_config%n", &w, &n) == 1) && (key[n] == '\0'))
+    {
+        return (w < WHEEL_MAX) && cansignal_parse_wheel(value, &db->wheels[w]);
+    }
+    for (uint16_t i=0; i<CAN_SIGNAL_NUM; i++)
+    {
+        if (strcmp(key, signal_names[i]) == 0)
+        {
+            return cansignal_parse_signal(value, &db->signals[i]);
+        }
+    }
+    char* end = NULL;
+    if (strcmp(key, "interface") == 0)
+    {
+        if ((value[0] == '\0') || (strlen(value) >= CAN_SIGNAL_MAX_IFNAME))
+        {
+            return false;
+        }
+        strcpy(db->interface, value);
+    }
+    else if (strcmp(key, "reverse_gear_value") == 0)
+    {
+        db->reverse_gear_value = strtod(value, &end);
+        return (end != value) && (*end == '\0');
+    }
+    else if (strcmp(key, "timeout") == 0)
+    {
+        db->timeout = strtoul(value, &end, 0);
+        return (end != value) && (*end == '\0') && (db->timeout > 0);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+
+/** ===================================================================
+ * 3.) FUNCTIONS IMPLEMENTING THE PUBLIC INTERFACE OF cansignal.h
+ */
+
+bool cansignal_get_default_db(TCanSignalDb* db)
+{
+    if (db == NULL)
+    {
+        return false;
+    }
+    memset(db, 0, sizeof(TCanSignalDb));
+    strcpy(db->interface, "can0");
+    db->reverse_gear_value = 1.0;
+    db->timeout = 100;
+    return true;
+}
+
+bool cansignal_load_db(const char* filename, TCanSignalDb* db)
+{
+    char line[256];
+    unsigned int line_number = 0;
+    bool is_ok = true;
+
+    if ((filename == NULL) || (db == NULL))
+    {
+        return false;
+    }
+    FILE* file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        return false;
+    }
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        line_number++;
+        char* comment = strchr(line, '#');
+        if (comment != NULL)
+        {
+            *comment = '\0';
+        }
+        char* key = cansignal_trim(line);
+        if (*key == '\0')
+        {
+            continue;
+        }
+        char* separator = strchr(key, '=');
+        if (separator != NULL)
+        {
+            *separator = '\0';
+        }
+        if ((separator == NULL) || !cansignal_parse_line(cansignal_trim(key), cansignal_trim(separator+1), db))
+        {
+            fprintf(stderr, "%s:%u: invalid signal database entry\n", filename, line_number);
+            is_ok = false;
+        }
+    }
+    fclose(file);
+    return is_ok;
+}
+
+uint16_t cansignal_get_can_ids(const TCanSignalDb* db, uint32_t can_ids[])
+{
+    uint16_t num_ids = 0;
+    for (uint16_t i=0; i<CAN_SIGNAL_NUM; i++)
+    {
+        if (!db->signals[i].defined)
+        {
+            continue;
+        }
+        bool found = false;
+        for (uint16_t j=0; j<num_ids; j++)
+        {
+            found = found || (can_ids[j] == db->signals[i].can_id);
+        }
+        if (!found)
+        {
+            can_ids[num_ids++] = db->signals[i].can_id;
+        }
+    }
+    return num_ids;
+}
+
+bool cansignal_decode_raw(const TCanSignal* signal, const uint8_t data[], uint8_t len, int64_t* raw)
+{
+    uint8_t lsb = 0;
+    if ((signal == NULL) || (data == NULL) || (raw == NULL) || !cansignal_get_lsb(signal, len, &lsb))
+    {
+        return false;
+    }
+    uint64_t mask = cansignal_mask(signal->length);
+    uint64_t value = (cansignal_load(signal, data, len) >> lsb) & mask;
+    if (signal->is_signed && (signal->length < 64) && (value >> (signal->length-1)))
+    {
+        //sign extension
+        value |= ~mask;
+    }
+    *raw = (int64_t)value;
+    return true;
+}
+
+bool cansignal_decode(const TCanSignal* signal, const uint8_t data[], uint8_t len, double* value)
+{
+    int64_t raw = 0;
+    if ((value == NULL) || !cansignal_decode_raw(signal, data, len, &raw))
+    {
+        return false;
+    }
+    if (signal->is_signed)
+    {
+        *value = raw * signal->factor + signal->offset;
+    }
+    else
+    {
+        *value = (uint64_t)raw * signal->factor + signal->offset;
+    }
+    return true;
+}
+
+bool cansignal_encode_raw(const TCanSignal* signal, int64_t raw, uint8_t data[], uint8_t len)
+{
+    uint8_t lsb = 0;
+    if ((signal == NULL) || (data == NULL) || !cansignal_get_lsb(signal, len, &lsb))
+    {
+        return false;
+    }
+    uint64_t mask = cansignal_mask(signal->length);
+    uint64_t word = cansignal_load(signal, data, len);
+    word &= ~(mask << lsb);
+    word |= ((uint64_t)raw & mask) << lsb;
+    cansignal_store(signal, word, data, len);
+    return true;
+}
+
+bool cansignal_encode(const TCanSignal* signal, double value, uint8_t data[], uint8_t len)
+{
+    if ((signal == NULL) || (signal->factor == 0.0))
+    {
+        return false;
+    }
+    return cansignal_encode_raw(signal, (int64_t)llround((value - signal->offset) / signal->factor), data, len);
+}
@@ -0,0 +1,173 @@
+/**************************************************************************
+ * @brief Signal database for vehicle signals received via CAN
+ *
+ * @details Describes where the wheel tick counters, the vehicle speed
+ * and the reverse gear are located in the CAN frames of a given vehicle
+ * and decodes/encodes them. The layout follows the DBC conventions:
+ * start bit and length in bits, Intel (little endian) or Motorola
+ * (big endian) byte order, signed or unsigned raw value, and the
+ * physical value = raw * factor + offset.
+ *
+ * The signal database is read from a text file with one "key = value"
+ * per line, '#' starts a comment. Signals are defined as
+ *   <signal> = <can_id> <start_bit> <length> <intel|motorola> <signed|unsigned> <factor> <offset>
+ * with <signal> one of
+ *   wheel0 ... wheel7  rolling wheel tick counters, index as in TWheelData::data[]
+ *   wheel_valid        qualifier of the wheel tick counters in the same frame, 0: invalid
+ *   vehicle_speed      vehicle speed, the physical value must be in [m/s]
+ *   reverse_gear       gear signal, reverse if equal to reverse_gear_value
+ * CAN identifiers > 0x7FF or with a trailing 'x' (e.g. 0x123x) are extended (29 bit) identifiers.
+ * Further keys:
+ *   interface          CAN network interface, e.g. can0 or vcan0
+ *   reverse_gear_value physical value of reverse_gear which means reverse, default 1
+ *   timeout            maximum time between two wheel tick frames [ms], default 100.
+ *                      A longer interruption is reported as WHEEL_STATUS_GAP
+ *
+ * @author agent <agent@local>
+ * @copyright Copyright (C) 2026, agent
+ *
+ * @license MPL-2.0 <http://spdx.org/licenses/MPL-2.0>
+ *
+ **************************************************************************/
+
+#ifndef INCLUDE_CANSIGNAL
+#define INCLUDE_CANSIGNAL
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "wheel.h"
+
+/** Maximum length of the CAN interface name including terminating 0 (IFNAMSIZ)
+ */
+#define CAN_SIGNAL_MAX_IFNAME 16
+
+/** Maximum payload size of a CAN frame
+ */
+#define CAN_SIGNAL_MAX_DATA 8
+
+/** Flag for extended (29 bit) CAN identifiers, same as CAN_EFF_FLAG of linux/can.h
+ */
+#define CAN_SIGNAL_EFF_FLAG 0x80000000U
+
+/**
+ * Signals known by the signal database
+ */
+typedef enum
+{
+    CAN_SIGNAL_WHEEL_0 = 0,     /**< Rolling wheel tick counter for TWheelData::data[0] */
+    CAN_SIGNAL_WHEEL_1,
+    CAN_SIGNAL_WHEEL_2,
+    CAN_SIGNAL_WHEEL_3,
+    CAN_SIGNAL_WHEEL_4,
+    CAN_SIGNAL_WHEEL_5,
+    CAN_SIGNAL_WHEEL_6,
+    CAN_SIGNAL_WHEEL_7,         /**< Rolling wheel tick counter for TWheelData::data[7] */
+    CAN_SIGNAL_WHEEL_VALID,     /**< Qualifier of the wheel tick counters */
+    CAN_SIGNAL_VEHICLE_SPEED,   /**< Vehicle speed [m/s] */
+    CAN_SIGNAL_REVERSE_GEAR,    /**< Gear, see TCanSignalDb::reverse_gear_value */
+    CAN_SIGNAL_NUM
+} ECanSignal;
+
+/**
+ * Location and scaling of one signal
+ */
+typedef struct
+{
+    bool defined;           /**< True if the signal is available on the vehicle */
+    uint32_t can_id;        /**< CAN identifier, or'ed with CAN_SIGNAL_EFF_FLAG for extended identifiers */
+    uint8_t start_bit;      /**< Intel: position of the LSB, Motorola: position of the MSB (DBC numbering) */
+    uint8_t length;         /**< Length in bits 1..64 */
+    bool motorola;          /**< True for big endian (Motorola), false for little endian (Intel) byte order */
+    bool is_signed;         /**< True if the raw value is two's complement */
+    double factor;          /**< Physical value = raw * factor + offset */
+    double offset;
+} TCanSignal;
+
+/**
+ * Signal database of a vehicle
+ */
+typedef struct
+{
+    char interface[CAN_SIGNAL_MAX_IFNAME];  /**< CAN network interface */
+    TCanSignal signals[CAN_SIGNAL_NUM];     /**< Signals, see ECanSignal */
+    double reverse_gear_value;              /**< Physical value of CAN_SIGNAL_REVERSE_GEAR meaning reverse */
+    uint32_t timeout;                       /**< Maximum time between two wheel tick frames [ms] */
+    TWheelConfigurationArray wheels;        /**< Configuration of the wheels with a defined tick counter signal */
+} TCanSignalDb;
+
+/**
+ * Get an empty signal database with default settings (interface can0, no signals defined).
+ * @param db returns the signal database
+ * @return true on success
+ */
+bool cansignal_get_default_db(TCanSignalDb* db);
+
+/**
+ * Read a signal database file.
+ * The definitions found in the file overwrite the corresponding members of db.
+ * @param filename path of the signal database file
+ * @param db signal database to update
+ * @return true on success, false if the file cannot be read or contains invalid lines.
+ */
+bool cansignal_load_db(const char* filename, TCanSignalDb* db);
+
+/**
+ * Get the distinct CAN identifiers of all defined signals.
+ * @param db the signal database
+ * @param can_ids returns the CAN identifiers, must hold CAN_SIGNAL_NUM elements
+ * @return number of CAN identifiers
+ */
+uint16_t cansignal_get_can_ids(const TCanSignalDb* db, uint32_t can_ids[]);
+
+/**
+ * Extract the raw value of a signal from the payload of a CAN frame.
+ * @param signal the signal
+ * @param data the payload
+ * @param len the payload length
+ * @param raw returns the raw value, sign extended if the signal is signed
+ * @return false if the signal is not completely contained in the payload
+ */
+bool cansignal_decode_raw(const TCanSignal* signal, const uint8_t data[], uint8_t len, int64_t* raw);
+
+/**
+ * Extract the physical value of a signal from the payload of a CAN frame.
+ * @param signal the signal
+ * @param data the payload
+ * @param len the payload length
+ * @param value returns the physical value
+ * @return false if the signal is not completely contained in the payload
+ */
+bool cansignal_decode(const TCanSignal* signal, const uint8_t data[], uint8_t len, double* value);
+
+/**
+ * Insert the raw value of a signal into the payload of a CAN frame.
+ * The other bits of the payload are not changed.
+ * @param signal the signal
+ * @param raw the raw value, truncated to the signal length
+ * @param data the payload to update
+ * @param len the payload length
+ * @return false if the signal is not completely contained in the payload
+ */
+bool cansignal_encode_raw(const TCanSignal* signal, int64_t raw, uint8_t data[], uint8_t len);
+
+/**
+ * Insert the physical value of a signal into the payload of a CAN frame.
+ * The value is rounded to the nearest raw value.
+ * @param signal the signal
+ * @param value the physical value
+ * @param data the payload to update
+ * @param len the payload length
+ * @return false if the signal is not completely contained in the payload
+ */
+bool cansignal_encode(const TCanSignal* signal, double value, uint8_t data[], uint8_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //INCLUDE_CANSIGNAL
@@ -0,0 +1,171 @@
+/**************************************************************************
+ * @brief Decimation filter for multi-channel sensor data
+ *
+ * @author agent <agent@local>
+ * @copyright Copyright (C) 2026, agent
+ *
+ * @license MPL-2.0 <http://spdx.org/licenses/MPL-2.0>
+ *
+ **************************************************************************/
+
+
+/** ===================================================================
+ * 1.) INCLUDES
+ */
+
+ //provided interface
+#include "decimator.h"
+
+//standard c library functions
+#include <string.h>
+#include <math.h>
+
+#define DECIMATOR_PI 3.14159265358979323846
+
+
+/** ===================================================================
+ * 2.) FUNCTIONS IMPLEMENTING THE PUBLIC INTERFACE OF decimator.h
+ */
+
+decimator::decimator():
+    _num_taps(1),
+    _ratio(1),
+    _num_channels(DECIMATOR_MAX_CHANNELS),
+    _delay(0)
+{
+    _taps[0] = 1.0;
+    reset();
+}
+
+bool decimator::init(const float taps[], uint16_t num_taps, uint16_t ratio, uint16_t num_channels)
+{
+    if ((taps == 0) || (num_taps == 0) || (num_taps > DECIMATOR_MAX_TAPS) || (ratio == 0) ||
+        (num_channels == 0) || (num_channels > DECIMATOR_MAX_CHANNELS))
+    {
+        return false;
+    }
+    memcpy(_taps, taps, num_taps*sizeof(float));
+    _num_taps = num_taps;
+    _ratio = ratio;
+    _num_channels = num_channels;
+    //linear phase filters are symmetric: the delay is half of the filter length
+    _delay = (num_taps-1)/2;
+    reset();
+    return true;
+}
+
+bool decimator::init_lowpass(uint16_t num_taps, uint16_t ratio, uint16_t num_channels)
+{
+    float taps[DECIMATOR_MAX_TAPS];
+    double sum = 0.0;
+
+    if ((num_taps == 0) || (num_taps > DECIMATOR_MAX_TAPS) || (ratio == 0))
+    {
+        return false;
+    }
+    //cut-off frequency in cycles per input sample
+    double fc = 0.8 * 0.5 / ratio;
+    double center = (num_taps-1) / 2.0;
+    for (uint16_t n=0; n<num_taps; n++)
+    {
+        double x = n - center;
+        double sinc = (x == 0.0) ? 2.0*fc : sin(2.0*DECIMATOR_PI*fc*x) / (DECIMATOR_PI*x);
+        double window = (num_taps > 1) ? 0.54 - 0.46*cos(2.0*DECIMATOR_PI*n/(num_taps-1)) : 1.0;
+        taps[n] = sinc * window;
+        sum += taps[n];
+    }
+    //unity DC gain
+    for (uint16_t n=0; n<num_taps; n++)
+    {
+        taps[n] /= sum;
+    }
+    return init(taps, num_taps, ratio, num_channels);
+}
+
+bool decimator::init_cic(uint16_t order, uint16_t ratio, uint16_t num_channels)
+{
+    float taps[DECIMATOR_MAX_TAPS];
+    float stage[DECIMATOR_MAX_TAPS];
+
+    if ((order == 0) || (ratio == 0) || (order*(ratio-1)+1 > DECIMATOR_MAX_TAPS))
+    {
+        return false;
+    }
+    //convolve order boxcars of length ratio, each with gain 1/ratio
+    uint16_t num_taps = 1;
+    taps[0] = 1.0;
+    for (uint16_t o=0; o<order; o++)
+    {
+        memset(stage, 0, sizeof(stage));
+        for (uint16_t n=0; n<num_taps; n++)
+        {
+            for (uint16_t r=0; r<ratio; r++)
+            {
+                stage[n+r] += taps[n] / ratio;
+            }
+        }
+        num_taps += ratio-1;
+        memcpy(taps, stage, num_taps*sizeof(float));
+    }
+    return init(taps, num_taps, ratio, num_channels);
+}
+
+void decimator::reset()
+{
+    memset(_history, 0, sizeof(_history));
+    memset(_timestamps, 0, sizeof(_timestamps));
+    _pos = 0;
+    _phase = 0;
+    _fill = 0;
+}
+
+uint16_t decimator::process(const float* const input[], const uint64_t timestamp[], uint16_t num_samples,
+                            float* const output[], uint64_t out_timestamp[])
+{
+    uint16_t num_out = 0;
+
+    for (uint16_t i=0; i<num_samples; i++)
+    {
+        //the history is written backwards: the newest frame is at _pos, the oldest at _pos+_num_taps-1
+        _pos = (_pos == 0) ? _num_taps-1 : _pos-1;
+        for (uint16_t c=0; c<_num_channels; c++)
+        {
+            _history[_pos][c] = input[c][i];
+            _history[_pos+_num_taps][c] = input[c][i];
+        }
+        _timestamps[_pos] = timestamp[i];
+        if (_fill < _num_taps)
+        {
+            _fill++;
+        }
+
+        if (++_phase < _ratio)
+        {
+            continue;
+        }
+        _phase = 0;
+        if (_fill < _num_taps)
+        {
+            continue;
+        }
+
+        //the inner loop over all channels of one frame is vectorized by the compiler
+        float acc[DECIMATOR_MAX_CHANNELS] __attribute__((aligned(32))) = {0};
+        const float (*window)[DECIMATOR_MAX_CHANNELS] = &_history[_pos];
+        for (uint16_t k=0; k<_num_taps; k++)
+        {
+            const float h = _taps[k];
+            for (uint16_t c=0; c<DECIMATOR_MAX_CHANNELS; c++)
+            {
+                acc[c] += h * window[k][c];
+            }
+        }
+        for (uint16_t c=0; c<_num_channels; c++)
+        {
+            output[c][num_out] = acc[c];
+        }
+        out_timestamp[num_out] = _timestamps[(_pos+_delay) % _num_taps];
+        num_out++;
+    }
+    return num_out;
+}
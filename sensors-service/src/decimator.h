@@ -0,0 +1,127 @@
+/**************************************************************************
+ * @brief Decimation filter for multi-channel sensor data
+ *
+ * @details Reduces the sample rate of several channels sampled together
+ * (e.g. acceleration x/y/z, angular rate x/y/z and temperature of an IMU)
+ * by an integer ratio. Before decimation, the data is low pass filtered
+ * by a FIR filter, so that vibrations above the output Nyquist frequency
+ * are suppressed instead of being aliased into the output as with
+ * a plain boxcar average.
+ *
+ * @author agent <agent@local>
+ * @copyright Copyright (C) 2026, agent
+ *
+ * @license MPL-2.0 <http://spdx.org/licenses/MPL-2.0>
+ *
+ **************************************************************************/
+
+#ifndef INCLUDE_DECIMATOR
+#define INCLUDE_DECIMATOR
+
+#include <stdint.h>
+
+/** Maximum number of FIR filter taps
+  */
+#define DECIMATOR_MAX_TAPS 64
+
+/** Maximum number of channels filtered together
+  * The history stores one frame of DECIMATOR_MAX_CHANNELS floats per input sample,
+  * so that each filter tap is applied to all channels by one vector operation.
+  */
+#define DECIMATOR_MAX_CHANNELS 8
+
+/**
+ * Decimating FIR filter.
+ * Only every ratio-th output sample is computed, so the cost per input sample
+ * is num_taps/ratio multiply-accumulates per channel (polyphase equivalent).
+ * No dynamic memory is used.
+ */
+class decimator {
+
+private:
+    float _taps[DECIMATOR_MAX_TAPS];
+    //two copies of the history so that the newest num_taps frames are always contiguous
+    float _history[2*DECIMATOR_MAX_TAPS][DECIMATOR_MAX_CHANNELS] __attribute__((aligned(32)));
+    uint64_t _timestamps[DECIMATOR_MAX_TAPS];
+    uint16_t _num_taps;
+    uint16_t _ratio;
+    uint16_t _num_channels;
+    uint16_t _delay;
+    uint16_t _pos;
+    uint16_t _phase;
+    uint16_t _fill;
+
+public:
+    /**
+     * Constructor
+     * The filter is a pass-through (1 tap, ratio 1) until initialized
+     */
+    decimator();
+
+    /**
+     * Initialize with arbitrary FIR filter coefficients
+     * @param taps the filter coefficients, taps[k] is applied to the input sample k steps ago
+     * @param num_taps number of coefficients, allowed range 1..DECIMATOR_MAX_TAPS
+     * @param ratio decimation ratio, allowed range >= 1
+     * @param num_channels number of channels, allowed range 1..DECIMATOR_MAX_CHANNELS
+     * @return true on success
+     */
+    bool init(const float taps[], uint16_t num_taps, uint16_t ratio, uint16_t num_channels);
+
+    /**
+     * Initialize with a windowed-sinc (Hamming) low pass filter with unity DC gain.
+     * The cut-off frequency is 80% of the Nyquist frequency of the output rate.
+     * @param num_taps number of coefficients, allowed range 1..DECIMATOR_MAX_TAPS.
+     *        More taps improve the stop band attenuation, but increase the delay:
+     *        2*ratio+1 taps are a reasonable minimum, 4*ratio taps give a steep filter.
+     * @param ratio decimation ratio, allowed range >= 1
+     * @param num_channels number of channels, allowed range 1..DECIMATOR_MAX_CHANNELS
+     * @return true on success
+     */
+    bool init_lowpass(uint16_t num_taps, uint16_t ratio, uint16_t num_channels);
+
+    /**
+     * Initialize with the response of a CIC (cascaded integrator comb) decimator.
+     * The CIC response is realized by its equivalent FIR (order cascaded boxcars of length ratio),
+     * which avoids the unbounded integrator growth of the recursive structure with floating point data.
+     * Order 1 is the plain boxcar average.
+     * @param order number of stages, allowed range >= 1, order*(ratio-1)+1 must not exceed DECIMATOR_MAX_TAPS
+     * @param ratio decimation ratio, allowed range >= 1
+     * @param num_channels number of channels, allowed range 1..DECIMATOR_MAX_CHANNELS
+     * @return true on success
+     */
+    bool init_cic(uint16_t order, uint16_t ratio, uint16_t num_channels);
+
+    /**
+     * Clear the filter history
+     */
+    void reset();
+
+    /**
+     * Get the decimation ratio
+     */
+    uint16_t get_ratio() const { return _ratio; };
+
+    /**
+     * Get the group delay of the filter in input samples (rounded down)
+     */
+    uint16_t get_delay() const { return _delay; };
+
+    /**
+     * Filter and decimate a batch of input samples.
+     * Input and output are in SoA layout: one array per channel.
+     * Output samples are only produced once the history is filled.
+     * The output timestamps are compensated for the group delay of the filter,
+     * i.e. they are the timestamps of the input samples in the center of the filter window.
+     * @param input input[c][i] is sample i of channel c
+     * @param timestamp timestamp of each input sample
+     * @param num_samples number of input samples
+     * @param output output[c][j] returns output sample j of channel c, each array must hold num_samples/ratio+1 samples
+     * @param out_timestamp returns the timestamp of each output sample, must hold num_samples/ratio+1 samples
+     * @return number of output samples
+     */
+    uint16_t process(const float* const input[], const uint64_t timestamp[], uint16_t num_samples,
+                     float* const output[], uint64_t out_timestamp[]);
+};
+
+#endif //INCLUDE_DECIMATOR
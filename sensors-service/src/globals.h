@@ -28,6 +28,7 @@
 #include "acceleration.h"
 #include "gyroscope.h"
 #include "vehicle-speed.h"
+#include "odometer.h"
 #include "sns-meta-data.h"
 
 #ifdef __cplusplus
@@ -51,6 +52,13 @@ bool iWheelInit();
 bool iWheelDestroy();
 void updateWheelData(const TWheelData wheelData[], uint16_t numElements);
 void updateWheelStatus(const TSensorStatus* status);
+void updateWheelConfiguration(const TWheelConfigurationArray* config);
+
+bool iOdometerInit();
+bool iOdometerDestroy();
+void updateOdometerFromWheelData(const TWheelData wheelData[], uint16_t numElements);
+void updateOdometerWheelConfiguration(const TWheelConfigurationArray* config);
+void updateOdometerStatus(const TSensorStatus* status);
 
 bool iVehicleSpeedInit();
 bool iVehicleSpeedDestroy();
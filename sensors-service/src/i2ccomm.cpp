@@ -76,11 +76,88 @@
 //standard c library functions
 #include <unistd.h>
 #include <fcntl.h>
+#include <string.h>
+#include <pthread.h>
+
+/** Registered backends replacing the Linux device driver
+ *  The number of I2C busses on typical target devices is small,
+ *  so a fixed size table is sufficient
+ */
+#define I2CCOMM_MAX_BACKENDS 4
+#define I2CCOMM_MAX_DEVICE_NAME 32
+
+typedef struct
+{
+    char i2c_device[I2CCOMM_MAX_DEVICE_NAME];
+    i2cbackend* backend;
+} TI2CBackendEntry;
+
+static TI2CBackendEntry _backends[I2CCOMM_MAX_BACKENDS];
+static pthread_mutex_t _mutex_backends = PTHREAD_MUTEX_INITIALIZER;
+
+static i2cbackend* find_backend(const char* i2c_device)
+{
+    i2cbackend* backend = 0;
+    pthread_mutex_lock(&_mutex_backends);
+    for (int i=0; i<I2CCOMM_MAX_BACKENDS; i++)
+    {
+        if (_backends[i].backend && (0 == strcmp(_backends[i].i2c_device, i2c_device)))
+        {
+            backend = _backends[i].backend;
+        }
+    }
+    pthread_mutex_unlock(&_mutex_backends);
+    return backend;
+}
+
+bool i2ccomm::register_backend(const char* i2c_device, i2cbackend* backend)
+{
+    bool result = false;
+    if (i2c_device && backend && (strlen(i2c_device) < I2CCOMM_MAX_DEVICE_NAME))
+    {
+        pthread_mutex_lock(&_mutex_backends);
+        for (int i=0; (i<I2CCOMM_MAX_BACKENDS) && !result; i++)
+        {
+            if (0 == _backends[i].backend)
+            {
+                strcpy(_backends[i].i2c_device, i2c_device);
+                _backends[i].backend = backend;
+                result = true;
+            }
+        }
+        pthread_mutex_unlock(&_mutex_backends);
+    }
+    return result;
+}
+
+bool i2ccomm::deregister_backend(const char* i2c_device)
+{
+    bool result = false;
+    if (i2c_device)
+    {
+        pthread_mutex_lock(&_mutex_backends);
+        for (int i=0; i<I2CCOMM_MAX_BACKENDS; i++)
+        {
+            if (_backends[i].backend && (0 == strcmp(_backends[i].i2c_device, i2c_device)))
+            {
+                _backends[i].backend = 0;
+                _backends[i].i2c_device[0] = 0;
+                result = true;
+            }
+        }
+        pthread_mutex_unlock(&_mutex_backends);
+    }
+    return result;
+}
 
 
 bool i2ccomm::write_uint8(uint8_t reg, uint8_t data)
 {
     bool result = false;
+    if (_backend)
+    {
+        return _backend->write_uint8(_i2c_addr, reg, data);
+    }
 #ifndef I2C_NOT_AVAILABLE
     __s32 i2c_result;
 
@@ -107,6 +184,10 @@ bool i2ccomm::write_uint8(uint8_t reg, uint8_t data)
 bool i2ccomm::read_uint8(uint8_t reg, uint8_t* data)
 {
     bool result = false;
+    if (_backend)
+    {
+        return _backend->read_block(_i2c_addr, reg, data, 1);
+    }
 #ifndef I2C_NOT_AVAILABLE
     __s32 i2c_result;
 
@@ -145,6 +226,10 @@ bool i2ccomm::read_uint8(uint8_t reg, uint8_t* data)
 bool i2ccomm::read_block(uint8_t reg, uint8_t* data, uint8_t size)
 {
     bool result = false;
+    if (_backend)
+    {
+        return _backend->read_block(_i2c_addr, reg, data, size);
+    }
 #ifndef I2C_NOT_AVAILABLE
     struct i2c_rdwr_ioctl_data i2c_data;
     struct i2c_msg msg[2];
@@ -185,9 +270,130 @@ bool i2ccomm::read_block(uint8_t reg, uint8_t* data, uint8_t size)
 }
 
 
+bool i2cbackend::transfer(const TI2CTransfer transfers[], uint8_t num)
+{
+    bool result = true;
+    for (uint8_t i=0; (i<num) && result; i++)
+    {
+        if (transfers[i].read)
+        {
+            result = read_block(transfers[i].i2c_addr, transfers[i].reg, transfers[i].data, transfers[i].size);
+        }
+        else
+        {
+            for (uint8_t j=0; (j<transfers[i].size) && result; j++)
+            {
+                result = write_uint8(transfers[i].i2c_addr, transfers[i].reg+j, transfers[i].data[j]);
+            }
+        }
+    }
+    return result;
+}
+
+/** Execute several register accesses with 1 single ioctl() call
+ *  Each read access is mapped to two i2c_msg (write register address, then read),
+ *  each write access to one i2c_msg (register address followed by the data).
+ *  The kernel issues a repeated start condition between the messages,
+ *  so the bus is not released during the whole transaction.
+ */
+bool i2ccomm::transfer(const TI2CTransfer transfers[], uint8_t num)
+{
+    bool result = false;
+    TI2CTransfer resolved[I2CCOMM_MAX_TRANSFERS];
+
+    if ((num == 0) || (num > I2CCOMM_MAX_TRANSFERS))
+    {
+        return false;
+    }
+    for (uint8_t i=0; i<num; i++)
+    {
+        if (!transfers[i].read && (transfers[i].size > I2CCOMM_MAX_WRITE_SIZE))
+        {
+            return false;
+        }
+        resolved[i] = transfers[i];
+        if (resolved[i].i2c_addr == 0)
+        {
+            resolved[i].i2c_addr = _i2c_addr;
+        }
+    }
+    if (_backend)
+    {
+        return _backend->transfer(resolved, num);
+    }
+#ifndef I2C_NOT_AVAILABLE
+    struct i2c_rdwr_ioctl_data i2c_data;
+    struct i2c_msg msg[2*I2CCOMM_MAX_TRANSFERS];
+    uint8_t regs[I2CCOMM_MAX_TRANSFERS];
+    uint8_t writes[I2CCOMM_MAX_TRANSFERS][1+I2CCOMM_MAX_WRITE_SIZE];
+    int i2c_result;
+
+    if (_i2c_fd < 0)
+    {
+        /* Invalid file descriptor */
+    }
+    else
+    {
+        i2c_data.msgs = msg;
+        i2c_data.nmsgs = 0;
+
+        for (uint8_t i=0; i<num; i++)
+        {
+            if (resolved[i].read)
+            {
+                regs[i] = resolved[i].reg;
+                msg[i2c_data.nmsgs].addr = resolved[i].i2c_addr;
+                msg[i2c_data.nmsgs].flags = 0;              // write
+                msg[i2c_data.nmsgs].len = 1;                // only the register address
+                msg[i2c_data.nmsgs].buf = (char*)&regs[i];  // typecast to char*: see i2c-dev.h
+                i2c_data.nmsgs++;
+                msg[i2c_data.nmsgs].addr = resolved[i].i2c_addr;
+                msg[i2c_data.nmsgs].flags = I2C_M_RD;       // read command
+                msg[i2c_data.nmsgs].len = resolved[i].size;
+                msg[i2c_data.nmsgs].buf = (char*)resolved[i].data;
+                i2c_data.nmsgs++;
+            }
+            else
+            {
+                writes[i][0] = resolved[i].reg;
+                memcpy(&writes[i][1], resolved[i].data, resolved[i].size);
+                msg[i2c_data.nmsgs].addr = resolved[i].i2c_addr;
+                msg[i2c_data.nmsgs].flags = 0;              // write
+                msg[i2c_data.nmsgs].len = 1+resolved[i].size;
+                msg[i2c_data.nmsgs].buf = (char*)writes[i];
+                i2c_data.nmsgs++;
+            }
+        }
+
+        i2c_result = ioctl(_i2c_fd, I2C_RDWR, &i2c_data);
+
+        if (i2c_result < 0)
+        {
+            /* ERROR HANDLING: i2c transaction failed */
+        }
+        else
+        {
+            result = true;
+        }
+    }
+#endif
+    return result;
+}
+
 bool i2ccomm::init(const char* i2c_device, uint8_t i2c_addr)
 {
     bool result = false;
+    i2cbackend* backend = find_backend(i2c_device);
+    if (backend)
+    {
+        if (backend->probe(i2c_addr))
+        {
+            _backend = backend;
+            _i2c_addr = i2c_addr;
+            result = true;
+        }
+        return result;
+    }
 #ifndef I2C_NOT_AVAILABLE
     _i2c_fd = open(i2c_device, O_RDWR);
     if (_i2c_fd < 0)
@@ -213,6 +419,12 @@ bool i2ccomm::init(const char* i2c_device, uint8_t i2c_addr)
 bool i2ccomm::deinit()
 {
     bool result = false;
+    if (_backend)
+    {
+        _backend = 0;
+        _i2c_addr = 0;
+        return true;
+    }
 #ifndef I2C_NOT_AVAILABLE
     if (_i2c_fd < 0)
     {
@@ -229,3 +441,46 @@ bool i2ccomm::deinit()
     return result;
 }
 
+bool i2csweep::init(const char* i2c_device, uint8_t i2c_addr)
+{
+    _buffer_used = 0;
+    _num_slots = 0;
+    return _i2ccomm.init(i2c_device, i2c_addr);
+}
+
+bool i2csweep::deinit()
+{
+    _buffer_used = 0;
+    _num_slots = 0;
+    return _i2ccomm.deinit();
+}
+
+int i2csweep::add_read(uint8_t i2c_addr, uint8_t reg, uint8_t size)
+{
+    if ((_num_slots >= I2CCOMM_MAX_TRANSFERS) || (size == 0) ||
+        (_buffer_used + size > I2CSWEEP_BUFFER_SIZE))
+    {
+        return -1;
+    }
+    _transfers[_num_slots].i2c_addr = i2c_addr;
+    _transfers[_num_slots].reg = reg;
+    _transfers[_num_slots].read = true;
+    _transfers[_num_slots].size = size;
+    _transfers[_num_slots].data = &_buffer[_buffer_used];
+    _buffer_used += size;
+    return _num_slots++;
+}
+
+bool i2csweep::execute()
+{
+    return (_num_slots > 0) && _i2ccomm.transfer(_transfers, _num_slots);
+}
+
+const uint8_t* i2csweep::get_data(int slot) const
+{
+    if ((slot < 0) || (slot >= _num_slots))
+    {
+        return NULL;
+    }
+    return _transfers[slot].data;
+}
@@ -17,6 +17,79 @@
 
 #include <stdint.h>
 
+/** Maximum number of register accesses in one combined transaction
+  * Each read access requires two i2c_msg, each write access one i2c_msg.
+  * The Linux kernel accepts at most 42 i2c_msg per I2C_RDWR ioctl.
+  */
+#define I2CCOMM_MAX_TRANSFERS 16
+
+/** Maximum number of bytes of a single write access within a combined transaction
+  */
+#define I2CCOMM_MAX_WRITE_SIZE 8
+
+/**
+ * One register access within a combined transaction.
+ * @see i2ccomm::transfer()
+ */
+typedef struct
+{
+    uint8_t i2c_addr;   /**< I2C address (7bit) of the slave. 0 means the slave of the connection */
+    uint8_t reg;        /**< Register (start) address */
+    bool read;          /**< true: read from the registers, false: write to the registers */
+    uint8_t size;       /**< Number of bytes to read or write */
+    uint8_t* data;      /**< Buffer with at least size bytes */
+} TI2CTransfer;
+
+/**
+ * Backend interface for I2C access.
+ * By default, i2ccomm talks to the Linux user space device driver.
+ * A backend registered for a device name via i2ccomm::register_backend()
+ * replaces the device driver for all connections to this device name.
+ * This allows to run the sensor drivers against simulated devices,
+ * e.g. for testing and benchmarking without real hardware.
+ * @see i2csim.h
+ */
+class i2cbackend {
+
+public:
+    virtual ~i2cbackend() {};
+
+    /**
+     * Check whether an I2C slave is reachable
+     * @param i2c_addr the I2C address (7bit) of the I2C slave
+     * @return true if the slave is present
+     */
+    virtual bool probe(uint8_t i2c_addr) = 0;
+
+    /**
+     * Write a 8 bit unsigned integer to a register
+     * @param i2c_addr the I2C address (7bit) of the I2C slave
+     * @param reg register address
+     * @param data value to write to the register
+     * @return true on success
+     */
+    virtual bool write_uint8(uint8_t i2c_addr, uint8_t reg, uint8_t data) = 0;
+
+    /**
+     * Read a block of 8 bit unsigned integers from several consecutive registers.
+     * @param i2c_addr the I2C address (7bit) of the I2C slave
+     * @param reg register start address
+     * @param data returns values read from the registers, buffer must be at least size bytes large
+     * @param size number of bytes to read
+     * @return true on success
+     */
+    virtual bool read_block(uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t size) = 0;
+
+    /**
+     * Execute several register accesses as one combined transaction.
+     * The default implementation executes the accesses one by one.
+     * @param transfers the register accesses, i2c_addr is always set
+     * @param num number of register accesses
+     * @return true on success
+     */
+    virtual bool transfer(const TI2CTransfer transfers[], uint8_t num);
+};
+
 /**
  * Minimalistic wrapper fo Linux I2C access.
  * Only the functions absolutely necessary to access
@@ -31,12 +104,29 @@ class i2ccomm {
 private:
     int _i2c_fd;
     uint8_t _i2c_addr;
+    i2cbackend* _backend;
 
 public:
     /**
      * Constructor
      */
-    i2ccomm(): _i2c_fd (-1), _i2c_addr(0) {};
+    i2ccomm(): _i2c_fd (-1), _i2c_addr(0), _backend(0) {};
+
+    /**
+     * Register a backend which replaces the Linux device driver for an I2C bus.
+     * Only connections initialized after the registration are affected.
+     * @param i2c_device device name of the I2C bus, e.g. "/dev/i2c-1"
+     * @param backend the backend to use, must stay valid until it is deregistered
+     * @return true on success
+     */
+    static bool register_backend(const char* i2c_device, i2cbackend* backend);
+
+    /**
+     * Deregister a backend previously registered by register_backend().
+     * @param i2c_device device name of the I2C bus, e.g. "/dev/i2c-1"
+     * @return true on success
+     */
+    static bool deregister_backend(const char* i2c_device);
 
     /**
      * Initialize a connection to an I2C slave
@@ -76,6 +166,80 @@ public:
      * @return true on success
      */
     bool read_block(uint8_t reg, uint8_t* data, uint8_t size);
+
+    /**
+     * Execute several register reads and writes as one combined transaction.
+     * All accesses are issued with one single I2C_RDWR ioctl() call,
+     * separated by repeated start conditions. This saves system calls
+     * and bus turnaround compared to issuing the accesses one by one.
+     * The accesses may address different slaves on the same bus.
+     * @param transfers the register accesses, executed in the given order
+     * @param num number of register accesses, allowed range 1..I2CCOMM_MAX_TRANSFERS
+     * @return true on success
+     */
+    bool transfer(const TI2CTransfer transfers[], uint8_t num);
+};
+
+/** Total number of bytes which can be read by one sweep
+  */
+#define I2CSWEEP_BUFFER_SIZE 256
+
+/**
+ * Sweep over several slaves on the same I2C bus.
+ * Register blocks of several devices (e.g. IMU, magnetometer, barometer)
+ * are registered once as slots and then read in one combined transaction
+ * per sweep, typically from the reader thread of the master sensor.
+ */
+class i2csweep {
+
+private:
+    i2ccomm _i2ccomm;
+    TI2CTransfer _transfers[I2CCOMM_MAX_TRANSFERS];
+    uint8_t _buffer[I2CSWEEP_BUFFER_SIZE];
+    uint16_t _buffer_used;
+    uint8_t _num_slots;
+
+public:
+    /**
+     * Constructor
+     */
+    i2csweep(): _buffer_used(0), _num_slots(0) {};
+
+    /**
+     * Initialize the connection to the I2C bus
+     * @param i2c_device device name of the I2C bus, e.g. "/dev/i2c-1"
+     * @param i2c_addr the I2C address (7bit) of any slave on the bus, used to verify the connection
+     * @return true on success
+     */
+    bool init(const char* i2c_device, uint8_t i2c_addr);
+
+    /**
+     * Close the connection and remove all slots
+     * @return true on success
+     */
+    bool deinit();
+
+    /**
+     * Add a register block to be read in each sweep
+     * @param i2c_addr the I2C address (7bit) of the slave
+     * @param reg register start address
+     * @param size number of bytes to read
+     * @return the slot number on success, -1 if no more slots or buffer space are available
+     */
+    int add_read(uint8_t i2c_addr, uint8_t reg, uint8_t size);
+
+    /**
+     * Read all slots in one combined transaction
+     * @return true on success
+     */
+    bool execute();
+
+    /**
+     * Get the data read by the last sweep
+     * @param slot the slot number as returned by add_read()
+     * @return pointer to the data of the slot, NULL for an invalid slot
+     */
+    const uint8_t* get_data(int slot) const;
 };
 
 #endif //I2CCOMM
\ No newline at end of file
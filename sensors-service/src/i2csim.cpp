@@ -0,0 +1,499 @@
+/**************************************************************************
+ * @brief Simulated I2C bus and sensor devices
+ *
+ * @details Register map models of the inertial sensors supported by
+ * the sensors service.
+ * The register addresses and conversion factors are duplicated
+ * from mpu6050.cpp and lsm9ds1.cpp on purpose: the models shall
+ * behave like the data sheet, not like the driver.
+ *
+ * @author agent <agent@local>
+ * @copyright Copyright (C) 2026, agent
+ *
+ * @license MPL-2.0 <http://spdx.org/licenses/MPL-2.0>
+ *
+ **************************************************************************/
+
+
+/** ===================================================================
+ * 1.) INCLUDES
+ */
+
+ //provided interface
+#include "i2csim.h"
+
+//standard c library functions
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+
+/** ===================================================================
+ * 2.) Sensor magic numbers
+ */
+
+/** MPU6050 registers and conversion factors
+ *  Source: http://invensense.com/mems/gyro/documents/RM-MPU-6000A-00v4.2.pdf
+ *  Data registers are big endian
+ */
+#define MPU6050_REG_ACCEL_XOUT 0x3B
+#define MPU6050_REG_TEMP_OUT   0x41
+#define MPU6050_REG_GYRO_XOUT  0x43
+#define MPU6050_REG_PWR_MGMT_1 0x6B
+#define MPU6050_REG_WHO_AM_I   0x75
+#define MPU6050_PWR_MGMT_1__SLEEP  0x40
+#define MPU6050_WHO_AM_I       0x68
+#define MPU6050_ACCEL_SCALE    16384.0
+#define MPU6050_TEMP_SCALE     340.0
+#define MPU6050_TEMP_BIAS      36.53
+#define MPU6050_GYRO_SCALE     131.0
+
+/** LSM9DS1 registers and conversion factors
+ *  Source: http://www.st.com/web/en/resource/technical/document/datasheet/DM00103319.pdf
+ *  Data registers are little endian, the axes form a left-handed system
+ */
+#define LSM9DS1_REG_OUT_TEMP        0x15
+#define LSM9DS1_REG_OUT_X_G         0x18
+#define LSM9DS1_REG_OUT_Z_G_H       0x1D
+#define LSM9DS1_REG_OUT_X_XL        0x28
+#define LSM9DS1_REG_OUT_Z_XL_H      0x2D
+#define LSM9DS1_REG_CTRL_REG1_G     0x10
+#define LSM9DS1_REG_CTRL_REG8       0x22
+#define LSM9DS1_REG_WHO_AM_I        0x0F
+#define LSM9DS1_CTRL_REG8__BOOT     0x80
+#define LSM9DS1_CTRL_REG1_G__ODR    0xE0
+#define LSM9DS1_WHO_AM_I            0x68
+#define LSM9DS1_ACCEL_SCALE         16384.0
+#define LSM9DS1_TEMP_SCALE          16.0
+#define LSM9DS1_TEMP_BIAS           27.5
+#define LSM9DS1_GYRO_SCALE          114.3
+
+#define I2CSIM_PI 3.14159265358979323846
+
+
+/** ===================================================================
+ * 3.) PRIVATE FUNCTIONS
+ */
+
+static uint64_t get_timestamp_us()
+{
+    struct timespec time_value;
+    clock_gettime(CLOCK_MONOTONIC, &time_value);
+    return (uint64_t)time_value.tv_sec*1000000 + time_value.tv_nsec/1000;
+}
+
+static void sleep_us(uint64_t us)
+{
+    struct timespec t;
+    t.tv_sec = us / 1000000;
+    t.tv_nsec = (us % 1000000) * 1000;
+    while(nanosleep(&t, &t));
+}
+
+static void put_be16(uint8_t* regs, uint8_t reg, int16_t value)
+{
+    regs[reg] = (uint8_t)(((uint16_t)value) >> 8);
+    regs[(uint8_t)(reg+1)] = (uint8_t)(value & 0xFF);
+}
+
+static void put_le16(uint8_t* regs, uint8_t reg, int16_t value)
+{
+    regs[reg] = (uint8_t)(value & 0xFF);
+    regs[(uint8_t)(reg+1)] = (uint8_t)(((uint16_t)value) >> 8);
+}
+
+
+/** ===================================================================
+ * 4.) i2csimdevice
+ */
+
+i2csimdevice::i2csimdevice(uint8_t i2c_addr):
+    _i2c_addr(i2c_addr),
+    _num_segments(1),
+    _script_duration(0),
+    _loop(false),
+    _script_start(get_timestamp_us()),
+    _accel_noise(0.0),
+    _gyro_noise(0.0),
+    _seed(0x12345678)
+{
+    memset(_regs, 0, sizeof(_regs));
+    //default: vehicle standing still
+    memset(_segments, 0, sizeof(_segments));
+    _segments[0].accel[2] = 1.0;
+    _segments[0].temperature = 25.0;
+}
+
+bool i2csimdevice::set_motion_script(const TI2CSimMotionSegment segments[], uint16_t num_segments, bool loop)
+{
+    if ((segments == 0) || (num_segments == 0) || (num_segments > I2CSIM_MAX_SEGMENTS))
+    {
+        return false;
+    }
+    memcpy(_segments, segments, num_segments*sizeof(TI2CSimMotionSegment));
+    _num_segments = num_segments;
+    _script_duration = 0;
+    for (uint16_t i=0; i<num_segments; i++)
+    {
+        _script_duration += segments[i].duration;
+    }
+    _loop = loop;
+    _script_start = get_timestamp_us();
+    return true;
+}
+
+void i2csimdevice::set_noise(float accel_noise, float gyro_noise)
+{
+    _accel_noise = accel_noise;
+    _gyro_noise = gyro_noise;
+}
+
+void i2csimdevice::write_reg(uint8_t reg, uint8_t data)
+{
+    _regs[reg] = data;
+}
+
+uint8_t i2csimdevice::read_reg(uint8_t reg)
+{
+    return _regs[reg];
+}
+
+uint8_t i2csimdevice::next_reg(uint8_t reg)
+{
+    return reg+1;
+}
+
+float i2csimdevice::noise(float amplitude)
+{
+    if (amplitude == 0.0)
+    {
+        return 0.0;
+    }
+    //linear congruential generator - deterministic and cheap
+    _seed = _seed * 1664525 + 1013904223;
+    return amplitude * ((float)(_seed >> 8) / (float)(1 << 23) - 1.0);
+}
+
+void i2csimdevice::get_motion(float accel[3], float gyro[3], float* temperature)
+{
+    uint64_t now = get_timestamp_us();
+    uint64_t t_ms = (now - _script_start) / 1000;
+    const TI2CSimMotionSegment* segment = &_segments[_num_segments-1];
+
+    if (_loop && (_script_duration > 0))
+    {
+        t_ms = t_ms % _script_duration;
+    }
+    for (uint16_t i=0; i<_num_segments; i++)
+    {
+        if ((_segments[i].duration == 0) || (t_ms < _segments[i].duration))
+        {
+            segment = &_segments[i];
+            break;
+        }
+        t_ms -= _segments[i].duration;
+    }
+
+    float vibration = 0.0;
+    if (segment->vib_amplitude != 0.0)
+    {
+        vibration = segment->vib_amplitude * sin(2.0*I2CSIM_PI*segment->vib_frequency*(now/1000000.0));
+    }
+    for (int i=0; i<3; i++)
+    {
+        accel[i] = segment->accel[i] + vibration + noise(_accel_noise);
+        gyro[i] = segment->gyro[i] + noise(_gyro_noise);
+    }
+    *temperature = segment->temperature;
+}
+
+int16_t i2csimdevice::to_raw(float value, float scale, float bias)
+{
+    float raw = (value - bias) * scale;
+    if (raw > 32767.0)
+    {
+        raw = 32767.0;
+    }
+    if (raw < -32768.0)
+    {
+        raw = -32768.0;
+    }
+    return (int16_t)lrintf(raw);
+}
+
+
+/** ===================================================================
+ * 5.) mpu6050sim
+ */
+
+mpu6050sim::mpu6050sim(uint8_t i2c_addr): i2csimdevice(i2c_addr)
+{
+    _regs[MPU6050_REG_PWR_MGMT_1] = MPU6050_PWR_MGMT_1__SLEEP;
+    _regs[MPU6050_REG_WHO_AM_I] = MPU6050_WHO_AM_I;
+}
+
+//all data registers are latched, whatever the start address of the read
+void mpu6050sim::begin_read(uint8_t)
+{
+    float accel[3];
+    float gyro[3];
+    float temperature;
+
+    if (_regs[MPU6050_REG_PWR_MGMT_1] & MPU6050_PWR_MGMT_1__SLEEP)
+    {
+        return;
+    }
+    get_motion(accel, gyro, &temperature);
+    for (int i=0; i<3; i++)
+    {
+        put_be16(_regs, MPU6050_REG_ACCEL_XOUT+2*i, to_raw(accel[i], MPU6050_ACCEL_SCALE, 0.0));
+        put_be16(_regs, MPU6050_REG_GYRO_XOUT+2*i, to_raw(gyro[i], MPU6050_GYRO_SCALE, 0.0));
+    }
+    put_be16(_regs, MPU6050_REG_TEMP_OUT, to_raw(temperature, MPU6050_TEMP_SCALE, MPU6050_TEMP_BIAS));
+}
+
+
+/** ===================================================================
+ * 6.) lsm9ds1sim
+ */
+
+lsm9ds1sim::lsm9ds1sim(uint8_t i2c_addr): i2csimdevice(i2c_addr)
+{
+    _regs[LSM9DS1_REG_WHO_AM_I] = LSM9DS1_WHO_AM_I;
+}
+
+void lsm9ds1sim::write_reg(uint8_t reg, uint8_t data)
+{
+    if ((reg == LSM9DS1_REG_CTRL_REG8) && (data & LSM9DS1_CTRL_REG8__BOOT))
+    {
+        //reboot: back to power down, BOOT bit clears itself
+        _regs[LSM9DS1_REG_CTRL_REG1_G] = 0;
+        data &= ~LSM9DS1_CTRL_REG8__BOOT;
+    }
+    _regs[reg] = data;
+}
+
+void lsm9ds1sim::begin_read(uint8_t)
+{
+    float accel[3];
+    float gyro[3];
+    float temperature;
+
+    if (0 == (_regs[LSM9DS1_REG_CTRL_REG1_G] & LSM9DS1_CTRL_REG1_G__ODR))
+    {
+        return;
+    }
+    get_motion(accel, gyro, &temperature);
+    //left-handed axis system: the y axis is inverted
+    accel[1] = -accel[1];
+    gyro[1] = -gyro[1];
+    for (int i=0; i<3; i++)
+    {
+        put_le16(_regs, LSM9DS1_REG_OUT_X_XL+2*i, to_raw(accel[i], LSM9DS1_ACCEL_SCALE, 0.0));
+        put_le16(_regs, LSM9DS1_REG_OUT_X_G+2*i, to_raw(gyro[i], LSM9DS1_GYRO_SCALE, 0.0));
+    }
+    put_le16(_regs, LSM9DS1_REG_OUT_TEMP, to_raw(temperature, LSM9DS1_TEMP_SCALE, LSM9DS1_TEMP_BIAS));
+}
+
+uint8_t lsm9ds1sim::next_reg(uint8_t reg)
+{
+    //See datasheet, section 3.3
+    if (reg == LSM9DS1_REG_OUT_Z_G_H)
+    {
+        return LSM9DS1_REG_OUT_X_XL;
+    }
+    if (reg == LSM9DS1_REG_OUT_Z_XL_H)
+    {
+        return LSM9DS1_REG_OUT_X_G;
+    }
+    return reg+1;
+}
+
+
+/** ===================================================================
+ * 7.) i2csimbus
+ */
+
+i2csimbus::i2csimbus():
+    _transaction_us(0),
+    _byte_us(0),
+    _error_interval(0),
+    _transactions(0),
+    _bytes(0),
+    _errors(0)
+{
+    pthread_mutex_init(&_mutex, NULL);
+    memset(_devices, 0, sizeof(_devices));
+}
+
+i2csimbus::~i2csimbus()
+{
+    pthread_mutex_destroy(&_mutex);
+}
+
+bool i2csimbus::attach(i2csimdevice* device)
+{
+    bool result = false;
+    pthread_mutex_lock(&_mutex);
+    if (device && (find_device(device->get_addr()) == 0))
+    {
+        for (int i=0; (i<I2CSIM_MAX_DEVICES) && !result; i++)
+        {
+            if (_devices[i] == 0)
+            {
+                _devices[i] = device;
+                result = true;
+            }
+        }
+    }
+    pthread_mutex_unlock(&_mutex);
+    return result;
+}
+
+void i2csimbus::set_latency(uint32_t transaction_us, uint32_t byte_us)
+{
+    pthread_mutex_lock(&_mutex);
+    _transaction_us = transaction_us;
+    _byte_us = byte_us;
+    pthread_mutex_unlock(&_mutex);
+}
+
+void i2csimbus::set_error_injection(uint32_t error_interval)
+{
+    pthread_mutex_lock(&_mutex);
+    _error_interval = error_interval;
+    pthread_mutex_unlock(&_mutex);
+}
+
+void i2csimbus::get_statistics(uint64_t* transactions, uint64_t* bytes, uint64_t* errors)
+{
+    pthread_mutex_lock(&_mutex);
+    if (transactions)
+    {
+        *transactions = _transactions;
+    }
+    if (bytes)
+    {
+        *bytes = _bytes;
+    }
+    if (errors)
+    {
+        *errors = _errors;
+    }
+    pthread_mutex_unlock(&_mutex);
+}
+
+i2csimdevice* i2csimbus::find_device(uint8_t i2c_addr)
+{
+    for (int i=0; i<I2CSIM_MAX_DEVICES; i++)
+    {
+        if (_devices[i] && (_devices[i]->get_addr() == i2c_addr))
+        {
+            return _devices[i];
+        }
+    }
+    return 0;
+}
+
+/**
+ * Account for one transaction: apply latency and error injection.
+ * Must be called with _mutex locked.
+ * @return false if the transaction shall fail
+ */
+bool i2csimbus::transaction(uint16_t num_bytes)
+{
+    _transactions++;
+    _bytes += num_bytes;
+    uint64_t latency = _transaction_us + (uint64_t)_byte_us*num_bytes;
+    if (latency > 0)
+    {
+        sleep_us(latency);
+    }
+    if (_error_interval && ((_transactions % _error_interval) == 0))
+    {
+        _errors++;
+        return false;
+    }
+    return true;
+}
+
+bool i2csimbus::probe(uint8_t i2c_addr)
+{
+    pthread_mutex_lock(&_mutex);
+    bool result = (find_device(i2c_addr) != 0);
+    pthread_mutex_unlock(&_mutex);
+    return result;
+}
+
+bool i2csimbus::write_uint8(uint8_t i2c_addr, uint8_t reg, uint8_t data)
+{
+    bool result = false;
+    pthread_mutex_lock(&_mutex);
+    i2csimdevice* device = find_device(i2c_addr);
+    if (device && transaction(2))
+    {
+        device->write_reg(reg, data);
+        result = true;
+    }
+    pthread_mutex_unlock(&_mutex);
+    return result;
+}
+
+bool i2csimbus::read_block(uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t size)
+{
+    bool result = false;
+    pthread_mutex_lock(&_mutex);
+    i2csimdevice* device = find_device(i2c_addr);
+    if (device && transaction(1+size))
+    {
+        device->begin_read(reg);
+        for (uint8_t i=0; i<size; i++)
+        {
+            data[i] = device->read_reg(reg);
+            reg = device->next_reg(reg);
+        }
+        result = true;
+    }
+    pthread_mutex_unlock(&_mutex);
+    return result;
+}
+
+/**
+ * Combined transaction: the fixed latency applies only once,
+ * as the bus is not released between the register accesses.
+ */
+bool i2csimbus::transfer(const TI2CTransfer transfers[], uint8_t num)
+{
+    bool result = true;
+    uint16_t num_bytes = 0;
+    pthread_mutex_lock(&_mutex);
+    for (uint8_t i=0; i<num; i++)
+    {
+        num_bytes += 1+transfers[i].size;
+        result = result && (find_device(transfers[i].i2c_addr) != 0);
+    }
+    result = result && transaction(num_bytes);
+    for (uint8_t i=0; (i<num) && result; i++)
+    {
+        i2csimdevice* device = find_device(transfers[i].i2c_addr);
+        uint8_t reg = transfers[i].reg;
+        if (transfers[i].read)
+        {
+            device->begin_read(reg);
+        }
+        for (uint8_t j=0; j<transfers[i].size; j++)
+        {
+            if (transfers[i].read)
+            {
+                transfers[i].data[j] = device->read_reg(reg);
+            }
+            else
+            {
+                device->write_reg(reg, transfers[i].data[j]);
+            }
+            reg = device->next_reg(reg);
+        }
+    }
+    pthread_mutex_unlock(&_mutex);
+    return result;
+}
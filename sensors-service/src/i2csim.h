@@ -0,0 +1,235 @@
+/**************************************************************************
+ * @brief Simulated I2C bus and sensor devices
+ *
+ * @details Register map models of the inertial sensors supported by
+ * the sensors service. The simulated bus can be registered as
+ * i2ccomm backend so that the unmodified sensor drivers (mpu6050.cpp,
+ * lsm9ds1.cpp) can be exercised without real hardware, e.g. in CI or
+ * to profile the drivers on a development host.
+ * @see i2ccomm.h
+ *
+ * @author agent <agent@local>
+ * @copyright Copyright (C) 2026, agent
+ *
+ * @license MPL-2.0 <http://spdx.org/licenses/MPL-2.0>
+ *
+ **************************************************************************/
+
+#ifndef INCLUDE_I2CSIM
+#define INCLUDE_I2CSIM
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "i2ccomm.h"
+
+/** Maximum number of segments of a motion script
+  */
+#define I2CSIM_MAX_SEGMENTS 16
+
+/** Maximum number of devices attached to a simulated bus
+  */
+#define I2CSIM_MAX_DEVICES 4
+
+/**
+ * One segment of a motion script.
+ * The simulated sensor outputs the constant values of the segment,
+ * superimposed by a sinusoidal vibration and noise.
+ * Measurement units are the same as for the sensor drivers:
+ *   For accelerometer values, the unit is g
+ *   For gyro values, the unit is degrees per seconds (deg/s)
+ */
+typedef struct
+{
+    uint32_t duration;      /**< Duration of the segment in ms. 0 means that the segment lasts forever */
+    float accel[3];         /**< Acceleration along the x,y,z axes [g] */
+    float gyro[3];          /**< Angular rate around the x,y,z axes [deg/s] */
+    float vib_amplitude;    /**< Amplitude of a vibration added to all acceleration axes [g] */
+    float vib_frequency;    /**< Frequency of the vibration [Hz] */
+    float temperature;      /**< Temperature [degrees celsius] */
+} TI2CSimMotionSegment;
+
+/**
+ * Register map model of an I2C slave.
+ * Derived classes provide the sensor specific behaviour.
+ * Not thread safe on its own: all accesses are serialized by i2csimbus.
+ */
+class i2csimdevice {
+
+public:
+    /**
+     * Constructor
+     * @param i2c_addr the I2C address (7bit) of the simulated slave
+     */
+    i2csimdevice(uint8_t i2c_addr);
+
+    virtual ~i2csimdevice() {};
+
+    /**
+     * Get the I2C address of the simulated slave
+     */
+    uint8_t get_addr() const { return _i2c_addr; };
+
+    /**
+     * Set the motion script which controls the simulated sensor values.
+     * The script starts immediately.
+     * @param segments array of motion segments, will be copied
+     * @param num_segments number of segments, allowed range 1..I2CSIM_MAX_SEGMENTS
+     * @param loop if true, the script is repeated after the last segment, otherwise the last segment is held
+     * @return true on success
+     */
+    bool set_motion_script(const TI2CSimMotionSegment segments[], uint16_t num_segments, bool loop);
+
+    /**
+     * Set the amplitude of the uniformly distributed noise added to the sensor values.
+     * The noise is generated by a pseudo random generator with fixed seed.
+     * @param accel_noise noise amplitude for acceleration [g]
+     * @param gyro_noise noise amplitude for angular rate [deg/s]
+     */
+    void set_noise(float accel_noise, float gyro_noise);
+
+    /**
+     * Called by the bus when a register is written.
+     * Default behaviour: store the value in the register map.
+     */
+    virtual void write_reg(uint8_t reg, uint8_t data);
+
+    /**
+     * Called by the bus at the start of each read transaction.
+     * Sensors use this to latch the current measurement into the data registers.
+     * @param reg register start address of the read transaction
+     */
+    virtual void begin_read(uint8_t /*reg*/) {}
+
+    /**
+     * Called by the bus for each register read.
+     * Default behaviour: return the value from the register map.
+     */
+    virtual uint8_t read_reg(uint8_t reg);
+
+    /**
+     * Address of the register which is read after reg within a block read.
+     * Default behaviour: auto-increment.
+     */
+    virtual uint8_t next_reg(uint8_t reg);
+
+protected:
+    /**
+     * Evaluate the motion script at the current time
+     * @param accel returns the acceleration [g]
+     * @param gyro returns the angular rate [deg/s]
+     * @param temperature returns the temperature [degrees celsius]
+     */
+    void get_motion(float accel[3], float gyro[3], float* temperature);
+
+    /**
+     * Convert a physical value to a raw sensor value with saturation
+     */
+    static int16_t to_raw(float value, float scale, float bias);
+
+    uint8_t _regs[256];
+
+private:
+    float noise(float amplitude);
+
+    uint8_t _i2c_addr;
+    TI2CSimMotionSegment _segments[I2CSIM_MAX_SEGMENTS];
+    uint16_t _num_segments;
+    uint32_t _script_duration;
+    bool _loop;
+    uint64_t _script_start;
+    float _accel_noise;
+    float _gyro_noise;
+    uint32_t _seed;
+};
+
+/**
+ * Register map model of the MPU6050.
+ * Data registers are only updated after wake up via PWR_MGMT_1.
+ */
+class mpu6050sim: public i2csimdevice {
+
+public:
+    mpu6050sim(uint8_t i2c_addr = 0x68);
+    virtual void begin_read(uint8_t reg);
+};
+
+/**
+ * Register map model of the LSM9DS1 accelerometer/gyroscope.
+ * Data registers are only updated when the ODR in CTRL_REG1_G is set.
+ * Block reads starting at OUT_X_G wrap from OUT_Z_XL back to OUT_X_G
+ * and skip the gap between gyroscope and accelerometer registers.
+ */
+class lsm9ds1sim: public i2csimdevice {
+
+public:
+    lsm9ds1sim(uint8_t i2c_addr = 0x6A);
+    virtual void write_reg(uint8_t reg, uint8_t data);
+    virtual void begin_read(uint8_t reg);
+    virtual uint8_t next_reg(uint8_t reg);
+};
+
+/**
+ * Simulated I2C bus.
+ * Register it via i2ccomm::register_backend() to route the I2C
+ * accesses of the sensor drivers to the attached simulated devices.
+ * All transactions are serialized like on a real bus.
+ */
+class i2csimbus: public i2cbackend {
+
+public:
+    i2csimbus();
+    virtual ~i2csimbus();
+
+    /**
+     * Attach a simulated device to the bus
+     * @param device the device, must stay valid as long as the bus is used
+     * @return true on success
+     */
+    bool attach(i2csimdevice* device);
+
+    /**
+     * Configure the simulated bus latency.
+     * The calling thread is blocked for the duration of each transaction.
+     * @param transaction_us fixed latency per transaction in us (addressing, turnaround)
+     * @param byte_us additional latency per transferred byte in us (ca. 25us at 400kHz)
+     */
+    void set_latency(uint32_t transaction_us, uint32_t byte_us);
+
+    /**
+     * Configure error injection.
+     * @param error_interval every error_interval-th transaction fails. 0 disables error injection.
+     */
+    void set_error_injection(uint32_t error_interval);
+
+    /**
+     * Get the bus statistics
+     * A combined transaction (see i2ccomm::transfer()) counts as one transaction.
+     * Any pointer may be NULL to indicate that the corresponding value is not requested
+     * @param transactions returns the number of transactions
+     * @param bytes returns the number of transferred bytes including register addresses
+     * @param errors returns the number of failed transactions
+     */
+    void get_statistics(uint64_t* transactions, uint64_t* bytes, uint64_t* errors);
+
+    //i2cbackend interface
+    virtual bool probe(uint8_t i2c_addr);
+    virtual bool write_uint8(uint8_t i2c_addr, uint8_t reg, uint8_t data);
+    virtual bool read_block(uint8_t i2c_addr, uint8_t reg, uint8_t* data, uint8_t size);
+    virtual bool transfer(const TI2CTransfer transfers[], uint8_t num);
+
+private:
+    i2csimdevice* find_device(uint8_t i2c_addr);
+    bool transaction(uint16_t num_bytes);
+
+    pthread_mutex_t _mutex;
+    i2csimdevice* _devices[I2CSIM_MAX_DEVICES];
+    uint32_t _transaction_us;
+    uint32_t _byte_us;
+    uint32_t _error_interval;
+    uint64_t _transactions;
+    uint64_t _bytes;
+    uint64_t _errors;
+};
+
+#endif //INCLUDE_I2CSIM
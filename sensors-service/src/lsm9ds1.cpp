@@ -109,6 +109,12 @@ static bool _average;
 static pthread_mutex_t _mutex_cb  = PTHREAD_MUTEX_INITIALIZER;
 static volatile LSM9DS1Callback _cb = 0;
 
+/** Real-time configuration and timing statistics of the reader thread
+ */
+static TRtSchedConfig _rt_config = {0, -1, false};
+static pthread_mutex_t _mutex_stats  = PTHREAD_MUTEX_INITIALIZER;
+static TRtSchedStatistics _stats;
+
 static i2ccomm _i2ccomm;
 
 static bool lsm9ds1_config()
@@ -153,29 +159,13 @@ static float conv_gyro(int16_t raw_gyro)
     return raw_gyro / LSM9DS1_GYRO_SCALE;
 }
 
-static uint64_t sleep_until(uint64_t wakeup)
-{
-    uint64_t start =  lsm9ds1_get_timestamp();
-
-    if (wakeup > start)
-    {
-        uint64_t diff = wakeup - start;
-        struct timespec t;
-        t.tv_sec = diff / 1000;
-        t.tv_nsec = (diff - t.tv_sec*1000) * 1000000;
-        while(nanosleep(&t, &t));
-    }
-
-    uint64_t stop =  lsm9ds1_get_timestamp();
-    return stop-start;
-}
-
 static bool fire_callback(const TLSM9DS1Vector3D acceleration[], const TLSM9DS1Vector3D gyro_angular_rate[], const float temperature[], const uint64_t timestamp[], const uint16_t num_elements, bool average)
 {
     pthread_mutex_lock(&_mutex_cb);
     if (_cb)
     {
-        if (average)
+        //a failed read delivers no samples, there is nothing to average
+        if (average && (num_elements > 0))
         {
             TLSM9DS1Vector3D av_acceleration = acceleration[0];
             TLSM9DS1Vector3D av_gyro_angular_rate = gyro_angular_rate[0];
@@ -206,6 +196,7 @@ static bool fire_callback(const TLSM9DS1Vector3D acceleration[], const TLSM9DS1V
         }
     }
     pthread_mutex_unlock(&_mutex_cb);
+    return true;
 }
 
 /**
@@ -221,12 +212,29 @@ static void* lsm9ds1_reader_thread(void* param)
 
     uint16_t sample_idx = 0;
 
-    uint64_t next =  lsm9ds1_get_timestamp();
-    uint64_t next_cb = next;
+    //apply the real-time configuration from within the reader thread
+    bool realtime = false;
+    if ((_rt_config.priority > 0) || (_rt_config.cpu >= 0) || _rt_config.lock_memory)
+    {
+        realtime = rtsched_apply(&_rt_config);
+    }
+    pthread_mutex_lock(&_mutex_stats);
+    rtsched_reset_statistics(&_stats);
+    _stats.realtime = realtime;
+    pthread_mutex_unlock(&_mutex_stats);
+
+    //deadlines with ns resolution to avoid accumulating rounding errors
+    const uint64_t interval = _sample_interval*1000000;
+    uint64_t next = rtsched_get_time();
+    uint64_t wakeup = next;
+    uint64_t next_cb = lsm9ds1_get_timestamp();
 
     while (_lsm9ds1_reader_loop)
     {
-        if (lsm9ds1_read_accel_gyro(&acceleration[sample_idx], &gyro_angular_rate[sample_idx], &temperature[sample_idx], &timestamp[sample_idx]))
+        uint64_t read_start = rtsched_get_time();
+        bool read_ok = lsm9ds1_read_accel_gyro(&acceleration[sample_idx], &gyro_angular_rate[sample_idx], &temperature[sample_idx], &timestamp[sample_idx]);
+        uint64_t read_stop = rtsched_get_time();
+        if (read_ok)
         {
             sample_idx++;
         }
@@ -236,6 +244,9 @@ static void* lsm9ds1_reader_thread(void* param)
             //TODO fire error callback!!!!! TODO
         }
 
+        pthread_mutex_lock(&_mutex_stats);
+        rtsched_update_statistics(&_stats, next, wakeup, interval, read_stop-read_start, read_ok);
+        pthread_mutex_unlock(&_mutex_stats);
 
         //fire callback when either the requested number of samples has been acquired or the corresponding time is over
         if ((sample_idx == _num_samples) || (lsm9ds1_get_timestamp() > next_cb))
@@ -245,9 +256,10 @@ static void* lsm9ds1_reader_thread(void* param)
             next_cb += _sample_interval*_num_samples;
         }
         //wait until next sampling timeslot
-        next = next + _sample_interval;
-        sleep_until(next);
+        next = next + interval;
+        wakeup = rtsched_sleep_until(next);
     }
+    return NULL;
 }
 
 
@@ -317,21 +329,35 @@ bool lsm9ds1_read_accel_gyro(TLSM9DS1Vector3D* acceleration, TLSM9DS1Vector3D* g
         *timestamp = lsm9ds1_get_timestamp();
     }
 
+    //temperature and gyro/accel blocks are read in one combined transaction
+    TI2CTransfer transfers[2];
+    uint8_t num_transfers = 0;
     if (temperature)
     {
-        if (_i2ccomm.read_block(LSM9DS1_REG_OUT_TEMP, block+12, 2))
+        transfers[num_transfers].i2c_addr = 0;
+        transfers[num_transfers].reg = LSM9DS1_REG_OUT_TEMP;
+        transfers[num_transfers].read = true;
+        transfers[num_transfers].size = 2;
+        transfers[num_transfers].data = block+12;
+        num_transfers++;
+    }
+    if (start_reg)
+    {
+        transfers[num_transfers].i2c_addr = 0;
+        transfers[num_transfers].reg = start_reg;
+        transfers[num_transfers].read = true;
+        transfers[num_transfers].size = num_bytes;
+        transfers[num_transfers].data = block+start;
+        num_transfers++;
+    }
+
+    if (num_transfers && _i2ccomm.transfer(transfers, num_transfers))
+    {
+        if (temperature)
         {
             value = (((int16_t)block[13]) << 8) | block[12];
             *temperature = conv_temp(value);
         }
-        else
-        {
-            result = false;
-        }
-    }
-
-    if (start_reg && _i2ccomm.read_block(start_reg, block+start, num_bytes))
-    {
         /* GENIVI specifies, that x,y,z axes form a right-handed coordinate system.
          * The LSM9DS1 x,y,z axes form a left-handed coordinate system.
          * Therefore the y-axis values are inverted
@@ -378,9 +404,9 @@ bool lsm9ds1_register_callback(LSM9DS1Callback callback)
 
 bool lsm9ds1_deregister_callback(LSM9DS1Callback callback)
 {
-    if(_cb == callback && _cb != 0)
+    if(_cb != callback || _cb == 0)
     {
-        return false; //if already registered
+        return false; //if not registered
     }
 
     pthread_mutex_lock(&_mutex_cb);
@@ -429,6 +455,47 @@ bool lsm9ds1_stop_reader_thread()
     return true;
 }
 
+bool lsm9ds1_set_realtime_config(const TRtSchedConfig* config)
+{
+    if (_lsm9ds1_reader_loop)
+    {
+        return false; //thread already running
+    }
+    if (config)
+    {
+        _rt_config = *config;
+    }
+    else
+    {
+        _rt_config.priority = 0;
+        _rt_config.cpu = -1;
+        _rt_config.lock_memory = false;
+    }
+    return true;
+}
+
+bool lsm9ds1_get_statistics(TRtSchedStatistics* stats)
+{
+    if (stats == NULL)
+    {
+        return false;
+    }
+    pthread_mutex_lock(&_mutex_stats);
+    *stats = _stats;
+    pthread_mutex_unlock(&_mutex_stats);
+    return true;
+}
+
+bool lsm9ds1_reset_statistics()
+{
+    pthread_mutex_lock(&_mutex_stats);
+    bool realtime = _stats.realtime;
+    rtsched_reset_statistics(&_stats);
+    _stats.realtime = realtime;
+    pthread_mutex_unlock(&_mutex_stats);
+    return true;
+}
+
 uint64_t lsm9ds1_get_timestamp()
 {
   struct timespec time_value;
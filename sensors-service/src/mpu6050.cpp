@@ -98,6 +98,12 @@ static bool _average;
 static pthread_mutex_t _mutex_cb  = PTHREAD_MUTEX_INITIALIZER;
 static volatile MPU6050Callback _cb = 0;
 
+/** Real-time configuration and timing statistics of the reader thread
+ */
+static TRtSchedConfig _rt_config = {0, -1, false};
+static pthread_mutex_t _mutex_stats  = PTHREAD_MUTEX_INITIALIZER;
+static TRtSchedStatistics _stats;
+
 static i2ccomm _i2ccomm;
 
 static bool mpu6050_wakeup()
@@ -140,29 +146,13 @@ static float conv_gyro(int16_t raw_gyro)
     return raw_gyro / MPU6050_GYRO_SCALE;
 }
 
-static uint64_t sleep_until(uint64_t wakeup)
-{
-    uint64_t start =  mpu6050_get_timestamp();
-
-    if (wakeup > start)
-    {
-        uint64_t diff = wakeup - start;
-        struct timespec t;
-        t.tv_sec = diff / 1000;
-        t.tv_nsec = (diff - t.tv_sec*1000) * 1000000;
-        while(nanosleep(&t, &t));
-    }
-
-    uint64_t stop =  mpu6050_get_timestamp();
-    return stop-start;
-}
-
 static bool fire_callback(const TMPU6050Vector3D acceleration[], const TMPU6050Vector3D gyro_angular_rate[], const float temperature[], const uint64_t timestamp[], const uint16_t num_elements, bool average)
 {
     pthread_mutex_lock(&_mutex_cb);
     if (_cb)
     {
-        if (average)
+        //a failed read delivers no samples, there is nothing to average
+        if (average && (num_elements > 0))
         {
             TMPU6050Vector3D av_acceleration = acceleration[0];
             TMPU6050Vector3D av_gyro_angular_rate = gyro_angular_rate[0];
@@ -193,6 +183,7 @@ static bool fire_callback(const TMPU6050Vector3D acceleration[], const TMPU6050V
         }
     }
     pthread_mutex_unlock(&_mutex_cb);
+    return true;
 }
 
 /**
@@ -208,12 +199,29 @@ static void* mpu6050_reader_thread(void* param)
 
     uint16_t sample_idx = 0;
 
-    uint64_t next =  mpu6050_get_timestamp();
-    uint64_t next_cb = next;
+    //apply the real-time configuration from within the reader thread
+    bool realtime = false;
+    if ((_rt_config.priority > 0) || (_rt_config.cpu >= 0) || _rt_config.lock_memory)
+    {
+        realtime = rtsched_apply(&_rt_config);
+    }
+    pthread_mutex_lock(&_mutex_stats);
+    rtsched_reset_statistics(&_stats);
+    _stats.realtime = realtime;
+    pthread_mutex_unlock(&_mutex_stats);
+
+    //deadlines with ns resolution to avoid accumulating rounding errors
+    const uint64_t interval = _sample_interval*1000000;
+    uint64_t next = rtsched_get_time();
+    uint64_t wakeup = next;
+    uint64_t next_cb = mpu6050_get_timestamp();
 
     while (_mpu6050_reader_loop)
     {
-        if (mpu6050_read_accel_gyro(&acceleration[sample_idx], &gyro_angular_rate[sample_idx], &temperature[sample_idx], &timestamp[sample_idx]))
+        uint64_t read_start = rtsched_get_time();
+        bool read_ok = mpu6050_read_accel_gyro(&acceleration[sample_idx], &gyro_angular_rate[sample_idx], &temperature[sample_idx], &timestamp[sample_idx]);
+        uint64_t read_stop = rtsched_get_time();
+        if (read_ok)
         {
             sample_idx++;
         }
@@ -223,6 +231,9 @@ static void* mpu6050_reader_thread(void* param)
             //TODO fire error callback!!!!! TODO
         }
 
+        pthread_mutex_lock(&_mutex_stats);
+        rtsched_update_statistics(&_stats, next, wakeup, interval, read_stop-read_start, read_ok);
+        pthread_mutex_unlock(&_mutex_stats);
 
         //fire callback when either the requested number of samples has been acquired or the corresponding time is over
         if ((sample_idx == _num_samples) || (mpu6050_get_timestamp() > next_cb))
@@ -232,9 +243,10 @@ static void* mpu6050_reader_thread(void* param)
             next_cb += _sample_interval*_num_samples;
         }
         //wait until next sampling timeslot
-        next = next + _sample_interval;
-        sleep_until(next);
+        next = next + interval;
+        wakeup = rtsched_sleep_until(next);
     }
+    return NULL;
 }
 
 
@@ -346,9 +358,9 @@ bool mpu6050_register_callback(MPU6050Callback callback)
 
 bool mpu6050_deregister_callback(MPU6050Callback callback)
 {
-    if(_cb == callback && _cb != 0)
+    if(_cb != callback || _cb == 0)
     {
-        return false; //if already registered
+        return false; //if not registered
     }
 
     pthread_mutex_lock(&_mutex_cb);
@@ -397,6 +409,47 @@ bool mpu6050_stop_reader_thread()
     return true;
 }
 
+bool mpu6050_set_realtime_config(const TRtSchedConfig* config)
+{
+    if (_mpu6050_reader_loop)
+    {
+        return false; //thread already running
+    }
+    if (config)
+    {
+        _rt_config = *config;
+    }
+    else
+    {
+        _rt_config.priority = 0;
+        _rt_config.cpu = -1;
+        _rt_config.lock_memory = false;
+    }
+    return true;
+}
+
+bool mpu6050_get_statistics(TRtSchedStatistics* stats)
+{
+    if (stats == NULL)
+    {
+        return false;
+    }
+    pthread_mutex_lock(&_mutex_stats);
+    *stats = _stats;
+    pthread_mutex_unlock(&_mutex_stats);
+    return true;
+}
+
+bool mpu6050_reset_statistics()
+{
+    pthread_mutex_lock(&_mutex_stats);
+    bool realtime = _stats.realtime;
+    rtsched_reset_statistics(&_stats);
+    _stats.realtime = realtime;
+    pthread_mutex_unlock(&_mutex_stats);
+    return true;
+}
+
 uint64_t mpu6050_get_timestamp()
 {
   struct timespec time_value;
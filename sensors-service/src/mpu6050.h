@@ -26,6 +26,8 @@ extern "C" {
 #include <stdbool.h>
 #include <stdint.h>
 #include <math.h>
+
+#include "rtsched.h"
  
  
 /** Part 0: I2C device names and device addresses
@@ -164,6 +166,32 @@ bool mpu6050_start_reader_thread(uint64_t sample_interval, uint16_t num_samples,
  */
 bool mpu6050_stop_reader_thread();
 
+/**
+ * Configure real-time scheduling of the MPU6050 reader thread.
+ * The configuration is applied by the reader thread itself when it starts,
+ * so it must be set before calling mpu6050_start_reader_thread().
+ * If it cannot be applied (e.g. missing privileges), the thread runs with default scheduling,
+ * see TRtSchedStatistics.realtime.
+ * @param config the real-time configuration. NULL restores the default scheduling.
+ * @return True on success.
+ */
+bool mpu6050_set_realtime_config(const TRtSchedConfig* config);
+
+/**
+ * Get the timing statistics of the MPU6050 reader thread.
+ * The reader thread wakes up at absolute deadlines spaced by the sample interval.
+ * The statistics describe how late it actually woke up and how long the sensor read took.
+ * @param stats returns the statistics since the thread has been started or the statistics have been reset
+ * @return True on success.
+ */
+bool mpu6050_get_statistics(TRtSchedStatistics* stats);
+
+/**
+ * Reset the timing statistics of the MPU6050 reader thread.
+ * @return True on success.
+ */
+bool mpu6050_reset_statistics();
+
 /** Part 3: Utility functions and conversion factors
  *
  */
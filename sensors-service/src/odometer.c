@@ -0,0 +1,312 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup SensorsService
+* \brief Odometer and wheel odometry derived from the wheel rotation data
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <math.h>
+
+#include "globals.h"
+#include "odometer.h"
+#include "wheelodometry.h"
+
+//wheel data is processed in chunks of this size, so that no dynamic memory is needed
+#define ODOMETER_CHUNK_SIZE 32
+
+static pthread_mutex_t mutexCb  = PTHREAD_MUTEX_INITIALIZER;     //protects the callbacks
+static pthread_mutex_t mutexData = PTHREAD_MUTEX_INITIALIZER;    //protects the data
+static pthread_mutex_t mutexEngine = PTHREAD_MUTEX_INITIALIZER;  //protects the odometry engine and the output buffers
+
+static volatile OdometerCallback cbOdometer = 0;
+static TOdometerData gOdometerData = {0};
+static volatile WheelOdometryCallback cbWheelOdometry = 0;
+static TWheelOdometryData gWheelOdometryData = {0};
+
+static TSensorStatus gStatus = {0};
+static volatile SensorStatusCallback cbStatus = 0;
+
+static bool gInitialized = false;
+static bool gEngineValid = false;
+static TWheelOdometry gEngine;
+static uint16_t gTravelledDistance = 0;     //running counter [cm]
+static double gDistanceRemainder = 0;       //not yet counted fraction of a cm
+static TWheelOdometryData gOdometryBuffer[ODOMETER_CHUNK_SIZE];
+static TOdometerData gOdometerBuffer[ODOMETER_CHUNK_SIZE];
+
+bool iOdometerInit()
+{
+    TWheelConfigurationArray config;
+
+    pthread_mutex_lock(&mutexCb);
+    cbOdometer = 0;
+    cbWheelOdometry = 0;
+    pthread_mutex_unlock(&mutexCb);
+
+    pthread_mutex_lock(&mutexData);
+    gOdometerData.validityBits = 0;
+    gWheelOdometryData.validityBits = 0;
+    pthread_mutex_unlock(&mutexData);
+
+    pthread_mutex_lock(&mutexEngine);
+    gTravelledDistance = 0;
+    gDistanceRemainder = 0;
+    gEngineValid = snsWheelGetConfiguration(&config) && wheelodometry_init(&gEngine, &config);
+    gInitialized = true;
+    pthread_mutex_unlock(&mutexEngine);
+
+    return true;
+}
+
+bool iOdometerDestroy()
+{
+    pthread_mutex_lock(&mutexEngine);
+    gInitialized = false;
+    pthread_mutex_unlock(&mutexEngine);
+
+    pthread_mutex_lock(&mutexCb);
+    cbOdometer = 0;
+    cbWheelOdometry = 0;
+    pthread_mutex_unlock(&mutexCb);
+
+    return true;
+}
+
+bool snsOdometerGetMetaData(TSensorMetaData *data)
+{
+    bool retval = false;
+
+    if(data)
+    {
+        pthread_mutex_lock(&mutexData);
+        *data = gSensorsMetaData[4];
+        pthread_mutex_unlock(&mutexData);
+        retval = true;
+    }
+
+    return retval;
+}
+
+bool snsOdometerGetOdometerData(TOdometerData* odometer)
+{
+    bool retval = false;
+    if(odometer)
+    {
+        pthread_mutex_lock(&mutexData);
+        *odometer = gOdometerData;
+        pthread_mutex_unlock(&mutexData);
+        retval = true;
+    }
+    return retval;
+}
+
+bool snsOdometerRegisterCallback(OdometerCallback callback)
+{
+    bool retval = false;
+
+    pthread_mutex_lock(&mutexCb);
+    //only if valid callback and not already registered
+    if(callback && !cbOdometer)
+    {
+        cbOdometer = callback;
+        retval = true;
+    }
+    pthread_mutex_unlock(&mutexCb);
+
+    return retval;
+}
+
+bool snsOdometerDeregisterCallback(OdometerCallback callback)
+{
+    bool retval = false;
+
+    pthread_mutex_lock(&mutexCb);
+    if((cbOdometer == callback) && callback)
+    {
+        cbOdometer = 0;
+        retval = true;
+    }
+    pthread_mutex_unlock(&mutexCb);
+
+    return retval;
+}
+
+bool snsWheelOdometryGetData(TWheelOdometryData* odometryData)
+{
+    bool retval = false;
+    if(odometryData)
+    {
+        pthread_mutex_lock(&mutexData);
+        *odometryData = gWheelOdometryData;
+        pthread_mutex_unlock(&mutexData);
+        retval = true;
+    }
+    return retval;
+}
+
+bool snsWheelOdometryRegisterCallback(WheelOdometryCallback callback)
+{
+    bool retval = false;
+
+    pthread_mutex_lock(&mutexCb);
+    //only if valid callback and not already registered
+    if(callback && !cbWheelOdometry)
+    {
+        cbWheelOdometry = callback;
+        retval = true;
+    }
+    pthread_mutex_unlock(&mutexCb);
+
+    return retval;
+}
+
+bool snsWheelOdometryDeregisterCallback(WheelOdometryCallback callback)
+{
+    bool retval = false;
+
+    pthread_mutex_lock(&mutexCb);
+    if((cbWheelOdometry == callback) && callback)
+    {
+        cbWheelOdometry = 0;
+        retval = true;
+    }
+    pthread_mutex_unlock(&mutexCb);
+
+    return retval;
+}
+
+void updateOdometerWheelConfiguration(const TWheelConfigurationArray* config)
+{
+    if (config)
+    {
+        pthread_mutex_lock(&mutexEngine);
+        gEngineValid = wheelodometry_init(&gEngine, config);
+        pthread_mutex_unlock(&mutexEngine);
+    }
+}
+
+void updateOdometerFromWheelData(const TWheelData wheelData[], uint16_t numElements)
+{
+    if (wheelData == NULL)
+    {
+        return;
+    }
+    pthread_mutex_lock(&mutexEngine);
+    if (gInitialized && gEngineValid)
+    {
+        for (uint16_t start = 0; start < numElements; start += ODOMETER_CHUNK_SIZE)
+        {
+            uint16_t num = numElements - start;
+            if (num > ODOMETER_CHUNK_SIZE)
+            {
+                num = ODOMETER_CHUNK_SIZE;
+            }
+            wheelodometry_process(&gEngine, &wheelData[start], num, gOdometryBuffer);
+
+            for (uint16_t i = 0; i < num; i++)
+            {
+                gOdometerBuffer[i].timestamp = gOdometryBuffer[i].timestamp;
+                gOdometerBuffer[i].validityBits = 0;
+                if (gOdometryBuffer[i].validityBits & WHEELODOMETRY_DISTANCE_VALID)
+                {
+                    //only whole cm are counted, the remainder is kept, so the counter does not drift
+                    gDistanceRemainder += fabs(gOdometryBuffer[i].distance) * 100.0;
+                    double cm = floor(gDistanceRemainder);
+                    gDistanceRemainder -= cm;
+                    gTravelledDistance = (uint16_t)(gTravelledDistance + (uint32_t)fmod(cm, 65536.0));
+                    gOdometerBuffer[i].validityBits = ODOMETER_TRAVELLEDDISTANCE_VALID;
+                }
+                gOdometerBuffer[i].travelledDistance = gTravelledDistance;
+            }
+
+            pthread_mutex_lock(&mutexData);
+            gWheelOdometryData = gOdometryBuffer[num-1];
+            gOdometerData = gOdometerBuffer[num-1];
+            pthread_mutex_unlock(&mutexData);
+            pthread_mutex_lock(&mutexCb);
+            if (cbWheelOdometry)
+            {
+                cbWheelOdometry(gOdometryBuffer, num);
+            }
+            if (cbOdometer)
+            {
+                cbOdometer(gOdometerBuffer, num);
+            }
+            pthread_mutex_unlock(&mutexCb);
+        }
+    }
+    pthread_mutex_unlock(&mutexEngine);
+}
+
+bool snsOdometerGetStatus(TSensorStatus* status)
+{
+    bool retval = false;
+    if(status)
+    {
+        pthread_mutex_lock(&mutexData);
+        *status = gStatus;
+        pthread_mutex_unlock(&mutexData);
+        retval = true;
+    }
+    return retval;
+}
+
+bool snsOdometerRegisterStatusCallback(SensorStatusCallback callback)
+{
+    bool retval = false;
+
+    pthread_mutex_lock(&mutexCb);
+    //only if valid callback and not already registered
+    if(callback && !cbStatus)
+    {
+        cbStatus = callback;
+        retval = true;
+    }
+    pthread_mutex_unlock(&mutexCb);
+
+    return retval;
+}
+
+bool snsOdometerDeregisterStatusCallback(SensorStatusCallback callback)
+{
+    bool retval = false;
+
+    pthread_mutex_lock(&mutexCb);
+    if((cbStatus == callback) && callback)
+    {
+        cbStatus = 0;
+        retval = true;
+    }
+    pthread_mutex_unlock(&mutexCb);
+
+    return retval;
+}
+
+void updateOdometerStatus(const TSensorStatus* status)
+{
+    if (status)
+    {
+        pthread_mutex_lock(&mutexData);
+        gStatus = *status;
+        pthread_mutex_unlock(&mutexData);
+        pthread_mutex_lock(&mutexCb);
+        if (cbStatus)
+        {
+            cbStatus(status);
+        }
+        pthread_mutex_unlock(&mutexCb);
+    }
+}
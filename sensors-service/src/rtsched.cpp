@@ -0,0 +1,127 @@
+/**************************************************************************
+ * @brief Real-time scheduling and timing statistics for sampling threads
+ *
+ * @author agent <agent@local>
+ * @copyright Copyright (C) 2026, agent
+ *
+ * @license MPL-2.0 <http://spdx.org/licenses/MPL-2.0>
+ *
+ **************************************************************************/
+
+
+/** ===================================================================
+ * 1.) INCLUDES
+ */
+
+//pthread_setaffinity_np, cpu_set_t
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+ //provided interface
+#include "rtsched.h"
+
+//standard c library functions
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+
+/** ===================================================================
+ * 2.) FUNCTIONS IMPLEMENTING THE PUBLIC INTERFACE OF rtsched.h
+ */
+
+bool rtsched_apply(const TRtSchedConfig* config)
+{
+    bool result = true;
+
+    if (config == NULL)
+    {
+        return false;
+    }
+    if (config->lock_memory)
+    {
+        result = result && (0 == mlockall(MCL_CURRENT | MCL_FUTURE));
+    }
+    if (config->cpu >= 0)
+    {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(config->cpu, &cpuset);
+        result = result && (0 == pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset));
+    }
+    if (config->priority > 0)
+    {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = config->priority;
+        result = result && (0 == pthread_setschedparam(pthread_self(), SCHED_FIFO, &param));
+    }
+    return result;
+}
+
+uint64_t rtsched_get_time()
+{
+    struct timespec time_value;
+    if (clock_gettime(CLOCK_MONOTONIC, &time_value) != -1)
+    {
+        return (uint64_t)time_value.tv_sec*1000000000 + time_value.tv_nsec;
+    }
+    else
+    {
+        return 0xFFFFFFFFFFFFFFFF;
+    }
+}
+
+uint64_t rtsched_sleep_until(uint64_t deadline)
+{
+    struct timespec t;
+    t.tv_sec = deadline / 1000000000;
+    t.tv_nsec = deadline % 1000000000;
+    //absolute sleep: no drift, restart after signals without recalculation
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR);
+    return rtsched_get_time();
+}
+
+void rtsched_reset_statistics(TRtSchedStatistics* stats)
+{
+    memset(stats, 0, sizeof(TRtSchedStatistics));
+}
+
+void rtsched_update_statistics(TRtSchedStatistics* stats, uint64_t deadline, uint64_t wakeup,
+                               uint64_t interval, uint64_t read_duration, bool read_ok)
+{
+    uint64_t lateness = (wakeup > deadline) ? wakeup - deadline : 0;
+    uint64_t lateness_us = lateness / 1000;
+    uint16_t bin = 0;
+
+    while ((lateness_us > 0) && (bin < RTSCHED_HISTOGRAM_BINS-1))
+    {
+        lateness_us >>= 1;
+        bin++;
+    }
+
+    stats->cycles++;
+    stats->lateness_sum += lateness;
+    stats->lateness_histogram[bin]++;
+    if (lateness > stats->lateness_max)
+    {
+        stats->lateness_max = lateness;
+    }
+    if (lateness > interval)
+    {
+        stats->missed_deadlines++;
+    }
+    stats->read_duration_sum += read_duration;
+    if (read_duration > stats->read_duration_max)
+    {
+        stats->read_duration_max = read_duration;
+    }
+    if (!read_ok)
+    {
+        stats->read_errors++;
+    }
+}
@@ -0,0 +1,105 @@
+/**************************************************************************
+ * @brief Real-time scheduling and timing statistics for sampling threads
+ *
+ * @details Helper functions shared by the reader threads of the
+ * inertial sensor drivers (mpu6050.cpp, lsm9ds1.cpp):
+ * optional real-time configuration (SCHED_FIFO, CPU affinity, mlockall),
+ * absolute sleeping with nanosecond deadlines on CLOCK_MONOTONIC
+ * and per-thread statistics on wakeup lateness and read duration.
+ *
+ * @author agent <agent@local>
+ * @copyright Copyright (C) 2026, agent
+ *
+ * @license MPL-2.0 <http://spdx.org/licenses/MPL-2.0>
+ *
+ **************************************************************************/
+
+#ifndef INCLUDE_RTSCHED
+#define INCLUDE_RTSCHED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Real-time configuration of a sampling thread.
+ * The default (all members 0 except cpu=-1) keeps the default scheduling.
+ */
+typedef struct
+{
+    int priority;       /**< SCHED_FIFO priority 1..99. 0 keeps the default scheduling policy */
+    int cpu;            /**< CPU to which the thread is bound. -1 means no CPU affinity */
+    bool lock_memory;   /**< If true, all current and future pages of the process are locked in memory (mlockall) */
+} TRtSchedConfig;
+
+/** Number of bins of the wakeup lateness histogram
+  * Bin 0 counts wakeups less than 1us late,
+  * bin i (1..RTSCHED_HISTOGRAM_BINS-2) counts wakeups [2^(i-1), 2^i) us late,
+  * the last bin counts all later wakeups (>= 16.384ms)
+  */
+#define RTSCHED_HISTOGRAM_BINS 16
+
+/**
+ * Timing statistics of a sampling thread.
+ * All times are in ns (nanoseconds).
+ */
+typedef struct
+{
+    uint64_t cycles;                /**< Number of sampling cycles */
+    uint64_t missed_deadlines;      /**< Number of wakeups later than one full sample interval */
+    uint64_t lateness_sum;          /**< Sum of the wakeup lateness */
+    uint64_t lateness_max;          /**< Maximum wakeup lateness */
+    uint32_t lateness_histogram[RTSCHED_HISTOGRAM_BINS]; /**< Wakeup lateness histogram, see RTSCHED_HISTOGRAM_BINS */
+    uint64_t read_duration_sum;     /**< Sum of the sensor read durations */
+    uint64_t read_duration_max;     /**< Maximum sensor read duration */
+    uint64_t read_errors;           /**< Number of failed sensor reads */
+    bool realtime;                  /**< True if the real-time configuration has been applied successfully */
+} TRtSchedStatistics;
+
+/**
+ * Apply the real-time configuration to the calling thread.
+ * @param config the configuration
+ * @return true on success. Typically fails without CAP_SYS_NICE / CAP_IPC_LOCK.
+ */
+bool rtsched_apply(const TRtSchedConfig* config);
+
+/**
+ * Get system timestamp
+ * @return returns a system timestamp in ns (nanoseconds) derived from clock_gettime(CLOCK_MONOTONIC);
+ */
+uint64_t rtsched_get_time();
+
+/**
+ * Sleep until an absolute deadline using clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME).
+ * Returns immediately if the deadline is already over.
+ * @param deadline the deadline in ns as returned by rtsched_get_time()
+ * @return the time of the wakeup in ns
+ */
+uint64_t rtsched_sleep_until(uint64_t deadline);
+
+/**
+ * Reset the statistics
+ * @param stats the statistics to reset
+ */
+void rtsched_reset_statistics(TRtSchedStatistics* stats);
+
+/**
+ * Add one sampling cycle to the statistics
+ * @param stats the statistics to update
+ * @param deadline the deadline of the wakeup in ns
+ * @param wakeup the actual wakeup time in ns
+ * @param interval the sample interval in ns
+ * @param read_duration the duration of the sensor read in ns
+ * @param read_ok true if the sensor read was successful
+ */
+void rtsched_update_statistics(TRtSchedStatistics* stats, uint64_t deadline, uint64_t wakeup,
+                               uint64_t interval, uint64_t read_duration, bool read_ok);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //INCLUDE_RTSCHED
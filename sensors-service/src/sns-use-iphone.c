@@ -7,7 +7,7 @@
 * \author Marco Residori <marco.residori@xse.de>
 *
 * \copyright Copyright (C) 2013, XS Embedded GmbH
-* 
+*
 * \license
 * This Source Code Form is subject to the terms of the
 * Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
@@ -16,66 +16,110 @@
 * @licence end@
 **************************************************************************/
 
+/*
+ * Sensors service backend for the SensorLogger iPhone app.
+ *
+ * The datagrams of the app are received by the iPhone listener shared with
+ * the GNSS service, see iphone-listener.h. Gyroscope and acceleration samples
+ * are collected and passed to the callbacks in batches of SNS_IPHONE_BATCH
+ * samples (default IPHONE_DEFAULT_BATCH), or earlier if the oldest buffered
+ * sample is older than IPHONE_FLUSH_TIMEOUT. GPS records are ignored here,
+ * they are evaluated by the iPhone backend of the GNSS service.
+ */
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
-#include <time.h>
-#include <errno.h>
-#include <pthread.h>
-#include <assert.h>
-
-#include <arpa/inet.h>
-#include <netinet/in.h>
-#include <sys/types.h>
-#include <sys/socket.h>
-#include <unistd.h>
 #include <memory.h>
 
 #include "globals.h"
 #include "sns-init.h"
+#include "iphone-listener.h"
 #include "log.h"
 
-#define BUFLEN 256
-#define MSGIDLEN 20
-#define PORT 5555
+//Environment variable to override the batch size
+#define IPHONE_BATCH_ENV "SNS_IPHONE_BATCH"
+
+//Batch size: 10 samples at 100Hz correspond to the cycle time of the meta data
+#define IPHONE_DEFAULT_BATCH 10
+#define IPHONE_MAX_BATCH 64
+//Maximum age of buffered samples [ms]
+#define IPHONE_FLUSH_TIMEOUT 100
 
-//Sensors IDs used by the SensorLogger App
-#define GPS_SENSOR 1
-#define ACC_SENSOR 2
-#define COMPASS    3
-#define GYRO       4
+//The app provides rotation rates in rad/s and accelerations in g
+#define IPHONE_RAD2DEG 57.295779513082320876
+#define IPHONE_GRAVITY 9.80665
 
 DLT_DECLARE_CONTEXT(gContext);
 
-pthread_t listenerThread;
-bool isRunning = true;
+static uint16_t batchSize = IPHONE_DEFAULT_BATCH;
+
+//Samples not yet passed to the callbacks
+static TGyroscopeData gyroBuffer[IPHONE_MAX_BATCH];
+static uint16_t gyroCount = 0;
+static uint64_t gyroFirstReception = 0;
+static TAccelerationData accBuffer[IPHONE_MAX_BATCH];
+static uint16_t accCount = 0;
+static uint64_t accFirstReception = 0;
+
+//Phone timestamps of the previous samples [ms] to determine the measurement interval
+static double lastGyroTime = -1;
+static double lastAccTime = -1;
+
+static void onRecord(int sensorId, uint64_t timestamp, double phoneTime, const double values[], uint64_t now);
+static void onFlush(uint64_t now);
+static void flushGyroscope();
+static void flushAcceleration();
 
-void *listenForMessages( void *ptr );
+static const TIphoneListenerClient listenerClient = { onRecord, onFlush };
+static bool isRunning = false;
 
 bool snsInit()
 {
-    isRunning = true;
+    const char* env;
+
+    DLT_REGISTER_APP("SNSS", "SENSORS-SERVICE");
+    DLT_REGISTER_CONTEXT(gContext,"SSRV", "Global Context");
 
-    if(pthread_create( &listenerThread, NULL, listenForMessages, NULL) != 0)
+    env = getenv(IPHONE_BATCH_ENV);
+    if (env != NULL)
     {
-        isRunning = false;
+        int n = atoi(env);
+        batchSize = ((n >= 1) && (n <= IPHONE_MAX_BATCH)) ? n : IPHONE_DEFAULT_BATCH;
+    }
+
+    gyroCount = 0;
+    accCount = 0;
+    lastGyroTime = -1;
+    lastAccTime = -1;
 
-    	return false;
+    if (!iphoneListenerAdd(&listenerClient))
+    {
+        LOG_ERROR_MSG(gContext,"cannot start the iPhone listener");
+        return false;
     }
 
+    LOG_INFO(gContext,"Batch size %d", batchSize);
+
+    isRunning = true;
     return true;
 }
 
 bool snsDestroy()
 {
-    isRunning = false;
-
-    if(listenerThread)
+    if (!isRunning)
     {
-        pthread_join( listenerThread, NULL);
+        return false;
     }
 
+    isRunning = false;
+    iphoneListenerRemove(&listenerClient);
+
+    //the listener does not call onFlush() anymore
+    flushGyroscope();
+    flushAcceleration();
+
     return true;
 }
 
@@ -97,6 +141,16 @@ void snsGetVersion(int *major, int *minor, int *micro)
     }
 }
 
+bool snsAccelerationInit()
+{
+    return iAccelerationInit();
+}
+
+bool snsAccelerationDestroy()
+{
+    return iAccelerationDestroy();
+}
+
 bool snsGyroscopeInit()
 {
     return iGyroscopeInit();
@@ -107,126 +161,159 @@ bool snsGyroscopeDestroy()
     return iGyroscopeDestroy();
 }
 
-
-static bool processGVGYRO(char* data)
+bool snsVehicleSpeedInit()
 {
-    long unsigned int timestamp = 0;
-    float yawRate;
-    float pitchRate;
-    float rollRate;
-    int32_t sensorId;
-    uint32_t n = 0;
+    return iVehicleSpeedInit();
+}
 
-    if(!data || !pGyroscopeData)
-    {
-        LOG_ERROR_MSG(gContext,"wrong parameter!");
-        return false;
-    }
+bool snsVehicleSpeedDestroy()
+{
+    return iVehicleSpeedDestroy();
+}
 
-    n = sscanf(data, "%lu,%d,%f,%f,%f", &timestamp, &sensorId, &yawRate, &pitchRate, &rollRate);
+bool snsWheelInit()
+{
+    return iWheelInit();
+}
 
-    if(n <= 0)
-    {
-        LOG_ERROR_MSG(gContext,"replayer: processGVGYRO failed!");
-        return false;
-    }
+bool snsWheelDestroy()
+{
+    return iWheelDestroy();
+}
 
-    TGyroscopeData gyroscopeData    
-    
-    gyroscopeData.timestamp = timestamp;
+bool snsOdometerInit()
+{
+    return iOdometerInit();
+}
 
-    //LOG_INFO(gContext,"timestamp:%lu",timestamp);
+bool snsOdometerDestroy()
+{
+    return iOdometerDestroy();
+}
 
-    //angleYaw
-    gyroscopeData.yawRate = yawRate;
-    gyroscopeData.validityBits |= GYROSCOPE_CONFIG_ANGLEYAW_VALID;
-    LOG_INFO(gContext,"yawRate: %lf", gyroscopeData.yawRate);
-     
-    //anglePitch
-    gyroscopeData.pitchRate = pitchRate;
-    gyroscopeData.validityBits |= GYROSCOPE_CONFIG_ANGLEPITCH_VALID;
-    LOG_INFO(gContext,"pitchRate: %lf", gyroscopeData.pitchRate);
+bool snsVehicleDataInit()
+{
+    return iVehicleDataInit();
+}
 
-    //angleRoll
-    gyroscopeData.rollRate = rollRate;
-    gyroscopeData.validityBits |= GYROSCOPE_CONFIG_ANGLEROLL_VALID;
-    LOG_INFO(gContext,"rollRate: %f", gyroscopeData.rollRate);
+bool snsVehicleDataDestroy()
+{
+    return iVehicleDataDestroy();
+}
 
-    if(cbGyroscope != 0)
+static void flushGyroscope()
+{
+    if (gyroCount > 0)
     {
-        cbGyroscope(&gyroscopeData,1);
+        updateGyroscopeData(gyroBuffer, gyroCount);
+        gyroCount = 0;
     }
-
-    return true;
 }
 
-void *listenForMessages( void *ptr )
-{  
-    struct sockaddr_in si_me;
-    struct sockaddr_in si_other;
-    long unsigned int timestamp = 0;
-    int s;
-    socklen_t slen = sizeof(si_other);
-    ssize_t readBytes = 0;
-    char buf[BUFLEN];
-    int msgId;
-    int port = PORT;
-
-    DLT_REGISTER_APP("SNSS", "SENSORS-SERVICE");
-    DLT_REGISTER_CONTEXT(gContext,"SSRV", "Global Context");
-
-    LOG_INFO(gContext,"Listening on port %d...",port);
-
-    if((s=socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP))==-1)
+static void flushAcceleration()
+{
+    if (accCount > 0)
     {
-        LOG_ERROR_MSG(gContext,"socket() failed!");
-        exit(EXIT_FAILURE);
+        updateAccelerationData(accBuffer, accCount);
+        accCount = 0;
     }
+}
 
-    memset((char *) &si_me, 0, sizeof(si_me));
-    si_me.sin_family = AF_INET;
-
-    si_me.sin_port = htons(port);
-    si_me.sin_addr.s_addr = htonl(INADDR_ANY);
-    if(bind(s, (struct sockaddr *)&si_me, sizeof(si_me)) == -1)
+/**
+ * Pass buffered samples to the callbacks if they get too old
+ */
+static void flushTimeout(uint64_t now)
+{
+    if ((gyroCount > 0) && (now - gyroFirstReception >= IPHONE_FLUSH_TIMEOUT))
     {
-        LOG_ERROR_MSG(gContext,"socket() failed!");
-        exit(EXIT_FAILURE);
+        flushGyroscope();
     }
-
-    while(isRunning == true)
+    if ((accCount > 0) && (now - accFirstReception >= IPHONE_FLUSH_TIMEOUT))
     {
-        readBytes = recvfrom(s, buf, BUFLEN, 0, (struct sockaddr *)&si_other, &slen);
-
-        if(readBytes < 0)
-        {
-            LOG_ERROR_MSG(gContext,"recvfrom() failed!");
-            exit(EXIT_FAILURE);
-        }
-
-        buf[readBytes] = '\0';
-
-        LOG_DEBUG_MSG(gContext,"------------------------------------------------");
+        flushAcceleration();
+    }
+}
 
-        LOG_DEBUG(gContext,"Received Packet from %s:%d", 
-                  inet_ntoa(si_other.sin_addr), ntohs(si_other.sin_port));
+static uint32_t getInterval(double phoneTime, double* lastTime)
+{
+    uint32_t interval = 0;
+    //intervals of more than 1s are considered as gap
+    if ((*lastTime >= 0) && (phoneTime > *lastTime) && (phoneTime - *lastTime < 1000))
+    {
+        interval = (uint32_t)((phoneTime - *lastTime)*1000);
+    }
+    *lastTime = phoneTime;
+    return interval;
+}
 
-        sscanf(buf,"%lu,%d,",&timestamp, &msgId);
+static void processGyroscope(uint64_t timestamp, double phoneTime, const double values[], uint64_t now)
+{
+    TGyroscopeData* gyroscopeData = &gyroBuffer[gyroCount];
+
+    memset(gyroscopeData, 0, sizeof(TGyroscopeData));
+    gyroscopeData->timestamp = timestamp;
+    gyroscopeData->yawRate = values[0]*IPHONE_RAD2DEG;
+    gyroscopeData->pitchRate = values[1]*IPHONE_RAD2DEG;
+    gyroscopeData->rollRate = values[2]*IPHONE_RAD2DEG;
+    gyroscopeData->validityBits = GYROSCOPE_YAWRATE_VALID | GYROSCOPE_PITCHRATE_VALID | GYROSCOPE_ROLLRATE_VALID;
+    gyroscopeData->measurementInterval = getInterval(phoneTime, &lastGyroTime);
+    if (gyroscopeData->measurementInterval > 0)
+    {
+        gyroscopeData->validityBits |= GYROSCOPE_MEASINT_VALID;
+    }
 
-        LOG_DEBUG_MSG(gContext,"------------------------------------------------");
-        LOG_DEBUG(gContext,"msgID:%d",msgId);
-        
-        pthread_mutex_lock(&mutexData);
+    if (gyroCount == 0)
+    {
+        gyroFirstReception = now;
+    }
+    gyroCount++;
+    if (gyroCount >= batchSize)
+    {
+        flushGyroscope();
+    }
+}
 
-        if(msgId == GYRO) 
-        {
-            processGVGYRO(buf, &gGyroscopeData);
-        }
+static void processAcceleration(uint64_t timestamp, double phoneTime, const double values[], uint64_t now)
+{
+    TAccelerationData* accelerationData = &accBuffer[accCount];
+
+    memset(accelerationData, 0, sizeof(TAccelerationData));
+    accelerationData->timestamp = timestamp;
+    accelerationData->x = values[0]*IPHONE_GRAVITY;
+    accelerationData->y = values[1]*IPHONE_GRAVITY;
+    accelerationData->z = values[2]*IPHONE_GRAVITY;
+    accelerationData->validityBits = ACCELERATION_X_VALID | ACCELERATION_Y_VALID | ACCELERATION_Z_VALID;
+    accelerationData->measurementInterval = getInterval(phoneTime, &lastAccTime);
+    if (accelerationData->measurementInterval > 0)
+    {
+        accelerationData->validityBits |= ACCELERATION_MEASINT_VALID;
+    }
 
-        pthread_mutex_unlock(&mutexData);
+    if (accCount == 0)
+    {
+        accFirstReception = now;
+    }
+    accCount++;
+    if (accCount >= batchSize)
+    {
+        flushAcceleration();
     }
+}
 
-    close(s);
+static void onRecord(int sensorId, uint64_t timestamp, double phoneTime, const double values[], uint64_t now)
+{
+    if (sensorId == IPHONE_GYRO)
+    {
+        processGyroscope(timestamp, phoneTime, values, now);
+    }
+    else if (sensorId == IPHONE_ACC_SENSOR)
+    {
+        processAcceleration(timestamp, phoneTime, values, now);
+    }
+    //IPHONE_GPS_SENSOR is handled by the GNSS service, IPHONE_COMPASS is not supported
+}
 
-    return EXIT_SUCCESS;
+static void onFlush(uint64_t now)
+{
+    flushTimeout(now);
 }
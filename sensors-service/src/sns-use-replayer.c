@@ -159,6 +159,25 @@ bool snsWheelDestroy()
     return iWheelDestroy();
 }
 
+//the log files contain no wheel configuration, so the odometer stays inactive
+//until a configuration is provided via updateWheelConfiguration()
+bool snsOdometerInit()
+{
+    TWheelConfigurationArray config;
+    bool is_ok = iOdometerInit();
+
+    if (is_ok && !snsWheelGetConfiguration(&config))
+    {
+        LOG_WARNING_MSG(gContext,"replayer: no wheel configuration, odometer inactive");
+    }
+    return is_ok;
+}
+
+bool snsOdometerDestroy()
+{
+    return iOdometerDestroy();
+}
+
 bool snsVehicleDataInit()
 {
     return iVehicleDataInit();
@@ -20,12 +20,18 @@
 #include "sns-init.h"
 #include "acceleration.h"
 #include "gyroscope.h"
+#include "wheel.h"
+#include "vehicle-speed.h"
+#include "sns-use-sensors.h"
 
 //standard headers
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
 #include <unistd.h>
 
 //sns internals
@@ -33,10 +39,15 @@
 #include "log.h"
 #include "mpu6050.h"
 #include "lsm9ds1.h"
+#include "decimator.h"
+#include "cancomm.h"
+#include "cansignal.h"
+#include "wheelodometry.h"
 
 DLT_DECLARE_CONTEXT(gContext);
 
-//configuration parameters - may be set from outside
+//default configuration parameters - may be set from outside
+//at runtime, they may be overridden by snsImuSetConfig() or a configuration file, see sns-use-sensors.h
 
 //configure how to address the IMU
 #ifndef IMU_I2C_DEV
@@ -56,73 +67,282 @@ DLT_DECLARE_CONTEXT(gContext);
 #ifndef IMU_AVG_SAMPLES
 #define IMU_AVG_SAMPLES true
 #endif
+//decimation filter used when samples are averaged
+//0: windowed-sinc low pass with IMU_DECIMATION_TAPS taps, >0: CIC filter of this order
+#ifndef IMU_DECIMATION_CIC_ORDER
+#define IMU_DECIMATION_CIC_ORDER 0
+#endif
+//number of taps of the low pass - more taps give better vibration suppression, but more delay
+//0: 2*IMU_NUM_SAMPLES+1
+#ifndef IMU_DECIMATION_TAPS
+#define IMU_DECIMATION_TAPS 0
+#endif
+
+//real-time scheduling of the IMU reader thread
+//SCHED_FIFO priority 1..99, 0 keeps the default scheduling
+#ifndef IMU_RT_PRIORITY
+#define IMU_RT_PRIORITY 0
+#endif
+//CPU to which the IMU reader thread is bound, -1 for no affinity
+#ifndef IMU_RT_CPU
+#define IMU_RT_CPU -1
+#endif
+//lock all pages of the process in memory
+#ifndef IMU_RT_LOCK_MEMORY
+#define IMU_RT_LOCK_MEMORY false
+#endif
+
+//default IMU type
+#if defined(IMU_TYPE_MPU6050)
+#define IMU_TYPE SNS_IMU_MPU6050
+#elif defined(IMU_TYPE_LSM9DS1)
+#define IMU_TYPE SNS_IMU_LSM9DS1
+#else
+#define IMU_TYPE SNS_IMU_NONE
+#endif
 
 static volatile bool is_initialized = false;
 
-static void mpu6050_cb(const TMPU6050Vector3D acceleration[], const TMPU6050Vector3D gyro_angular_rate[], const float temperature[], const uint64_t timestamp[], const uint16_t num_elements)
+//configuration used by the next snsGyroscopeInit()
+static TSnsImuConfig imu_config;
+static bool imu_config_valid = false;
+
+/** Channels of the IMU data in SoA layout as filtered by the decimator
+ */
+enum EImuChannel
 {
-    TAccelerationData accel[IMU_NUM_SAMPLES] = {0};
-    TGyroscopeData gyro[IMU_NUM_SAMPLES] = {0};
+    IMU_ACCEL_X,
+    IMU_ACCEL_Y,
+    IMU_ACCEL_Z,
+    IMU_GYRO_X,
+    IMU_GYRO_Y,
+    IMU_GYRO_Z,
+    IMU_TEMPERATURE,
+    IMU_NUM_CHANNELS
+};
 
-    for (uint16_t i=0; i<num_elements; i++)
-    {
-        accel[i].timestamp = timestamp[i];
-        accel[i].x = acceleration[i].x*MPU6050_UNIT_1_G;
-        accel[i].y = acceleration[i].y*MPU6050_UNIT_1_G;
-        accel[i].z = acceleration[i].z*MPU6050_UNIT_1_G;
-        accel[i].temperature = temperature[i];
-        accel[i].validityBits = ACCELERATION_X_VALID | ACCELERATION_Y_VALID |
-                                ACCELERATION_Z_VALID | ACCELERATION_TEMPERATURE_VALID;
+/** Conversion buffers, allocated in snsGyroscopeInit() for the configured number of samples.
+ * Only accessed from the IMU reader thread.
+ */
+typedef struct
+{
+    void* memory;                                   //single allocation holding all buffers
+    float* soa[IMU_NUM_CHANNELS];                   //driver data in SoA layout, num_samples each
+    float* decimated[IMU_NUM_CHANNELS];             //decimator output, num_samples+1 each
+    uint64_t* decimated_timestamp;                  //num_samples+1
+    TAccelerationData* accel;                       //num_samples+1
+    TGyroscopeData* gyro;                           //num_samples+1
+    uint16_t num_samples;
+} TImuBuffers;
 
-        gyro[i].timestamp = timestamp[i];
-        gyro[i].yawRate = gyro_angular_rate[i].z;
-        gyro[i].pitchRate = gyro_angular_rate[i].y;
-        gyro[i].rollRate = gyro_angular_rate[i].x;
-        gyro[i].temperature = temperature[i];
-        gyro[i].validityBits = GYROSCOPE_YAWRATE_VALID | GYROSCOPE_PITCHRATE_VALID |
-                               GYROSCOPE_ROLLRATE_VALID | GYROSCOPE_TEMPERATURE_VALID;
+static TImuBuffers imu_buffers;
+
+//the decimator is only accessed from the IMU reader thread
+static decimator imu_decimator;
+
+static bool imu_buffers_alloc(uint16_t num_samples)
+{
+    size_t n_out = num_samples+1;
+    size_t size_accel = n_out*sizeof(TAccelerationData);
+    size_t size_gyro = n_out*sizeof(TGyroscopeData);
+    size_t size_timestamp = n_out*sizeof(uint64_t);
+    size_t size_float = (IMU_NUM_CHANNELS*num_samples + IMU_NUM_CHANNELS*n_out)*sizeof(float);
 
+    //the 64 bit members come first to keep the alignment
+    uint8_t* memory = (uint8_t*)calloc(1, size_accel + size_gyro + size_timestamp + size_float);
+    if (memory == NULL)
+    {
+        return false;
+    }
+    imu_buffers.memory = memory;
+    imu_buffers.accel = (TAccelerationData*)memory;
+    memory += size_accel;
+    imu_buffers.gyro = (TGyroscopeData*)memory;
+    memory += size_gyro;
+    imu_buffers.decimated_timestamp = (uint64_t*)memory;
+    memory += size_timestamp;
+    float* f = (float*)memory;
+    for (uint16_t c=0; c<IMU_NUM_CHANNELS; c++)
+    {
+        imu_buffers.soa[c] = f;
+        f += num_samples;
     }
-    updateAccelerationData(accel, num_elements);
-    updateGyroscopeData(gyro, num_elements);
+    for (uint16_t c=0; c<IMU_NUM_CHANNELS; c++)
+    {
+        imu_buffers.decimated[c] = f;
+        f += n_out;
+    }
+    imu_buffers.num_samples = num_samples;
+    return true;
+}
 
+static void imu_buffers_free()
+{
+    free(imu_buffers.memory);
+    memset(&imu_buffers, 0, sizeof(imu_buffers));
 }
 
-static void lsm9ds1_cb(const TLSM9DS1Vector3D acceleration[], const TLSM9DS1Vector3D gyro_angular_rate[], const float temperature[], const uint64_t timestamp[], const uint16_t num_elements)
+/**
+ * Decimate (if configured) and publish IMU data
+ * @param channels IMU data in SoA layout, see EImuChannel. Acceleration in m/s^2, angular rate in deg/s
+ * @param timestamp timestamps of the samples
+ * @param num_elements number of samples
+ */
+static void imu_publish(float* const channels[], const uint64_t timestamp[], uint16_t num_elements)
 {
-    TAccelerationData accel[IMU_NUM_SAMPLES] = {0};
-    TGyroscopeData gyro[IMU_NUM_SAMPLES] = {0};
+    TAccelerationData* accel = imu_buffers.accel;
+    TGyroscopeData* gyro = imu_buffers.gyro;
+    const float* const* data = channels;
+    const uint64_t* data_timestamp = timestamp;
+
+    if (imu_config.average)
+    {
+        num_elements = imu_decimator.process(channels, timestamp, num_elements, imu_buffers.decimated, imu_buffers.decimated_timestamp);
+        data = imu_buffers.decimated;
+        data_timestamp = imu_buffers.decimated_timestamp;
+    }
 
     for (uint16_t i=0; i<num_elements; i++)
     {
-        accel[i].timestamp = timestamp[i];
-        accel[i].x = acceleration[i].x*LSM9DS1_UNIT_1_G;
-        accel[i].y = acceleration[i].y*LSM9DS1_UNIT_1_G;
-        accel[i].z = acceleration[i].z*LSM9DS1_UNIT_1_G;
-        accel[i].temperature = temperature[i];
+        accel[i].timestamp = data_timestamp[i];
+        accel[i].x = data[IMU_ACCEL_X][i];
+        accel[i].y = data[IMU_ACCEL_Y][i];
+        accel[i].z = data[IMU_ACCEL_Z][i];
+        accel[i].temperature = data[IMU_TEMPERATURE][i];
         accel[i].validityBits = ACCELERATION_X_VALID | ACCELERATION_Y_VALID |
                                 ACCELERATION_Z_VALID | ACCELERATION_TEMPERATURE_VALID;
 
-        gyro[i].timestamp = timestamp[i];
-        gyro[i].yawRate = gyro_angular_rate[i].z;
-        gyro[i].pitchRate = gyro_angular_rate[i].y;
-        gyro[i].rollRate = gyro_angular_rate[i].x;
-        gyro[i].temperature = temperature[i];
+        gyro[i].timestamp = data_timestamp[i];
+        gyro[i].yawRate = data[IMU_GYRO_Z][i];
+        gyro[i].pitchRate = data[IMU_GYRO_Y][i];
+        gyro[i].rollRate = data[IMU_GYRO_X][i];
+        gyro[i].temperature = data[IMU_TEMPERATURE][i];
         gyro[i].validityBits = GYROSCOPE_YAWRATE_VALID | GYROSCOPE_PITCHRATE_VALID |
                                GYROSCOPE_ROLLRATE_VALID | GYROSCOPE_TEMPERATURE_VALID;
+    }
+    if (num_elements > 0)
+    {
+        updateAccelerationData(accel, num_elements);
+        updateGyroscopeData(gyro, num_elements);
+    }
+}
 
+/**
+ * Length of the decimation filter in samples
+ * The CIC filter is realized as order cascaded boxcars of length num_samples,
+ * the low pass defaults to 2*num_samples+1 taps, limited to the filter buffer.
+ */
+static uint32_t imu_decimation_length(const TSnsImuConfig* config)
+{
+    uint32_t ratio = config->num_samples;
+
+    if (config->decimation_cic_order > 0)
+    {
+        return (ratio == 0) ? 0 : config->decimation_cic_order*(ratio-1)+1;
+    }
+    if (config->decimation_taps > 0)
+    {
+        return config->decimation_taps;
     }
-    updateAccelerationData(accel, num_elements);
-    updateGyroscopeData(gyro, num_elements);
+    return (2*ratio+1 > DECIMATOR_MAX_TAPS) ? DECIMATOR_MAX_TAPS : 2*ratio+1;
+}
+
+static bool imu_decimator_init()
+{
+    uint16_t ratio = imu_config.num_samples;
 
+    if (!imu_config.average)
+    {
+        return true;
+    }
+    if (imu_config.decimation_cic_order > 0)
+    {
+        return imu_decimator.init_cic(imu_config.decimation_cic_order, ratio, IMU_NUM_CHANNELS);
+    }
+    return imu_decimator.init_lowpass(imu_decimation_length(&imu_config), ratio, IMU_NUM_CHANNELS);
+}
+
+/**
+ * Output data rate of the sensor: configured or one sample per sample interval
+ */
+static uint16_t imu_get_odr()
+{
+    return (imu_config.odr > 0) ? imu_config.odr : 1000/imu_config.sample_interval;
+}
+
+static void mpu6050_cb(const TMPU6050Vector3D acceleration[], const TMPU6050Vector3D gyro_angular_rate[], const float temperature[], const uint64_t timestamp[], const uint16_t num_elements)
+{
+    float* const* soa = imu_buffers.soa;
+
+    //the driver never delivers more than num_samples, this is just a safeguard
+    uint16_t n = (num_elements < imu_buffers.num_samples) ? num_elements : imu_buffers.num_samples;
+    for (uint16_t i=0; i<n; i++)
+    {
+        soa[IMU_ACCEL_X][i] = acceleration[i].x*MPU6050_UNIT_1_G;
+        soa[IMU_ACCEL_Y][i] = acceleration[i].y*MPU6050_UNIT_1_G;
+        soa[IMU_ACCEL_Z][i] = acceleration[i].z*MPU6050_UNIT_1_G;
+        soa[IMU_GYRO_X][i] = gyro_angular_rate[i].x;
+        soa[IMU_GYRO_Y][i] = gyro_angular_rate[i].y;
+        soa[IMU_GYRO_Z][i] = gyro_angular_rate[i].z;
+        soa[IMU_TEMPERATURE][i] = temperature[i];
+    }
+    imu_publish(imu_buffers.soa, timestamp, n);
+}
+
+static void lsm9ds1_cb(const TLSM9DS1Vector3D acceleration[], const TLSM9DS1Vector3D gyro_angular_rate[], const float temperature[], const uint64_t timestamp[], const uint16_t num_elements)
+{
+    float* const* soa = imu_buffers.soa;
+
+    //the driver never delivers more than num_samples, this is just a safeguard
+    uint16_t n = (num_elements < imu_buffers.num_samples) ? num_elements : imu_buffers.num_samples;
+    for (uint16_t i=0; i<n; i++)
+    {
+        soa[IMU_ACCEL_X][i] = acceleration[i].x*LSM9DS1_UNIT_1_G;
+        soa[IMU_ACCEL_Y][i] = acceleration[i].y*LSM9DS1_UNIT_1_G;
+        soa[IMU_ACCEL_Z][i] = acceleration[i].z*LSM9DS1_UNIT_1_G;
+        soa[IMU_GYRO_X][i] = gyro_angular_rate[i].x;
+        soa[IMU_GYRO_Y][i] = gyro_angular_rate[i].y;
+        soa[IMU_GYRO_Z][i] = gyro_angular_rate[i].z;
+        soa[IMU_TEMPERATURE][i] = temperature[i];
+    }
+    imu_publish(imu_buffers.soa, timestamp, n);
 }
 
 static bool snsGyroscopeInit_MPU6050()
 {
-    //DLPF cut-off 42Hz fits best to 100Hz sample rate
-    bool is_ok = mpu6050_init(IMU_I2C_DEV, MPU6050_ADDR_1, MPU6050_DLPF_42HZ);
+    //select the widest DLPF bandwidth which is still below the Nyquist frequency
+    //e.g. 42Hz for 100Hz sample rate
+    static const struct { uint16_t bandwidth; EMPU6050LowPassFilterBandwidth dlpf; } dlpf_table[] =
+    {
+        {256, MPU6050_DLPF_256HZ}, {188, MPU6050_DLPF_188HZ}, {98, MPU6050_DLPF_98HZ},
+        {42, MPU6050_DLPF_42HZ}, {20, MPU6050_DLPF_20HZ}, {10, MPU6050_DLPF_10HZ}, {5, MPU6050_DLPF_5HZ}
+    };
+    uint16_t nyquist = imu_get_odr()/2;
+    EMPU6050LowPassFilterBandwidth dlpf = MPU6050_DLPF_5HZ;
+    for (size_t i=0; i<sizeof(dlpf_table)/sizeof(dlpf_table[0]); i++)
+    {
+        if (dlpf_table[i].bandwidth <= nyquist)
+        {
+            dlpf = dlpf_table[i].dlpf;
+            break;
+        }
+    }
+    uint8_t addr = (imu_config.i2c_addr != 0) ? imu_config.i2c_addr : MPU6050_ADDR_1;
+
+    if (!mpu6050_init(imu_config.i2c_device, addr, dlpf))
+    {
+        return false;
+    }
+    bool is_ok = imu_decimator_init();
     is_ok = is_ok && mpu6050_register_callback(&mpu6050_cb);
-    is_ok = is_ok && mpu6050_start_reader_thread(IMU_SAMPLE_INTERVAL, IMU_NUM_SAMPLES, IMU_AVG_SAMPLES);
+    is_ok = is_ok && mpu6050_set_realtime_config(&imu_config.rt);
+    is_ok = is_ok && mpu6050_start_reader_thread(imu_config.sample_interval, imu_config.num_samples, false);
+    if (!is_ok)
+    {
+        //deregistering fails harmlessly if the callback has not been registered
+        mpu6050_deregister_callback(&mpu6050_cb);
+        mpu6050_deinit();
+    }
     return is_ok;
 }
 
@@ -137,10 +357,39 @@ static bool snsGyroscopeDestroy_MPU6050()
 
 static bool snsGyroscopeInit_LSM9DS1()
 {
-    //ODR 119Hz with LPF1 cut-off 38Hz fits best to 100Hz sample rate
-    bool is_ok = lsm9ds1_init(IMU_I2C_DEV, LSM9DS1_ADDR_1, LSM9DS1_ODR_119HZ);
+    //select the lowest ODR which is not below the sample rate
+    //e.g. ODR 119Hz with LPF1 cut-off 38Hz for 100Hz sample rate
+    static const struct { uint16_t odr; ELSM9DS1OutputDataRate lsm9ds1_odr; } odr_table[] =
+    {
+        {15, LSM9DS1_ODR_14_9HZ}, {60, LSM9DS1_ODR_59_5HZ}, {119, LSM9DS1_ODR_119HZ},
+        {238, LSM9DS1_ODR_238HZ}, {476, LSM9DS1_ODR_476HZ}, {952, LSM9DS1_ODR_952HZ}
+    };
+    uint16_t rate = imu_get_odr();
+    ELSM9DS1OutputDataRate odr = LSM9DS1_ODR_952HZ;
+    for (size_t i=0; i<sizeof(odr_table)/sizeof(odr_table[0]); i++)
+    {
+        if (odr_table[i].odr >= rate)
+        {
+            odr = odr_table[i].lsm9ds1_odr;
+            break;
+        }
+    }
+    uint8_t addr = (imu_config.i2c_addr != 0) ? imu_config.i2c_addr : LSM9DS1_ADDR_1;
+
+    if (!lsm9ds1_init(imu_config.i2c_device, addr, odr))
+    {
+        return false;
+    }
+    bool is_ok = imu_decimator_init();
     is_ok = is_ok && lsm9ds1_register_callback(&lsm9ds1_cb);
-    is_ok = is_ok && lsm9ds1_start_reader_thread(IMU_SAMPLE_INTERVAL, IMU_NUM_SAMPLES, IMU_AVG_SAMPLES);
+    is_ok = is_ok && lsm9ds1_set_realtime_config(&imu_config.rt);
+    is_ok = is_ok && lsm9ds1_start_reader_thread(imu_config.sample_interval, imu_config.num_samples, false);
+    if (!is_ok)
+    {
+        //deregistering fails harmlessly if the callback has not been registered
+        lsm9ds1_deregister_callback(&lsm9ds1_cb);
+        lsm9ds1_deinit();
+    }
     return is_ok;
 }
 
@@ -152,6 +401,515 @@ static bool snsGyroscopeDestroy_LSM9DS1()
     return is_ok;
 }
 
+static bool imu_config_check(const TSnsImuConfig* config)
+{
+    return (config != NULL) &&
+           ((config->type == SNS_IMU_MPU6050) || (config->type == SNS_IMU_LSM9DS1) || (config->type == SNS_IMU_NONE)) &&
+           (config->i2c_device[0] != '\0') &&
+           (memchr(config->i2c_device, '\0', SNS_IMU_MAX_DEVICE_NAME) != NULL) &&
+           (config->sample_interval >= 1) &&
+           (config->num_samples >= 1) && (config->num_samples <= SNS_IMU_MAX_NUM_SAMPLES) &&
+           (config->decimation_taps <= DECIMATOR_MAX_TAPS) &&
+           (!config->average || ((imu_decimation_length(config) >= 1) && (imu_decimation_length(config) <= DECIMATOR_MAX_TAPS)));
+}
+
+/**
+ * Remove leading and trailing white space in place
+ */
+static char* imu_config_trim(char* s)
+{
+    while (isspace((unsigned char)*s))
+    {
+        s++;
+    }
+    char* end = s + strlen(s);
+    while ((end > s) && isspace((unsigned char)end[-1]))
+    {
+        end--;
+    }
+    *end = '\0';
+    return s;
+}
+
+static bool imu_config_parse_bool(const char* value, bool* result)
+{
+    if ((strcmp(value, "true") == 0) || (strcmp(value, "1") == 0) || (strcmp(value, "yes") == 0))
+    {
+        *result = true;
+        return true;
+    }
+    if ((strcmp(value, "false") == 0) || (strcmp(value, "0") == 0) || (strcmp(value, "no") == 0))
+    {
+        *result = false;
+        return true;
+    }
+    return false;
+}
+
+static bool imu_config_parse_int(const char* value, long min, long max, long* result)
+{
+    char* end = NULL;
+    long l = strtol(value, &end, 0);
+    if ((end == value) || (*end != '\0') || (l < min) || (l > max))
+    {
+        return false;
+    }
+    *result = l;
+    return true;
+}
+
+static bool imu_config_parse_line(char* key, char* value, TSnsImuConfig* config)
+{
+    long l = 0;
+    bool b = false;
+
+    if (strcmp(key, "type") == 0)
+    {
+        if (strcmp(value, "mpu6050") == 0)
+        {
+            config->type = SNS_IMU_MPU6050;
+        }
+        else if (strcmp(value, "lsm9ds1") == 0)
+        {
+            config->type = SNS_IMU_LSM9DS1;
+        }
+        else if (strcmp(value, "none") == 0)
+        {
+            config->type = SNS_IMU_NONE;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    else if (strcmp(key, "i2c_device") == 0)
+    {
+        if ((value[0] == '\0') || (strlen(value) >= SNS_IMU_MAX_DEVICE_NAME))
+        {
+            return false;
+        }
+        strcpy(config->i2c_device, value);
+    }
+    else if ((strcmp(key, "i2c_addr") == 0) && imu_config_parse_int(value, 0, 0x7F, &l))
+    {
+        config->i2c_addr = l;
+    }
+    else if ((strcmp(key, "odr") == 0) && imu_config_parse_int(value, 0, 10000, &l))
+    {
+        config->odr = l;
+    }
+    else if ((strcmp(key, "sample_interval") == 0) && imu_config_parse_int(value, 1, 60000, &l))
+    {
+        config->sample_interval = l;
+    }
+    else if ((strcmp(key, "num_samples") == 0) && imu_config_parse_int(value, 1, SNS_IMU_MAX_NUM_SAMPLES, &l))
+    {
+        config->num_samples = l;
+    }
+    else if ((strcmp(key, "average") == 0) && imu_config_parse_bool(value, &b))
+    {
+        config->average = b;
+    }
+    else if ((strcmp(key, "decimation_taps") == 0) && imu_config_parse_int(value, 0, DECIMATOR_MAX_TAPS, &l))
+    {
+        config->decimation_taps = l;
+    }
+    else if ((strcmp(key, "decimation_cic_order") == 0) && imu_config_parse_int(value, 0, DECIMATOR_MAX_TAPS, &l))
+    {
+        config->decimation_cic_order = l;
+    }
+    else if ((strcmp(key, "rt_priority") == 0) && imu_config_parse_int(value, 0, 99, &l))
+    {
+        config->rt.priority = l;
+    }
+    else if ((strcmp(key, "rt_cpu") == 0) && imu_config_parse_int(value, -1, 1023, &l))
+    {
+        config->rt.cpu = l;
+    }
+    else if ((strcmp(key, "rt_lock_memory") == 0) && imu_config_parse_bool(value, &b))
+    {
+        config->rt.lock_memory = b;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool snsImuGetDefaultConfig(TSnsImuConfig* config)
+{
+    if (config == NULL)
+    {
+        return false;
+    }
+    memset(config, 0, sizeof(TSnsImuConfig));
+    config->type = IMU_TYPE;
+    strncpy(config->i2c_device, IMU_I2C_DEV, SNS_IMU_MAX_DEVICE_NAME-1);
+    config->i2c_addr = 0;
+    config->odr = 0;
+    config->sample_interval = IMU_SAMPLE_INTERVAL;
+    config->num_samples = IMU_NUM_SAMPLES;
+    config->average = IMU_AVG_SAMPLES;
+    config->decimation_taps = IMU_DECIMATION_TAPS;
+    config->decimation_cic_order = IMU_DECIMATION_CIC_ORDER;
+    config->rt.priority = IMU_RT_PRIORITY;
+    config->rt.cpu = IMU_RT_CPU;
+    config->rt.lock_memory = IMU_RT_LOCK_MEMORY;
+    return true;
+}
+
+bool snsImuGetConfig(TSnsImuConfig* config)
+{
+    if (config == NULL)
+    {
+        return false;
+    }
+    if (!imu_config_valid)
+    {
+        return snsImuGetDefaultConfig(config);
+    }
+    *config = imu_config;
+    return true;
+}
+
+bool snsImuSetConfig(const TSnsImuConfig* config)
+{
+    if (is_initialized || !imu_config_check(config))
+    {
+        return false;
+    }
+    imu_config = *config;
+    imu_config_valid = true;
+    return true;
+}
+
+bool snsImuLoadConfig(const char* filename, TSnsImuConfig* config)
+{
+    char line[256];
+    unsigned int line_number = 0;
+    bool is_ok = true;
+
+    if ((filename == NULL) || (config == NULL))
+    {
+        return false;
+    }
+    FILE* file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        LOG_ERROR(gContext, "Cannot open IMU configuration file %s", filename);
+        return false;
+    }
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        line_number++;
+        char* comment = strchr(line, '#');
+        if (comment != NULL)
+        {
+            *comment = '\0';
+        }
+        char* key = imu_config_trim(line);
+        if (*key == '\0')
+        {
+            continue;
+        }
+        char* separator = strchr(key, '=');
+        if (separator != NULL)
+        {
+            *separator = '\0';
+        }
+        if ((separator == NULL) || !imu_config_parse_line(imu_config_trim(key), imu_config_trim(separator+1), config))
+        {
+            LOG_ERROR(gContext, "Invalid line %u in IMU configuration file %s", line_number, filename);
+            is_ok = false;
+        }
+    }
+    fclose(file);
+    return is_ok;
+}
+
+/** State of the CAN reception
+ * The conversion state is only accessed from the CAN reader thread
+ */
+typedef struct
+{
+    TCanSignalDb db;                        //signal database
+    bool db_valid;                          //db has been set
+    uint16_t users;                         //wheel and vehicle speed share the CAN reception
+    bool running;                           //CAN reader thread is running
+    bool reverse;                           //last received reverse gear state
+    bool gap;                               //wheel ticks have been lost since the last wheel sample
+    bool init;                              //no wheel sample has been provided yet
+    bool counter_valid[WHEEL_MAX];          //last_counter is valid
+    int64_t last_counter[WHEEL_MAX];        //last rolling counter value per wheel
+    uint64_t last_counter_time[WHEEL_MAX];  //timestamp of last_counter [ns]
+    uint64_t last_speed_time;               //timestamp of the last vehicle speed [ns]
+    TWheelData wheel[CANCOMM_MAX_FRAMES];           //output buffer
+    TVehicleSpeedData speed[CANCOMM_MAX_FRAMES];    //output buffer
+} TCanState;
+
+static TCanState can_state;
+
+static void can_reset_state()
+{
+    can_state.reverse = false;
+    can_state.gap = false;
+    can_state.init = true;
+    for (uint16_t w=0; w<WHEEL_MAX; w++)
+    {
+        can_state.counter_valid[w] = false;
+    }
+    can_state.last_speed_time = 0;
+}
+
+static bool can_match(ECanSignal signal, uint32_t can_id)
+{
+    return can_state.db.signals[signal].defined && (can_state.db.signals[signal].can_id == can_id);
+}
+
+/**
+ * Convert the rolling wheel tick counters of a frame to wheel ticks since the previous frame
+ * @return true if the frame contains wheel tick counters
+ */
+static bool can_process_wheel(const TCanFrame* frame, TWheelData* wheel)
+{
+    bool has_wheel = false;
+    bool qualifier = true;
+    double value = 0;
+    uint64_t timeout = (uint64_t)can_state.db.timeout*1000000;
+
+    if (can_match(CAN_SIGNAL_WHEEL_VALID, frame->can_id))
+    {
+        qualifier = cansignal_decode(&can_state.db.signals[CAN_SIGNAL_WHEEL_VALID], frame->data, frame->len, &value) &&
+                    (value != 0);
+    }
+    memset(wheel, 0, sizeof(TWheelData));
+    wheel->timestamp = frame->timestamp/1000000;
+
+    for (uint16_t w=0; w<WHEEL_MAX; w++)
+    {
+        const TCanSignal* signal = &can_state.db.signals[CAN_SIGNAL_WHEEL_0+w];
+        int64_t counter = 0;
+        if (!can_match((ECanSignal)(CAN_SIGNAL_WHEEL_0+w), frame->can_id))
+        {
+            continue;
+        }
+        has_wheel = true;
+        if (!qualifier || !cansignal_decode_raw(signal, frame->data, frame->len, &counter))
+        {
+            //invalid counter: the ticks until the next valid counter are lost
+            can_state.gap = can_state.gap || can_state.counter_valid[w];
+            can_state.counter_valid[w] = false;
+            continue;
+        }
+        uint64_t interval = frame->timestamp - can_state.last_counter_time[w];
+        if (can_state.counter_valid[w] && (interval <= timeout))
+        {
+            float ticks = (float)wheelodometry_counter_ticks((uint64_t)counter, (uint64_t)can_state.last_counter[w], signal->length);
+            //the driving direction is coded as sign of the wheel ticks
+            wheel->data[w] = can_state.reverse ? -ticks : ticks;
+            wheel->validityBits |= (WHEEL0_VALID << w);
+            wheel->measurementInterval = interval/1000;
+            wheel->validityBits |= WHEEL_MEASINT_VALID;
+        }
+        else if (can_state.counter_valid[w])
+        {
+            //reception interrupted for longer than the timeout
+            can_state.gap = true;
+        }
+        can_state.last_counter[w] = counter;
+        can_state.last_counter_time[w] = frame->timestamp;
+        can_state.counter_valid[w] = true;
+    }
+    if (has_wheel)
+    {
+        wheel->statusBits = (can_state.gap ? WHEEL_STATUS_GAP : 0) | (can_state.init ? WHEEL_STATUS_INIT : 0);
+        can_state.gap = false;
+        can_state.init = false;
+    }
+    return has_wheel;
+}
+
+/**
+ * Decode the vehicle speed of a frame
+ * @return true if the frame contains the vehicle speed
+ */
+static bool can_process_speed(const TCanFrame* frame, TVehicleSpeedData* speed)
+{
+    double value = 0;
+    if (!can_match(CAN_SIGNAL_VEHICLE_SPEED, frame->can_id) ||
+        !cansignal_decode(&can_state.db.signals[CAN_SIGNAL_VEHICLE_SPEED], frame->data, frame->len, &value))
+    {
+        return false;
+    }
+    memset(speed, 0, sizeof(TVehicleSpeedData));
+    speed->timestamp = frame->timestamp/1000000;
+    speed->vehicleSpeed = can_state.reverse ? -fabs(value) : value;
+    speed->validityBits = VEHICLESPEED_VEHICLESPEED_VALID;
+    if (can_state.last_speed_time != 0)
+    {
+        speed->measurementInterval = (frame->timestamp - can_state.last_speed_time)/1000;
+        speed->validityBits |= VEHICLESPEED__MEASINT_VALID;
+    }
+    can_state.last_speed_time = frame->timestamp;
+    return true;
+}
+
+static void can_process_reverse_gear(const TCanFrame* frame)
+{
+    const TCanSignal* signal = &can_state.db.signals[CAN_SIGNAL_REVERSE_GEAR];
+    double value = 0;
+    if (can_match(CAN_SIGNAL_REVERSE_GEAR, frame->can_id) &&
+        cansignal_decode(signal, frame->data, frame->len, &value))
+    {
+        can_state.reverse = (fabs(value - can_state.db.reverse_gear_value) <= fabs(signal->factor)/2);
+    }
+}
+
+static void can_cb(const TCanFrame frames[], uint16_t num_frames, uint32_t dropped)
+{
+    uint16_t num_wheel = 0;
+    uint16_t num_speed = 0;
+
+    if (dropped > 0)
+    {
+        //frames lost in the kernel: no valid tick difference to the previous counters
+        for (uint16_t w=0; w<WHEEL_MAX; w++)
+        {
+            can_state.gap = can_state.gap || can_state.counter_valid[w];
+            can_state.counter_valid[w] = false;
+        }
+    }
+    for (uint16_t i=0; i<num_frames; i++)
+    {
+        //the reverse gear applies to the wheel ticks and speed of the same frame
+        can_process_reverse_gear(&frames[i]);
+        TWheelData* wheel = &can_state.wheel[num_wheel];
+        if (can_process_wheel(&frames[i], wheel))
+        {
+            if ((num_wheel > 0) && (can_state.wheel[num_wheel-1].timestamp == wheel->timestamp))
+            {
+                TWheelData* previous = &can_state.wheel[num_wheel-1];
+                //wheels distributed over several frames with the same timestamp: one element per timestamp
+                for (uint16_t w=0; w<WHEEL_MAX; w++)
+                {
+                    if (wheel->validityBits & (WHEEL0_VALID << w))
+                    {
+                        previous->data[w] = wheel->data[w];
+                    }
+                }
+                previous->validityBits |= wheel->validityBits;
+                previous->statusBits |= wheel->statusBits;
+            }
+            else
+            {
+                num_wheel++;
+            }
+        }
+        if (can_process_speed(&frames[i], &can_state.speed[num_speed]))
+        {
+            num_speed++;
+        }
+    }
+    if (num_wheel > 0)
+    {
+        updateWheelData(can_state.wheel, num_wheel);
+    }
+    if (num_speed > 0)
+    {
+        updateVehicleSpeedData(can_state.speed, num_speed);
+    }
+}
+
+/**
+ * Start the CAN reception for the first user
+ * Without signal database, nothing is started: the services then do not provide data
+ */
+static bool can_start()
+{
+    uint32_t can_ids[CAN_SIGNAL_NUM];
+
+    if (can_state.users == 0)
+    {
+        if (!can_state.db_valid)
+        {
+            const char* filename = getenv(SNS_CAN_CONFIG_ENV);
+            TCanSignalDb db;
+            if (filename != NULL)
+            {
+                if (!cansignal_get_default_db(&db) || !cansignal_load_db(filename, &db) || !snsCanSetConfig(&db))
+                {
+                    LOG_ERROR(gContext, "Invalid CAN signal database %s", filename);
+                    return false;
+                }
+            }
+        }
+        if (can_state.db_valid)
+        {
+            can_reset_state();
+            uint16_t num_ids = cansignal_get_can_ids(&can_state.db, can_ids);
+            bool is_ok = cancomm_init(can_state.db.interface, can_ids, num_ids);
+            is_ok = is_ok && cancomm_register_callback(&can_cb);
+            is_ok = is_ok && cancomm_start_reader_thread();
+            if (!is_ok)
+            {
+                LOG_ERROR(gContext, "Cannot receive from CAN interface %s", can_state.db.interface);
+                cancomm_deregister_callback(&can_cb);
+                cancomm_deinit();
+                return false;
+            }
+            can_state.running = true;
+        }
+    }
+    can_state.users++;
+    return true;
+}
+
+/**
+ * Stop the CAN reception after the last user
+ */
+static bool can_stop()
+{
+    bool is_ok = true;
+    if (can_state.users == 0)
+    {
+        return false;
+    }
+    can_state.users--;
+    if ((can_state.users == 0) && can_state.running)
+    {
+        can_state.running = false;
+        is_ok = cancomm_stop_reader_thread();
+        is_ok = cancomm_deregister_callback(&can_cb) && is_ok;
+        is_ok = cancomm_deinit() && is_ok;
+    }
+    return is_ok;
+}
+
+bool snsCanGetConfig(TCanSignalDb* db)
+{
+    if ((db == NULL) || !can_state.db_valid)
+    {
+        return false;
+    }
+    *db = can_state.db;
+    return true;
+}
+
+bool snsCanSetConfig(const TCanSignalDb* db)
+{
+    uint32_t can_ids[CAN_SIGNAL_NUM];
+    if ((db == NULL) || (can_state.users > 0) || (cansignal_get_can_ids(db, can_ids) == 0) ||
+        (memchr(db->interface, '\0', CAN_SIGNAL_MAX_IFNAME) == NULL))
+    {
+        return false;
+    }
+    can_state.db = *db;
+    can_state.db_valid = true;
+    updateWheelConfiguration(&can_state.db.wheels);
+    return true;
+}
+
 bool snsInit()
 {
     //nothing special to do
@@ -190,14 +948,45 @@ bool snsGyroscopeInit()
     }
     else
     {
-        is_ok = iGyroscopeInit();
-#if defined(IMU_TYPE_MPU6050)
-        is_ok = is_ok && snsGyroscopeInit_MPU6050();
-#elif defined(IMU_TYPE_LSM9DS1)
-        is_ok = is_ok && snsGyroscopeInit_LSM9DS1();
-#else
-        is_ok = false;
-#endif
+        if (!imu_config_valid)
+        {
+            //no explicit configuration: compile time defaults, optionally overridden by the configuration file
+            TSnsImuConfig config;
+            snsImuGetDefaultConfig(&config);
+            const char* filename = getenv(SNS_IMU_CONFIG_ENV);
+            if ((filename != NULL) && !snsImuLoadConfig(filename, &config))
+            {
+                return false;
+            }
+            if (!snsImuSetConfig(&config))
+            {
+                LOG_ERROR_MSG(gContext, "Invalid IMU configuration");
+                return false;
+            }
+        }
+        if (!iGyroscopeInit())
+        {
+            return false;
+        }
+        is_ok = imu_buffers_alloc(imu_config.num_samples);
+        if (imu_config.type == SNS_IMU_MPU6050)
+        {
+            is_ok = is_ok && snsGyroscopeInit_MPU6050();
+        }
+        else if (imu_config.type == SNS_IMU_LSM9DS1)
+        {
+            is_ok = is_ok && snsGyroscopeInit_LSM9DS1();
+        }
+        else
+        {
+            is_ok = false;
+        }
+        if (!is_ok)
+        {
+            //the driver has been released again, no reader thread accesses the buffers
+            imu_buffers_free();
+            iGyroscopeDestroy();
+        }
         is_initialized = is_ok;
     }
     return is_ok;
@@ -212,13 +1001,19 @@ bool snsGyroscopeDestroy()
     }
     else
     {
+        is_ok = true;
         is_initialized = false;
-#if defined(IMU_TYPE_MPU6050)
-        is_ok = is_ok && snsGyroscopeDestroy_MPU6050();
-#elif defined(IMU_TYPE_LSM9DS1)
-        is_ok = is_ok && snsGyroscopeDestroy_LSM9DS1();
-#endif
+        if (imu_config.type == SNS_IMU_MPU6050)
+        {
+            is_ok = is_ok && snsGyroscopeDestroy_MPU6050();
+        }
+        else if (imu_config.type == SNS_IMU_LSM9DS1)
+        {
+            is_ok = is_ok && snsGyroscopeDestroy_LSM9DS1();
+        }
         is_ok = is_ok && iGyroscopeDestroy();
+        //the reader thread has been stopped, the buffers are no longer accessed
+        imu_buffers_free();
     }
     return is_ok;
 }
@@ -235,23 +1030,86 @@ bool snsAccelerationDestroy()
     return snsGyroscopeDestroy();
 }
 
-//+ some dummy implementations
+//wheel and vehicle speed are received via CAN, if a signal database is available
+//the odometer is derived from the wheel ticks
+static bool is_vehicle_speed_initialized = false;
+static bool is_wheel_initialized = false;
+static bool is_odometer_initialized = false;
+
 bool snsVehicleSpeedInit()
 {
-    return iVehicleSpeedInit();
+    bool is_ok = true;
+    if (!is_vehicle_speed_initialized)
+    {
+        is_ok = iVehicleSpeedInit();
+        is_ok = is_ok && can_start();
+        is_vehicle_speed_initialized = is_ok;
+    }
+    return is_ok;
 }
 
 bool snsVehicleSpeedDestroy()
 {
-    return iVehicleSpeedDestroy();
+    bool is_ok = true;
+    if (is_vehicle_speed_initialized)
+    {
+        is_vehicle_speed_initialized = false;
+        is_ok = can_stop();
+        is_ok = iVehicleSpeedDestroy() && is_ok;
+    }
+    return is_ok;
 }
 
 bool snsWheelInit()
 {
-    return iWheelInit();
+    bool is_ok = true;
+    if (!is_wheel_initialized)
+    {
+        is_ok = iWheelInit();
+        is_ok = is_ok && can_start();
+        is_wheel_initialized = is_ok;
+    }
+    return is_ok;
 }
 
 bool snsWheelDestroy()
 {
-    return iWheelDestroy();
+    bool is_ok = true;
+    if (is_wheel_initialized)
+    {
+        is_wheel_initialized = false;
+        is_ok = can_stop();
+        is_ok = iWheelDestroy() && is_ok;
+    }
+    return is_ok;
+}
+
+bool snsOdometerInit()
+{
+    bool is_ok = true;
+    if (!is_odometer_initialized)
+    {
+        //the wheel configuration is published when the signal database is set in can_start()
+        is_ok = can_start();
+        if (is_ok && !iOdometerInit())
+        {
+            //release the CAN reception again
+            can_stop();
+            is_ok = false;
+        }
+        is_odometer_initialized = is_ok;
+    }
+    return is_ok;
+}
+
+bool snsOdometerDestroy()
+{
+    bool is_ok = true;
+    if (is_odometer_initialized)
+    {
+        is_odometer_initialized = false;
+        is_ok = iOdometerDestroy();
+        is_ok = can_stop() && is_ok;
+    }
+    return is_ok;
 }
@@ -0,0 +1,159 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup SensorsService
+* \brief Runtime configuration of the IMU and the CAN bus used by sns-use-sensors
+*
+* \details The IMU type, sampling and batching parameters can be set
+* at runtime, either via snsImuSetConfig() or via a configuration file,
+* before the first call of snsGyroscopeInit()/snsAccelerationInit().
+* If neither is done, the configuration file named by the environment
+* variable SNS_IMU_CONFIG is loaded, if set.
+* The compile time definitions IMU_TYPE_*, IMU_I2C_DEV, IMU_SAMPLE_INTERVAL,
+* IMU_NUM_SAMPLES, IMU_AVG_SAMPLES, IMU_DECIMATION_*, IMU_RT_* only provide
+* the defaults.
+*
+* Wheel ticks, vehicle speed and reverse gear are received via SocketCAN
+* as described by a signal database (see cansignal.h), which is set via
+* snsCanSetConfig() or read from the file named by the environment variable
+* SNS_CAN_CONFIG before the first call of snsWheelInit()/snsVehicleSpeedInit().
+* Without signal database, no wheel and vehicle speed data are provided.
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#ifndef INCLUDE_SNS_USE_SENSORS
+#define INCLUDE_SNS_USE_SENSORS
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "rtsched.h"
+#include "cansignal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Name of the environment variable with the path of the IMU configuration file
+ */
+#define SNS_IMU_CONFIG_ENV "SNS_IMU_CONFIG"
+
+/** Name of the environment variable with the path of the CAN signal database
+ */
+#define SNS_CAN_CONFIG_ENV "SNS_CAN_CONFIG"
+
+/** Maximum length of the I2C device name including terminating 0
+ */
+#define SNS_IMU_MAX_DEVICE_NAME 32
+
+/** Maximum number of samples per callback
+ */
+#define SNS_IMU_MAX_NUM_SAMPLES 1000
+
+/**
+ * Supported IMU types
+ */
+typedef enum
+{
+    SNS_IMU_NONE = 0,       /**< No IMU */
+    SNS_IMU_MPU6050,        /**< InvenSense MPU6050 / MPU9150 */
+    SNS_IMU_LSM9DS1         /**< ST LSM9DS1 */
+} ESnsImuType;
+
+/**
+ * IMU configuration
+ *
+ * Configuration file format: one "key = value" per line, '#' starts a comment.
+ * Keys are the names of the members below, e.g.
+ *   type = lsm9ds1           # mpu6050 | lsm9ds1 | none
+ *   i2c_device = /dev/i2c-1
+ *   i2c_addr = 0x6A
+ *   odr = 119
+ *   sample_interval = 10
+ *   num_samples = 10
+ *   average = true
+ *   decimation_taps = 21
+ *   decimation_cic_order = 0
+ *   rt_priority = 0
+ *   rt_cpu = -1
+ *   rt_lock_memory = false
+ * Keys not present keep their previous value.
+ */
+typedef struct
+{
+    ESnsImuType type;                           /**< IMU type */
+    char i2c_device[SNS_IMU_MAX_DEVICE_NAME];   /**< I2C bus to which the IMU is attached, e.g. "/dev/i2c-1" */
+    uint8_t i2c_addr;                           /**< I2C address of the IMU. 0 selects the default address of the IMU type */
+    uint16_t odr;                               /**< Sensor output data rate [Hz]. Selects the digital low pass (MPU6050) or ODR (LSM9DS1). 0: derived from sample_interval */
+    uint16_t sample_interval;                   /**< Interval at which the IMU is read [ms], >= 1 */
+    uint16_t num_samples;                       /**< Number of samples per callback, 1..SNS_IMU_MAX_NUM_SAMPLES */
+    bool average;                               /**< If true, the samples of one callback are decimated to one sample */
+    uint16_t decimation_taps;                   /**< Number of taps of the decimation low pass. 0: 2*num_samples+1 */
+    uint16_t decimation_cic_order;              /**< If > 0, a CIC decimation filter of this order is used instead of the low pass.
+                                                     Its length decimation_cic_order*(num_samples-1)+1 must not exceed the 64 taps of the filter buffer */
+    TRtSchedConfig rt;                          /**< Real-time configuration of the reader thread */
+} TSnsImuConfig;
+
+/**
+ * Get the default IMU configuration as defined at compile time.
+ * @param config returns the configuration
+ * @return True on success.
+ */
+bool snsImuGetDefaultConfig(TSnsImuConfig* config);
+
+/**
+ * Get the current IMU configuration.
+ * @param config returns the configuration
+ * @return True on success.
+ */
+bool snsImuGetConfig(TSnsImuConfig* config);
+
+/**
+ * Set the IMU configuration.
+ * Must be called before snsGyroscopeInit()/snsAccelerationInit() or after snsGyroscopeDestroy().
+ * @param config the configuration
+ * @return True on success, false if the configuration is invalid or the IMU is running.
+ */
+bool snsImuSetConfig(const TSnsImuConfig* config);
+
+/**
+ * Read an IMU configuration file.
+ * The values found in the file overwrite the corresponding members of config.
+ * @param filename path of the configuration file
+ * @param config configuration to update
+ * @return True on success, false if the file cannot be read or contains invalid lines.
+ */
+bool snsImuLoadConfig(const char* filename, TSnsImuConfig* config);
+
+/**
+ * Get the current CAN signal database.
+ * @param db returns the signal database
+ * @return True on success, false if no signal database has been set.
+ */
+bool snsCanGetConfig(TCanSignalDb* db);
+
+/**
+ * Set the CAN signal database.
+ * Must be called before snsWheelInit()/snsVehicleSpeedInit() or after snsWheelDestroy()/snsVehicleSpeedDestroy().
+ * @param db the signal database, see cansignal_load_db()
+ * @return True on success, false if the CAN reception is running or no signal is defined.
+ */
+bool snsCanSetConfig(const TCanSignalDb* db);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_SNS_USE_SENSORS */
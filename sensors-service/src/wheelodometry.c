@@ -0,0 +1,256 @@
+/**************************************************************************
+ * @brief Incremental odometry from wheel rotation data
+ *
+ * @author agent <agent@local>
+ * @copyright Copyright (C) 2026, agent
+ *
+ * @license MPL-2.0 <http://spdx.org/licenses/MPL-2.0>
+ *
+ **************************************************************************/
+
+
+/** ===================================================================
+ * 1.) INCLUDES
+ */
+
+ //provided interface
+#include "wheelodometry.h"
+
+//standard c library functions
+#include <string.h>
+
+#define WHEELODOMETRY_RAD2DEG 57.295779513082320876
+
+
+/** ===================================================================
+ * 2.) LOCAL FUNCTIONS
+ */
+
+/**
+ * Suitability of an axle for the yaw rate: steered and driven wheels
+ * are affected by the steering geometry and additional slip
+ */
+static int wheelodometry_axle_score(const TWheelConfiguration* wheel)
+{
+    int score = 0;
+    if ((wheel->validityBits & WHEEL_CONFIG_STEERED_VALID) && (wheel->statusBits & WHEEL_CONFIG_STEERED))
+    {
+        score -= 2;
+    }
+    if ((wheel->validityBits & WHEEL_CONFIG_DRIVEN_VALID) && (wheel->statusBits & WHEEL_CONFIG_DRIVEN))
+    {
+        score -= 1;
+    }
+    return score;
+}
+
+/**
+ * Select the left and right wheel of the most suitable axle
+ */
+static void wheelodometry_select_axle(TWheelOdometry* odometry, const TWheelConfigurationArray* config)
+{
+    int best_score = -100;
+
+    for (int8_t l=0; l<WHEEL_MAX; l++)
+    {
+        const TWheelConfiguration* left = &(*config)[l];
+        //wheelIndex 1 is the left-most wheel, 2 the right wheel of a typical axle
+        if (!(odometry->wheelMask & (WHEEL0_VALID << l)) || (left->axleIndex == 0) || (left->wheelIndex != 1))
+        {
+            continue;
+        }
+        for (int8_t r=0; r<WHEEL_MAX; r++)
+        {
+            const TWheelConfiguration* right = &(*config)[r];
+            if (!(odometry->wheelMask & (WHEEL0_VALID << r)) || (right->axleIndex != left->axleIndex) || (right->wheelIndex != 2))
+            {
+                continue;
+            }
+            int score = wheelodometry_axle_score(left) + wheelodometry_axle_score(right);
+            //on a tie, prefer the rear axle
+            if ((score > best_score) || ((score == best_score) && (left->axleIndex > (*config)[odometry->left].axleIndex)))
+            {
+                best_score = score;
+                odometry->left = l;
+                odometry->right = r;
+                odometry->trackWidth = 0;
+                if ((left->validityBits & WHEEL_CONFIG_DISTY_VALID) && (right->validityBits & WHEEL_CONFIG_DISTY_VALID))
+                {
+                    //y axis points to the left
+                    odometry->trackWidth = left->dist2RefPointY - right->dist2RefPointY;
+                }
+            }
+        }
+    }
+}
+
+
+/** ===================================================================
+ * 3.) FUNCTIONS IMPLEMENTING THE PUBLIC INTERFACE OF wheelodometry.h
+ */
+
+bool wheelodometry_init(TWheelOdometry* odometry, const TWheelConfigurationArray* config)
+{
+    if ((odometry == NULL) || (config == NULL))
+    {
+        return false;
+    }
+    memset(odometry, 0, sizeof(TWheelOdometry));
+    odometry->left = -1;
+    odometry->right = -1;
+
+    for (uint16_t w=0; w<WHEEL_MAX; w++)
+    {
+        const TWheelConfiguration* wheel = &(*config)[w];
+        bool circumference_valid = (wheel->validityBits & WHEEL_CONFIG_TIRE_CIRC_VALID) && (wheel->tireRollingCircumference > 0);
+        odometry->unit[w] = wheel->wheelUnit;
+        switch (wheel->wheelUnit)
+        {
+            case WHEEL_UNIT_TICKS:
+                if (circumference_valid && (wheel->validityBits & WHEEL_CONFIG_TICKS_PER_REV_VALID) && (wheel->wheelticksPerRevolution > 0))
+                {
+                    odometry->distancePerUnit[w] = wheel->tireRollingCircumference / wheel->wheelticksPerRevolution;
+                    odometry->wheelMask |= (WHEEL0_VALID << w);
+                }
+                break;
+            case WHEEL_UNIT_SPEED:
+                odometry->distancePerUnit[w] = 1.0;
+                odometry->wheelMask |= (WHEEL0_VALID << w);
+                break;
+            case WHEEL_UNIT_ANGULAR_SPEED:
+                if (circumference_valid)
+                {
+                    odometry->distancePerUnit[w] = wheel->tireRollingCircumference;
+                    odometry->wheelMask |= (WHEEL0_VALID << w);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    wheelodometry_select_axle(odometry, config);
+    return (odometry->wheelMask != 0);
+}
+
+void wheelodometry_reset(TWheelOdometry* odometry)
+{
+    odometry->lastTimestampValid = false;
+}
+
+uint64_t wheelodometry_counter_ticks(uint64_t counter, uint64_t last, uint8_t length)
+{
+    uint64_t mask = (length >= 64) ? ~(uint64_t)0 : ((uint64_t)1 << length) - 1;
+    return (counter - last) & mask;
+}
+
+void wheelodometry_process(TWheelOdometry* odometry, const TWheelData wheelData[], uint16_t numElements,
+                           TWheelOdometryData odometryData[])
+{
+    for (uint16_t i=0; i<numElements; i++)
+    {
+        const TWheelData* in = &wheelData[i];
+        TWheelOdometryData* out = &odometryData[i];
+        float distance[WHEEL_MAX];
+        uint32_t distance_valid = 0;
+        float interval = 0;
+
+        memset(out, 0, sizeof(TWheelOdometryData));
+        out->timestamp = in->timestamp;
+        out->statusBits = in->statusBits;
+
+        //measurement interval [s]: from the sample, or from the previous sample if there has been no gap
+        if ((in->validityBits & WHEEL_MEASINT_VALID) && (in->measurementInterval > 0))
+        {
+            interval = in->measurementInterval / 1000000.0f;
+        }
+        else if (odometry->lastTimestampValid && !(in->statusBits & WHEEL_STATUS_GAP) && (in->timestamp > odometry->lastTimestamp))
+        {
+            interval = (in->timestamp - odometry->lastTimestamp) / 1000.0f;
+        }
+
+        uint32_t valid = in->validityBits & odometry->wheelMask;
+        for (uint16_t w=0; w<WHEEL_MAX; w++)
+        {
+            uint32_t bit = (WHEEL0_VALID << w);
+            if (!(valid & bit))
+            {
+                continue;
+            }
+            float value = in->data[w] * odometry->distancePerUnit[w];
+            if (odometry->unit[w] == WHEEL_UNIT_TICKS)
+            {
+                //value is a distance
+                distance[w] = value;
+                distance_valid |= bit;
+                if (interval > 0)
+                {
+                    out->wheelSpeed[w] = value / interval;
+                    out->wheelSpeedValidityBits |= bit;
+                }
+            }
+            else
+            {
+                //value is a speed
+                out->wheelSpeed[w] = value;
+                out->wheelSpeedValidityBits |= bit;
+                if (interval > 0)
+                {
+                    distance[w] = value * interval;
+                    distance_valid |= bit;
+                }
+            }
+        }
+
+        //vehicle speed and distance: preferably from the selected axle, else from all wheels
+        int8_t l = odometry->left;
+        int8_t r = odometry->right;
+        uint32_t pair = (l >= 0) ? ((WHEEL0_VALID << l) | (WHEEL0_VALID << r)) : 0;
+        if (pair && ((out->wheelSpeedValidityBits & pair) == pair))
+        {
+            out->vehicleSpeed = (out->wheelSpeed[l] + out->wheelSpeed[r]) / 2;
+            out->validityBits |= WHEELODOMETRY_SPEED_VALID;
+            if (odometry->trackWidth > 0)
+            {
+                out->yawRate = (out->wheelSpeed[r] - out->wheelSpeed[l]) / odometry->trackWidth * WHEELODOMETRY_RAD2DEG;
+                out->validityBits |= WHEELODOMETRY_YAWRATE_VALID;
+            }
+        }
+        else if (out->wheelSpeedValidityBits)
+        {
+            uint16_t n = 0;
+            for (uint16_t w=0; w<WHEEL_MAX; w++)
+            {
+                if (out->wheelSpeedValidityBits & (WHEEL0_VALID << w))
+                {
+                    out->vehicleSpeed += out->wheelSpeed[w];
+                    n++;
+                }
+            }
+            out->vehicleSpeed /= n;
+            out->validityBits |= WHEELODOMETRY_SPEED_VALID;
+        }
+
+        if (pair && ((distance_valid & pair) == pair))
+        {
+            out->distance = (distance[l] + distance[r]) / 2;
+            out->validityBits |= WHEELODOMETRY_DISTANCE_VALID;
+        }
+        else if (distance_valid)
+        {
+            uint16_t n = 0;
+            for (uint16_t w=0; w<WHEEL_MAX; w++)
+            {
+                if (distance_valid & (WHEEL0_VALID << w))
+                {
+                    out->distance += distance[w];
+                    n++;
+                }
+            }
+            out->distance /= n;
+            out->validityBits |= WHEELODOMETRY_DISTANCE_VALID;
+        }
+
+        odometry->lastTimestamp = in->timestamp;
+        odometry->lastTimestampValid = true;
+    }
+}
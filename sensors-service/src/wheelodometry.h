@@ -0,0 +1,152 @@
+/**************************************************************************
+ * @brief Incremental odometry from wheel rotation data
+ *
+ * @details Derives per-wheel speeds, vehicle speed, travelled distance and
+ * the differential yaw rate from TWheelData as provided by the wheel
+ * sensor service, using the wheel configuration (ticks per revolution,
+ * tire rolling circumference, wheel positions).
+ *
+ * The engine works incrementally: each input sample produces one output
+ * sample with a constant amount of work, independent of the history.
+ * No dynamic memory is used.
+ *   - Wheel ticks are tick differences per measurement interval (see wheel.h),
+ *     i.e. rollover of the rolling counters on the vehicle bus is already
+ *     resolved by the wheel sensor service with wheelodometry_counter_ticks().
+ *     The travelled distance is
+ *     accumulated with an exact fractional remainder, so that the 16 bit
+ *     odometer counter (see odometer.h) wraps around without drift.
+ *   - After WHEEL_STATUS_GAP, the time since the previous sample is unknown:
+ *     speeds are only derived from the measurement interval of the sample
+ *     itself, not from the timestamp difference. The gap is propagated.
+ *   - The yaw rate is derived from the speed difference of the left and
+ *     right wheel of one axle, preferring a non-steered, non-driven axle.
+ *
+ * Additionally, odometer.c provides the results to clients via the
+ * functions snsWheelOdometry*() declared here.
+ *
+ * @author agent <agent@local>
+ * @copyright Copyright (C) 2026, agent
+ *
+ * @license MPL-2.0 <http://spdx.org/licenses/MPL-2.0>
+ *
+ **************************************************************************/
+
+#ifndef INCLUDE_WHEELODOMETRY
+#define INCLUDE_WHEELODOMETRY
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "wheel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * TWheelOdometryData::validityBits provides information which fields in TWheelOdometryData contain valid data.
+ * It is a or'ed bitmask of the EWheelOdometryValidityBits values.
+ */
+typedef enum {
+    WHEELODOMETRY_SPEED_VALID       = 0x00000001,   /**< Validity bit for field TWheelOdometryData::vehicleSpeed */
+    WHEELODOMETRY_YAWRATE_VALID     = 0x00000002,   /**< Validity bit for field TWheelOdometryData::yawRate */
+    WHEELODOMETRY_DISTANCE_VALID    = 0x00000004    /**< Validity bit for field TWheelOdometryData::distance */
+} EWheelOdometryValidityBits;
+
+/**
+ * Odometry derived from one sample of wheel rotation data
+ */
+typedef struct {
+    uint64_t timestamp;             /**< Timestamp of the wheel rotation data [ms] */
+    float wheelSpeed[WHEEL_MAX];    /**< Speed of each wheel [m/s], negative when driving backward. Index as in TWheelData::data[] */
+    uint32_t wheelSpeedValidityBits;/**< Validity of wheelSpeed[] [bitwise or'ed WHEEL0_VALID ... WHEEL7_VALID] */
+    float vehicleSpeed;             /**< Vehicle speed [m/s], negative when driving backward */
+    float yawRate;                  /**< Yaw rate from the wheel speed difference [degree/s], positive counter-clockwise (left turn) */
+    float distance;                 /**< Distance travelled since the previous sample [m], negative when driving backward */
+    uint32_t statusBits;            /**< Status of the wheel rotation data [bitwise or'ed @ref EWheelStatusBits values] */
+    uint32_t validityBits;          /**< [bitwise or'ed @ref EWheelOdometryValidityBits values] */
+} TWheelOdometryData;
+
+/**
+ * State of the odometry engine
+ */
+typedef struct {
+    float distancePerUnit[WHEEL_MAX];   /**< [m] per tick (WHEEL_UNIT_TICKS) or per revolution (WHEEL_UNIT_ANGULAR_SPEED) */
+    uint32_t wheelMask;                 /**< Wheels which can be used [WHEEL0_VALID ... WHEEL7_VALID] */
+    EWheelUnit unit[WHEEL_MAX];         /**< Unit of the wheel rotation data */
+    int8_t left;                        /**< Index of the left wheel for yaw rate and vehicle speed, -1 if none */
+    int8_t right;                       /**< Index of the right wheel for yaw rate and vehicle speed, -1 if none */
+    float trackWidth;                   /**< Distance between left and right wheel [m] */
+    uint64_t lastTimestamp;             /**< Timestamp of the previous sample [ms] */
+    bool lastTimestampValid;            /**< lastTimestamp may be used to calculate the measurement interval */
+} TWheelOdometry;
+
+/**
+ * Initialize the odometry engine for a wheel configuration.
+ * Wheels without valid ticks per revolution (WHEEL_UNIT_TICKS) or tire rolling circumference
+ * (WHEEL_UNIT_TICKS, WHEEL_UNIT_ANGULAR_SPEED) are ignored.
+ * @param odometry the engine
+ * @param config the wheel configuration as provided by snsWheelGetConfiguration()
+ * @return true if at least one wheel can be used
+ */
+bool wheelodometry_init(TWheelOdometry* odometry, const TWheelConfigurationArray* config);
+
+/**
+ * Forget the previous sample, e.g. after a restart of the wheel data reception
+ * @param odometry the engine
+ */
+void wheelodometry_reset(TWheelOdometry* odometry);
+
+/**
+ * Wheel ticks between two readings of a rolling wheel tick counter
+ * @param counter the current counter value
+ * @param last the previous counter value
+ * @param length the length of the counter in bits 1..64
+ * @return the difference modulo the counter range, i.e. the rollover is handled
+ */
+uint64_t wheelodometry_counter_ticks(uint64_t counter, uint64_t last, uint8_t length);
+
+/**
+ * Process wheel rotation data
+ * @param odometry the engine
+ * @param wheelData the wheel rotation data, ordered by rising timestamps
+ * @param numElements number of elements of wheelData
+ * @param odometryData returns one element per element of wheelData
+ */
+void wheelodometry_process(TWheelOdometry* odometry, const TWheelData wheelData[], uint16_t numElements,
+                           TWheelOdometryData odometryData[]);
+
+/**
+ * Callback type for wheel odometry data.
+ * @param odometryData pointer to an array of TWheelOdometryData with size numElements
+ * @param numElements: allowed range: >=1
+ */
+typedef void (*WheelOdometryCallback)(const TWheelOdometryData odometryData[], uint16_t numElements);
+
+/**
+ * Method to get the latest wheel odometry data (provided by odometer.c)
+ * @param odometryData After calling the method the latest wheel odometry data is written into this parameter.
+ * @return Is true if data can be provided and false otherwise
+ */
+bool snsWheelOdometryGetData(TWheelOdometryData* odometryData);
+
+/**
+ * Register wheel odometry callback (provided by odometer.c)
+ * The callback is invoked at the rate of the wheel rotation data, once snsOdometerInit() has been called.
+ * @param callback The callback which should be registered.
+ * @return True if callback has been registered successfully.
+ */
+bool snsWheelOdometryRegisterCallback(WheelOdometryCallback callback);
+
+/**
+ * Deregister wheel odometry callback (provided by odometer.c)
+ * @param callback The callback which should be deregistered.
+ * @return True if callback has been deregistered successfully.
+ */
+bool snsWheelOdometryDeregisterCallback(WheelOdometryCallback callback);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //INCLUDE_WHEELODOMETRY
@@ -16,6 +16,8 @@
 * @licence end@
 **************************************************************************/
 
+#include <string.h>
+
 #include "globals.h"
 #include "wheel.h"
 
@@ -28,6 +30,10 @@ static TWheelData gWheelData = {0};
 static TSensorStatus gStatus = {0};
 static volatile SensorStatusCallback cbStatus = 0;
 
+static TWheelConfigurationArray gWheelConfiguration = {{0}};
+static bool gWheelConfigurationValid = false;
+static volatile WheelConfigurationCallback cbConfiguration = 0;
+
 bool iWheelInit()
 {
     int i;
@@ -47,6 +53,7 @@ bool iWheelDestroy()
 {
     pthread_mutex_lock(&mutexCb);
     cbWheel = 0;
+    cbConfiguration = 0;
     pthread_mutex_unlock(&mutexCb);
 
     return true;
@@ -109,6 +116,72 @@ void updateWheelData(const TWheelData wheelData[], uint16_t numElements)
             cbWheel(wheelData, numElements);
         }
         pthread_mutex_unlock(&mutexCb);
+        updateOdometerFromWheelData(wheelData, numElements);
+    }
+}
+
+bool snsWheelGetConfiguration(TWheelConfigurationArray* config)
+{
+    bool retval = false;
+    if(config)
+    {
+        pthread_mutex_lock(&mutexData);
+        if (gWheelConfigurationValid)
+        {
+            memcpy(config, &gWheelConfiguration, sizeof(TWheelConfigurationArray));
+            retval = true;
+        }
+        pthread_mutex_unlock(&mutexData);
+    }
+    return retval;
+}
+
+bool snsWheelRegisterConfigurationCallback(WheelConfigurationCallback callback)
+{
+    bool retval = false;
+
+    pthread_mutex_lock(&mutexCb);
+    //only if valid callback and not already registered
+    if(callback && !cbConfiguration)
+    {
+        cbConfiguration = callback;
+        retval = true;
+    }
+    pthread_mutex_unlock(&mutexCb);
+
+    return retval;
+}
+
+bool snsWheelDeregisterConfigurationCallback(WheelConfigurationCallback callback)
+{
+    bool retval = false;
+
+    pthread_mutex_lock(&mutexCb);
+    if((cbConfiguration == callback) && callback)
+    {
+        cbConfiguration = 0;
+        retval = true;
+    }
+    pthread_mutex_unlock(&mutexCb);
+
+    return retval;
+}
+
+void updateWheelConfiguration(const TWheelConfigurationArray* config)
+{
+    if (config)
+    {
+        pthread_mutex_lock(&mutexData);
+        memcpy(&gWheelConfiguration, config, sizeof(TWheelConfigurationArray));
+        gWheelConfigurationValid = true;
+        pthread_mutex_unlock(&mutexData);
+        updateOdometerWheelConfiguration(config);
+        pthread_mutex_lock(&mutexCb);
+        if (cbConfiguration)
+        {
+            cbConfiguration(config);
+        }
+        pthread_mutex_unlock(&mutexCb);
     }
 }
 
@@ -168,5 +241,7 @@ void updateWheelStatus(const TSensorStatus* status)
             cbStatus(status);
         }
         pthread_mutex_unlock(&mutexCb);
+        //the odometer is derived from the wheel rotation data
+        updateOdometerStatus(status);
     }
 }
\ No newline at end of file
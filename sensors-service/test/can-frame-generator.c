@@ -0,0 +1,345 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup SensorsService
+* \brief CAN frame generator for testing the SocketCAN backend
+*
+* \details Sends the wheel tick counters, the vehicle speed and the
+* gear as described by a CAN signal database (see cansignal.h)
+* for a simulated drive: acceleration, cruising on a winding road,
+* braking, reversing. The frames can be sent to a virtual CAN interface:
+*   modprobe vcan
+*   ip link add dev vcan0 type vcan
+*   ip link set up vcan0
+*   can-frame-generator -f /etc/sns-can.conf
+* Option -x checks that all signals of the database can be encoded
+* and decoded without interference, without sending anything.
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+#include "cansignal.h"
+#include "sns-use-sensors.h"
+
+#define TRACK_WIDTH 1.5
+#define GEAR_DRIVE 1
+#define GEAR_REVERSE 7
+
+/**
+ * Simulated drive, repeated every 60s
+ * @param t time [s]
+ * @param speed returns the vehicle speed [m/s], always >= 0
+ * @param yaw_rate returns the yaw rate [rad/s], positive to the left
+ * @param reverse returns true if the reverse gear is engaged
+ */
+static void drive_profile(double t, double* speed, double* yaw_rate, bool* reverse)
+{
+    t = fmod(t, 60.0);
+    *yaw_rate = 0.0;
+    *reverse = false;
+    if (t < 10.0)
+    {
+        *speed = 1.4*t;
+    }
+    else if (t < 30.0)
+    {
+        *speed = 14.0;
+        *yaw_rate = 10.0*M_PI/180.0*sin(2*M_PI*(t-10.0)/10.0);
+    }
+    else if (t < 40.0)
+    {
+        *speed = 1.4*(40.0-t);
+    }
+    else if ((t >= 42.0) && (t < 50.0))
+    {
+        *speed = 2.0;
+        *yaw_rate = -5.0*M_PI/180.0;
+        *reverse = true;
+    }
+    else
+    {
+        *speed = 0.0;
+    }
+}
+
+/**
+ * Encode and decode each signal with several values, in a frame which already contains
+ * all other signals with the same CAN identifier
+ */
+static bool self_test(const TCanSignalDb* db)
+{
+    bool is_ok = true;
+    for (uint16_t i=0; i<CAN_SIGNAL_NUM; i++)
+    {
+        const TCanSignal* signal = &db->signals[i];
+        if (!signal->defined)
+        {
+            continue;
+        }
+        uint64_t mask = (signal->length >= 64) ? ~(uint64_t)0 : ((uint64_t)1 << signal->length) - 1;
+        int64_t values[4] = {0, 1, (int64_t)(mask >> 1), (int64_t)mask};
+        for (uint16_t v=0; v<4; v++)
+        {
+            uint8_t data[CAN_SIGNAL_MAX_DATA] = {0};
+            int64_t expected = values[v];
+            if (signal->is_signed && (signal->length < 64) && (expected >> (signal->length-1)))
+            {
+                expected |= ~mask;
+            }
+            //fill the other signals of the frame with all ones, then set the signal under test
+            for (uint16_t j=0; j<CAN_SIGNAL_NUM; j++)
+            {
+                if ((j != i) && db->signals[j].defined && (db->signals[j].can_id == signal->can_id))
+                {
+                    cansignal_encode_raw(&db->signals[j], -1, data, CAN_SIGNAL_MAX_DATA);
+                }
+            }
+            int64_t raw = 0;
+            bool ok = cansignal_encode_raw(signal, values[v], data, CAN_SIGNAL_MAX_DATA) &&
+                      cansignal_decode_raw(signal, data, CAN_SIGNAL_MAX_DATA, &raw) &&
+                      (raw == expected);
+            //the other signals must not be affected
+            for (uint16_t j=0; j<CAN_SIGNAL_NUM; j++)
+            {
+                const TCanSignal* other = &db->signals[j];
+                if ((j != i) && other->defined && (other->can_id == signal->can_id))
+                {
+                    uint64_t other_mask = (other->length >= 64) ? ~(uint64_t)0 : ((uint64_t)1 << other->length) - 1;
+                    int64_t other_raw = 0;
+                    ok = ok && cansignal_decode_raw(other, data, CAN_SIGNAL_MAX_DATA, &other_raw) &&
+                         (((uint64_t)other_raw & other_mask) == other_mask);
+                }
+            }
+            printf("signal %2u id 0x%03X value %20lld: %s\n", i, signal->can_id & ~CAN_SIGNAL_EFF_FLAG,
+                   (long long)values[v], ok ? "OK" : "FAILED");
+            is_ok = is_ok && ok;
+        }
+    }
+    return is_ok;
+}
+
+static int open_can(const char* interface)
+{
+    struct sockaddr_can addr;
+    struct ifreq ifr;
+
+    int fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, interface, IFNAMSIZ-1);
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    if (ioctl(fd, SIOCGIFINDEX, &ifr) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Check whether can_id carries only the gear signal
+ */
+static bool is_gear_frame(const TCanSignalDb* db, uint32_t can_id)
+{
+    for (uint16_t i=0; i<CAN_SIGNAL_NUM; i++)
+    {
+        if ((i != CAN_SIGNAL_REVERSE_GEAR) && db->signals[i].defined && (db->signals[i].can_id == can_id))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Send one frame with all signals which are defined for can_id
+ */
+static bool send_frame(int fd, const TCanSignalDb* db, uint32_t can_id, const double values[])
+{
+    struct can_frame frame;
+    bool found = false;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.can_id = can_id;
+    frame.can_dlc = 8;
+    for (uint16_t i=0; i<CAN_SIGNAL_NUM; i++)
+    {
+        const TCanSignal* signal = &db->signals[i];
+        if (signal->defined && (signal->can_id == can_id))
+        {
+            if (i <= CAN_SIGNAL_WHEEL_7)
+            {
+                //rolling counter: truncated to the counter length
+                cansignal_encode_raw(signal, (int64_t)values[i], frame.data, frame.can_dlc);
+            }
+            else
+            {
+                cansignal_encode(signal, values[i], frame.data, frame.can_dlc);
+            }
+            found = true;
+        }
+    }
+    return found && (write(fd, &frame, sizeof(frame)) == sizeof(frame));
+}
+
+static void usage(const char* prog)
+{
+    printf("Usage: %s -f database [-i interface] [-p period] [-r gear_period] [-d duration] [-n ticks] [-c circumference] [-g n] [-x]\n", prog);
+    printf("  -f CAN signal database (default: $%s)\n", SNS_CAN_CONFIG_ENV);
+    printf("  -i CAN interface (default: from the database)\n");
+    printf("  -p cycle time of the wheel tick and speed frames in ms (default 20)\n");
+    printf("  -r cycle time of the gear frame in ms (default 100)\n");
+    printf("  -d duration in s (default 60)\n");
+    printf("  -n wheel ticks per revolution (default 96)\n");
+    printf("  -c tire rolling circumference in m (default 1.9)\n");
+    printf("  -g mark every n-th wheel tick frame as invalid (default 0: never)\n");
+    printf("  -x self test of the signal database only\n");
+}
+
+int main(int argc, char* argv[])
+{
+    const char* filename = getenv(SNS_CAN_CONFIG_ENV);
+    const char* interface = NULL;
+    uint32_t period = 20;
+    uint32_t gear_period = 100;
+    uint32_t duration = 60;
+    double ticks_per_rev = 96;
+    double circumference = 1.9;
+    uint32_t invalid_interval = 0;
+    bool test_only = false;
+    TCanSignalDb db;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:i:p:r:d:n:c:g:xh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'f': filename = optarg; break;
+            case 'i': interface = optarg; break;
+            case 'p': period = atoi(optarg); break;
+            case 'r': gear_period = atoi(optarg); break;
+            case 'd': duration = atoi(optarg); break;
+            case 'n': ticks_per_rev = atof(optarg); break;
+            case 'c': circumference = atof(optarg); break;
+            case 'g': invalid_interval = atoi(optarg); break;
+            case 'x': test_only = true; break;
+            default: usage(argv[0]); return EXIT_FAILURE;
+        }
+    }
+    if ((filename == NULL) || (period == 0) || (gear_period == 0) || (circumference <= 0) ||
+        !cansignal_get_default_db(&db) || !cansignal_load_db(filename, &db))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (test_only)
+    {
+        return self_test(&db) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (interface == NULL)
+    {
+        interface = db.interface;
+    }
+    int fd = open_can(interface);
+    if (fd < 0)
+    {
+        printf("ERROR: cannot open CAN interface %s\n", interface);
+        return EXIT_FAILURE;
+    }
+
+    uint32_t can_ids[CAN_SIGNAL_NUM];
+    uint16_t num_ids = cansignal_get_can_ids(&db, can_ids);
+    double values[CAN_SIGNAL_NUM] = {0};
+    double counters[4] = {0};
+    uint64_t frames = 0;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    printf("sending to %s: %u CAN identifiers, cycle %u ms\n", interface, num_ids, period);
+    for (uint64_t cycle=0; cycle*period < duration*1000ULL; cycle++)
+    {
+        double t = cycle*period/1000.0;
+        double speed = 0;
+        double yaw_rate = 0;
+        bool reverse = false;
+        drive_profile(t, &speed, &yaw_rate, &reverse);
+
+        //wheels 0/2 left, 1/3 right
+        for (uint16_t w=0; w<4; w++)
+        {
+            double wheel_speed = speed + ((w % 2) ? 1 : -1)*yaw_rate*TRACK_WIDTH/2*(reverse ? -1 : 1);
+            counters[w] += fabs(wheel_speed)*period/1000.0/circumference*ticks_per_rev;
+            values[CAN_SIGNAL_WHEEL_0+w] = floor(counters[w]);
+        }
+        values[CAN_SIGNAL_WHEEL_VALID] = ((invalid_interval > 0) && (cycle % invalid_interval == invalid_interval-1)) ? 0 : 1;
+        values[CAN_SIGNAL_VEHICLE_SPEED] = speed;
+        values[CAN_SIGNAL_REVERSE_GEAR] = reverse ? GEAR_REVERSE : GEAR_DRIVE;
+
+        //the gear frame is sent first, so that it is already known for the wheel ticks of this cycle
+        bool send_gear = ((cycle*period) % gear_period) < period;
+        for (uint16_t pass=0; pass<2; pass++)
+        {
+            for (uint16_t i=0; i<num_ids; i++)
+            {
+                bool gear_frame = is_gear_frame(&db, can_ids[i]);
+                if ((gear_frame != (pass == 0)) || (gear_frame && !send_gear))
+                {
+                    continue;
+                }
+                if (!send_frame(fd, &db, can_ids[i], values))
+                {
+                    printf("ERROR: cannot send to CAN interface %s\n", interface);
+                    close(fd);
+                    return EXIT_FAILURE;
+                }
+                frames++;
+            }
+        }
+
+        next.tv_nsec += period*1000000L;
+        while (next.tv_nsec >= 1000000000L)
+        {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    printf("sent %llu frames\n", (unsigned long long)frames);
+    close(fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,542 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup SensorsService
+* \brief Benchmark of the IMU drivers on a simulated I2C bus
+*
+* \details Runs the MPU6050 and LSM9DS1 drivers against the simulated
+* register map devices of i2csim.h for each reader mode and measures
+*   - the process CPU time per sample read by the driver,
+*   - the callback latency (callback invocation time minus timestamp of the last sample),
+*   - the timestamp jitter (deviation of the timestamp differences from the nominal interval),
+*   - the wakeup lateness and read duration as reported by the driver statistics.
+* Additionally, reading several slaves on the same bus one by one
+* is compared with a combined sweep (see i2csweep in i2ccomm.h),
+* and the decimation filters (see decimator.h) are compared regarding
+* CPU time and suppression of a vibration above the output Nyquist frequency.
+* Finally, the complete sensors service path (sns-use-sensors.h) is run
+* with several runtime configurations of the batch size, to show the
+* trade-off between callback latency and wakeups.
+* No I2C hardware is required.
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "i2csim.h"
+#include "decimator.h"
+#include "mpu6050.h"
+#include "lsm9ds1.h"
+#include "gyroscope.h"
+#include "sns-use-sensors.h"
+
+#define SIM_I2C_DEV "/dev/i2c-sim"
+
+/** Reader modes of the drivers: see mpu6050_start_reader_thread()
+ */
+typedef struct
+{
+    const char* name;
+    uint16_t num_samples;
+    bool average;
+} TReaderMode;
+
+static const TReaderMode reader_modes[] =
+{
+    {"single",   1, false},
+    {"batch",   10, false},
+    {"average", 10, true}
+};
+
+/** Statistics collected by the callbacks
+ *  The callbacks are invoked from the reader thread only
+ */
+typedef struct
+{
+    uint64_t callbacks;
+    uint64_t samples;
+    uint64_t last_timestamp;
+    uint64_t nominal_delta;
+    double latency_sum;
+    double latency_max;
+    double jitter_sum;
+    double jitter_sqsum;
+    double jitter_max;
+    uint64_t jitter_count;
+} TBenchmarkStats;
+
+static TBenchmarkStats stats;
+static uint16_t samples_per_element;
+
+static uint64_t get_timestamp_us()
+{
+    struct timespec time_value;
+    clock_gettime(CLOCK_MONOTONIC, &time_value);
+    return (uint64_t)time_value.tv_sec*1000000 + time_value.tv_nsec/1000;
+}
+
+static double get_cpu_time_us()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec*1000000.0 + usage.ru_utime.tv_usec +
+           usage.ru_stime.tv_sec*1000000.0 + usage.ru_stime.tv_usec;
+}
+
+static void update_stats(const uint64_t timestamp[], const uint16_t num_elements)
+{
+    //a failed read is signalled by a callback without samples, the bus statistics count the errors
+    if (num_elements == 0)
+    {
+        return;
+    }
+    //driver timestamps have ms resolution - latency is therefore overestimated by up to 1ms
+    double latency = (double)get_timestamp_us() - timestamp[num_elements-1]*1000.0;
+    stats.callbacks++;
+    stats.samples += num_elements*samples_per_element;
+    stats.latency_sum += latency;
+    if (latency > stats.latency_max)
+    {
+        stats.latency_max = latency;
+    }
+    for (uint16_t i=0; i<num_elements; i++)
+    {
+        if (stats.last_timestamp)
+        {
+            double jitter = (double)(timestamp[i] - stats.last_timestamp) - stats.nominal_delta;
+            stats.jitter_sum += jitter;
+            stats.jitter_sqsum += jitter*jitter;
+            stats.jitter_count++;
+            if (fabs(jitter) > stats.jitter_max)
+            {
+                stats.jitter_max = fabs(jitter);
+            }
+        }
+        stats.last_timestamp = timestamp[i];
+    }
+}
+
+static void mpu6050_cb(const TMPU6050Vector3D /*acceleration*/[], const TMPU6050Vector3D /*gyro_angular_rate*/[], const float /*temperature*/[], const uint64_t timestamp[], const uint16_t num_elements)
+{
+    update_stats(timestamp, num_elements);
+}
+
+static void lsm9ds1_cb(const TLSM9DS1Vector3D /*acceleration*/[], const TLSM9DS1Vector3D /*gyro_angular_rate*/[], const float /*temperature*/[], const uint64_t timestamp[], const uint16_t num_elements)
+{
+    update_stats(timestamp, num_elements);
+}
+
+static void print_stats(const char* imu, const TReaderMode* mode, double cpu_us, i2csimbus* bus, const TRtSchedStatistics* rt_stats)
+{
+    uint64_t transactions = 0;
+    uint64_t errors = 0;
+    bus->get_statistics(&transactions, NULL, &errors);
+
+    double jitter_mean = 0.0;
+    double jitter_std = 0.0;
+    if (stats.jitter_count > 0)
+    {
+        jitter_mean = stats.jitter_sum / stats.jitter_count;
+        jitter_std = sqrt(stats.jitter_sqsum / stats.jitter_count - jitter_mean*jitter_mean);
+    }
+    uint64_t cycles = rt_stats->cycles ? rt_stats->cycles : 1;
+    printf("%-8s %-8s %8llu %8llu %10.2f %10.1f %10.1f %8.3f %8.1f %8llu %6llu %9.1f %9.1f %5llu %8.1f %3s\n",
+           imu, mode->name,
+           (unsigned long long)stats.callbacks,
+           (unsigned long long)stats.samples,
+           stats.samples ? cpu_us/stats.samples : 0.0,
+           stats.callbacks ? stats.latency_sum/stats.callbacks : 0.0,
+           stats.latency_max,
+           jitter_std,
+           stats.jitter_max,
+           (unsigned long long)transactions,
+           (unsigned long long)errors,
+           rt_stats->lateness_sum/1000.0/cycles,
+           rt_stats->lateness_max/1000.0,
+           (unsigned long long)rt_stats->missed_deadlines,
+           rt_stats->read_duration_sum/1000.0/cycles,
+           rt_stats->realtime ? "yes" : "no");
+}
+
+static void reset_stats(uint64_t nominal_delta, uint16_t num_samples_per_element)
+{
+    stats = TBenchmarkStats();
+    stats.nominal_delta = nominal_delta;
+    samples_per_element = num_samples_per_element;
+}
+
+static bool run_mpu6050(const TReaderMode* mode, uint64_t interval, uint32_t duration, i2csimbus* bus, const TRtSchedConfig* rt_config)
+{
+    TRtSchedStatistics rt_stats;
+    bool is_ok = mpu6050_init(SIM_I2C_DEV, MPU6050_ADDR_1, MPU6050_DLPF_42HZ);
+    is_ok = is_ok && mpu6050_register_callback(&mpu6050_cb);
+    if (is_ok)
+    {
+        reset_stats(mode->average ? interval*mode->num_samples : interval, mode->average ? mode->num_samples : 1);
+        double cpu_start = get_cpu_time_us();
+        is_ok = is_ok && mpu6050_set_realtime_config(rt_config);
+        is_ok = is_ok && mpu6050_start_reader_thread(interval, mode->num_samples, mode->average);
+        sleep(duration);
+        is_ok = is_ok && mpu6050_stop_reader_thread();
+        double cpu_stop = get_cpu_time_us();
+        is_ok = is_ok && mpu6050_get_statistics(&rt_stats);
+        print_stats("MPU6050", mode, cpu_stop-cpu_start, bus, &rt_stats);
+    }
+    mpu6050_deregister_callback(&mpu6050_cb);
+    mpu6050_deinit();
+    return is_ok;
+}
+
+static bool run_lsm9ds1(const TReaderMode* mode, uint64_t interval, uint32_t duration, i2csimbus* bus, const TRtSchedConfig* rt_config)
+{
+    TRtSchedStatistics rt_stats;
+    bool is_ok = lsm9ds1_init(SIM_I2C_DEV, LSM9DS1_ADDR_1, LSM9DS1_ODR_119HZ);
+    is_ok = is_ok && lsm9ds1_register_callback(&lsm9ds1_cb);
+    if (is_ok)
+    {
+        reset_stats(mode->average ? interval*mode->num_samples : interval, mode->average ? mode->num_samples : 1);
+        double cpu_start = get_cpu_time_us();
+        is_ok = is_ok && lsm9ds1_set_realtime_config(rt_config);
+        is_ok = is_ok && lsm9ds1_start_reader_thread(interval, mode->num_samples, mode->average);
+        sleep(duration);
+        is_ok = is_ok && lsm9ds1_stop_reader_thread();
+        double cpu_stop = get_cpu_time_us();
+        is_ok = is_ok && lsm9ds1_get_statistics(&rt_stats);
+        print_stats("LSM9DS1", mode, cpu_stop-cpu_start, bus, &rt_stats);
+    }
+    lsm9ds1_deregister_callback(&lsm9ds1_cb);
+    lsm9ds1_deinit();
+    return is_ok;
+}
+
+static void gyroscope_cb(const TGyroscopeData gyroData[], uint16_t numElements)
+{
+    double latency = (double)get_timestamp_us() - gyroData[numElements-1].timestamp*1000.0;
+    stats.callbacks++;
+    stats.samples += numElements;
+    stats.latency_sum += latency;
+    if (latency > stats.latency_max)
+    {
+        stats.latency_max = latency;
+    }
+}
+
+/**
+ * Run the sensors service with the given IMU configuration.
+ * The I2C device is replaced by the simulated bus.
+ */
+static bool run_sns(const char* name, const TSnsImuConfig* config, uint32_t duration)
+{
+    TSnsImuConfig sim_config = *config;
+    snprintf(sim_config.i2c_device, SNS_IMU_MAX_DEVICE_NAME, "%s", SIM_I2C_DEV);
+    reset_stats(0, 1);
+    bool is_ok = snsImuSetConfig(&sim_config);
+    is_ok = is_ok && snsGyroscopeInit();
+    is_ok = is_ok && snsGyroscopeRegisterCallback(&gyroscope_cb);
+    if (is_ok)
+    {
+        double cpu_start = get_cpu_time_us();
+        sleep(duration);
+        double cpu_stop = get_cpu_time_us();
+        printf("%-17s %8u %8u %8llu %8llu %10.1f %10.1f %10.1f %10.2f\n",
+               name, sim_config.sample_interval, sim_config.num_samples,
+               (unsigned long long)stats.callbacks,
+               (unsigned long long)stats.samples,
+               stats.callbacks/(double)duration,
+               stats.callbacks ? stats.latency_sum/stats.callbacks : 0.0,
+               stats.latency_max,
+               stats.callbacks ? (cpu_stop-cpu_start)/stats.callbacks : 0.0);
+    }
+    snsGyroscopeDeregisterCallback(&gyroscope_cb);
+    is_ok = snsGyroscopeDestroy() && is_ok;
+    return is_ok;
+}
+
+/**
+ * Read the MPU6050 and the LSM9DS1 data registers num_iterations times,
+ * once with one transaction per register block and once with one sweep per iteration
+ */
+static bool run_sweep(uint32_t num_iterations, i2csimbus* bus)
+{
+    i2ccomm mpu6050;
+    i2ccomm lsm9ds1;
+    i2csweep sweep;
+    uint8_t block[14];
+    uint64_t transactions_start;
+    uint64_t transactions_stop;
+    bool is_ok = mpu6050.init(SIM_I2C_DEV, MPU6050_ADDR_1);
+    is_ok = is_ok && lsm9ds1.init(SIM_I2C_DEV, LSM9DS1_ADDR_1);
+    is_ok = is_ok && sweep.init(SIM_I2C_DEV, MPU6050_ADDR_1);
+    is_ok = is_ok && (sweep.add_read(MPU6050_ADDR_1, 0x3B, 14) >= 0);  //accel, temperature, gyro
+    is_ok = is_ok && (sweep.add_read(LSM9DS1_ADDR_1, 0x15, 2) >= 0);   //temperature
+    is_ok = is_ok && (sweep.add_read(LSM9DS1_ADDR_1, 0x18, 12) >= 0);  //gyro, accel
+
+    if (is_ok)
+    {
+        bus->get_statistics(&transactions_start, NULL, NULL);
+        uint64_t start = get_timestamp_us();
+        for (uint32_t i=0; i<num_iterations; i++)
+        {
+            mpu6050.read_block(0x3B, block, 14);
+            lsm9ds1.read_block(0x15, block, 2);
+            lsm9ds1.read_block(0x18, block, 12);
+        }
+        uint64_t stop = get_timestamp_us();
+        bus->get_statistics(&transactions_stop, NULL, NULL);
+        printf("%-17s %10.1f %8llu\n", "separate", (double)(stop-start)/num_iterations,
+               (unsigned long long)(transactions_stop-transactions_start));
+
+        bus->get_statistics(&transactions_start, NULL, NULL);
+        start = get_timestamp_us();
+        for (uint32_t i=0; i<num_iterations; i++)
+        {
+            sweep.execute();
+        }
+        stop = get_timestamp_us();
+        bus->get_statistics(&transactions_stop, NULL, NULL);
+        printf("%-17s %10.1f %8llu\n", "sweep", (double)(stop-start)/num_iterations,
+               (unsigned long long)(transactions_stop-transactions_start));
+    }
+    mpu6050.deinit();
+    lsm9ds1.deinit();
+    sweep.deinit();
+    return is_ok;
+}
+
+/**
+ * Decimate a 7 channel vibration of vib_frequency (integer Hz) sampled at 100Hz by 10
+ * and print the CPU time per input sample and the residual amplitude of the vibration
+ */
+static void run_decimator(const char* name, decimator* filter, uint16_t vib_frequency)
+{
+    const uint16_t batch = 10;
+    const uint32_t num_batches = 100000;
+    float table[7][100];
+    float input[7][batch];
+    float output[7][batch/10+1];
+    const float* in_channels[7];
+    float* out_channels[7];
+    uint64_t timestamp[batch];
+    uint64_t out_timestamp[batch/10+1];
+    float max_amplitude = 0.0;
+
+    //one second of the vibration, precomputed to keep sin() out of the measurement
+    for (uint16_t c=0; c<7; c++)
+    {
+        for (uint16_t n=0; n<100; n++)
+        {
+            table[c][n] = sin(2.0*M_PI*vib_frequency*n/100.0 + c);
+        }
+        in_channels[c] = input[c];
+        out_channels[c] = output[c];
+    }
+
+    filter->reset();
+    double cpu_start = get_cpu_time_us();
+    for (uint32_t b=0; b<num_batches; b++)
+    {
+        for (uint16_t i=0; i<batch; i++)
+        {
+            uint64_t n = (uint64_t)b*batch+i;
+            timestamp[i] = n*10;
+            for (uint16_t c=0; c<7; c++)
+            {
+                input[c][i] = table[c][n%100];
+            }
+        }
+        uint16_t num_out = filter->process(in_channels, timestamp, batch, out_channels, out_timestamp);
+        //skip the settling phase
+        for (uint16_t j=0; (j<num_out) && (b>10); j++)
+        {
+            if (fabs(output[0][j]) > max_amplitude)
+            {
+                max_amplitude = fabs(output[0][j]);
+            }
+        }
+    }
+    double cpu_stop = get_cpu_time_us();
+    printf("%-17s %10.1f %10.4f %8u\n", name, (cpu_stop-cpu_start)*1000.0/(num_batches*batch),
+           max_amplitude, filter->get_delay());
+}
+
+static void usage(const char* prog)
+{
+    printf("Usage: %s [-d duration] [-i interval] [-t transaction_latency] [-b byte_latency] [-e error_interval] [-r priority] [-c cpu] [-m] [-f config_file]\n", prog);
+    printf("  -d duration per run in s (default 2)\n");
+    printf("  -i sample interval in ms (default 10)\n");
+    printf("  -t simulated bus latency per transaction in us (default 50)\n");
+    printf("  -b simulated bus latency per byte in us (default 25, i.e. 400kHz)\n");
+    printf("  -e inject an error every n-th transaction (default 0: off)\n");
+    printf("  -r SCHED_FIFO priority of the reader thread (default 0: default scheduling)\n");
+    printf("  -c bind the reader thread to this CPU (default -1: no affinity)\n");
+    printf("  -m lock the process memory (mlockall)\n");
+    printf("  -f additionally run the sensors service with this IMU configuration file\n");
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t duration = 2;
+    uint64_t interval = 10;
+    uint32_t transaction_us = 50;
+    uint32_t byte_us = 25;
+    uint32_t error_interval = 0;
+    TRtSchedConfig rt_config = {0, -1, false};
+    const char* config_file = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:i:t:b:e:r:c:mf:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'd': duration = atoi(optarg); break;
+            case 'i': interval = atoi(optarg); break;
+            case 't': transaction_us = atoi(optarg); break;
+            case 'b': byte_us = atoi(optarg); break;
+            case 'e': error_interval = atoi(optarg); break;
+            case 'r': rt_config.priority = atoi(optarg); break;
+            case 'c': rt_config.cpu = atoi(optarg); break;
+            case 'm': rt_config.lock_memory = true; break;
+            case 'f': config_file = optarg; break;
+            default: usage(argv[0]); return EXIT_FAILURE;
+        }
+    }
+
+    //a car driving a slalom on a bumpy road
+    TI2CSimMotionSegment script[2] =
+    {
+        {1000, {0.1, 0.2, 1.0}, {0.0, 0.0,  15.0}, 0.05, 12.0, 30.0},
+        {1000, {0.1,-0.2, 1.0}, {0.0, 0.0, -15.0}, 0.05, 12.0, 30.0}
+    };
+
+    mpu6050sim mpu6050(MPU6050_ADDR_1);
+    lsm9ds1sim lsm9ds1(LSM9DS1_ADDR_1);
+    mpu6050.set_motion_script(script, 2, true);
+    lsm9ds1.set_motion_script(script, 2, true);
+    mpu6050.set_noise(0.01, 0.1);
+    lsm9ds1.set_noise(0.01, 0.1);
+
+    bool is_ok = true;
+    const uint16_t num_modes = sizeof(reader_modes)/sizeof(reader_modes[0]);
+
+    printf("sample interval %llu ms, bus latency %u us + %u us/byte, error interval %u\n",
+           (unsigned long long)interval, transaction_us, byte_us, error_interval);
+    printf("%-8s %-8s %8s %8s %10s %10s %10s %8s %8s %8s %6s %9s %9s %5s %8s %3s\n",
+           "IMU", "mode", "cb", "samples", "cpu[us]", "lat[us]", "latmax[us]",
+           "jit[ms]", "jmax[ms]", "i2c-tx", "i2c-er",
+           "wake[us]", "wmax[us]", "miss", "read[us]", "rt");
+
+    for (uint16_t i=0; i<num_modes; i++)
+    {
+        //fresh bus per run, so that the bus statistics belong to the run
+        i2csimbus bus;
+        bus.attach(&mpu6050);
+        bus.attach(&lsm9ds1);
+        bus.set_latency(transaction_us, byte_us);
+        bus.set_error_injection(error_interval);
+        is_ok = is_ok && i2ccomm::register_backend(SIM_I2C_DEV, &bus);
+        is_ok = is_ok && run_mpu6050(&reader_modes[i], interval, duration, &bus, &rt_config);
+        i2ccomm::deregister_backend(SIM_I2C_DEV);
+    }
+
+    for (uint16_t i=0; i<num_modes; i++)
+    {
+        i2csimbus bus;
+        bus.attach(&mpu6050);
+        bus.attach(&lsm9ds1);
+        bus.set_latency(transaction_us, byte_us);
+        bus.set_error_injection(error_interval);
+        is_ok = is_ok && i2ccomm::register_backend(SIM_I2C_DEV, &bus);
+        is_ok = is_ok && run_lsm9ds1(&reader_modes[i], interval, duration, &bus, &rt_config);
+        i2ccomm::deregister_backend(SIM_I2C_DEV);
+    }
+
+    {
+        i2csimbus bus;
+        bus.attach(&mpu6050);
+        bus.attach(&lsm9ds1);
+        bus.set_latency(transaction_us, byte_us);
+        is_ok = is_ok && i2ccomm::register_backend(SIM_I2C_DEV, &bus);
+        printf("\n%-17s %10s %8s\n", "MPU6050+LSM9DS1", "t/it[us]", "i2c-tx");
+        is_ok = is_ok && run_sweep(1000, &bus);
+        i2ccomm::deregister_backend(SIM_I2C_DEV);
+    }
+
+    {
+        decimator boxcar;
+        decimator cic;
+        decimator lowpass;
+        decimator lowpass_steep;
+        boxcar.init_cic(1, 10, 7);
+        cic.init_cic(3, 10, 7);
+        lowpass.init_lowpass(21, 10, 7);
+        lowpass_steep.init_lowpass(40, 10, 7);
+        printf("\n%-17s %10s %10s %8s\n", "decimate 10:1", "t/smp[ns]", "ampl@42Hz", "delay");
+        run_decimator("boxcar", &boxcar, 42);
+        run_decimator("cic order 3", &cic, 42);
+        run_decimator("lowpass 21 taps", &lowpass, 42);
+        run_decimator("lowpass 40 taps", &lowpass_steep, 42);
+    }
+
+    {
+        //batch size configured at runtime: fewer wakeups of the consumer vs. higher latency
+        static const struct { const char* name; uint16_t num_samples; bool average; } sns_modes[] =
+        {
+            {"sns single",   1, false},
+            {"sns batch 5",  5, false},
+            {"sns batch 20", 20, false},
+            {"sns average 5", 5, true},
+            {"sns average 10", 10, true}
+        };
+        i2csimbus bus;
+        bus.attach(&mpu6050);
+        bus.attach(&lsm9ds1);
+        bus.set_latency(transaction_us, byte_us);
+        is_ok = is_ok && i2ccomm::register_backend(SIM_I2C_DEV, &bus);
+        printf("\n%-17s %8s %8s %8s %8s %10s %10s %10s %10s\n",
+               "sensors service", "int[ms]", "batch", "cb", "samples", "cb/s", "lat[us]", "latmax[us]", "cpu/cb[us]");
+        TSnsImuConfig config;
+        for (uint16_t i=0; i<sizeof(sns_modes)/sizeof(sns_modes[0]); i++)
+        {
+            snsImuGetDefaultConfig(&config);
+            config.type = SNS_IMU_LSM9DS1;
+            config.sample_interval = interval;
+            config.num_samples = sns_modes[i].num_samples;
+            config.average = sns_modes[i].average;
+            config.rt = rt_config;
+            is_ok = is_ok && run_sns(sns_modes[i].name, &config, duration);
+        }
+        if (config_file)
+        {
+            snsImuGetDefaultConfig(&config);
+            is_ok = is_ok && snsImuLoadConfig(config_file, &config);
+            is_ok = is_ok && run_sns("sns config file", &config, duration);
+        }
+        i2ccomm::deregister_backend(SIM_I2C_DEV);
+    }
+
+    if (!is_ok)
+    {
+        printf("ERROR: benchmark failed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
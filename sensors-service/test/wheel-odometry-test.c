@@ -0,0 +1,209 @@
+/**************************************************************************
+* @licence app begin@
+*
+* SPDX-License-Identifier: MPL-2.0
+*
+* \ingroup SensorsService
+* \brief Test of the wheel odometry and the odometer
+*
+* \details Feeds known wheel tick sequences for a 4-wheel vehicle into the
+* odometry engine and checks the travelled distance, the vehicle speed and
+* the yaw rate. Also checks the rollover of the rolling wheel tick counters
+* and of the 16 bit odometer counter. No backend is started, the wheel data
+* is passed directly to the sensors service as a backend would do.
+*
+* \author agent <agent@local>
+*
+* \copyright Copyright (C) 2026, agent
+*
+* \license
+* This Source Code Form is subject to the terms of the
+* Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed with
+* this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* @licence end@
+**************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "globals.h"
+#include "wheelodometry.h"
+
+#define TICKS_PER_REV 100
+#define CIRCUMFERENCE 2.0f          //[m], i.e. 0.02m per tick
+#define TRACK_WIDTH 1.6f            //[m]
+#define INTERVAL_US 100000          //measurement interval [us]
+#define ODOMETER_SAMPLES 700        //1m each: more than the 655.35m range of the odometer
+#define ODOMETER_CHUNK 70           //more than the chunk size of odometer.c
+
+#define RAD2DEG 57.295779513082320876
+
+static bool gOk = true;
+static uint32_t gOdometerElements = 0;
+static TOdometerData gLastOdometer;
+
+static void check(bool condition, const char* name)
+{
+    if (!condition)
+    {
+        printf("FAILED: %s\n", name);
+        gOk = false;
+    }
+}
+
+static bool near(float value, float expected, float tolerance)
+{
+    return fabs(value - expected) <= tolerance;
+}
+
+static void cbOdometer(const TOdometerData odometerData[], uint16_t numElements)
+{
+    gOdometerElements += numElements;
+    gLastOdometer = odometerData[numElements-1];
+}
+
+/**
+ * Front axle steered and driven, rear axle free rolling: the rear axle is used
+ */
+static void setConfiguration(TWheelConfigurationArray* config)
+{
+    memset(config, 0, sizeof(TWheelConfigurationArray));
+    for (int w = 0; w < 4; w++)
+    {
+        TWheelConfiguration* wheel = &(*config)[w];
+        wheel->wheelUnit = WHEEL_UNIT_TICKS;
+        wheel->axleIndex = (w < 2) ? 1 : 2;
+        wheel->wheelIndex = (w % 2) + 1;
+        wheel->wheelticksPerRevolution = TICKS_PER_REV;
+        wheel->tireRollingCircumference = CIRCUMFERENCE;
+        wheel->dist2RefPointY = (wheel->wheelIndex == 1) ? TRACK_WIDTH/2 : -TRACK_WIDTH/2;
+        wheel->statusBits = (w < 2) ? (WHEEL_CONFIG_STEERED | WHEEL_CONFIG_DRIVEN) : 0;
+        wheel->validityBits = WHEEL_CONFIG_TICKS_PER_REV_VALID | WHEEL_CONFIG_TIRE_CIRC_VALID |
+                              WHEEL_CONFIG_DISTY_VALID | WHEEL_CONFIG_STEERED_VALID | WHEEL_CONFIG_DRIVEN_VALID;
+    }
+}
+
+static TWheelData wheelTicks(uint64_t timestamp, float frontLeft, float frontRight, float rearLeft, float rearRight)
+{
+    TWheelData wheel;
+    memset(&wheel, 0, sizeof(wheel));
+    wheel.timestamp = timestamp;
+    wheel.data[0] = frontLeft;
+    wheel.data[1] = frontRight;
+    wheel.data[2] = rearLeft;
+    wheel.data[3] = rearRight;
+    wheel.measurementInterval = INTERVAL_US;
+    wheel.validityBits = WHEEL0_VALID | WHEEL1_VALID | WHEEL2_VALID | WHEEL3_VALID | WHEEL_MEASINT_VALID;
+    return wheel;
+}
+
+static void testCounterTicks()
+{
+    check(wheelodometry_counter_ticks(120, 100, 8) == 20, "counter difference");
+    check(wheelodometry_counter_ticks(4, 250, 8) == 10, "8 bit counter rollover");
+    check(wheelodometry_counter_ticks(0x0003, 0xFFFE, 16) == 5, "16 bit counter rollover");
+    check(wheelodometry_counter_ticks(2, UINT64_MAX, 64) == 3, "64 bit counter rollover");
+}
+
+static void testOdometry()
+{
+    TWheelConfigurationArray config;
+    TWheelOdometry odometry;
+    TWheelData wheel[4];
+    TWheelOdometryData out[4];
+
+    setConfiguration(&config);
+    check(wheelodometry_init(&odometry, &config), "init");
+    check((odometry.left == 2) && (odometry.right == 3), "rear axle selected");
+
+    //straight: 50 ticks per 100ms on the rear axle = 1m, 10m/s
+    wheel[0] = wheelTicks(1000, 52, 52, 50, 50);
+    //left turn: the right wheel travels further
+    wheel[1] = wheelTicks(1100, 45, 65, 40, 60);
+    //backward
+    wheel[2] = wheelTicks(1200, -10, -10, -10, -10);
+    //after a gap without measurement interval: distance only
+    wheel[3] = wheelTicks(1500, 50, 50, 50, 50);
+    wheel[3].validityBits &= ~WHEEL_MEASINT_VALID;
+    wheel[3].statusBits = WHEEL_STATUS_GAP;
+
+    wheelodometry_process(&odometry, wheel, 4, out);
+
+    check(out[0].validityBits == (WHEELODOMETRY_SPEED_VALID | WHEELODOMETRY_YAWRATE_VALID | WHEELODOMETRY_DISTANCE_VALID),
+          "straight validity");
+    check(near(out[0].distance, 1.0f, 1e-4f), "straight distance");
+    check(near(out[0].vehicleSpeed, 10.0f, 1e-3f), "straight speed");
+    check(near(out[0].yawRate, 0.0f, 1e-3f), "straight yaw rate");
+
+    check(near(out[1].distance, 1.0f, 1e-4f), "turn distance");
+    check(near(out[1].vehicleSpeed, 10.0f, 1e-3f), "turn speed");
+    check(near(out[1].yawRate, (float)((12.0 - 8.0)/TRACK_WIDTH*RAD2DEG), 1e-2f), "turn yaw rate");
+
+    check(near(out[2].distance, -0.2f, 1e-4f), "backward distance");
+    check(near(out[2].vehicleSpeed, -2.0f, 1e-3f), "backward speed");
+
+    check(out[3].validityBits == WHEELODOMETRY_DISTANCE_VALID, "gap validity");
+    check(near(out[3].distance, 1.0f, 1e-4f), "gap distance");
+    check(out[3].statusBits == WHEEL_STATUS_GAP, "gap status");
+
+    //without measurement interval, the timestamp difference is used
+    wheel[0] = wheelTicks(1600, 25, 25, 25, 25);
+    wheel[0].validityBits &= ~WHEEL_MEASINT_VALID;
+    wheelodometry_process(&odometry, wheel, 1, out);
+    check(near(out[0].vehicleSpeed, 5.0f, 1e-3f), "speed from timestamps");
+}
+
+static void testOdometer()
+{
+    TWheelConfigurationArray config;
+    TWheelData wheel[ODOMETER_CHUNK];
+    uint64_t timestamp = 0;
+
+    iWheelInit();
+    iOdometerInit();
+    check(snsOdometerRegisterCallback(&cbOdometer), "register callback");
+
+    //without wheel configuration, the odometer is inactive
+    wheel[0] = wheelTicks(timestamp, 50, 50, 50, 50);
+    updateWheelData(wheel, 1);
+    check(gOdometerElements == 0, "inactive without configuration");
+
+    setConfiguration(&config);
+    updateWheelConfiguration(&config);
+
+    for (int sample = 0; sample < ODOMETER_SAMPLES; sample += ODOMETER_CHUNK)
+    {
+        for (int i = 0; i < ODOMETER_CHUNK; i++)
+        {
+            timestamp += INTERVAL_US/1000;
+            wheel[i] = wheelTicks(timestamp, 50, 50, 50, 50);
+        }
+        updateWheelData(wheel, ODOMETER_CHUNK);
+    }
+
+    check(gOdometerElements == ODOMETER_SAMPLES, "odometer elements");
+    check(gLastOdometer.validityBits & ODOMETER_TRAVELLEDDISTANCE_VALID, "odometer validity");
+    //700m = 70000cm wrap around to 4464cm, at most 1cm may still be in the remainder
+    uint16_t expected = (uint16_t)(ODOMETER_SAMPLES*100 % 65536);
+    check((gLastOdometer.travelledDistance == expected) || (gLastOdometer.travelledDistance == expected-1),
+          "odometer rollover");
+
+    snsOdometerDeregisterCallback(&cbOdometer);
+    iOdometerDestroy();
+    iWheelDestroy();
+}
+
+int main()
+{
+    testCounterTicks();
+    testOdometry();
+    testOdometer();
+
+    printf("%s\n", gOk ? "OK" : "FAILED");
+    return gOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}